@@ -2,6 +2,9 @@
 
 #include <magfapi.h>
 
+#include <cstring>
+#include <vector>
+
 static const MagicFormatPluginInterface *_moduleIntf = NULL;
 
 MAGICAPI void __MAGICCALL SetInterface( const MagicFormatPluginInterface *intf )
@@ -41,8 +44,9 @@ class FormatA4L4 : public MagicFormat
 
 	void GetTextureRWFormat(MAGIC_RASTER_FORMAT& rasterFormatOut, unsigned int& depthOut, MAGIC_COLOR_ORDERING& colorOrderOut) const
 	{
-		rasterFormatOut = RASTER_8888;
-		depthOut = 32;
+		// 8bit luminance-alpha in RenderWare has the same layout as A4L4.
+		rasterFormatOut = RASTER_LUM_ALPHA;
+		depthOut = 8;
 		colorOrderOut = COLOR_BGRA;
 	}
 
@@ -51,15 +55,7 @@ class FormatA4L4 : public MagicFormat
         size_t stride = getD3DBitmapStride(texMipWidth, 8);
 		for (unsigned int row = 0; row < texMipHeight; row++)
 		{
-            const pixel_t *rowData = (const pixel_t*)getD3DBitmapConstRow(texData, stride, row);
-            void *dstRow = getD3DBitmapRow(texOut, dstRowStride, row);
-
-            for (unsigned int col = 0; col < texMipWidth; col++)
-            {
-			    const pixel_t *theTexel = rowData + col;
-			    unsigned char lum = theTexel->lum * 17;
-			    _moduleIntf->PutTexelRGBA(dstRow, col, RASTER_8888, 32, COLOR_BGRA, lum, lum, lum, theTexel->alpha * 17);
-            }
+            memcpy(getD3DBitmapRow(texOut, dstRowStride, row), getD3DBitmapConstRow(texData, stride, row), texMipWidth);
 		}
 	}
 
@@ -68,19 +64,33 @@ class FormatA4L4 : public MagicFormat
 		void *texOut) const override
 	{
         size_t stride = getD3DBitmapStride(texMipWidth, 8);
+
+        if (rasterFormat == RASTER_LUM_ALPHA && depth == 8 && paletteType == PALETTE_NONE)
+        {
+            for (unsigned int row = 0; row < texMipHeight; row++)
+            {
+                memcpy(getD3DBitmapRow(texOut, stride, row), getD3DBitmapConstRow(texelSource, srcRowStride, row), texMipWidth);
+            }
+
+            return;
+        }
+
+        std::vector <unsigned char> rgbaRow(texMipWidth * 4);
+
 		for (unsigned int row = 0; row < texMipHeight; row++)
 		{
             const void *srcRow = getD3DBitmapConstRow(texelSource, srcRowStride, row);
             pixel_t *dstRow = (pixel_t*)getD3DBitmapRow(texOut, stride, row);
 
+            _moduleIntf->BrowseTexelRowRGBA(srcRow, texMipWidth, rasterFormat, depth, colorOrder, paletteType, paletteData, paletteSize, rgbaRow.data());
+
             for (unsigned int col = 0; col < texMipWidth; col++)
             {
-			    unsigned char r, g, b, a;
-			    _moduleIntf->BrowseTexelRGBA(srcRow, col, rasterFormat, depth, colorOrder, paletteType, paletteData, paletteSize, r, g, b, a);
-			    unsigned char lumVal = rgbToLuminance(r, g, b);
+                const unsigned char *rgba = &rgbaRow[col * 4];
+			    unsigned char lumVal = rgbToLuminance(rgba[0], rgba[1], rgba[2]);
 			    pixel_t *theTexel = (dstRow + col);
 			    theTexel->lum = lumVal / 17;
-			    theTexel->alpha = a / 17;
+			    theTexel->alpha = rgba[3] / 17;
             }
 		}
 	}
@@ -88,6 +98,11 @@ class FormatA4L4 : public MagicFormat
 
 static FormatA4L4 a4l4Format;
 
+MAGICAPI unsigned int __MAGICCALL GetFormatCapabilities(void)
+{
+	return ( MAGIC_FORMAT_CAPS_RW_LAYOUT | MAGIC_FORMAT_CAPS_ROW_BANDS );
+}
+
 MAGICAPI MagicFormat * __MAGICCALL GetFormatInstance(unsigned int& versionOut)
 {
     versionOut = MagicFormatAPIVersion();
@@ -2,6 +2,8 @@
 
 #include <magfapi.h>
 
+#include <vector>
+
 static const MagicFormatPluginInterface *_moduleIntf = NULL;
 
 MAGICAPI void __MAGICCALL SetInterface( const MagicFormatPluginInterface *intf )
@@ -35,15 +37,21 @@ class FormatA8 : public MagicFormat
 
 	void ConvertToRW(const void *texData, unsigned int texMipWidth, unsigned int texMipHeight, size_t dstRowStride, size_t texDataSize, void *texOut) const override
 	{
+        // We write our declared RW format (8888 BGRA) directly.
         size_t stride = getD3DBitmapStride(texMipWidth, 8);
 		for ( unsigned int row = 0; row < texMipHeight; row++ )
         {
-            const unsigned char *rowData = (unsigned char*)getD3DBitmapConstRow(texData, stride, row);
-            void *dstRowData = getD3DBitmapRow(texOut, dstRowStride, row);
+            const unsigned char *rowData = (const unsigned char*)getD3DBitmapConstRow(texData, stride, row);
+            unsigned char *dstRowData = (unsigned char*)getD3DBitmapRow(texOut, dstRowStride, row);
 
             for ( unsigned int col = 0; col < texMipWidth; col++ )
             {
-			    _moduleIntf->PutTexelRGBA(dstRowData, col, RASTER_8888, 32, COLOR_BGRA, 0, 0, 0, rowData[col]);
+                unsigned char *dstTexel = dstRowData + col * 4;
+
+                dstTexel[0] = 0;
+                dstTexel[1] = 0;
+                dstTexel[2] = 0;
+                dstTexel[3] = rowData[col];
             }
         }
 	}
@@ -53,16 +61,18 @@ class FormatA8 : public MagicFormat
 		void *texOut) const override
 	{
         size_t stride = getD3DBitmapStride(texMipWidth, 8);
+        std::vector <unsigned char> rgbaRow(texMipWidth * 4);
+
 		for (unsigned int row = 0; row < texMipHeight; row++)
 		{
             const void *srcRowData = getD3DBitmapConstRow(texelSource, srcRowStride, row);
             unsigned char *dstRowData = (unsigned char*)getD3DBitmapRow(texOut, stride, row);
 
+            _moduleIntf->BrowseTexelRowRGBA(srcRowData, texMipWidth, rasterFormat, depth, colorOrder, paletteType, paletteData, paletteSize, rgbaRow.data());
+
             for (unsigned int col = 0; col < texMipWidth; col++)
             {
-			    unsigned char r, g, b, a;
-			    _moduleIntf->BrowseTexelRGBA(srcRowData, col, rasterFormat, depth, colorOrder, paletteType, paletteData, paletteSize, r, g, b, a);
-			    dstRowData[col] = a;
+			    dstRowData[col] = rgbaRow[col * 4 + 3];
             }
 		}
 	}
@@ -70,6 +80,11 @@ class FormatA8 : public MagicFormat
 
 static FormatA8 a8Format;
 
+MAGICAPI unsigned int __MAGICCALL GetFormatCapabilities(void)
+{
+	return ( MAGIC_FORMAT_CAPS_ROW_BANDS );
+}
+
 MAGICAPI MagicFormat * __MAGICCALL GetFormatInstance(unsigned int& versionOut)
 {
     versionOut = MagicFormatAPIVersion();
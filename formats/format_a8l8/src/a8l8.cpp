@@ -2,6 +2,9 @@
 
 #include <magfapi.h>
 
+#include <cstring>
+#include <vector>
+
 static const MagicFormatPluginInterface *_moduleIntf = NULL;
 
 MAGICAPI void __MAGICCALL SetInterface( const MagicFormatPluginInterface *intf )
@@ -41,8 +44,9 @@ class FormatA8L8 : public MagicFormat
 
 	void GetTextureRWFormat(MAGIC_RASTER_FORMAT& rasterFormatOut, unsigned int& depthOut, MAGIC_COLOR_ORDERING& colorOrderOut) const
 	{
-		rasterFormatOut = RASTER_8888;
-		depthOut = 32;
+		// A8L8 is a native RenderWare luminance format, so we do not have to expand it.
+		rasterFormatOut = RASTER_LUM_ALPHA;
+		depthOut = 16;
 		colorOrderOut = COLOR_BGRA;
 	}
 
@@ -51,25 +55,13 @@ class FormatA8L8 : public MagicFormat
 		void *texOut
 		) const override
 	{
-		const MAGIC_RASTER_FORMAT rasterFormat = RASTER_8888;
-		const unsigned int depth = 32;
-		const MAGIC_COLOR_ORDERING colorOrder = COLOR_BGRA;
-
-		// do the conversion.
+		// Same texel layout, so we just copy the rows.
         size_t srcStride = getD3DBitmapStride(texMipWidth, 16);
+        size_t rowSize = ( texMipWidth * sizeof(pixel_t) );
 
 		for (unsigned int row = 0; row < texMipHeight; row++)
 		{
-            const pixel_t *srcRow = (const pixel_t*)getD3DBitmapConstRow(texData, srcStride, row);
-            void *dstRow = getD3DBitmapRow(texOut, dstRowStride, row);
-
-            for (unsigned int col = 0; col < texMipWidth; col++)
-            {
-			    // We are simply a pixel_t.
-			    const pixel_t *theTexel = srcRow + col;
-
-			    _moduleIntf->PutTexelRGBA(dstRow, col, rasterFormat, depth, colorOrder, theTexel->lum, theTexel->lum, theTexel->lum, theTexel->alpha);
-            }
+            memcpy(getD3DBitmapRow(texOut, dstRowStride, row), getD3DBitmapConstRow(texData, srcStride, row), rowSize);
 		}
 
 		// Alright, we are done!
@@ -84,28 +76,40 @@ class FormatA8L8 : public MagicFormat
 		// We write stuff.
 		size_t dstRowStride = getD3DBitmapStride(texMipWidth, 16);
 
+        if (rasterFormat == RASTER_LUM_ALPHA && depth == 16 && paletteType == PALETTE_NONE)
+        {
+            size_t rowSize = ( texMipWidth * sizeof(pixel_t) );
+
+            for (unsigned int row = 0; row < texMipHeight; row++)
+            {
+                memcpy(getD3DBitmapRow(texOut, dstRowStride, row), getD3DBitmapConstRow(texelSource, srcRowStride, row), rowSize);
+            }
+
+            return;
+        }
+
+        std::vector <unsigned char> rgbaRow(texMipWidth * 4);
+
 		for (unsigned int row = 0; row < texMipHeight; row++)
 		{
             const void *srcRowData = getD3DBitmapConstRow(texelSource, srcRowStride, row);
             pixel_t *dstRowData = (pixel_t*)getD3DBitmapRow(texOut, dstRowStride, row);
 
+            _moduleIntf->BrowseTexelRowRGBA(
+                srcRowData, texMipWidth,
+                rasterFormat, depth, colorOrder, paletteType, paletteData, paletteSize,
+                rgbaRow.data()
+            );
+
             for (unsigned int col = 0; col < texMipWidth; col++)
             {
 			    // Get the color as RGBA and convert to closely matching luminance value.
-			    unsigned char r, g, b, a;
-
-			    _moduleIntf->BrowseTexelRGBA(
-				    srcRowData, col,
-				    rasterFormat, depth, colorOrder, paletteType, paletteData, paletteSize,
-				    r, g, b, a
-				    );
-
-			    unsigned char lumVal = rgbToLuminance(r, g, b);
+                const unsigned char *rgba = &rgbaRow[col * 4];
 
 			    pixel_t *theTexel = (dstRowData + col);
 
-			    theTexel->lum = lumVal;
-			    theTexel->alpha = a;
+			    theTexel->lum = rgbToLuminance(rgba[0], rgba[1], rgba[2]);
+			    theTexel->alpha = rgba[3];
             }
 		}
 
@@ -117,6 +121,11 @@ class FormatA8L8 : public MagicFormat
 // that is bound natively by the library ;)
 static FormatA8L8 a8l8Format;
 
+MAGICAPI unsigned int __MAGICCALL GetFormatCapabilities(void)
+{
+	return ( MAGIC_FORMAT_CAPS_RW_LAYOUT | MAGIC_FORMAT_CAPS_ROW_BANDS );
+}
+
 MAGICAPI MagicFormat * __MAGICCALL GetFormatInstance(unsigned int& versionOut)
 {
     versionOut = MagicFormatAPIVersion();
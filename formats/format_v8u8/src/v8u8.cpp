@@ -2,6 +2,8 @@
 
 #include <magfapi.h>
 
+#include <vector>
+
 static const MagicFormatPluginInterface *_moduleIntf = NULL;
 
 MAGICAPI void __MAGICCALL SetInterface( const MagicFormatPluginInterface *intf )
@@ -41,16 +43,22 @@ class FormatV8U8 : public MagicFormat
 
 	void ConvertToRW(const void *texData, unsigned int texMipWidth, unsigned int texMipHeight, size_t dstRowStride, size_t texDataSize, void *texOut) const override
 	{
+        // We write our declared RW format (8888 BGRA) directly.
         size_t stride = getD3DBitmapStride(texMipWidth, 16);
 		for (unsigned int row = 0; row < texMipHeight; row++)
 		{
             const pixel_t *srcRowData = (const pixel_t*)getD3DBitmapConstRow(texData, stride, row);
-            void *dstRowData = getD3DBitmapRow(texOut, dstRowStride, row);
+            unsigned char *dstRowData = (unsigned char*)getD3DBitmapRow(texOut, dstRowStride, row);
 
             for (unsigned int col = 0; col < texMipWidth; col++)
             {
 			    const pixel_t *theTexel = srcRowData + col;
-			    _moduleIntf->PutTexelRGBA(dstRowData, col, RASTER_8888, 32, COLOR_BGRA, theTexel->u, theTexel->v, 0, 255);
+                unsigned char *dstTexel = dstRowData + col * 4;
+
+                dstTexel[0] = 0;            // blue
+                dstTexel[1] = theTexel->v;  // green
+                dstTexel[2] = theTexel->u;  // red
+                dstTexel[3] = 255;          // alpha
             }
 		}
 	}
@@ -60,18 +68,21 @@ class FormatV8U8 : public MagicFormat
 		void *texOut) const override
 	{
 		size_t stride = getD3DBitmapStride(texMipWidth, 16);
+        std::vector <unsigned char> rgbaRow(texMipWidth * 4);
+
 		for (unsigned int row = 0; row < texMipHeight; row++)
 		{
             const void *srcRowData = getD3DBitmapConstRow(texelSource, srcRowStride, row);
             pixel_t *dstRowData = (pixel_t*)getD3DBitmapRow(texOut, stride, row);
 
+            _moduleIntf->BrowseTexelRowRGBA(srcRowData, texMipWidth, rasterFormat, depth, colorOrder, paletteType, paletteData, paletteSize, rgbaRow.data());
+
             for (unsigned int col = 0; col < texMipWidth; col++)
             {
-			    unsigned char r, g, b, a;
-			    _moduleIntf->BrowseTexelRGBA(srcRowData, col, rasterFormat, depth, colorOrder, paletteType, paletteData, paletteSize, r, g, b, a);
+                const unsigned char *rgba = &rgbaRow[col * 4];
 			    pixel_t *theTexel = (dstRowData + col);
-			    theTexel->u = r;
-			    theTexel->v = g;
+			    theTexel->u = rgba[0];
+			    theTexel->v = rgba[1];
             }
 		}
 	}
@@ -79,6 +90,11 @@ class FormatV8U8 : public MagicFormat
 
 static FormatV8U8 v8u8Format;
 
+MAGICAPI unsigned int __MAGICCALL GetFormatCapabilities(void)
+{
+	return ( MAGIC_FORMAT_CAPS_ROW_BANDS );
+}
+
 MAGICAPI MagicFormat * __MAGICCALL GetFormatInstance(unsigned int& versionOut)
 {
     versionOut = MagicFormatAPIVersion();
@@ -21,4 +21,15 @@ struct MagicFormatPluginExports : public MagicFormatPluginInterface
 	    unsigned int depth, MAGIC_COLOR_ORDERING colorOrder, MAGIC_PALETTE_TYPE paletteType, const void *paletteData, unsigned int paletteSize,
 	    unsigned char& redOut, unsigned char& greenOut, unsigned char& blueOut, unsigned char& alphaOut
     ) const override;
+
+    bool PutTexelRowRGBA(
+        void *dstRow, unsigned int texelCount, MAGIC_RASTER_FORMAT rasterFormat, unsigned int depth,
+        MAGIC_COLOR_ORDERING colorOrder, const unsigned char *rgbaTexels
+    ) const override;
+
+    bool BrowseTexelRowRGBA(
+        const void *srcRow, unsigned int texelCount, MAGIC_RASTER_FORMAT rasterFormat,
+        unsigned int depth, MAGIC_COLOR_ORDERING colorOrder, MAGIC_PALETTE_TYPE paletteType, const void *paletteData, unsigned int paletteSize,
+        unsigned char *rgbaTexelsOut
+    ) const override;
 };
\ No newline at end of file
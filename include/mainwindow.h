@@ -72,6 +72,7 @@ struct magicThemeAwareItem abstract
 #include "aboutdialog.h"
 #include "streamcompress.h"
 #include "helperruntime.h"
+#include "texturepreview.h"
 
 #include "MagicExport.h"
 
@@ -128,6 +129,10 @@ public:
 
     void updateTextureViewport(void);
 
+    // Called by the texture preview service once a preview is available.
+    void presentTexturePreview(rw::Raster *raster, const QImage& image, rw::uint32 logicalWidth, rw::uint32 logicalHeight, rw::uint32 mipIndex);
+    void presentTexturePreviewError(const QString& errorMessage);
+
     bool saveCurrentTXDAt(QString location);
 
     void clearViewImage(void);
@@ -286,6 +291,10 @@ private:
 
     bool showFullImage;
     bool drawMipmapLayers;
+
+    // Size of the shown texture, independent of the mipmap layer that was decoded for it.
+    rw::uint32 previewLogicalWidth, previewLogicalHeight;
+    rw::uint32 previewMipIndex;
     bool showBackground;
 
     // Editor theme awareness.
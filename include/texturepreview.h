@@ -0,0 +1,18 @@
+// Texture preview service of the main window viewport.
+// Decoding texels can take long for big or compressed textures, so we do it on a worker thread.
+// Only the smallest mipmap layer that covers the viewport is decoded; full resolution is fetched
+// when the user looks at the image in actual size.
+
+#pragma once
+
+// Requests a preview of a raster for a viewport of the given size.
+// Pass a viewport size of zero to request the full resolution image.
+// The most recent request wins; the result is handed to MainWindow::presentTexturePreview,
+// immediately if it was found in the preview cache.
+void RequestTexturePreview( MainWindow *mainWnd, rw::Raster *raster, rw::uint32 viewWidth, rw::uint32 viewHeight, bool drawMipmapLayers );
+
+// Makes sure that no pending preview is presented anymore.
+void CancelTexturePreview( MainWindow *mainWnd );
+
+// Releases all cached previews, including the raster references they hold.
+void PurgeTexturePreviewCache( MainWindow *mainWnd );
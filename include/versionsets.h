@@ -32,8 +32,9 @@ public:
         RWVS_DT_POWERVR,
         RWVS_DT_PSP,
         RWVS_DT_GAMECUBE,
+        RWVS_DT_ETC_MOBILE,
 
-        RWVS_DT_NUM_OF_TYPES = RWVS_DT_GAMECUBE
+        RWVS_DT_NUM_OF_TYPES = RWVS_DT_ETC_MOBILE
     };
 
     // translate name from settings file to id
@@ -74,6 +75,8 @@ public:
             return RWVS_DT_PSP;
         if (name == "GAMECUBE")
             return RWVS_DT_GAMECUBE;
+        if (name == "ETC")
+            return RWVS_DT_ETC_MOBILE;
         return RWVS_DT_NOT_DEFINED;
     }
 
@@ -118,6 +121,8 @@ public:
             return "PSP";
         case RWVS_DT_GAMECUBE:
             return "Gamecube";
+        case RWVS_DT_ETC_MOBILE:
+            return "etc_mobile";
         }
         return "Unknown";
     }
@@ -143,6 +148,8 @@ public:
             return RWVS_DT_PSP;
         if (name == "Gamecube")
             return RWVS_DT_GAMECUBE;
+        if (name == "etc_mobile")
+            return RWVS_DT_ETC_MOBILE;
         return RWVS_DT_NOT_DEFINED;
     }
 
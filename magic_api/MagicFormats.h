@@ -1,7 +1,12 @@
 #ifndef MAGIC_CORE
 
+#ifdef _WIN32
 #define MAGICAPI extern "C" __declspec(dllexport)
 #define __MAGICCALL __cdecl
+#else
+#define MAGICAPI extern "C" __attribute__((visibility("default")))
+#define __MAGICCALL
+#endif
 
 #endif //MAGIC_CORE
 
@@ -11,10 +16,12 @@ typedef uint32_t D3DFORMAT_SDK;
 
 inline unsigned int MagicFormatAPIVersion( void )
 {
-    // We are currently version 2 API.
+    // We are currently version 4 API.
     // Update this whenever the ABI of the magf API changed!
     // * Rev2: added dynamic loading from any .exe
-    return 2;
+    // * Rev3: added row-based texel conversion and native luminance targets
+    // * Rev4: added the optional GetFormatCapabilities export
+    return 4;
 }
 
 enum MAGIC_RASTER_FORMAT
@@ -26,7 +33,8 @@ enum MAGIC_RASTER_FORMAT
 	RASTER_LUM,
 	RASTER_8888,
 	RASTER_888,
-	RASTER_555 = 10
+	RASTER_555 = 10,
+	RASTER_LUM_ALPHA    // since Rev3; 8bit = A4L4, 16bit = A8L8 layout
 };
 
 enum MAGIC_COLOR_ORDERING
@@ -44,6 +52,19 @@ enum MAGIC_PALETTE_TYPE
     PALETTE_4BIT_LSB
 };
 
+// Since Rev4 a plugin can export "unsigned int GetFormatCapabilities(void)" to enable fast paths.
+// It returns a combination of these flags.
+enum MAGIC_FORMAT_CAPABILITY
+{
+	// The texture data already is texel data of GetTextureRWFormat, with the same row stride.
+	// It is then used in-place, without calling ConvertToRW.
+	MAGIC_FORMAT_CAPS_RW_LAYOUT = 0x01,
+
+	// Rows convert independently of each other. ConvertToRW may then be called on bands of rows,
+	// from multiple threads at once. A band starting at row n starts at GetFormatTextureDataSize(width, n).
+	MAGIC_FORMAT_CAPS_ROW_BANDS = 0x02
+};
+
 /*
 This class manages conversion between extension D3DFORMAT native textures to original RW types.
 It is required so that specific D3DFORMAT textures can be integrated into this RenderWare framework.
@@ -64,6 +85,8 @@ struct MagicFormat abstract
 	virtual size_t GetFormatTextureDataSize(unsigned int width, unsigned int height) const = 0;
 
 	// The raster format that this native texture has mapped as original RW type has to stay the same.
+	// Since Rev3 this can be RASTER_LUM or RASTER_LUM_ALPHA, so that luminance formats do not have to expand to RASTER_8888.
+	// ConvertToRW must write texels of exactly this format.
 	virtual void GetTextureRWFormat(MAGIC_RASTER_FORMAT& rasterFormatOut, unsigned int& depthOut, MAGIC_COLOR_ORDERING& colorOrderOut) const = 0;
 
 	// Converts the D3DFORMAT anonymous data to RW original types and returns it.
@@ -94,4 +117,18 @@ struct MagicFormatPluginInterface abstract
 	    unsigned int depth, MAGIC_COLOR_ORDERING colorOrder, MAGIC_PALETTE_TYPE paletteType, const void *paletteData, unsigned int paletteSize,
 	    unsigned char& redOut, unsigned char& greenOut, unsigned char& blueOut, unsigned char& alphaOut
     ) const = 0;
+
+    // In Revision 3 we added conversion of whole rows, so that the format dispatch
+    // is done once per row instead of once per texel.
+    // RGBA data is always passed as four unsigned chars per texel, in that order.
+    virtual bool PutTexelRowRGBA(
+        void *dstRow, unsigned int texelCount, MAGIC_RASTER_FORMAT rasterFormat, unsigned int depth,
+        MAGIC_COLOR_ORDERING colorOrder, const unsigned char *rgbaTexels
+    ) const = 0;
+
+    virtual bool BrowseTexelRowRGBA(
+        const void *srcRow, unsigned int texelCount, MAGIC_RASTER_FORMAT rasterFormat,
+        unsigned int depth, MAGIC_COLOR_ORDERING colorOrder, MAGIC_PALETTE_TYPE paletteType, const void *paletteData, unsigned int paletteSize,
+        unsigned char *rgbaTexelsOut
+    ) const = 0;
 };
\ No newline at end of file
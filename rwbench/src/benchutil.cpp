@@ -0,0 +1,231 @@
+#include "rwbench.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif //_WIN32
+
+// *** Memory sampling ***
+
+benchMemorySampler::benchMemorySampler( void )
+{
+    this->isTerminating = false;
+    this->baselineMemory = 0;
+    this->peakMemory = 0;
+
+    this->samplerThread = std::thread( [this] { this->SamplerThread(); } );
+}
+
+benchMemorySampler::~benchMemorySampler( void )
+{
+    this->isTerminating = true;
+
+    this->samplerThread.join();
+}
+
+rw::uint64 benchMemorySampler::GetProcessMemoryUsage( void )
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS_EX memCounters;
+    memCounters.cb = sizeof( memCounters );
+
+    if ( GetProcessMemoryInfo( GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&memCounters, sizeof( memCounters ) ) )
+    {
+        return memCounters.PrivateUsage;
+    }
+#endif //_WIN32
+
+    return 0;
+}
+
+void benchMemorySampler::BeginMeasure( void )
+{
+    rw::uint64 curMemory = GetProcessMemoryUsage();
+
+    this->baselineMemory = curMemory;
+    this->peakMemory = curMemory;
+}
+
+rw::uint64 benchMemorySampler::EndMeasure( void )
+{
+    rw::uint64 curMemory = GetProcessMemoryUsage();
+
+    rw::uint64 peakMemory = std::max( (rw::uint64)this->peakMemory, curMemory );
+    rw::uint64 baselineMemory = this->baselineMemory;
+
+    if ( peakMemory < baselineMemory )
+        return 0;
+
+    return ( peakMemory - baselineMemory );
+}
+
+void benchMemorySampler::SamplerThread( void )
+{
+    while ( !this->isTerminating )
+    {
+        rw::uint64 curMemory = GetProcessMemoryUsage();
+
+        rw::uint64 prevPeak = this->peakMemory;
+
+        while ( curMemory > prevPeak && !this->peakMemory.compare_exchange_weak( prevPeak, curMemory ) );
+
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+}
+
+// *** Memory stream ***
+
+struct benchMemoryStreamProvider : public rw::customStreamInterface
+{
+    void OnConstruct( rw::eStreamMode streamMode, void *userdata, void *memBuf, size_t memSize ) const override
+    {
+        *(benchMemoryStreamData**)memBuf = (benchMemoryStreamData*)userdata;
+    }
+
+    void OnDestruct( void *memBuf, size_t memSize ) const override
+    {
+        return;
+    }
+
+    size_t Read( void *memBuf, void *out_buf, size_t readCount ) const override
+    {
+        benchMemoryStreamData *data = *(benchMemoryStreamData**)memBuf;
+
+        size_t bufSize = data->buffer.size();
+        size_t seekPos = data->seekPos;
+
+        if ( seekPos >= bufSize )
+            return 0;
+
+        size_t actualCount = std::min( readCount, bufSize - seekPos );
+
+        memcpy( out_buf, data->buffer.data() + seekPos, actualCount );
+
+        data->seekPos = ( seekPos + actualCount );
+
+        return actualCount;
+    }
+
+    size_t Write( void *memBuf, const void *in_buf, size_t writeCount ) const override
+    {
+        benchMemoryStreamData *data = *(benchMemoryStreamData**)memBuf;
+
+        size_t seekPos = data->seekPos;
+        size_t endPos = ( seekPos + writeCount );
+
+        if ( endPos > data->buffer.size() )
+        {
+            data->buffer.resize( endPos );
+        }
+
+        memcpy( data->buffer.data() + seekPos, in_buf, writeCount );
+
+        data->seekPos = endPos;
+
+        return writeCount;
+    }
+
+    void Skip( void *memBuf, rw::int64 skipCount ) const override
+    {
+        this->Seek( memBuf, skipCount, rw::RWSEEK_CUR );
+    }
+
+    rw::int64 Tell( const void *memBuf ) const override
+    {
+        const benchMemoryStreamData *data = *(const benchMemoryStreamData* const*)memBuf;
+
+        return (rw::int64)data->seekPos;
+    }
+
+    void Seek( void *memBuf, rw::int64 stream_offset, rw::eSeekMode seek_mode ) const override
+    {
+        benchMemoryStreamData *data = *(benchMemoryStreamData**)memBuf;
+
+        rw::int64 basePos = 0;
+
+        if ( seek_mode == rw::RWSEEK_CUR )
+        {
+            basePos = (rw::int64)data->seekPos;
+        }
+        else if ( seek_mode == rw::RWSEEK_END )
+        {
+            basePos = (rw::int64)data->buffer.size();
+        }
+
+        rw::int64 newPos = ( basePos + stream_offset );
+
+        if ( newPos < 0 )
+        {
+            throw rw::RwStreamException( "seek before the beginning of a memory stream" );
+        }
+
+        data->seekPos = (size_t)newPos;
+    }
+
+    rw::int64 Size( const void *memBuf ) const override
+    {
+        const benchMemoryStreamData *data = *(const benchMemoryStreamData* const*)memBuf;
+
+        return (rw::int64)data->buffer.size();
+    }
+
+    bool SupportsSize( const void *memBuf ) const override
+    {
+        return true;
+    }
+};
+
+static benchMemoryStreamProvider _memStreamProvider;
+
+void RegisterBenchMemoryStream( rw::Interface *engineInterface )
+{
+    engineInterface->RegisterStream( "bench_memory", sizeof( benchMemoryStreamData* ), &_memStreamProvider );
+}
+
+rw::Stream* CreateBenchMemoryStream( rw::Interface *engineInterface, benchMemoryStreamData *data )
+{
+    rw::streamConstructionCustomParam_t customParam( "bench_memory", data );
+
+    return engineInterface->CreateStream( rw::RWSTREAMTYPE_CUSTOM, rw::RWSTREAMMODE_READWRITE, &customParam );
+}
+
+// *** Misc ***
+
+rw::uint64 GetRasterTexelBytes( rw::Raster *raster )
+{
+    rw::uint32 width, height;
+    raster->getSize( width, height );
+
+    rw::uint32 mipmapCount = std::max( 1u, raster->getMipmapCount() );
+
+    rw::uint64 texelBytes = 0;
+
+    for ( rw::uint32 n = 0; n < mipmapCount; n++ )
+    {
+        texelBytes += ( (rw::uint64)width * height * 4 );
+
+        width = std::max( 1u, width / 2 );
+        height = std::max( 1u, height / 2 );
+    }
+
+    return texelBytes;
+}
+
+bool benchConfig::isStageEnabled( const std::string& stageName ) const
+{
+    if ( this->stageFilters.empty() )
+        return true;
+
+    for ( const std::string& filter : this->stageFilters )
+    {
+        if ( stageName.compare( 0, filter.size(), filter ) == 0 )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
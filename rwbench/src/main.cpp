@@ -0,0 +1,598 @@
+#include "rwbench.h"
+
+#include <cstdio>
+#include <cwctype>
+#include <locale>
+#include <codecvt>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif //_WIN32
+
+namespace rw
+{
+    LibraryVersion app_version( void )
+    {
+        LibraryVersion ver;
+
+        ver.rwLibMajor = 3;
+        ver.rwLibMinor = 6;
+        ver.rwRevMajor = 0;
+        ver.rwRevMinor = 3;
+
+        return ver;
+    }
+
+    int32 rwmain( Interface *engineInterface )
+    {
+        // We use our own entry point.
+        return -1;
+    }
+};
+
+// Warnings would distort the measurements, so we only count them.
+struct benchWarningManager : public rw::WarningManagerInterface
+{
+    void OnWarning( std::string&& message ) override
+    {
+        this->warningCount++;
+    }
+
+    rw::uint32 warningCount = 0;
+};
+
+static std::string toUTF8( const std::wstring& str )
+{
+    return ( std::wstring_convert <std::codecvt_utf8 <wchar_t>, wchar_t> () ).to_bytes( str );
+}
+
+static std::wstring getFileExtension( const std::wstring& path )
+{
+    size_t dotPos = path.find_last_of( L'.' );
+    size_t slashPos = path.find_last_of( L"/\\" );
+
+    if ( dotPos == std::wstring::npos || ( slashPos != std::wstring::npos && dotPos < slashPos ) )
+        return std::wstring();
+
+    std::wstring ext = path.substr( dotPos + 1 );
+
+    for ( wchar_t& c : ext )
+    {
+        c = std::towlower( c );
+    }
+
+    return ext;
+}
+
+static bool readCorpusFile( rw::Interface *engineInterface, const std::wstring& path, std::vector <char>& dataOut )
+{
+    rw::streamConstructionFileParamW_t fileParam( path.c_str() );
+
+    rw::Stream *fileStream = engineInterface->CreateStream( rw::RWSTREAMTYPE_FILE_W, rw::RWSTREAMMODE_READONLY, &fileParam );
+
+    if ( !fileStream )
+        return false;
+
+    bool successful = false;
+
+    try
+    {
+        rw::int64 fileSize = fileStream->size();
+
+        dataOut.resize( (size_t)fileSize );
+
+        successful = ( fileStream->read( dataOut.data(), dataOut.size() ) == dataOut.size() );
+    }
+    catch( rw::RwException& )
+    {
+        successful = false;
+    }
+
+    engineInterface->DeleteStream( fileStream );
+
+    return successful;
+}
+
+static void addCorpusPath( rw::Interface *engineInterface, const std::wstring& path, benchCorpus& corpus );
+
+static void addCorpusDirectory( rw::Interface *engineInterface, const std::wstring& dirPath, benchCorpus& corpus )
+{
+#ifdef _WIN32
+    WIN32_FIND_DATAW findData;
+
+    HANDLE findHandle = FindFirstFileW( ( dirPath + L"\\*" ).c_str(), &findData );
+
+    if ( findHandle == INVALID_HANDLE_VALUE )
+        return;
+
+    do
+    {
+        std::wstring fileName = findData.cFileName;
+
+        if ( fileName == L"." || fileName == L".." )
+            continue;
+
+        addCorpusPath( engineInterface, dirPath + L"\\" + fileName, corpus );
+    }
+    while ( FindNextFileW( findHandle, &findData ) );
+
+    FindClose( findHandle );
+#endif //_WIN32
+}
+
+static void addCorpusPath( rw::Interface *engineInterface, const std::wstring& path, benchCorpus& corpus )
+{
+#ifdef _WIN32
+    DWORD fileAttributes = GetFileAttributesW( path.c_str() );
+
+    if ( fileAttributes != INVALID_FILE_ATTRIBUTES && ( fileAttributes & FILE_ATTRIBUTE_DIRECTORY ) != 0 )
+    {
+        addCorpusDirectory( engineInterface, path, corpus );
+        return;
+    }
+#endif //_WIN32
+
+    std::wstring ext = getFileExtension( path );
+
+    bool isTXD = ( ext == L"txd" );
+
+    // Only take image files that rwlib knows about.
+    if ( !isTXD )
+    {
+        std::string ansiExt = toUTF8( ext );
+
+        bool isKnownImage = false;
+
+        rw::registered_image_formats_t imageFormats;
+        rw::GetRegisteredImageFormats( engineInterface, imageFormats );
+
+        // Native images like DDS and PVR are loaded by the rasters aswell.
+        rw::GetRegisteredNativeImageTypes( engineInterface, imageFormats );
+
+        for ( const rw::registered_image_format& imgFormat : imageFormats )
+        {
+            if ( rw::IsImagingFormatExtension( imgFormat.num_ext, imgFormat.ext_array, ansiExt.c_str() ) )
+            {
+                isKnownImage = true;
+                break;
+            }
+        }
+
+        if ( !isKnownImage )
+            return;
+    }
+
+    benchCorpusFile file;
+    file.path = path;
+    file.isTXD = isTXD;
+
+    if ( !readCorpusFile( engineInterface, path, file.fileData ) )
+    {
+        fwprintf( stderr, L"failed to read corpus file %ls\n", path.c_str() );
+        return;
+    }
+
+    corpus.files.push_back( std::move( file ) );
+}
+
+// Decodes every corpus file into the rasters that the stages work on.
+static void loadCorpusTextures( rw::Interface *engineInterface, benchCorpus& corpus )
+{
+    for ( const benchCorpusFile& file : corpus.files )
+    {
+        benchMemoryStreamData streamData;
+        streamData.buffer = file.fileData;
+
+        rw::Stream *inputStream = CreateBenchMemoryStream( engineInterface, &streamData );
+
+        if ( !inputStream )
+            continue;
+
+        try
+        {
+            if ( file.isTXD )
+            {
+                rw::RwObject *rwObj = engineInterface->Deserialize( inputStream );
+
+                if ( rwObj )
+                {
+                    if ( rw::TexDictionary *texDict = rw::ToTexDictionary( engineInterface, rwObj ) )
+                    {
+                        for ( rw::TexDictionary::texIter_t iter( texDict->GetTextureIterator() ); !iter.IsEnd(); iter.Increment() )
+                        {
+                            rw::TextureBase *texHandle = iter.Resolve();
+
+                            rw::Raster *texRaster = texHandle->GetRaster();
+
+                            if ( texRaster )
+                            {
+                                benchCorpusTexture tex;
+                                tex.name = texHandle->GetName();
+                                tex.raster = rw::AcquireRaster( texRaster );
+                                tex.texelBytes = GetRasterTexelBytes( texRaster );
+
+                                corpus.textures.push_back( std::move( tex ) );
+                            }
+                        }
+                    }
+
+                    engineInterface->DeleteRwObject( rwObj );
+                }
+            }
+            else
+            {
+                rw::Raster *imgRaster = rw::CreateRaster( engineInterface );
+
+                if ( imgRaster )
+                {
+                    try
+                    {
+                        imgRaster->newNativeData( benchProcessingNativeName );
+                        imgRaster->readImage( inputStream );
+                    }
+                    catch( ... )
+                    {
+                        rw::DeleteRaster( imgRaster );
+
+                        throw;
+                    }
+
+                    benchCorpusTexture tex;
+                    tex.name = toUTF8( file.path );
+                    tex.raster = imgRaster;
+                    tex.texelBytes = GetRasterTexelBytes( imgRaster );
+
+                    corpus.textures.push_back( std::move( tex ) );
+                }
+            }
+        }
+        catch( rw::RwException& except )
+        {
+            fwprintf( stderr, L"failed to load corpus file %ls: %hs\n", file.path.c_str(), except.message.c_str() );
+        }
+
+        engineInterface->DeleteStream( inputStream );
+    }
+}
+
+static std::string jsonEscape( const std::string& str )
+{
+    std::string escaped;
+
+    for ( char c : str )
+    {
+        if ( c == '"' || c == '\\' )
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ( (unsigned char)c < 0x20 )
+        {
+            char buf[ 8 ];
+            snprintf( buf, sizeof( buf ), "\\u%04x", (unsigned int)(unsigned char)c );
+
+            escaped += buf;
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+static double getMBPerSecond( const benchStageResult& stage )
+{
+    if ( stage.seconds <= 0 )
+        return 0;
+
+    return ( (double)stage.byteCount / ( 1024.0 * 1024.0 ) / stage.seconds );
+}
+
+static double getTexturesPerSecond( const benchStageResult& stage )
+{
+    if ( stage.seconds <= 0 )
+        return 0;
+
+    return ( (double)stage.textureCount / stage.seconds );
+}
+
+// The report is plain JSON, so that runs of different commits can be compared by scripts.
+static std::string buildJSONReport( const std::string& label, const benchConfig& config, const benchCorpus& corpus, const std::vector <benchStageResult>& stages, rw::uint32 warningCount )
+{
+    rw::uint64 corpusBytes = 0;
+
+    for ( const benchCorpusFile& file : corpus.files )
+    {
+        corpusBytes += file.fileData.size();
+    }
+
+    std::string json;
+    char buf[ 512 ];
+
+    json += "{\n";
+    json += "  \"label\": \"" + jsonEscape( label ) + "\",\n";
+
+    snprintf( buf, sizeof( buf ), "  \"iterations\": %u,\n", config.iterations );
+    json += buf;
+
+    snprintf( buf, sizeof( buf ), "  \"warnings\": %u,\n", warningCount );
+    json += buf;
+
+    snprintf( buf, sizeof( buf ),
+        "  \"corpus\": { \"files\": %u, \"textures\": %u, \"bytes\": %llu },\n",
+        (unsigned int)corpus.files.size(), (unsigned int)corpus.textures.size(), (unsigned long long)corpusBytes
+    );
+    json += buf;
+
+    json += "  \"stages\": [";
+
+    bool isFirst = true;
+
+    for ( const benchStageResult& stage : stages )
+    {
+        json += ( isFirst ? "\n" : ",\n" );
+
+        snprintf( buf, sizeof( buf ),
+            "    { \"name\": \"%s\", \"textures\": %llu, \"bytes\": %llu, \"seconds\": %.6f, "
+            "\"mb_per_s\": %.3f, \"textures_per_s\": %.3f, \"peak_memory_bytes\": %llu, \"failures\": %u }",
+            jsonEscape( stage.name ).c_str(),
+            (unsigned long long)stage.textureCount, (unsigned long long)stage.byteCount, stage.seconds,
+            getMBPerSecond( stage ), getTexturesPerSecond( stage ),
+            (unsigned long long)stage.peakMemory, stage.failureCount
+        );
+        json += buf;
+
+        isFirst = false;
+    }
+
+    json += "\n  ]\n}\n";
+
+    return json;
+}
+
+static void printStageTable( const std::vector <benchStageResult>& stages )
+{
+    printf( "%-32s %10s %12s %12s %12s %10s\n", "stage", "textures", "MB/s", "tex/s", "peak mem KB", "failures" );
+
+    for ( const benchStageResult& stage : stages )
+    {
+        printf( "%-32s %10llu %12.2f %12.2f %12llu %10u\n",
+            stage.name.c_str(),
+            (unsigned long long)stage.textureCount,
+            getMBPerSecond( stage ), getTexturesPerSecond( stage ),
+            (unsigned long long)( stage.peakMemory / 1024 ),
+            stage.failureCount
+        );
+    }
+}
+
+static bool writeReport( rw::Interface *engineInterface, const std::wstring& path, const std::string& report )
+{
+    rw::streamConstructionFileParamW_t fileParam( path.c_str() );
+
+    rw::Stream *outputStream = engineInterface->CreateStream( rw::RWSTREAMTYPE_FILE_W, rw::RWSTREAMMODE_CREATE, &fileParam );
+
+    if ( !outputStream )
+        return false;
+
+    bool successful = false;
+
+    try
+    {
+        successful = ( outputStream->write( report.c_str(), report.size() ) == report.size() );
+    }
+    catch( rw::RwException& )
+    {
+        successful = false;
+    }
+
+    engineInterface->DeleteStream( outputStream );
+
+    return successful;
+}
+
+static bool writeTrace( rw::Interface *engineInterface, const std::wstring& path )
+{
+    rw::streamConstructionFileParamW_t fileParam( path.c_str() );
+
+    rw::Stream *outputStream = engineInterface->CreateStream( rw::RWSTREAMTYPE_FILE_W, rw::RWSTREAMMODE_CREATE, &fileParam );
+
+    if ( !outputStream )
+        return false;
+
+    bool successful = true;
+
+    try
+    {
+        engineInterface->DumpProfilingTrace( outputStream );
+    }
+    catch( rw::RwException& )
+    {
+        successful = false;
+    }
+
+    engineInterface->DeleteStream( outputStream );
+
+    return successful;
+}
+
+static void printUsage( void )
+{
+    printf(
+        "usage: rwbench [-o report.json] [-trace trace.json] [-iterations N] [-stage prefix] [-label name] <txd/image files or directories...>\n"
+        "  -o           writes the results as JSON into the given file\n"
+        "  -trace       records the rwlib profiling zones and writes them as Chrome trace JSON\n"
+        "  -iterations  runs every stage N times (default 1)\n"
+        "  -stage       runs only stages whose name starts with prefix (can be given multiple times)\n"
+        "  -label       name of this run inside of the report, like a commit hash\n"
+    );
+}
+
+static int runBenchmark( rw::Interface *engineInterface, int argc, wchar_t *argv[] )
+{
+    benchConfig config;
+
+    std::wstring reportPath;
+    std::wstring tracePath;
+    std::string label;
+    std::vector <std::wstring> corpusPaths;
+
+    for ( int n = 1; n < argc; n++ )
+    {
+        std::wstring arg = argv[ n ];
+
+        bool hasValue = ( n + 1 < argc );
+
+        if ( arg == L"-o" && hasValue )
+        {
+            reportPath = argv[ ++n ];
+        }
+        else if ( arg == L"-trace" && hasValue )
+        {
+            tracePath = argv[ ++n ];
+        }
+        else if ( arg == L"-iterations" && hasValue )
+        {
+            int iterations = _wtoi( argv[ ++n ] );
+
+            config.iterations = (rw::uint32)std::max( 1, iterations );
+        }
+        else if ( arg == L"-stage" && hasValue )
+        {
+            config.stageFilters.push_back( toUTF8( argv[ ++n ] ) );
+        }
+        else if ( arg == L"-label" && hasValue )
+        {
+            label = toUTF8( argv[ ++n ] );
+        }
+        else if ( arg == L"-h" || arg == L"-help" )
+        {
+            printUsage();
+            return 0;
+        }
+        else
+        {
+            corpusPaths.push_back( arg );
+        }
+    }
+
+    if ( corpusPaths.empty() )
+    {
+        printUsage();
+        return -1;
+    }
+
+    benchCorpus corpus;
+
+    for ( const std::wstring& path : corpusPaths )
+    {
+        addCorpusPath( engineInterface, path, corpus );
+    }
+
+    loadCorpusTextures( engineInterface, corpus );
+
+    printf( "corpus: %u files, %u textures\n", (unsigned int)corpus.files.size(), (unsigned int)corpus.textures.size() );
+
+    if ( corpus.textures.empty() )
+    {
+        fprintf( stderr, "no textures in the corpus\n" );
+        return -1;
+    }
+
+    benchWarningManager warningMan;
+
+    engineInterface->SetWarningManager( &warningMan );
+
+    std::vector <benchStageResult> stages;
+
+    if ( !tracePath.empty() )
+    {
+        engineInterface->SetProfilingEnabled( true );
+    }
+
+    RunBenchStages( engineInterface, config, corpus, stages );
+
+    engineInterface->SetProfilingEnabled( false );
+    engineInterface->SetWarningManager( NULL );
+
+    for ( benchCorpusTexture& tex : corpus.textures )
+    {
+        rw::DeleteRaster( tex.raster );
+    }
+
+    printStageTable( stages );
+
+    if ( !tracePath.empty() )
+    {
+        if ( !writeTrace( engineInterface, tracePath ) )
+        {
+            fwprintf( stderr, L"failed to write trace to %ls\n", tracePath.c_str() );
+        }
+    }
+
+    if ( !reportPath.empty() )
+    {
+        std::string report = buildJSONReport( label, config, corpus, stages, warningMan.warningCount );
+
+        if ( !writeReport( engineInterface, reportPath, report ) )
+        {
+            fwprintf( stderr, L"failed to write report to %ls\n", reportPath.c_str() );
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int wmain( int argc, wchar_t *argv[] )
+{
+    rw::LibraryVersion engineVersion = rw::app_version();
+
+    rw::Interface *engineInterface = rw::CreateEngine( engineVersion );
+
+    if ( engineInterface == NULL )
+    {
+        fprintf( stderr, "failed to initialize the RenderWare engine\n" );
+        return -1;
+    }
+
+    int iRet = -1;
+
+    try
+    {
+        // Use the same engine properties as the tools.
+        engineInterface->SetIgnoreSerializationBlockRegions( true );
+        engineInterface->SetIgnoreSecureWarnings( false );
+
+        engineInterface->SetWarningLevel( 3 );
+
+        engineInterface->SetCompatTransformNativeImaging( true );
+        engineInterface->SetPreferPackedSampleExport( true );
+
+        engineInterface->SetDXTRuntime( rw::DXTRUNTIME_SQUISH );
+        engineInterface->SetPaletteRuntime( rw::PALRUNTIME_PNGQUANT );
+
+        rw::softwareMetaInfo metaInfo;
+        metaInfo.applicationName = "rwbench";
+        metaInfo.applicationVersion = "1.0";
+        metaInfo.description = "rwtools benchmark suite";
+
+        engineInterface->SetApplicationInfo( metaInfo );
+
+        RegisterBenchMemoryStream( engineInterface );
+
+        iRet = runBenchmark( engineInterface, argc, argv );
+    }
+    catch( rw::RwException& except )
+    {
+        fprintf( stderr, "error: %s\n", except.message.c_str() );
+
+        iRet = -1;
+    }
+
+    rw::DeleteEngine( engineInterface );
+
+    return iRet;
+}
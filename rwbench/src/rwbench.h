@@ -0,0 +1,144 @@
+// Shared definitions of the headless rwtools benchmark.
+
+#pragma once
+
+#include <renderware.h>
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+// Platform that images are loaded into and that the processing stages run on.
+// Most tools do their processing on Direct3D9 rasters.
+static const char *const benchProcessingNativeName = "Direct3D9";
+
+// Measures the peak memory usage of the process above a baseline.
+// A background thread samples the process memory, because the allocations of
+// rwlib are not observable from the outside.
+struct benchMemorySampler
+{
+    benchMemorySampler( void );
+    ~benchMemorySampler( void );
+
+    // Starts a new measurement at the current memory usage.
+    void BeginMeasure( void );
+
+    // Returns the peak memory usage in bytes above the baseline since BeginMeasure.
+    rw::uint64 EndMeasure( void );
+
+    static rw::uint64 GetProcessMemoryUsage( void );
+
+private:
+    void SamplerThread( void );
+
+    std::thread samplerThread;
+
+    std::atomic <bool> isTerminating;
+    std::atomic <rw::uint64> baselineMemory;
+    std::atomic <rw::uint64> peakMemory;
+};
+
+// Result of one benchmark stage, accumulated over every item of the corpus.
+struct benchStageResult
+{
+    std::string name;
+
+    rw::uint64 textureCount = 0;
+    rw::uint64 byteCount = 0;
+    rw::uint32 failureCount = 0;
+
+    double seconds = 0;
+
+    rw::uint64 peakMemory = 0;
+};
+
+// Runs a single operation of a stage and accounts it.
+// Returns false if the operation has failed.
+template <typename callbackType>
+inline bool RunBenchOperation( benchStageResult& stage, benchMemorySampler& memSampler, rw::uint64 textureCount, rw::uint64 byteCount, const callbackType& cb )
+{
+    memSampler.BeginMeasure();
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    bool successful = true;
+
+    try
+    {
+        cb();
+    }
+    catch( rw::RwException& )
+    {
+        successful = false;
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    rw::uint64 peakMemory = memSampler.EndMeasure();
+
+    stage.seconds += std::chrono::duration <double> ( endTime - startTime ).count();
+
+    if ( peakMemory > stage.peakMemory )
+    {
+        stage.peakMemory = peakMemory;
+    }
+
+    if ( successful )
+    {
+        stage.textureCount += textureCount;
+        stage.byteCount += byteCount;
+    }
+    else
+    {
+        stage.failureCount++;
+    }
+
+    return successful;
+}
+
+// Growable in-memory stream, so that serialization is measured without disk access.
+struct benchMemoryStreamData
+{
+    std::vector <char> buffer;
+    size_t seekPos = 0;
+};
+
+void RegisterBenchMemoryStream( rw::Interface *engineInterface );
+rw::Stream* CreateBenchMemoryStream( rw::Interface *engineInterface, benchMemoryStreamData *data );
+
+// Input files of the benchmark, kept in memory.
+struct benchCorpusFile
+{
+    std::wstring path;
+    std::vector <char> fileData;
+    bool isTXD;
+};
+
+// Texture of the corpus in the format it was loaded in.
+struct benchCorpusTexture
+{
+    std::string name;
+    rw::Raster *raster;
+    rw::uint64 texelBytes;          // size of all mipmaps as 32bit texels
+};
+
+struct benchCorpus
+{
+    std::vector <benchCorpusFile> files;
+    std::vector <benchCorpusTexture> textures;
+};
+
+rw::uint64 GetRasterTexelBytes( rw::Raster *raster );
+
+struct benchConfig
+{
+    rw::uint32 iterations = 1;
+    std::vector <std::string> stageFilters;     // run only stages that start with one of these
+
+    bool isStageEnabled( const std::string& stageName ) const;
+};
+
+// Runs every benchmark stage over the corpus.
+void RunBenchStages( rw::Interface *engineInterface, const benchConfig& config, const benchCorpus& corpus, std::vector <benchStageResult>& resultsOut );
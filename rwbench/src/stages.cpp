@@ -0,0 +1,990 @@
+// Benchmark stages that are run over the corpus.
+
+#include "rwbench.h"
+
+#include <cctype>
+#include <cstring>
+#include <list>
+#include <algorithm>
+
+struct benchStageRunner
+{
+    inline benchStageRunner( rw::Interface *engineInterface, const benchConfig& config )
+        : engineInterface( engineInterface ), config( config )
+    {
+        return;
+    }
+
+    // Returns a new stage result if the stage should be run.
+    benchStageResult* BeginStage( const std::string& stageName )
+    {
+        if ( !config.isStageEnabled( stageName ) )
+            return NULL;
+
+        benchStageResult stage;
+        stage.name = stageName;
+
+        stages.push_back( std::move( stage ) );
+
+        return &stages.back();
+    }
+
+    // Runs an operation on a private clone of every corpus raster.
+    // The preparation of the clone is not part of the measurement.
+    template <typename prepareCallbackType, typename operationCallbackType>
+    void RunRasterStage( const std::string& stageName, const std::vector <rw::Raster*>& rasters, const prepareCallbackType& prepare, const operationCallbackType& op )
+    {
+        benchStageResult *stage = BeginStage( stageName );
+
+        if ( !stage )
+            return;
+
+        for ( rw::uint32 iter = 0; iter < config.iterations; iter++ )
+        {
+            for ( rw::Raster *srcRaster : rasters )
+            {
+                rw::Raster *workRaster = NULL;
+
+                try
+                {
+                    workRaster = rw::CloneRaster( srcRaster );
+
+                    if ( !prepare( workRaster ) )
+                    {
+                        rw::DeleteRaster( workRaster );
+                        continue;
+                    }
+                }
+                catch( rw::RwException& )
+                {
+                    if ( workRaster )
+                    {
+                        rw::DeleteRaster( workRaster );
+                    }
+
+                    stage->failureCount++;
+                    continue;
+                }
+
+                RunBenchOperation( *stage, memSampler, 1, GetRasterTexelBytes( workRaster ),
+                    [&]
+                {
+                    op( workRaster );
+                });
+
+                rw::DeleteRaster( workRaster );
+            }
+        }
+    }
+
+    rw::Interface *engineInterface;
+    const benchConfig& config;
+
+    std::list <benchStageResult> stages;    // stable, because stages are accounted through pointers
+
+    benchMemorySampler memSampler;
+};
+
+static std::string lowercase( std::string str )
+{
+    for ( char& c : str )
+    {
+        c = (char)std::tolower( (unsigned char)c );
+    }
+
+    return str;
+}
+
+static rw::uint32 getTXDTextureCount( rw::Interface *engineInterface, rw::RwObject *rwObj )
+{
+    rw::TexDictionary *texDict = rw::ToTexDictionary( engineInterface, rwObj );
+
+    if ( texDict == NULL )
+        return 0;
+
+    return texDict->GetTextureCount();
+}
+
+static void runInputStages( benchStageRunner& runner, const benchCorpus& corpus )
+{
+    rw::Interface *engineInterface = runner.engineInterface;
+
+    benchStageResult *txdStage = runner.BeginStage( "txd.deserialize" );
+    benchStageResult *imageStage = runner.BeginStage( "image.import" );
+
+    for ( rw::uint32 iter = 0; iter < runner.config.iterations; iter++ )
+    {
+        for ( const benchCorpusFile& file : corpus.files )
+        {
+            benchStageResult *stage = ( file.isTXD ? txdStage : imageStage );
+
+            if ( !stage )
+                continue;
+
+            benchMemoryStreamData streamData;
+            streamData.buffer = file.fileData;
+
+            rw::Stream *inputStream = CreateBenchMemoryStream( engineInterface, &streamData );
+
+            if ( !inputStream )
+            {
+                stage->failureCount++;
+                continue;
+            }
+
+            if ( file.isTXD )
+            {
+                rw::RwObject *rwObj = NULL;
+
+                bool successful = RunBenchOperation( *stage, runner.memSampler, 0, file.fileData.size(),
+                    [&]
+                {
+                    rwObj = engineInterface->Deserialize( inputStream );
+                });
+
+                if ( successful && rwObj )
+                {
+                    stage->textureCount += getTXDTextureCount( engineInterface, rwObj );
+                }
+
+                if ( rwObj )
+                {
+                    engineInterface->DeleteRwObject( rwObj );
+                }
+            }
+            else
+            {
+                rw::Raster *raster = rw::CreateRaster( engineInterface );
+
+                if ( raster )
+                {
+                    raster->newNativeData( benchProcessingNativeName );
+
+                    RunBenchOperation( *stage, runner.memSampler, 1, file.fileData.size(),
+                        [&]
+                    {
+                        raster->readImage( inputStream );
+                    });
+
+                    rw::DeleteRaster( raster );
+                }
+            }
+
+            engineInterface->DeleteStream( inputStream );
+        }
+    }
+}
+
+// Size of the thumbnails in the thumbnail stage, like a large icon view of the shell.
+static const rw::uint32 benchThumbnailSize = 256;
+
+// Decodes a thumbnail of every corpus file straight from its file data, like the shell thumbnail provider does.
+static void runThumbnailStage( benchStageRunner& runner, const benchCorpus& corpus )
+{
+    rw::Interface *engineInterface = runner.engineInterface;
+
+    benchStageResult *stage = runner.BeginStage( "thumbnail.decode" );
+
+    if ( !stage )
+        return;
+
+    for ( rw::uint32 iter = 0; iter < runner.config.iterations; iter++ )
+    {
+        for ( const benchCorpusFile& file : corpus.files )
+        {
+            benchMemoryStreamData streamData;
+            streamData.buffer = file.fileData;
+
+            rw::Stream *inputStream = CreateBenchMemoryStream( engineInterface, &streamData );
+
+            if ( !inputStream )
+            {
+                stage->failureCount++;
+                continue;
+            }
+
+            RunBenchOperation( *stage, runner.memSampler, 1, file.fileData.size(),
+                [&]
+            {
+                rw::Bitmap thumbnail( engineInterface );
+
+                if ( !rw::DecodeThumbnail( inputStream, benchThumbnailSize, thumbnail ) )
+                {
+                    throw rw::RwException( "no thumbnail could be decoded" );
+                }
+
+                // Every file has to come out at the requested size.
+                rw::uint32 thumbWidth, thumbHeight;
+                thumbnail.getSize( thumbWidth, thumbHeight );
+
+                if ( thumbWidth == 0 || thumbHeight == 0 || std::max( thumbWidth, thumbHeight ) > benchThumbnailSize )
+                {
+                    throw rw::RwException( "thumbnail has invalid dimensions" );
+                }
+            });
+
+            engineInterface->DeleteStream( inputStream );
+        }
+    }
+}
+
+// Fixed blocks of a native texture codec together with the texels they have to decode to.
+// The texels were worked out from the format specifications, as 0xRRGGBBAA in row-major order.
+struct codecKnownAnswer
+{
+    const char *stageName;
+    const char *nativeName;
+    rw::uint32 width, height;
+    const rw::uint8 *blockData;
+    size_t blockDataSize;
+    const rw::uint32 *texels;
+};
+
+static bool isNativeTextureTypeAvailable( rw::Interface *engineInterface, const char *nativeName )
+{
+    rw::platformTypeNameList_t nativeNames = rw::GetAvailableNativeTextureTypes( engineInterface );
+
+    return ( std::find( nativeNames.begin(), nativeNames.end(), nativeName ) != nativeNames.end() );
+}
+
+static rw::uint32 readLittleEndianUInt32( const std::vector <char>& buffer, size_t offset )
+{
+    const unsigned char *bytes = (const unsigned char*)buffer.data() + offset;
+
+    return ( (rw::uint32)bytes[0] | ( (rw::uint32)bytes[1] << 8 ) | ( (rw::uint32)bytes[2] << 16 ) | ( (rw::uint32)bytes[3] << 24 ) );
+}
+
+// Replaces the texel data of a serialized single-mipmap texture.
+// Every mobile native texture ends its struct chunk with the size of the mipmap followed by its data.
+static void replaceSerializedTexelData( std::vector <char>& buffer, const rw::uint8 *blockData, size_t blockDataSize )
+{
+    const size_t chunkHeaderSize = 12;
+
+    if ( buffer.size() < chunkHeaderSize * 2 ||
+         readLittleEndianUInt32( buffer, 0 ) != rw::CHUNK_TEXTURENATIVE ||
+         readLittleEndianUInt32( buffer, chunkHeaderSize ) != rw::CHUNK_STRUCT )
+    {
+        throw rw::RwException( "unexpected chunk layout of the serialized texture" );
+    }
+
+    size_t structEnd = ( chunkHeaderSize * 2 + readLittleEndianUInt32( buffer, chunkHeaderSize + 4 ) );
+
+    if ( structEnd > buffer.size() || structEnd < chunkHeaderSize * 2 + blockDataSize + 4 )
+    {
+        throw rw::RwException( "serialized texture struct is too small for the known-answer blocks" );
+    }
+
+    size_t texelOffset = ( structEnd - blockDataSize );
+
+    if ( readLittleEndianUInt32( buffer, texelOffset - 4 ) != blockDataSize )
+    {
+        throw rw::RwException( "serialized texture mipmap size does not match the known-answer blocks" );
+    }
+
+    memcpy( buffer.data() + texelOffset, blockData, blockDataSize );
+}
+
+// Creates an RGBA bitmap from texels given as 0xRRGGBBAA.
+static rw::Bitmap createTexelBitmap( rw::Interface *engineInterface, rw::uint32 width, rw::uint32 height, const rw::uint32 *texels )
+{
+    std::vector <rw::uint8> texelBytes( width * height * 4 );
+
+    for ( rw::uint32 n = 0; n < width * height; n++ )
+    {
+        rw::uint32 texel = texels[ n ];
+
+        texelBytes[ n * 4 + 0 ] = (rw::uint8)( texel >> 24 );
+        texelBytes[ n * 4 + 1 ] = (rw::uint8)( texel >> 16 );
+        texelBytes[ n * 4 + 2 ] = (rw::uint8)( texel >> 8 );
+        texelBytes[ n * 4 + 3 ] = (rw::uint8)( texel );
+    }
+
+    rw::Bitmap bitmap( engineInterface, 32, rw::RASTER_8888, rw::COLOR_RGBA );
+    bitmap.setImageDataSimple( texelBytes.data(), rw::RASTER_8888, rw::COLOR_RGBA, 32, 4, width, height );
+
+    return bitmap;
+}
+
+// Throws if the bitmap does not consist of exactly the given texels.
+static void verifyDecodedTexels( const rw::Bitmap& decoded, rw::uint32 width, rw::uint32 height, const rw::uint32 *texels )
+{
+    rw::uint32 decodedWidth, decodedHeight;
+    decoded.getSize( decodedWidth, decodedHeight );
+
+    if ( decodedWidth != width || decodedHeight != height )
+    {
+        throw rw::RwException( "known-answer image decoded at the wrong size" );
+    }
+
+    for ( rw::uint32 y = 0; y < height; y++ )
+    {
+        for ( rw::uint32 x = 0; x < width; x++ )
+        {
+            rw::uint8 r, g, b, a;
+
+            if ( !decoded.browsecolor( x, y, r, g, b, a ) )
+            {
+                throw rw::RwException( "failed to fetch a decoded known-answer texel" );
+            }
+
+            rw::uint32 texel = ( ( (rw::uint32)r << 24 ) | ( (rw::uint32)g << 16 ) | ( (rw::uint32)b << 8 ) | a );
+
+            if ( texel != texels[ y * width + x ] )
+            {
+                throw rw::RwException( "decoded texel does not match the known answer" );
+            }
+        }
+    }
+}
+
+// Serializes a texture of the codec's native type, swaps its texel data for the known blocks and
+// decodes it again. A texel that differs from the answer fails the stage, so a SIMD and a
+// scalar build of rwlib are held to the same results.
+static void runCodecKnownAnswerStage( benchStageRunner& runner, const codecKnownAnswer& answer )
+{
+    rw::Interface *engineInterface = runner.engineInterface;
+
+    if ( !isNativeTextureTypeAvailable( engineInterface, answer.nativeName ) )
+        return;
+
+    benchStageResult *stage = runner.BeginStage( answer.stageName );
+
+    if ( !stage )
+        return;
+
+    rw::uint32 width = answer.width;
+    rw::uint32 height = answer.height;
+
+    for ( rw::uint32 iter = 0; iter < runner.config.iterations; iter++ )
+    {
+        benchMemoryStreamData streamData;
+
+        rw::Raster *raster = rw::CreateRaster( engineInterface );
+
+        if ( !raster )
+        {
+            stage->failureCount++;
+            continue;
+        }
+
+        rw::TextureBase *texHandle = NULL;
+
+        try
+        {
+            // The answer itself is the source image, so the encoder picks the internal format that the blocks are meant for.
+            raster->newNativeData( benchProcessingNativeName );
+            raster->setImageData( createTexelBitmap( engineInterface, width, height, answer.texels ) );
+
+            if ( rw::ConvertRasterTo( raster, answer.nativeName ) )
+            {
+                texHandle = rw::CreateTexture( engineInterface, raster );
+            }
+        }
+        catch( rw::RwException& )
+        {
+            texHandle = NULL;
+        }
+
+        rw::DeleteRaster( raster );
+
+        if ( !texHandle )
+        {
+            stage->failureCount++;
+            continue;
+        }
+
+        rw::Stream *memStream = CreateBenchMemoryStream( engineInterface, &streamData );
+
+        if ( memStream )
+        {
+            RunBenchOperation( *stage, runner.memSampler, 1, width * height * 4,
+                [&]
+            {
+                engineInterface->Serialize( texHandle, memStream );
+
+                replaceSerializedTexelData( streamData.buffer, answer.blockData, answer.blockDataSize );
+
+                streamData.seekPos = 0;
+
+                rw::RwObject *readObj = engineInterface->Deserialize( memStream );
+
+                if ( !readObj )
+                {
+                    throw rw::RwException( "failed to deserialize the known-answer texture" );
+                }
+
+                try
+                {
+                    rw::TextureBase *readTex = rw::ToTexture( engineInterface, readObj );
+
+                    if ( !readTex || !readTex->GetRaster() )
+                    {
+                        throw rw::RwException( "known-answer texture has no raster" );
+                    }
+
+                    verifyDecodedTexels( readTex->GetRaster()->getBitmap(), width, height, answer.texels );
+                }
+                catch( ... )
+                {
+                    engineInterface->DeleteRwObject( readObj );
+                    throw;
+                }
+
+                engineInterface->DeleteRwObject( readObj );
+            });
+
+            engineInterface->DeleteStream( memStream );
+        }
+        else
+        {
+            stage->failureCount++;
+        }
+
+        engineInterface->DeleteRwObject( texHandle );
+    }
+}
+
+// PVRTC 4bpp, four equal blocks so that the upscaled endpoints are flat.
+// Opaque endpoints (24, 6, 6) and (2, 29, 17) in 5bit precision, every pixel row uses other modulation values.
+static const rw::uint8 pvrtcOpaqueBlocks[] =
+{
+    0xE4, 0x1B, 0xA5, 0xCC, 0xC6, 0xE0, 0xB1, 0x8B, 0xE4, 0x1B, 0xA5, 0xCC, 0xC6, 0xE0, 0xB1, 0x8B,
+    0xE4, 0x1B, 0xA5, 0xCC, 0xC6, 0xE0, 0xB1, 0x8B, 0xE4, 0x1B, 0xA5, 0xCC, 0xC6, 0xE0, 0xB1, 0x8B
+};
+
+static const rw::uint32 pvrtcOpaqueTexels[] =
+{
+    0xC53131FF, 0x817853FF, 0x54A86AFF, 0x10EF8CFF, 0xC53131FF, 0x817853FF, 0x54A86AFF, 0x10EF8CFF,
+    0x10EF8CFF, 0x54A86AFF, 0x817853FF, 0xC53131FF, 0x10EF8CFF, 0x54A86AFF, 0x817853FF, 0xC53131FF,
+    0x817853FF, 0x817853FF, 0x54A86AFF, 0x54A86AFF, 0x817853FF, 0x817853FF, 0x54A86AFF, 0x54A86AFF,
+    0xC53131FF, 0x10EF8CFF, 0xC53131FF, 0x10EF8CFF, 0xC53131FF, 0x10EF8CFF, 0xC53131FF, 0x10EF8CFF,
+    0xC53131FF, 0x817853FF, 0x54A86AFF, 0x10EF8CFF, 0xC53131FF, 0x817853FF, 0x54A86AFF, 0x10EF8CFF,
+    0x10EF8CFF, 0x54A86AFF, 0x817853FF, 0xC53131FF, 0x10EF8CFF, 0x54A86AFF, 0x817853FF, 0xC53131FF,
+    0x817853FF, 0x817853FF, 0x54A86AFF, 0x54A86AFF, 0x817853FF, 0x817853FF, 0x54A86AFF, 0x54A86AFF,
+    0xC53131FF, 0x10EF8CFF, 0xC53131FF, 0x10EF8CFF, 0xC53131FF, 0x10EF8CFF, 0xC53131FF, 0x10EF8CFF
+};
+
+// The same modulation with translucent endpoints in punch-through mode, where modulation value 2 is transparent.
+static const rw::uint8 pvrtcPunchThroughBlocks[] =
+{
+    0xE4, 0x1B, 0xA5, 0xCC, 0x3D, 0x5C, 0xE9, 0x21, 0xE4, 0x1B, 0xA5, 0xCC, 0x3D, 0x5C, 0xE9, 0x21,
+    0xE4, 0x1B, 0xA5, 0xCC, 0x3D, 0x5C, 0xE9, 0x21, 0xE4, 0x1B, 0xA5, 0xCC, 0x3D, 0x5C, 0xE9, 0x21
+};
+
+static const rw::uint32 pvrtcPunchThroughTexels[] =
+{
+    0xCE31DEAA, 0x6F90BD77, 0x6F90BD00, 0x10EF9C44, 0xCE31DEAA, 0x6F90BD77, 0x6F90BD00, 0x10EF9C44,
+    0x10EF9C44, 0x6F90BD00, 0x6F90BD77, 0xCE31DEAA, 0x10EF9C44, 0x6F90BD00, 0x6F90BD77, 0xCE31DEAA,
+    0x6F90BD77, 0x6F90BD77, 0x6F90BD00, 0x6F90BD00, 0x6F90BD77, 0x6F90BD77, 0x6F90BD00, 0x6F90BD00,
+    0xCE31DEAA, 0x10EF9C44, 0xCE31DEAA, 0x10EF9C44, 0xCE31DEAA, 0x10EF9C44, 0xCE31DEAA, 0x10EF9C44,
+    0xCE31DEAA, 0x6F90BD77, 0x6F90BD00, 0x10EF9C44, 0xCE31DEAA, 0x6F90BD77, 0x6F90BD00, 0x10EF9C44,
+    0x10EF9C44, 0x6F90BD00, 0x6F90BD77, 0xCE31DEAA, 0x10EF9C44, 0x6F90BD00, 0x6F90BD77, 0xCE31DEAA,
+    0x6F90BD77, 0x6F90BD77, 0x6F90BD00, 0x6F90BD00, 0x6F90BD77, 0x6F90BD77, 0x6F90BD00, 0x6F90BD00,
+    0xCE31DEAA, 0x10EF9C44, 0xCE31DEAA, 0x10EF9C44, 0xCE31DEAA, 0x10EF9C44, 0xCE31DEAA, 0x10EF9C44
+};
+
+// ATC RGB, one block with the interpolated palette and one in mode 1 (black, a darkened first endpoint and both endpoints).
+static const rw::uint8 atcColorBlocks[] =
+{
+    0xF3, 0x64, 0x5C, 0x1E, 0xB1, 0xB1, 0xB1, 0xB1, 0x84, 0xF9, 0xBF, 0xA9, 0x6C, 0x6C, 0x6C, 0x6C
+};
+
+static const rw::uint32 atcColorTexels[] =
+{
+    0x896FB8FF, 0xCE399CFF, 0x18CBE7FF, 0x5C94CAFF, 0x000000FF, 0xAD34FFFF, 0xF76321FF, 0xCC5600FF,
+    0x896FB8FF, 0xCE399CFF, 0x18CBE7FF, 0x5C94CAFF, 0x000000FF, 0xAD34FFFF, 0xF76321FF, 0xCC5600FF,
+    0x896FB8FF, 0xCE399CFF, 0x18CBE7FF, 0x5C94CAFF, 0x000000FF, 0xAD34FFFF, 0xF76321FF, 0xCC5600FF,
+    0x896FB8FF, 0xCE399CFF, 0x18CBE7FF, 0x5C94CAFF, 0x000000FF, 0xAD34FFFF, 0xF76321FF, 0xCC5600FF
+};
+
+// ATC with explicit alpha, where the pixels use many different 4bit alpha values.
+static const rw::uint8 atcExplicitAlphaBlocks[] =
+{
+    0xD2, 0x38, 0x9E, 0xF4, 0x5A, 0xB0, 0x16, 0x7C, 0x8E, 0x27, 0xA2, 0xD8, 0x4E, 0x4E, 0x4E, 0x4E
+};
+
+static const rw::uint32 atcExplicitAlphaTexels[] =
+{
+    0xA6633522, 0xDE1410DD, 0x4AE77388, 0x81974D33,
+    0xA66335EE, 0xDE141099, 0x4AE77344, 0x81974DFF,
+    0xA66335AA, 0xDE141055, 0x4AE77300, 0x81974DBB,
+    0xA6633566, 0xDE141011, 0x4AE773CC, 0x81974D77
+};
+
+// ETC1, one block in individual mode with side by side halves and one in differential mode with stacked halves.
+// The differential block clamps at both ends of the channel range.
+static const rw::uint8 etc1Blocks[] =
+{
+    0xE3, 0x5C, 0x90, 0x58, 0x5A, 0x3C, 0x96, 0xF0, 0xA5, 0x1A, 0xE3, 0xE7, 0x0F, 0xF0, 0x3C, 0x3C
+};
+
+static const rw::uint32 etc1Texels[] =
+{
+    0xF75EA2FF, 0xD1387CFF, 0x54ED21FF, 0x006200FF, 0xD447FFFF, 0x000030FF, 0x7600B8FF, 0xFFCFFFFF,
+    0xF75EA2FF, 0xD1387CFF, 0x006200FF, 0x54ED21FF, 0xD447FFFF, 0x000030FF, 0x7600B8FF, 0xFFCFFFFF,
+    0xE54C90FF, 0xFF72B6FF, 0x9DFF6AFF, 0x12AB00FF, 0x9D3AFFFF, 0x8724FAFF, 0x7B18EEFF, 0x912EFFFF,
+    0xE54C90FF, 0xFF72B6FF, 0x12AB00FF, 0x9DFF6AFF, 0x9D3AFFFF, 0x8724FAFF, 0x7B18EEFF, 0x912EFFFF
+};
+
+// ETC2 RGBA, one block each in planar, T and H mode. Every color block is preceded by an EAC alpha block.
+static const rw::uint8 etc2AlphaBlocks[] =
+{
+    0x80, 0x35, 0x15, 0x78, 0x73, 0x15, 0x78, 0x73, 0x65, 0x12, 0xFA, 0x8F, 0xF1, 0xF9, 0x8A, 0x21,
+    0xF0, 0x90, 0x33, 0xAA, 0x1E, 0x33, 0xAA, 0x1E, 0xF3, 0x4D, 0x72, 0xAB, 0xA5, 0xC3, 0x3C, 0x5A,
+    0x10, 0x2D, 0x05, 0x39, 0x77, 0x05, 0x39, 0x77, 0x1D, 0xF3, 0x58, 0xC6, 0xF0, 0x0F, 0x69, 0x96
+};
+
+static const rw::uint32 etc2AlphaTexels[] =
+{
+    0xCB937577, 0x9FAB9886, 0x74C2BA77, 0x48DADD86, 0x7722AABA, 0x9742CAFF, 0x7722AABA, 0x9742CAFF, 0xD2289F0E, 0x1CA44F10, 0x1CA44F0E, 0xD2289F10,
+    0xA4827992, 0x799A9C6B, 0x4DB1BE92, 0x21C9E16B, 0x57028AFF, 0xBB44DDD5, 0xBB44DDFF, 0x57028AD5, 0xA400710C, 0x4AD27D12, 0x4AD27D0C, 0xA4007112,
+    0x7E727E65, 0x5289A098, 0x26A1C365, 0x00B8E598, 0xBB44DDFF, 0x57028A69, 0x57028AFF, 0xBB44DD69, 0xA400710A, 0x4AD27D14, 0x4AD27D0A, 0xA4007114,
+    0x5761829E, 0x2B78A45F, 0x0090C79E, 0x00A7E95F, 0x9742CA9F, 0x7722AAFF, 0x9742CA9F, 0x7722AAFF, 0xD2289F00, 0x1CA44F22, 0x1CA44F00, 0xD2289F22
+};
+
+static const codecKnownAnswer codecKnownAnswers[] =
+{
+    { "check.pvrtc.rgb4", "PowerVR", 8, 8, pvrtcOpaqueBlocks, sizeof( pvrtcOpaqueBlocks ), pvrtcOpaqueTexels },
+    { "check.pvrtc.rgba4", "PowerVR", 8, 8, pvrtcPunchThroughBlocks, sizeof( pvrtcPunchThroughBlocks ), pvrtcPunchThroughTexels },
+    { "check.atc.rgb", "AMDCompress", 8, 4, atcColorBlocks, sizeof( atcColorBlocks ), atcColorTexels },
+    { "check.atc.explicit", "AMDCompress", 4, 4, atcExplicitAlphaBlocks, sizeof( atcExplicitAlphaBlocks ), atcExplicitAlphaTexels },
+    { "check.etc.etc1", "etc_mobile", 8, 4, etc1Blocks, sizeof( etc1Blocks ), etc1Texels },
+    { "check.etc.etc2_rgba", "etc_mobile", 12, 4, etc2AlphaBlocks, sizeof( etc2AlphaBlocks ), etc2AlphaTexels }
+};
+
+// Run-length encoded 4x3 TGA, 32bit and stored bottom-up. Both the run packet and the raw packet cross a scanline.
+static const rw::uint8 tgaRunLengthImage[] =
+{
+    0x00, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x03, 0x00, 0x20, 0x08,
+    0x85, 0x80, 0x40, 0x20, 0xFF,
+    0x02, 0x00, 0x00, 0xFF, 0x80, 0x00, 0xFF, 0x00, 0x40, 0x56, 0x34, 0x12, 0x78,
+    0x82, 0xC0, 0xC0, 0xC0, 0x00
+};
+
+static const rw::uint32 tgaRunLengthTexels[] =
+{
+    0x12345678, 0xC0C0C000, 0xC0C0C000, 0xC0C0C000,
+    0x204080FF, 0x204080FF, 0xFF000080, 0x00FF0040,
+    0x204080FF, 0x204080FF, 0x204080FF, 0x204080FF
+};
+
+// Size of the image of the TGA round trip stage.
+static const rw::uint32 tgaRoundTripWidth = 64;
+static const rw::uint32 tgaRoundTripHeight = 32;
+
+// Decodes a fixed run-length encoded TGA, then writes an image with flat areas as run-length encoded TGA and reads it back.
+static void runTGARunLengthStages( benchStageRunner& runner )
+{
+    rw::Interface *engineInterface = runner.engineInterface;
+
+    benchStageResult *decodeStage = runner.BeginStage( "check.tga.rle.decode" );
+    benchStageResult *roundTripStage = runner.BeginStage( "check.tga.rle.roundtrip" );
+
+    if ( !decodeStage && !roundTripStage )
+        return;
+
+    // UI style image: flat areas of a few colors and a gradient row that has to become raw packets.
+    std::vector <rw::uint32> roundTripTexels( tgaRoundTripWidth * tgaRoundTripHeight );
+
+    for ( rw::uint32 y = 0; y < tgaRoundTripHeight; y++ )
+    {
+        for ( rw::uint32 x = 0; x < tgaRoundTripWidth; x++ )
+        {
+            rw::uint32 texel;
+
+            if ( y == tgaRoundTripHeight / 2 )
+            {
+                texel = ( ( x * 4 ) << 24 ) | ( ( 255 - x * 4 ) << 16 ) | ( x << 8 ) | 0xFF;
+            }
+            else if ( x < tgaRoundTripWidth / 2 )
+            {
+                texel = ( y < tgaRoundTripHeight / 2 ? 0x3060A0FF : 0xF0E0D080 );
+            }
+            else
+            {
+                texel = ( y < tgaRoundTripHeight / 4 ? 0x00000000 : 0x80FF2040 );
+            }
+
+            roundTripTexels[ y * tgaRoundTripWidth + x ] = texel;
+        }
+    }
+
+    bool prevRunLengthEncoding = engineInterface->GetTGARunLengthEncoding();
+
+    for ( rw::uint32 iter = 0; iter < runner.config.iterations; iter++ )
+    {
+        if ( decodeStage )
+        {
+            benchMemoryStreamData streamData;
+            streamData.buffer.assign( (const char*)tgaRunLengthImage, (const char*)tgaRunLengthImage + sizeof( tgaRunLengthImage ) );
+
+            rw::Stream *inputStream = CreateBenchMemoryStream( engineInterface, &streamData );
+            rw::Raster *raster = rw::CreateRaster( engineInterface );
+
+            if ( inputStream && raster )
+            {
+                RunBenchOperation( *decodeStage, runner.memSampler, 1, sizeof( tgaRunLengthImage ),
+                    [&]
+                {
+                    raster->newNativeData( benchProcessingNativeName );
+                    raster->readImage( inputStream );
+
+                    verifyDecodedTexels( raster->getBitmap(), 4, 3, tgaRunLengthTexels );
+                });
+            }
+            else
+            {
+                decodeStage->failureCount++;
+            }
+
+            if ( raster )
+            {
+                rw::DeleteRaster( raster );
+            }
+
+            if ( inputStream )
+            {
+                engineInterface->DeleteStream( inputStream );
+            }
+        }
+
+        if ( roundTripStage )
+        {
+            benchMemoryStreamData streamData;
+
+            rw::Stream *memStream = CreateBenchMemoryStream( engineInterface, &streamData );
+            rw::Raster *srcRaster = rw::CreateRaster( engineInterface );
+            rw::Raster *readRaster = rw::CreateRaster( engineInterface );
+
+            if ( memStream && srcRaster && readRaster )
+            {
+                RunBenchOperation( *roundTripStage, runner.memSampler, 1, roundTripTexels.size() * sizeof( rw::uint32 ),
+                    [&]
+                {
+                    srcRaster->newNativeData( benchProcessingNativeName );
+                    srcRaster->setImageData( createTexelBitmap( engineInterface, tgaRoundTripWidth, tgaRoundTripHeight, roundTripTexels.data() ) );
+
+                    engineInterface->SetTGARunLengthEncoding( true );
+
+                    try
+                    {
+                        srcRaster->writeImage( memStream, "TGA" );
+                    }
+                    catch( ... )
+                    {
+                        engineInterface->SetTGARunLengthEncoding( prevRunLengthEncoding );
+                        throw;
+                    }
+
+                    engineInterface->SetTGARunLengthEncoding( prevRunLengthEncoding );
+
+                    // Image type 10 is run-length encoded true color, and the flat areas have to make it smaller than the texels.
+                    if ( streamData.buffer.size() < 18 || streamData.buffer[ 2 ] != 10 ||
+                         streamData.buffer.size() >= roundTripTexels.size() * sizeof( rw::uint32 ) )
+                    {
+                        throw rw::RwException( "TGA was not written with run-length encoding" );
+                    }
+
+                    streamData.seekPos = 0;
+
+                    readRaster->newNativeData( benchProcessingNativeName );
+                    readRaster->readImage( memStream );
+
+                    verifyDecodedTexels( readRaster->getBitmap(), tgaRoundTripWidth, tgaRoundTripHeight, roundTripTexels.data() );
+                });
+            }
+            else
+            {
+                roundTripStage->failureCount++;
+            }
+
+            if ( readRaster )
+            {
+                rw::DeleteRaster( readRaster );
+            }
+
+            if ( srcRaster )
+            {
+                rw::DeleteRaster( srcRaster );
+            }
+
+            if ( memStream )
+            {
+                engineInterface->DeleteStream( memStream );
+            }
+        }
+    }
+}
+
+static void runKnownAnswerStages( benchStageRunner& runner )
+{
+    for ( const codecKnownAnswer& answer : codecKnownAnswers )
+    {
+        runCodecKnownAnswerStage( runner, answer );
+    }
+
+    runTGARunLengthStages( runner );
+}
+
+// Converts into every native texture platform and serializes the result.
+static void runPlatformStages( benchStageRunner& runner, const std::vector <rw::Raster*>& rasters )
+{
+    rw::Interface *engineInterface = runner.engineInterface;
+
+    rw::platformTypeNameList_t nativeNames = rw::GetAvailableNativeTextureTypes( engineInterface );
+
+    for ( const std::string& nativeName : nativeNames )
+    {
+        benchStageResult *convertStage = runner.BeginStage( "convert." + nativeName );
+        benchStageResult *serializeStage = runner.BeginStage( "serialize." + nativeName );
+        benchStageResult *deserializeStage = runner.BeginStage( "deserialize." + nativeName );
+
+        if ( !convertStage && !serializeStage && !deserializeStage )
+            continue;
+
+        for ( rw::uint32 iter = 0; iter < runner.config.iterations; iter++ )
+        {
+            for ( rw::Raster *srcRaster : rasters )
+            {
+                rw::Raster *workRaster = rw::CloneRaster( srcRaster );
+
+                if ( !workRaster )
+                    continue;
+
+                bool hasConverted = false;
+
+                if ( convertStage )
+                {
+                    RunBenchOperation( *convertStage, runner.memSampler, 1, GetRasterTexelBytes( workRaster ),
+                        [&]
+                    {
+                        hasConverted = rw::ConvertRasterTo( workRaster, nativeName.c_str() );
+                    });
+                }
+                else
+                {
+                    try
+                    {
+                        hasConverted = rw::ConvertRasterTo( workRaster, nativeName.c_str() );
+                    }
+                    catch( rw::RwException& )
+                    {
+                        hasConverted = false;
+                    }
+                }
+
+                if ( hasConverted && ( serializeStage || deserializeStage ) )
+                {
+                    rw::TextureBase *texHandle = rw::CreateTexture( engineInterface, workRaster );
+
+                    if ( texHandle )
+                    {
+                        benchMemoryStreamData streamData;
+
+                        rw::Stream *memStream = CreateBenchMemoryStream( engineInterface, &streamData );
+
+                        if ( memStream )
+                        {
+                            bool hasSerialized = false;
+
+                            if ( serializeStage )
+                            {
+                                hasSerialized = RunBenchOperation( *serializeStage, runner.memSampler, 1, 0,
+                                    [&]
+                                {
+                                    engineInterface->Serialize( texHandle, memStream );
+                                });
+
+                                if ( hasSerialized )
+                                {
+                                    serializeStage->byteCount += streamData.buffer.size();
+                                }
+                            }
+                            else
+                            {
+                                try
+                                {
+                                    engineInterface->Serialize( texHandle, memStream );
+
+                                    hasSerialized = true;
+                                }
+                                catch( rw::RwException& )
+                                {
+                                    hasSerialized = false;
+                                }
+                            }
+
+                            if ( hasSerialized && deserializeStage )
+                            {
+                                streamData.seekPos = 0;
+
+                                rw::RwObject *readObj = NULL;
+
+                                RunBenchOperation( *deserializeStage, runner.memSampler, 1, streamData.buffer.size(),
+                                    [&]
+                                {
+                                    readObj = engineInterface->Deserialize( memStream );
+                                });
+
+                                if ( readObj )
+                                {
+                                    engineInterface->DeleteRwObject( readObj );
+                                }
+                            }
+
+                            engineInterface->DeleteStream( memStream );
+                        }
+
+                        engineInterface->DeleteRwObject( texHandle );
+                    }
+                }
+
+                rw::DeleteRaster( workRaster );
+            }
+        }
+    }
+}
+
+// Runs the processing steps that the tools apply to textures.
+static void runProcessingStages( benchStageRunner& runner, const std::vector <rw::Raster*>& rasters )
+{
+    rw::Interface *engineInterface = runner.engineInterface;
+
+    auto toProcessingPlatform = [&]( rw::Raster *raster )
+    {
+        return rw::ConvertRasterTo( raster, benchProcessingNativeName );
+    };
+
+    auto toUncompressedProcessingPlatform = [&]( rw::Raster *raster )
+    {
+        if ( !toProcessingPlatform( raster ) )
+            return false;
+
+        raster->convertToFormat( rw::RASTER_8888 );
+        return true;
+    };
+
+    runner.RunRasterStage( "mipmap.generate", rasters,
+        [&]( rw::Raster *raster )
+    {
+        if ( !toUncompressedProcessingPlatform( raster ) )
+            return false;
+
+        raster->clearMipmaps();
+        return true;
+    },
+        []( rw::Raster *raster )
+    {
+        raster->generateMipmaps( 32, rw::MIPMAPGEN_DEFAULT );
+    });
+
+    runner.RunRasterStage( "palettize.PAL8", rasters, toUncompressedProcessingPlatform,
+        []( rw::Raster *raster )
+    {
+        raster->convertToPalette( rw::PALETTE_8BIT );
+    });
+
+    runner.RunRasterStage( "palettize.PAL4", rasters, toUncompressedProcessingPlatform,
+        []( rw::Raster *raster )
+    {
+        raster->convertToPalette( rw::PALETTE_4BIT );
+    });
+
+    runner.RunRasterStage( "compress.DXT1", rasters, toUncompressedProcessingPlatform,
+        []( rw::Raster *raster )
+    {
+        raster->compressCustom( rw::RWCOMPRESS_DXT1 );
+    });
+
+    runner.RunRasterStage( "compress.DXT5", rasters, toUncompressedProcessingPlatform,
+        []( rw::Raster *raster )
+    {
+        raster->compressCustom( rw::RWCOMPRESS_DXT5 );
+    });
+
+    runner.RunRasterStage( "pixelconvert.565", rasters, toUncompressedProcessingPlatform,
+        []( rw::Raster *raster )
+    {
+        raster->convertToFormat( rw::RASTER_565 );
+    });
+
+    runner.RunRasterStage( "pixelconvert.8888", rasters, toProcessingPlatform,
+        []( rw::Raster *raster )
+    {
+        raster->convertToFormat( rw::RASTER_8888 );
+    });
+
+    runner.RunRasterStage( "resize.half", rasters, toUncompressedProcessingPlatform,
+        []( rw::Raster *raster )
+    {
+        rw::uint32 width, height;
+        raster->getSize( width, height );
+
+        raster->resize( std::max( 1u, width / 2 ), std::max( 1u, height / 2 ) );
+    });
+
+    // Export into every registered image format.
+    rw::registered_image_formats_t imageFormats;
+    rw::GetRegisteredImageFormats( engineInterface, imageFormats );
+
+    for ( const rw::registered_image_format& imgFormat : imageFormats )
+    {
+        const char *defaultExt = NULL;
+
+        if ( !rw::GetDefaultImagingFormatExtension( imgFormat.num_ext, imgFormat.ext_array, defaultExt ) )
+            continue;
+
+        runner.RunRasterStage( "image.export." + lowercase( defaultExt ), rasters,
+            [&]( rw::Raster *raster )
+        {
+            return ( toProcessingPlatform( raster ) && raster->supportsImageMethod( defaultExt ) );
+        },
+            [&]( rw::Raster *raster )
+        {
+            benchMemoryStreamData streamData;
+
+            rw::Stream *outputStream = CreateBenchMemoryStream( engineInterface, &streamData );
+
+            if ( !outputStream )
+            {
+                throw rw::RwException( "failed to create memory stream for image export" );
+            }
+
+            try
+            {
+                raster->writeImage( outputStream, defaultExt );
+            }
+            catch( ... )
+            {
+                engineInterface->DeleteStream( outputStream );
+                throw;
+            }
+
+            engineInterface->DeleteStream( outputStream );
+        });
+    }
+}
+
+void RunBenchStages( rw::Interface *engineInterface, const benchConfig& config, const benchCorpus& corpus, std::vector <benchStageResult>& resultsOut )
+{
+    benchStageRunner runner( engineInterface, config );
+
+    std::vector <rw::Raster*> rasters;
+    rasters.reserve( corpus.textures.size() );
+
+    for ( const benchCorpusTexture& tex : corpus.textures )
+    {
+        rasters.push_back( tex.raster );
+    }
+
+    runInputStages( runner, corpus );
+    runThumbnailStage( runner, corpus );
+    runKnownAnswerStages( runner );
+    runPlatformStages( runner, rasters );
+    runProcessingStages( runner, rasters );
+
+    for ( benchStageResult& stage : runner.stages )
+    {
+        resultsOut.push_back( std::move( stage ) );
+    }
+}
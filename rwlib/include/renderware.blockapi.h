@@ -8,6 +8,16 @@ enum eBlockMode
     RWBLOCKMODE_READ
 };
 
+// How block headers are written.
+// Streams that cannot seek need to know each header before the block contents, so a
+// counting pass records the headers first and a streaming pass writes them up front.
+enum eBlockWriteMode
+{
+    RWBLOCKWRITE_PATCH,     // seek back and patch the header after the block (default)
+    RWBLOCKWRITE_COUNT,     // write nothing, only record the block headers
+    RWBLOCKWRITE_STREAM     // write the recorded headers forward-only, never seek
+};
+
 struct RwBlockException : public RwException
 {
     inline RwBlockException( const char *msg ) : RwException( msg )
@@ -16,29 +26,49 @@ struct RwBlockException : public RwException
     }
 };
 
+// Block headers in the order their blocks were entered.
+struct BlockWritePlan
+{
+    struct blockHeader
+    {
+        uint32 chunk_id;
+        uint32 chunk_length;
+        LibraryVersion chunk_version;
+    };
+
+    std::vector <blockHeader> headers;
+};
+
 struct BlockProvider
 {
     typedef sliceOfData <int64> streamMemSlice_t;
 
     BlockProvider( Stream *contextStream, rw::eBlockMode blockMode );
     BlockProvider( Stream *contextStream, rw::eBlockMode blockMode, bool ignoreBlockRegions );
+    BlockProvider( Stream *contextStream, rw::eBlockWriteMode writeMode, BlockWritePlan *writePlan );
 
     inline BlockProvider( BlockProvider *parentProvider )
     {
         this->parent = parentProvider;
+        this->rootProvider = parentProvider->rootProvider;
         this->blockMode = parentProvider->blockMode;
         this->isInContext = false;
         this->contextStream = NULL;
         this->ignoreBlockRegions = parentProvider->ignoreBlockRegions;
+        this->initReadBuffer();
+        this->initWritePlan( RWBLOCKWRITE_PATCH, NULL );
     }
 
     inline BlockProvider( BlockProvider *parentProvider, bool ignoreBlockRegions )
     {
         this->parent = parentProvider;
+        this->rootProvider = parentProvider->rootProvider;
         this->blockMode = parentProvider->blockMode;
         this->isInContext = false;
         this->contextStream = NULL;
         this->ignoreBlockRegions = ignoreBlockRegions;
+        this->initReadBuffer();
+        this->initWritePlan( RWBLOCKWRITE_PATCH, NULL );
     }
 
     BlockProvider( const BlockProvider& right ) = delete;
@@ -50,6 +80,7 @@ struct BlockProvider
 
 protected:
     BlockProvider *parent;
+    BlockProvider *rootProvider;    // the provider that owns the stream
 
     eBlockMode blockMode;
     bool isInContext;
@@ -58,6 +89,38 @@ protected:
 
     bool ignoreBlockRegions;
 
+    // Read-ahead buffer of the root provider.
+    // Small field reads of nested blocks are served from here instead of the stream.
+    void *readBuffer;
+    int64 readBufferOffset;     // absolute stream offset of the first buffered byte
+    size_t readBufferSize;
+    size_t readBufferPos;
+
+    inline void initReadBuffer( void )
+    {
+        this->readBuffer = NULL;
+        this->readBufferOffset = 0;
+        this->readBufferSize = 0;
+        this->readBufferPos = 0;
+    }
+
+    // Forward-only writing state of the root provider.
+    // The stream position is tracked by ourselves because such streams may not report it.
+    eBlockWriteMode writeMode;
+    BlockWritePlan *writePlan;
+    size_t writePlanIndex;
+    int64 writeOffset;
+    bool hasWritePlanMismatch;
+
+    inline void initWritePlan( eBlockWriteMode writeMode, BlockWritePlan *writePlan )
+    {
+        this->writeMode = writeMode;
+        this->writePlan = writePlan;
+        this->writePlanIndex = 0;
+        this->writeOffset = 0;
+        this->hasWritePlanMismatch = false;
+    }
+
     // Processing context of this stream.
     // This is stored for important points.
     struct Context
@@ -70,6 +133,11 @@ protected:
             this->chunk_length = -1;
 
             this->context_seek = -1;
+
+            this->read_min_absolute = -1;
+            this->read_max_absolute = -1;
+
+            this->write_plan_index = 0;
         }
 
         uint32 chunk_id;
@@ -78,6 +146,14 @@ protected:
         int64 chunk_length;
 
         int64 context_seek;
+
+        // Absolute region that reads are allowed in, combined over all parent blocks
+        // and the stream size. Calculated once when entering a read context.
+        int64 read_min_absolute;
+        int64 read_max_absolute;
+
+        // Index of our header inside of the write plan, if writing forward-only.
+        size_t write_plan_index;
         
         LibraryVersion chunk_version;
     };
@@ -118,6 +194,16 @@ protected:
     int64 tell_native( void ) const;
     int64 tell_absolute_native( void ) const;
 
+    void beginReadBuffer( void );
+    void endReadBuffer( bool syncStream );
+    void dropReadBuffer( void );
+
+    inline bool isReadAccessInBounds( int64 absoluteOffset, size_t accessCount ) const
+    {
+        return ( absoluteOffset >= this->blockContext.read_min_absolute &&
+                 absoluteOffset + (int64)accessCount <= this->blockContext.read_max_absolute );
+    }
+
     Interface* getEngineInterface( void ) const;
 
 public:
@@ -139,6 +225,22 @@ public:
         return ( this->parent != NULL );
     }
 
+    // Returns true if a streaming pass wrote blocks that differ from its counting pass.
+    inline bool doesMismatchWritePlan( void ) const
+    {
+        const BlockProvider *rootProvider = this->rootProvider;
+
+        if ( rootProvider->hasWritePlanMismatch )
+            return true;
+
+        if ( rootProvider->writeMode == RWBLOCKWRITE_STREAM )
+        {
+            return ( rootProvider->writePlanIndex != rootProvider->writePlan->headers.size() );
+        }
+
+        return false;
+    }
+
     // Helper functions.
     template <typename structType>
     inline void writeStruct( const structType& theStruct )      { this->write( &theStruct, sizeof( theStruct ) ); }
@@ -170,4 +272,5 @@ protected:
     // Validation API.
     void verifyLocalStreamAccess( const streamMemSlice_t& requestedMemory ) const;
     void verifyStreamAccess( const streamMemSlice_t& requestedMemory ) const;
+    void verifyStreamedWrite( size_t writeCount ) const;
 };
\ No newline at end of file
@@ -154,7 +154,7 @@ struct Geometry : public RwObject
 	uint32 write(std::ostream &dff);
 	uint32 writeMeshExtension(std::ostream &dff);
 
-	void cleanUp(void);
+	void cleanUp(float32 weldEpsilon = 0.0f);
 
 	void dump(uint32 index, std::string ind = "", bool detailed = false);
 private:
@@ -168,26 +168,44 @@ private:
 	void deleteOverlapping(std::vector<uint32> &typesRead, uint32 split);
 	void readData(uint32 vertexCount, uint32 type, // native data block
                       uint32 split, std::istream &dff);
-
-	uint32 addTempVertexIfNew(uint32 index);
 };
 
+// A clump is what a DFF file stores. It is deserialized through the regular RenderWare stream API,
+// so rw::Interface::Deserialize returns one of these for model files.
 struct Clump : public RwObject
 {
-#if 0
-	std::vector<Atomic> atomicList;
-	std::vector<Frame> frameList;
-	std::vector<Geometry> geometryList;
-#endif
+    inline Clump( Interface *engineInterface, void *construction_params ) : RwObject( engineInterface, construction_params )
+    {
+        this->lightCount = 0;
+        this->cameraCount = 0;
+    }
+
+    // Copies share the frames, geometries and atomics by reference count.
+    Clump( const Clump& right );
+    ~Clump( void );
+
+	std::vector<Frame*> frameList;
+	std::vector<Geometry*> geometryList;
+	std::vector<Atomic*> atomicList;
+
+	uint32 lightCount;
+	uint32 cameraCount;
 
 	/* Extensions */
 	/* collision file */
 	// to do
 
+	// Returns the unique names of all textures (and masks) that the materials of this clump use.
+	void GetTextureReferences( std::vector<std::string>& namesOut ) const;
+
 	/* functions */
 	void read(std::istream &dff);
 	void readExtension(std::istream &dff);
 	uint32 write(std::ostream &dff);
 	void dump(bool detailed = false);
 	void clear(void);
-};
\ No newline at end of file
+};
+
+Clump* CreateClump( Interface *engineInterface );
+Clump* ToClump( Interface *engineInterface, RwObject *rwObj );
+const Clump* ToConstClump( Interface *engineInterface, const RwObject *rwObj );
\ No newline at end of file
@@ -519,6 +519,31 @@ enum eDXTCompressionMethod
     DXTRUNTIME_SQUISH       // prefer squish
 };
 
+// ETC compression configuration.
+// The tiers differ in how many base colors are tried per block.
+enum eETCCompressionQuality
+{
+    ETCQUALITY_FAST,
+    ETCQUALITY_NORMAL,
+    ETCQUALITY_HIGH
+};
+
+// Counters of a single thread that were recorded while profiling was enabled.
+struct profilingThreadCounters
+{
+    uint32 threadIndex;             // same as the "tid" of the trace dump
+
+    uint64 bytesConverted;          // pixel data that went through pixel format conversion
+    uint64 allocationCount;
+    uint64 allocationBytes;
+    uint64 lockWaitCount;           // how often a lock was contended
+    uint64 lockWaitMicroseconds;
+    uint64 streamBytesRead;
+    uint64 streamBytesWritten;
+};
+
+typedef std::vector <profilingThreadCounters> profilingCounterList_t;
+
 struct Interface abstract
 {
 protected:
@@ -551,6 +576,7 @@ public:
     // Serialization interface.
     void                SerializeBlock          ( RwObject *objectToStore, BlockProvider& outputProvider );
     void                Serialize               ( RwObject *objectToStore, Stream *outputStream );
+    void                SerializeStreaming      ( RwObject *objectToStore, Stream *outputStream );   // never seeks on outputStream
     RwObject*           DeserializeBlock        ( BlockProvider& inputProvider );
     RwObject*           Deserialize             ( Stream *inputStream );
 
@@ -588,12 +614,21 @@ public:
     void                PushWarning             ( std::string&& message );
     void                PushObjWarningVerb      ( const RwObject *theObj, const std::string& verbMsg );
 
+    // Warnings pushed inside of a batch are kept per thread and delivered together when the
+    // outermost batch ends or FlushWarnings is called on the same thread.
+    void                BeginWarningBatch       ( void );
+    void                EndWarningBatch         ( void );
+    void                FlushWarnings           ( void );
+
     bool                SetPaletteRuntime       ( ePaletteRuntimeType palRunType );
     ePaletteRuntimeType GetPaletteRuntime       ( void ) const;
 
     void                    SetDXTRuntime       ( eDXTCompressionMethod dxtRunType );
     eDXTCompressionMethod   GetDXTRuntime       ( void ) const;
 
+    void                    SetETCCompressionQuality    ( eETCCompressionQuality quality );
+    eETCCompressionQuality  GetETCCompressionQuality    ( void ) const;
+
     void                SetFixIncompatibleRasters   ( bool doFix );
     bool                GetFixIncompatibleRasters   ( void ) const;
 
@@ -603,11 +638,23 @@ public:
     void                SetPreferPackedSampleExport ( bool preferPacked );
     bool                GetPreferPackedSampleExport ( void ) const;
 
+    // Writes TGA images with run-length encoded packets (image types 9, 10 and 11).
+    void                SetTGARunLengthEncoding ( bool enable );
+    bool                GetTGARunLengthEncoding ( void ) const;
+
     void                SetDXTPackedDecompression   ( bool packedDecompress );
     bool                GetDXTPackedDecompression   ( void ) const;
 
     void                SetIgnoreSerializationBlockRegions  ( bool doIgnore );
     bool                GetIgnoreSerializationBlockRegions  ( void ) const;
+
+    // Profiling of the library hot-paths.
+    // While enabled, every thread records timed zones and counters. Disabled profiling has next to no cost.
+    void                SetProfilingEnabled     ( bool enabled );
+    bool                GetProfilingEnabled     ( void ) const;
+    void                ResetProfilingData      ( void );
+    void                GetProfilingCounters    ( profilingCounterList_t& countersOut ) const;
+    void                DumpProfilingTrace      ( Stream *outputStream ) const;         // writes Chrome trace event JSON
 };
 
 #include "renderware.utils.h"
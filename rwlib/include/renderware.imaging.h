@@ -9,6 +9,13 @@ bool IsImagingFormatAvailable( Interface *engineInterface, const char *formatDes
 bool DeserializeImage( Stream *inputStream, Bitmap& outputPixels );
 bool SerializeImage( Stream *outputStream, const char *formatDescriptor, const Bitmap& inputPixels );
 
+// Decodes a preview of an image file whose larger side is at most maxDimm pixels.
+// Works for imaging formats, native images and RenderWare textures or TXDs (first texture) alike
+// and decodes at reduced size where the format allows it.
+bool DecodeThumbnail( Stream *inputStream, uint32 maxDimm, Bitmap& outputPixels );
+// Same for a raster that is already loaded; only the closest mipmap is decoded.
+bool DecodeThumbnail( const Raster *raster, uint32 maxDimm, Bitmap& outputPixels );
+
 // Struct to specify the imaging format extensions that the framework should use.
 // This has to be stored as array in the imaging extension itself.
 struct imaging_filename_ext
@@ -52,6 +52,28 @@ struct nativeTextureFormatHandler abstract
         const void *texelSource, eRasterFormat rasterFormat, unsigned int depth, eColorOrdering colorOrder, ePaletteType paletteType, const void *paletteData, unsigned int paletteSize,
         void *texOut    // preallocated memory.
     ) const = 0;
+
+    // *** Optional fast paths. The defaults keep a handler on the ConvertToRW and ConvertFromRW path.
+
+    // Return true if the anonymous texels already are texels of the GetTextureRWFormat format, with Direct3D row layout.
+    // The engine then uses the texels in-place instead of allocating and converting a copy of every mipmap layer.
+    virtual bool IsTextureDataRWCompatible( void ) const
+    {
+        return false;
+    }
+
+    // Converts the rows [firstRow, firstRow + rowCount) of a layer, just like ConvertToRW would convert them.
+    // texOut points to the beginning of the whole destination layer, so write at row firstRow.
+    // The engine converts independent rows on multiple threads at once, so this has to be thread-safe.
+    // Return false if you do not support converting rows separately.
+    virtual bool ConvertRowsToRW(
+        const void *texData, unsigned int texMipWidth, unsigned int texMipHeight, size_t dstStride, size_t texDataSize,
+        unsigned int firstRow, unsigned int rowCount,
+        void *texOut
+    ) const
+    {
+        return false;
+    }
 };
 
 struct d3dNativeTextureDriverInterface abstract
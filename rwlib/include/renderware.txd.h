@@ -160,6 +160,9 @@ inline uint32 getPaletteItemCount( ePaletteType paletteType )
 // about the data that is pointed at by this.
 typedef void* PlatformTexture;
 
+// Manager of a native texture type (private).
+struct texNativeTypeProvider;
+
 // Native GTA:SA feature map:
 // no RASTER_PAL4 support at all.
 // if RASTER_PAL8, then only RASTER_8888 and RASTER_888
@@ -197,8 +200,11 @@ struct Raster
     {
         this->engineInterface = engineInterface;
         this->platformData = NULL;
+        this->platformProvider = NULL;
+        this->platformTypeHandle = 0;
         this->refCount = 1;
         this->constRefCount = 0;
+        this->revision = 0;
     }
 
     Raster( const Raster& right );
@@ -212,6 +218,8 @@ struct Raster
     void readImage(rw::Stream *inputStream);
 
     Bitmap getBitmap(void) const;
+    Bitmap getMipmapBitmap( uint32 mipIndex ) const;   // returns an empty bitmap if the layer does not exist
+    Bitmap getThumbnail( uint32 maxDimm ) const;        // larger side at most maxDimm, decoded from the closest mipmap
     void setImageData(const Bitmap& srcImage);
 
     void resize(uint32 width, uint32 height, const char *downsampleMode = NULL, const char *upscaleMode = NULL);
@@ -227,6 +235,13 @@ struct Raster
     void remConstRef( void );
     bool isImmutable( void ) const;
 
+    // Incremented each time the texel data changes; use it to invalidate derived data.
+    uint32 getRevision( void ) const;
+
+    // 128bit hash over the native pixel data and its format.
+    // Equal hashes mean equal rasters, without having to decode them.
+    void getContentHash( uint64& hashLowOut, uint64& hashHighOut ) const;
+
     bool hasNativeDataOfType( const char *typeName ) const;
     const char* getNativeDataTypeName( void ) const;
 
@@ -266,10 +281,14 @@ struct Raster
     Interface *engineInterface;
 
     PlatformTexture *platformData;
+    texNativeTypeProvider *platformProvider;    // cached type provider of platformData
+    uint32 platformTypeHandle;                  // interned native type of platformData (0 if none)
 
     std::atomic <uint32> refCount;          // general life-time reference count
 
     std::atomic <uint32> constRefCount;     // if != 0, the native data is immutable
+
+    std::atomic <uint32> revision;          // bumped by every texel data modification
 };
 
 struct TexDictionary;
@@ -457,6 +476,72 @@ typedef std::list <std::string> platformTypeNameList_t;
 // Complex native texture API.
 bool ConvertRasterTo( Raster *theRaster, const char *nativeName );
 
+// Fused raster processing.
+// A pipeline records raster operations in order and executes them in one go: the native data
+// is fetched once, all operations work on a single intermediate buffer per mipmap level and
+// the result is written to the (target) native texture exactly once.
+// Palettization and compression only decide the final encoding, so they are applied last.
+enum eRasterPipelineOperation
+{
+    RASTERPIPE_RESIZE,
+    RASTERPIPE_CLEAR_MIPMAPS,
+    RASTERPIPE_GENERATE_MIPMAPS,
+    RASTERPIPE_PALETTIZE,
+    RASTERPIPE_COMPRESS,
+    RASTERPIPE_COMPRESS_CUSTOM
+};
+
+struct rasterPipelineOperation
+{
+    eRasterPipelineOperation opType;
+
+    // RASTERPIPE_RESIZE
+    uint32 width, height;
+    const char *downsampleMode;
+    const char *upscaleMode;
+
+    // RASTERPIPE_GENERATE_MIPMAPS
+    uint32 maxMipmapCount;
+    eMipmapGenerationMode mipGenMode;
+
+    // RASTERPIPE_PALETTIZE
+    ePaletteType paletteType;
+    eRasterFormat paletteRasterFormat;
+
+    // RASTERPIPE_COMPRESS, RASTERPIPE_COMPRESS_CUSTOM
+    float quality;
+    eCompressionType compressionType;
+};
+
+struct RasterPipeline
+{
+    inline RasterPipeline( void )
+    {
+        this->targetNativeName = NULL;
+    }
+
+    // Same semantics as the Raster methods of the same name.
+    // String parameters are not copied, so they have to stay valid until execution.
+    // A pipeline may palettize or compress only once; the encoding is applied after all other operations.
+    RasterPipeline& resize( uint32 width, uint32 height, const char *downsampleMode = NULL, const char *upscaleMode = NULL );
+    RasterPipeline& clearMipmaps( void );
+    RasterPipeline& generateMipmaps( uint32 maxMipmapCount, eMipmapGenerationMode mipGenMode = MIPMAPGEN_DEFAULT );
+    RasterPipeline& convertToPalette( ePaletteType paletteType, eRasterFormat newRasterFormat = RASTER_DEFAULT );
+    RasterPipeline& compress( float quality );
+    RasterPipeline& compressCustom( eCompressionType format );
+
+    // Native texture type that the raster should end up in (NULL keeps the current type).
+    RasterPipeline& convertTo( const char *nativeName );
+
+    bool isEmpty( void ) const;
+    void clear( void );
+
+    std::vector <rasterPipelineOperation> operations;
+    const char *targetNativeName;
+};
+
+void ExecuteRasterPipeline( Raster *theRaster, const RasterPipeline& pipeline );
+
 void* GetNativeTextureDriverInterface( Interface *engineInterface, const char *nativeName );
 
 platformTypeNameList_t GetAvailableNativeTextureTypes( Interface *engineInterface );
@@ -35,6 +35,25 @@ private:
     WarningManagerInterface *prevWarnMan;
 };
 
+// Keeps the warnings of the calling thread together until the scope is left.
+struct warning_batch_scope
+{
+    inline warning_batch_scope( Interface *engineInterface )
+    {
+        engineInterface->BeginWarningBatch();
+
+        this->engineInterface = engineInterface;
+    }
+
+    inline ~warning_batch_scope( void )
+    {
+        this->engineInterface->EndWarningBatch();
+    }
+
+private:
+    Interface *engineInterface;
+};
+
 struct stacked_warnlevel_scope
 {
     inline stacked_warnlevel_scope( Interface *engineInterface, int level )
@@ -61,4 +80,64 @@ private:
 void writeStringChunkANSI( Interface *engineInterface, BlockProvider& outputProvider, const char *string, size_t strLen );
 void readStringChunkANSI( Interface *engineInterface, BlockProvider& inputProvider, std::string& stringOut );
 
+// 128bit content hash, made of two differently mixed 64bit lanes.
+// It is not cryptographic; use it for cache keys and deduplication of texel data.
+struct contentHasher
+{
+    inline contentHasher( void )
+    {
+        this->laneFNV = 14695981039346656037ULL;
+        this->lanePoly = 0;
+        this->dataLength = 0;
+    }
+
+    inline void feed( const void *data, size_t dataSize )
+    {
+        const uint8 *bytes = (const uint8*)data;
+
+        uint64 laneFNV = this->laneFNV;
+        uint64 lanePoly = this->lanePoly;
+
+        for ( size_t n = 0; n < dataSize; n++ )
+        {
+            uint8 curByte = bytes[ n ];
+
+            laneFNV = ( laneFNV ^ curByte ) * 1099511628211ULL;
+            lanePoly = ( lanePoly + curByte + 1 ) * 0x9E3779B97F4A7C15ULL;
+        }
+
+        this->laneFNV = laneFNV;
+        this->lanePoly = lanePoly;
+        this->dataLength += dataSize;
+    }
+
+    template <typename valueType>
+    inline void feedValue( const valueType& value )
+    {
+        feed( &value, sizeof( value ) );
+    }
+
+    // Spreads the length and all bits over the result.
+    inline void finish( uint64& hashLowOut, uint64& hashHighOut ) const
+    {
+        hashLowOut = mix( this->laneFNV ^ this->dataLength );
+        hashHighOut = mix( this->lanePoly + this->dataLength );
+    }
+
+private:
+    static inline uint64 mix( uint64 val )
+    {
+        val ^= ( val >> 33 );
+        val *= 0xFF51AFD7ED558CCDULL;
+        val ^= ( val >> 33 );
+        val *= 0xC4CEB9FE1A85EC53ULL;
+        val ^= ( val >> 33 );
+        return val;
+    }
+
+    uint64 laneFNV;
+    uint64 lanePoly;
+    uint64 dataLength;
+};
+
 }
\ No newline at end of file
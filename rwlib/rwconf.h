@@ -17,6 +17,7 @@
 #define RWLIB_INCLUDE_NATIVETEX_POWERVR_MOBILE
 #define RWLIB_INCLUDE_NATIVETEX_UNC_MOBILE
 #define RWLIB_INCLUDE_NATIVETEX_ATC_MOBILE
+#define RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
 
 // Define this macro if you have a "xdk/" folder in your vendors with all the
 // XBOX Development Kit headers. This will use correct and optimized swizzling
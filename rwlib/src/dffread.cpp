@@ -147,13 +147,93 @@ void Clump::dump(bool detailed)
 #endif
 }
 
+static void releaseMaterial(Material *material)
+{
+	// The texture belongs to the material, so it goes away with the last reference.
+	if (material->texture != NULL && GetRefCount(material) == 1)
+    {
+		material->engineInterface->DeleteRwObject(material->texture);
+
+		material->texture = NULL;
+	}
+
+	material->engineInterface->DeleteRwObject(material);
+}
+
+static void releaseGeometry(Geometry *geometry)
+{
+	// Materials are only released by the last owner of the geometry.
+	if (GetRefCount(geometry) == 1)
+    {
+		for (uint32 i = 0; i < geometry->materialList.size(); i++)
+        {
+			if (Material *material = geometry->materialList[i])
+            {
+				releaseMaterial(material);
+            }
+        }
+
+		geometry->materialList.clear();
+	}
+
+	geometry->engineInterface->DeleteRwObject(geometry);
+}
+
+Clump::Clump(const Clump& right) : RwObject(right)
+{
+	frameList = right.frameList;
+	geometryList = right.geometryList;
+	atomicList = right.atomicList;
+
+	lightCount = right.lightCount;
+	cameraCount = right.cameraCount;
+
+	for (uint32 i = 0; i < frameList.size(); i++)
+    {
+		if (frameList[i])
+			AcquireObject(frameList[i]);
+    }
+	for (uint32 i = 0; i < geometryList.size(); i++)
+    {
+		if (geometryList[i])
+			AcquireObject(geometryList[i]);
+    }
+	for (uint32 i = 0; i < atomicList.size(); i++)
+    {
+		if (atomicList[i])
+			AcquireObject(atomicList[i]);
+    }
+}
+
+Clump::~Clump(void)
+{
+	clear();
+}
+
 void Clump::clear(void)
 {
-#if 0
+	for (uint32 i = 0; i < atomicList.size(); i++)
+    {
+		if (atomicList[i])
+			engineInterface->DeleteRwObject(atomicList[i]);
+    }
+	for (uint32 i = 0; i < geometryList.size(); i++)
+    {
+		if (geometryList[i])
+			releaseGeometry(geometryList[i]);
+    }
+	for (uint32 i = 0; i < frameList.size(); i++)
+    {
+		if (frameList[i])
+			engineInterface->DeleteRwObject(frameList[i]);
+    }
+
 	atomicList.clear();
 	geometryList.clear();
 	frameList.clear();
-#endif
+
+	lightCount = 0;
+	cameraCount = 0;
 }
 
 /*
@@ -803,177 +883,238 @@ void Geometry::generateFaces(void)
 	}
 }
 
-// these hold the (temporary) cleaned up data
-static std::vector<float32>  vertices_new;
-static std::vector<float32>  normals_new;
-static std::vector<float32>  texCoords_new[8];
-static std::vector<uint8>    vertexColors_new;
-static std::vector<uint8>    nightColors_new;
-static std::vector<uint32>   vertexBoneIndices_new;
-static std::vector<float32>  vertexBoneWeights_new;
-
-// used only by Geometry::cleanUp()
-// adds new temporary vertex if it isn't already in the list
-// and returns the new index of that vertex
-uint32 Geometry::addTempVertexIfNew(uint32 index)
+// Vertex welding used by Geometry::cleanUp().
+// Every vertex is turned into a key made of its attribute words (position, normal, all UV sets,
+// colors, night colors and skin data) which is looked up in an open addressing hash table.
+// This runs in linear time and keeps all state local to the call, so geometries can be
+// cleaned up from multiple threads at the same time.
+static inline uint32 weldFloatKey(float32 value, float32 weldEpsilon)
+{
+	if (weldEpsilon > 0.0f)
+	{
+		// Snap to the epsilon grid.
+		return (uint32)(int64)floor((double)value / weldEpsilon + 0.5);
+	}
+
+	// Positive and negative zero compare equal.
+	if (value == 0.0f)
+		return 0;
+
+	uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	return bits;
+}
+
+static inline uint32 weldPackColor(const uint8 *color)
 {
-	// return if we already have the vertex
-	for (uint32 i = 0; i < vertices_new.size()/3; i++)
+	return ( (uint32)color[0] | ( (uint32)color[1] << 8 ) | ( (uint32)color[2] << 16 ) | ( (uint32)color[3] << 24 ) );
+}
+
+static inline uint32 weldHashKey(const uint32 *key, uint32 keyStride)
+{
+	uint32 hash = 2166136261u;
+
+	for (uint32 n = 0; n < keyStride; n++)
     {
-		if (vertices_new[i*3+0] != vertices[index*3+0] ||
-		    vertices_new[i*3+1] != vertices[index*3+1] ||
-		    vertices_new[i*3+2] != vertices[index*3+2])
-			continue;
+		hash = ( hash ^ key[n] ) * 16777619u;
+    }
 
-		if (flags & FLAGS_NORMALS)
+	// Finalize, so that the low bits are usable as table index.
+	hash ^= ( hash >> 16 );
+	hash *= 0x85EBCA6Bu;
+	hash ^= ( hash >> 13 );
+
+	return hash;
+}
+
+static void weldGeometryVertices(
+	const Geometry& geom, float32 weldEpsilon,
+	std::vector<uint32>& remapOut, std::vector<uint32>& keptVerticesOut
+)
+{
+	uint32 vertexCount = geom.vertices.size()/3;
+
+	bool hasNormals = ( geom.flags & FLAGS_NORMALS ) != 0;
+	bool hasTexCoords = ( geom.flags & FLAGS_TEXTURED || geom.flags & FLAGS_TEXTURED2 );
+	bool hasColors = ( geom.flags & FLAGS_PRELIT ) != 0;
+
+	uint32 numUVs = ( hasTexCoords ? std::min( geom.numUVs, (uint32)8 ) : 0 );
+
+	// Determine the amount of words per vertex key.
+	uint32 keyStride = 3;
+
+	if (hasNormals)
+		keyStride += 3;
+
+	keyStride += numUVs*2;
+
+	if (hasColors)
+		keyStride += 1;
+
+	if (geom.hasNightColors)
+		keyStride += 1;
+
+	if (geom.hasSkin)
+		keyStride += 5;
+
+	// Build the keys of all vertices.
+	std::vector<uint32> keys( (size_t)vertexCount * keyStride );
+
+	for (uint32 i = 0; i < vertexCount; i++)
+    {
+		uint32 *key = &keys[ (size_t)i * keyStride ];
+
+		for (uint32 c = 0; c < 3; c++)
         {
-			if (normals_new[i*3+0] != normals[index*3+0] ||
-			    normals_new[i*3+1] != normals[index*3+1] ||
-			    normals_new[i*3+2] != normals[index*3+2])
-				continue;
-		}
-		if (flags & FLAGS_TEXTURED || flags & FLAGS_TEXTURED2)
+			*key++ = weldFloatKey(geom.vertices[i*3+c], weldEpsilon);
+        }
+
+		if (hasNormals)
         {
-			for (uint32 j = 0; j < numUVs; j++)
+			for (uint32 c = 0; c < 3; c++)
             {
-				if (texCoords_new[j][i*2+0] != texCoords[j][index*2+0] ||
-				    texCoords_new[j][i*2+1] != texCoords[j][index*2+1])
-                {
-					goto cont;
-                }
+				*key++ = weldFloatKey(geom.normals[i*3+c], weldEpsilon);
             }
 		}
-		if (flags & FLAGS_PRELIT)
+		for (uint32 j = 0; j < numUVs; j++)
         {
-			if (vertexColors_new[i*4+0]!=vertexColors[index*4+0] ||
-			    vertexColors_new[i*4+1]!=vertexColors[index*4+1] ||
-			    vertexColors_new[i*4+2]!=vertexColors[index*4+2] ||
-			    vertexColors_new[i*4+3]!=vertexColors[index*4+3])
-				continue;
+			*key++ = weldFloatKey(geom.texCoords[j][i*2+0], weldEpsilon);
+			*key++ = weldFloatKey(geom.texCoords[j][i*2+1], weldEpsilon);
 		}
-		if (hasNightColors)
+		if (hasColors)
         {
-			if (nightColors_new[i*4+0] != nightColors[index*4+0] ||
-			    nightColors_new[i*4+1] != nightColors[index*4+1] ||
-			    nightColors_new[i*4+2] != nightColors[index*4+2] ||
-			    nightColors_new[i*4+3] != nightColors[index*4+3])
-				continue;
-		}
-		if (hasSkin)
+			*key++ = weldPackColor(&geom.vertexColors[i*4]);
+        }
+		if (geom.hasNightColors)
         {
-			if ( vertexBoneIndices_new[i] != vertexBoneIndices[index] )
-				continue;
+			*key++ = weldPackColor(&geom.nightColors[i*4]);
+        }
+		if (geom.hasSkin)
+        {
+			*key++ = geom.vertexBoneIndices[i];
 
-			if (vertexBoneWeights_new[i*4+0] != vertexBoneWeights[index*4+0] ||
-			    vertexBoneWeights_new[i*4+1] != vertexBoneWeights[index*4+1] ||
-			    vertexBoneWeights_new[i*4+2] != vertexBoneWeights[index*4+2] ||
-			    vertexBoneWeights_new[i*4+3] != vertexBoneWeights[index*4+3])
+			// Bone weights are blend factors, so they are never snapped.
+			for (uint32 c = 0; c < 4; c++)
             {
-				continue;
+				*key++ = weldFloatKey(geom.vertexBoneWeights[i*4+c], 0.0f);
             }
 		}
-		// this is only reached when the vertex is already in the list
-		return i;
-
-		cont: ;
 	}
 
-	// else add the vertex
-	vertices_new.push_back(vertices[index*3+0]);
-	vertices_new.push_back(vertices[index*3+1]);
-	vertices_new.push_back(vertices[index*3+2]);
+	// The table stores kept vertex index + 1, zero means empty.
+	uint32 tableSize = 16;
 
-	if (flags & FLAGS_NORMALS)
+	while (tableSize < vertexCount*2)
     {
-		normals_new.push_back(normals[index*3+0]);
-		normals_new.push_back(normals[index*3+1]);
-		normals_new.push_back(normals[index*3+2]);
-	}
-	if (flags & FLAGS_TEXTURED || flags & FLAGS_TEXTURED2)
+		tableSize *= 2;
+    }
+
+	std::vector<uint32> table( tableSize, 0 );
+
+	uint32 tableMask = tableSize - 1;
+
+	remapOut.resize( vertexCount );
+	keptVerticesOut.clear();
+	keptVerticesOut.reserve( vertexCount );
+
+	size_t keyByteSize = sizeof(uint32) * keyStride;
+
+	for (uint32 i = 0; i < vertexCount; i++)
     {
-		for (uint32 j = 0; j < numUVs; j++)
+		const uint32 *key = &keys[ (size_t)i * keyStride ];
+
+		uint32 slot = weldHashKey(key, keyStride) & tableMask;
+
+		while (true)
         {
-			texCoords_new[j].push_back(texCoords[j][index*2+0]);
-			texCoords_new[j].push_back(texCoords[j][index*2+1]);
+			uint32 entry = table[slot];
+
+			if (entry == 0)
+            {
+				// First vertex with these attributes, keep it.
+				uint32 newIndex = keptVerticesOut.size();
+
+				keptVerticesOut.push_back(i);
+
+				table[slot] = newIndex + 1;
+				remapOut[i] = newIndex;
+				break;
+			}
+
+			uint32 keptIndex = keptVerticesOut[entry - 1];
+
+			if (memcmp(&keys[ (size_t)keptIndex * keyStride ], key, keyByteSize) == 0)
+            {
+				remapOut[i] = entry - 1;
+				break;
+			}
+
+			slot = ( slot + 1 ) & tableMask;
 		}
 	}
-	if (flags & FLAGS_PRELIT)
-    {
-		vertexColors_new.push_back(vertexColors[index*4+0]);
-		vertexColors_new.push_back(vertexColors[index*4+1]);
-		vertexColors_new.push_back(vertexColors[index*4+2]);
-		vertexColors_new.push_back(vertexColors[index*4+3]);
-	}
-	if (hasNightColors)
+}
+
+template <typename dataType>
+static inline void weldGatherAttribute(std::vector<dataType>& data, const std::vector<uint32>& keptVertices, uint32 components)
+{
+	std::vector<dataType> newData;
+	newData.reserve( keptVertices.size() * components );
+
+	for (uint32 vertIndex : keptVertices)
     {
-		nightColors_new.push_back(nightColors[index*4+0]);
-		nightColors_new.push_back(nightColors[index*4+1]);
-		nightColors_new.push_back(nightColors[index*4+2]);
-		nightColors_new.push_back(nightColors[index*4+3]);
+		for (uint32 c = 0; c < components; c++)
+        {
+			newData.push_back(data[vertIndex*components+c]);
+        }
 	}
-	if (hasSkin)
-    {
-		vertexBoneIndices_new.push_back(vertexBoneIndices[index]);
 
-		vertexBoneWeights_new.push_back(vertexBoneWeights[index*4+0]);
-		vertexBoneWeights_new.push_back(vertexBoneWeights[index*4+1]);
-		vertexBoneWeights_new.push_back(vertexBoneWeights[index*4+2]);
-		vertexBoneWeights_new.push_back(vertexBoneWeights[index*4+3]);
-	}
-	return vertices_new.size()/3 - 1;
+	data = std::move( newData );
 }
 
 // removes duplicate vertices (only useful with ps2 meshes)
-void Geometry::cleanUp(void)
+// if weldEpsilon is bigger than zero, float attributes are compared on a grid of that spacing
+void Geometry::cleanUp(float32 weldEpsilon)
 {
-	vertices_new.clear();
-	normals_new.clear();
-	vertexColors_new.clear();
-	nightColors_new.clear();
-
-	for (uint32 i = 0; i < 8; i++)
-    {
-		texCoords_new[i].clear();
-    }
+	std::vector<uint32> newIndices;
+	std::vector<uint32> keptVertices;
 
-	vertexBoneIndices_new.clear();
-	vertexBoneWeights_new.clear();
+	weldGeometryVertices(*this, weldEpsilon, newIndices, keptVertices);
 
-	std::vector<uint32> newIndices;
+	// nothing was welded, so the indices stay the same
+	if (keptVertices.size() == newIndices.size())
+		return;
 
 	// create new vertex list
-	for (uint32 i = 0; i < vertices.size()/3; i++)
-    {
-		newIndices.push_back(addTempVertexIfNew(i));
-    }
-
-	vertices = vertices_new;
+	weldGatherAttribute(vertices, keptVertices, 3);
 
 	if (flags & FLAGS_NORMALS)
     {
-		normals = normals_new;
+		weldGatherAttribute(normals, keptVertices, 3);
     }
 	if (flags & FLAGS_TEXTURED || flags & FLAGS_TEXTURED2)
     {
-		for ( uint32 j = 0; j < numUVs; j++ )
+		for ( uint32 j = 0; j < numUVs && j < 8; j++ )
         {
-			texCoords[j] = texCoords_new[j];
+			weldGatherAttribute(texCoords[j], keptVertices, 2);
         }
     }
 	if (flags & FLAGS_PRELIT)
     {
-		vertexColors = vertexColors_new;
+		weldGatherAttribute(vertexColors, keptVertices, 4);
     }
 	if (hasNightColors)
     {
-		nightColors = nightColors_new;
+		weldGatherAttribute(nightColors, keptVertices, 4);
     }
 	if (hasSkin)
     {
-		vertexBoneIndices = vertexBoneIndices_new;
-		vertexBoneWeights = vertexBoneWeights_new;
+		weldGatherAttribute(vertexBoneIndices, keptVertices, 1);
+		weldGatherAttribute(vertexBoneWeights, keptVertices, 4);
 	}
 
+	vertexCount = vertices.size()/3;
+
 	// correct indices
 	for (uint32 i = 0; i < splits.size(); i++)
     {
@@ -0,0 +1,830 @@
+#include "StdInc.h"
+
+#include <cstring>
+
+#include "pluginutil.hxx"
+
+#include "rwserialize.hxx"
+
+#include "rwthreading.parallel.hxx"
+
+namespace rw
+{
+
+/*
+ * Clump stream deserializer
+ *
+ * Every big section of a clump (frame list, geometry, atomic) is fetched from the stream
+ * with a single bulk read and then decoded from memory. Since decoding does not touch the
+ * stream anymore, the geometries and atomics of a clump can be decoded in parallel.
+ */
+
+// Clumps whose sections are smaller than this are decoded on the calling thread, because
+// spawning workers would cost more than the decoding itself.
+static const size_t dffParallelDecodeThreshold = 256 * 1024;
+
+// A chunk body that has been fetched from the stream.
+struct dffSection
+{
+    std::vector <char> data;
+    LibraryVersion version;
+};
+
+// Cursor over the memory of a fetched section.
+struct dffMemoryReader
+{
+    inline dffMemoryReader( const char *data, size_t dataSize )
+    {
+        this->dataPtr = data;
+        this->dataSize = dataSize;
+        this->seekPos = 0;
+    }
+
+    inline size_t remaining( void ) const
+    {
+        return ( this->dataSize - this->seekPos );
+    }
+
+    inline bool isAtEnd( void ) const
+    {
+        return ( this->seekPos >= this->dataSize );
+    }
+
+    // Returns a pointer into the section, so no copy is made.
+    inline const char* borrow( size_t count )
+    {
+        if ( count > this->remaining() )
+        {
+            throw RwException( "unexpected end of DFF section" );
+        }
+
+        const char *dataPtr = ( this->dataPtr + this->seekPos );
+
+        this->seekPos += count;
+
+        return dataPtr;
+    }
+
+    inline void read( void *outBuf, size_t count )
+    {
+        memcpy( outBuf, this->borrow( count ), count );
+    }
+
+    inline void skip( size_t count )
+    {
+        this->borrow( count );
+    }
+
+    template <typename numberType>
+    inline numberType readValue( void )
+    {
+        endian::little_endian <numberType> val;
+
+        this->read( &val, sizeof( val ) );
+
+        return val;
+    }
+
+    // Sizes the array exactly once and fills it with a single copy.
+    template <typename elemType>
+    inline void readArray( std::vector <elemType>& arrayOut, size_t elemCount )
+    {
+        // Check before allocating, so broken counts cannot request huge buffers.
+        if ( elemCount > this->remaining() / sizeof( elemType ) )
+        {
+            throw RwException( "unexpected end of DFF section" );
+        }
+
+        arrayOut.resize( elemCount );
+
+        if ( elemCount != 0 )
+        {
+            this->read( arrayOut.data(), elemCount * sizeof( elemType ) );
+        }
+    }
+
+    // Returns a reader that is bounded to the body of the next chunk.
+    inline dffMemoryReader readChunk( uint32& chunkIDOut )
+    {
+        uint32 chunkID = this->readValue <uint32> ();
+        uint32 chunkLength = this->readValue <uint32> ();
+
+        this->skip( sizeof( uint32 ) );     // library version
+
+        chunkIDOut = chunkID;
+
+        return dffMemoryReader( this->borrow( chunkLength ), chunkLength );
+    }
+
+    inline dffMemoryReader expectChunk( uint32 chunkID, const char *chunkName )
+    {
+        uint32 foundChunkID;
+
+        dffMemoryReader chunkReader = this->readChunk( foundChunkID );
+
+        if ( foundChunkID != chunkID )
+        {
+            throw RwException( std::string( "invalid DFF section: could not find " ) + chunkName );
+        }
+
+        return chunkReader;
+    }
+
+    inline std::string readString( void )
+    {
+        size_t strLen = this->remaining();
+
+        const char *strData = this->borrow( strLen );
+
+        // Strings are zero-padded to a multiple of four.
+        const char *strEnd = (const char*)memchr( strData, '\0', strLen );
+
+        if ( strEnd != NULL )
+        {
+            strLen = ( strEnd - strData );
+        }
+
+        return std::string( strData, strLen );
+    }
+
+private:
+    const char *dataPtr;
+    size_t dataSize;
+    size_t seekPos;
+};
+
+static void readDFFSection( BlockProvider& parentProvider, uint32 chunkID, const char *chunkName, dffSection& sectionOut )
+{
+    BlockProvider sectionBlock( &parentProvider );
+
+    sectionBlock.EnterContext();
+
+    try
+    {
+        if ( sectionBlock.getBlockID() != chunkID )
+        {
+            throw RwException( std::string( "invalid clump: could not find " ) + chunkName );
+        }
+
+        int64 sectionLength = sectionBlock.getBlockLength();
+
+        sectionOut.version = sectionBlock.getBlockVersion();
+        sectionOut.data.resize( (size_t)sectionLength );
+
+        if ( sectionLength != 0 )
+        {
+            // Fetch the entire section at once.
+            sectionBlock.read( sectionOut.data.data(), (size_t)sectionLength );
+        }
+    }
+    catch( ... )
+    {
+        sectionBlock.LeaveContext();
+
+        throw;
+    }
+
+    sectionBlock.LeaveContext();
+}
+
+static void skipDFFSection( BlockProvider& parentProvider )
+{
+    BlockProvider sectionBlock( &parentProvider );
+
+    sectionBlock.EnterContext();
+    sectionBlock.LeaveContext();
+}
+
+// Types of the objects that make up a clump.
+struct clumpObjectTypes
+{
+    RwTypeSystem::typeInfoBase *frameTypeInfo;
+    RwTypeSystem::typeInfoBase *geometryTypeInfo;
+    RwTypeSystem::typeInfoBase *materialTypeInfo;
+    RwTypeSystem::typeInfoBase *textureTypeInfo;
+    RwTypeSystem::typeInfoBase *atomicTypeInfo;
+};
+
+template <typename objType>
+static objType* constructClumpObject( EngineInterface *engineInterface, RwTypeSystem::typeInfoBase *typeInfo )
+{
+    GenericRTTI *rttiObj = NULL;
+
+    if ( typeInfo )
+    {
+        rttiObj = engineInterface->typeSystem.Construct( engineInterface, typeInfo, NULL );
+    }
+
+    if ( rttiObj == NULL )
+    {
+        throw RwException( "failed to construct clump object" );
+    }
+
+    return (objType*)RwTypeSystem::GetObjectFromTypeStruct( rttiObj );
+}
+
+static void decodeClumpFrameList( EngineInterface *engineInterface, const clumpObjectTypes& objTypes, const dffSection& section, std::vector <Frame*>& framesOut )
+{
+    dffMemoryReader listReader( section.data.data(), section.data.size() );
+
+    // Frame transforms.
+    {
+        dffMemoryReader metaReader = listReader.expectChunk( CHUNK_STRUCT, "frame list struct" );
+
+        uint32 frameCount = metaReader.readValue <uint32> ();
+
+        const size_t frameStructSize = ( 12 * sizeof( float32 ) + 2 * sizeof( uint32 ) );
+
+        if ( frameCount > metaReader.remaining() / frameStructSize )
+        {
+            throw RwException( "invalid clump: frame count exceeds frame list size" );
+        }
+
+        framesOut.resize( frameCount, NULL );
+
+        for ( uint32 n = 0; n < frameCount; n++ )
+        {
+            Frame *theFrame = constructClumpObject <Frame> ( engineInterface, objTypes.frameTypeInfo );
+
+            framesOut[ n ] = theFrame;
+
+            metaReader.read( theFrame->rotationMatrix, sizeof( theFrame->rotationMatrix ) );
+            metaReader.read( theFrame->position, sizeof( theFrame->position ) );
+            theFrame->parent = metaReader.readValue <int32> ();
+            metaReader.skip( sizeof( uint32 ) );   // matrix creation flags, unused
+        }
+    }
+
+    // Frame extensions, one per frame.
+    for ( Frame *theFrame : framesOut )
+    {
+        if ( listReader.isAtEnd() )
+            break;
+
+        dffMemoryReader extReader = listReader.expectChunk( CHUNK_EXTENSION, "frame extension" );
+
+        while ( !extReader.isAtEnd() )
+        {
+            uint32 pluginID;
+
+            dffMemoryReader pluginReader = extReader.readChunk( pluginID );
+
+            if ( pluginID == CHUNK_FRAME )
+            {
+                theFrame->name = pluginReader.readString();
+            }
+        }
+    }
+}
+
+static void decodeClumpMaterial( EngineInterface *engineInterface, const clumpObjectTypes& objTypes, dffMemoryReader& materialReader, Material *materialOut )
+{
+    dffMemoryReader metaReader = materialReader.expectChunk( CHUNK_STRUCT, "material struct" );
+
+    materialOut->flags = metaReader.readValue <uint32> ();
+    metaReader.read( materialOut->color, sizeof( materialOut->color ) );
+    materialOut->unknown = metaReader.readValue <uint32> ();
+    materialOut->hasTex = ( metaReader.readValue <int32> () != 0 );
+
+    // Very old materials do not store surface properties.
+    if ( metaReader.remaining() >= sizeof( materialOut->surfaceProps ) )
+    {
+        metaReader.read( materialOut->surfaceProps, sizeof( materialOut->surfaceProps ) );
+    }
+
+    if ( materialOut->hasTex )
+    {
+        dffMemoryReader texReader = materialReader.expectChunk( CHUNK_TEXTURE, "material texture" );
+
+        Texture *texture = constructClumpObject <Texture> ( engineInterface, objTypes.textureTypeInfo );
+
+        // The material owns its texture.
+        materialOut->texture = texture;
+
+        {
+            dffMemoryReader texMetaReader = texReader.expectChunk( CHUNK_STRUCT, "texture struct" );
+
+            texture->filterFlags = texMetaReader.readValue <uint16> ();
+        }
+
+        texture->name = texReader.expectChunk( CHUNK_STRING, "texture name" ).readString();
+        texture->maskName = texReader.expectChunk( CHUNK_STRING, "texture mask name" ).readString();
+    }
+
+    // Material extensions are not decoded.
+}
+
+static void decodeClumpGeometry( EngineInterface *engineInterface, const clumpObjectTypes& objTypes, const dffSection& section, Geometry *geomOut )
+{
+    dffMemoryReader geomReader( section.data.data(), section.data.size() );
+
+    // Geometry meta data and vertex attributes.
+    {
+        dffMemoryReader metaReader = geomReader.expectChunk( CHUNK_STRUCT, "geometry struct" );
+
+        geomOut->flags = metaReader.readValue <uint16> ();
+        geomOut->numUVs = metaReader.readValue <uint8> ();
+        geomOut->hasNativeGeometry = ( metaReader.readValue <uint8> () != 0 );
+
+        uint32 triangleCount = metaReader.readValue <uint32> ();
+        geomOut->vertexCount = metaReader.readValue <uint32> ();
+        uint32 morphTargetCount = metaReader.readValue <uint32> ();
+
+        if ( geomOut->numUVs == 0 )
+        {
+            if ( geomOut->flags & FLAGS_TEXTURED2 )
+            {
+                geomOut->numUVs = 2;
+            }
+            else if ( geomOut->flags & FLAGS_TEXTURED )
+            {
+                geomOut->numUVs = 1;
+            }
+        }
+
+        if ( geomOut->numUVs > 8 )
+        {
+            throw RwException( "invalid geometry: too many texture coordinate sets" );
+        }
+
+        // skip light info
+        if ( section.version.rwLibMinor <= 3 )
+        {
+            metaReader.skip( 3 * sizeof( float32 ) );
+        }
+
+        const size_t vertexCount = geomOut->vertexCount;
+
+        if ( !geomOut->hasNativeGeometry )
+        {
+            if ( geomOut->flags & FLAGS_PRELIT )
+            {
+                metaReader.readArray( geomOut->vertexColors, 4 * vertexCount );
+            }
+
+            for ( uint32 n = 0; n < geomOut->numUVs; n++ )
+            {
+                metaReader.readArray( geomOut->texCoords[ n ], 2 * vertexCount );
+            }
+
+            metaReader.readArray( geomOut->faces, 4 * (size_t)triangleCount );
+        }
+
+        for ( uint32 n = 0; n < morphTargetCount; n++ )
+        {
+            float32 boundingSphere[4];
+
+            metaReader.read( boundingSphere, sizeof( boundingSphere ) );
+
+            uint32 hasPositions = metaReader.readValue <uint32> ();
+            uint32 hasNormals = metaReader.readValue <uint32> ();
+
+            if ( n == 0 )
+            {
+                memcpy( geomOut->boundingSphere, boundingSphere, sizeof( boundingSphere ) );
+
+                geomOut->hasPositions = hasPositions;
+                geomOut->hasNormals = hasNormals;
+
+                if ( hasPositions )
+                {
+                    metaReader.readArray( geomOut->vertices, 3 * vertexCount );
+                }
+
+                if ( hasNormals )
+                {
+                    metaReader.readArray( geomOut->normals, 3 * vertexCount );
+                }
+            }
+            else
+            {
+                // We only keep the first morph target.
+                const size_t morphDataSize = ( 3 * vertexCount * sizeof( float32 ) );
+
+                if ( hasPositions )
+                {
+                    metaReader.skip( morphDataSize );
+                }
+
+                if ( hasNormals )
+                {
+                    metaReader.skip( morphDataSize );
+                }
+            }
+        }
+    }
+
+    // Material list.
+    {
+        dffMemoryReader matListReader = geomReader.expectChunk( CHUNK_MATLIST, "material list" );
+
+        std::vector <int32> materialIndices;
+        {
+            dffMemoryReader metaReader = matListReader.expectChunk( CHUNK_STRUCT, "material list struct" );
+
+            uint32 materialCount = metaReader.readValue <uint32> ();
+
+            metaReader.readArray( materialIndices, materialCount );
+        }
+
+        size_t materialCount = materialIndices.size();
+
+        geomOut->materialList.resize( materialCount, NULL );
+
+        for ( size_t n = 0; n < materialCount; n++ )
+        {
+            int32 instanceIndex = materialIndices[ n ];
+
+            if ( instanceIndex < 0 )
+            {
+                dffMemoryReader materialReader = matListReader.expectChunk( CHUNK_MATERIAL, "material" );
+
+                Material *material = constructClumpObject <Material> ( engineInterface, objTypes.materialTypeInfo );
+
+                geomOut->materialList[ n ] = material;
+
+                decodeClumpMaterial( engineInterface, objTypes, materialReader, material );
+            }
+            else if ( (size_t)instanceIndex < n )
+            {
+                // Instance of a material that came before.
+                geomOut->materialList[ n ] = (Material*)AcquireObject( geomOut->materialList[ instanceIndex ] );
+            }
+            else
+            {
+                throw RwException( "invalid geometry: material instance index out of range" );
+            }
+        }
+    }
+
+    // Geometry extensions (bin mesh, skin, etc) are not decoded.
+}
+
+static void decodeClumpAtomic( const dffSection& section, Atomic *atomicOut )
+{
+    dffMemoryReader atomicReader( section.data.data(), section.data.size() );
+
+    {
+        dffMemoryReader metaReader = atomicReader.expectChunk( CHUNK_STRUCT, "atomic struct" );
+
+        atomicOut->frameIndex = metaReader.readValue <int32> ();
+        atomicOut->geometryIndex = metaReader.readValue <int32> ();
+        metaReader.skip( sizeof( uint32 ) );    // flags, unused
+    }
+
+    if ( atomicReader.isAtEnd() )
+        return;
+
+    dffMemoryReader extReader = atomicReader.expectChunk( CHUNK_EXTENSION, "atomic extension" );
+
+    while ( !extReader.isAtEnd() )
+    {
+        uint32 pluginID;
+
+        dffMemoryReader pluginReader = extReader.readChunk( pluginID );
+
+        if ( pluginID == CHUNK_RIGHTTORENDER )
+        {
+            atomicOut->hasRightToRender = true;
+            atomicOut->rightToRenderVal1 = pluginReader.readValue <uint32> ();
+            atomicOut->rightToRenderVal2 = pluginReader.readValue <uint32> ();
+        }
+        else if ( pluginID == CHUNK_PARTICLES )
+        {
+            atomicOut->hasParticles = true;
+            atomicOut->particlesVal = pluginReader.readValue <uint32> ();
+        }
+        else if ( pluginID == CHUNK_PIPELINESET )
+        {
+            atomicOut->hasPipelineSet = true;
+            atomicOut->pipelineSetVal = pluginReader.readValue <uint32> ();
+        }
+        else if ( pluginID == CHUNK_MATERIALEFFECTS )
+        {
+            atomicOut->hasMaterialFx = true;
+            atomicOut->materialFxVal = pluginReader.readValue <uint32> ();
+        }
+    }
+}
+
+struct clumpStreamPlugin : public serializationProvider
+{
+    inline void Initialize( EngineInterface *engineInterface )
+    {
+        RwTypeSystem::typeInfoBase *rwobjTypeInfo = engineInterface->rwobjTypeInfo;
+
+        objTypes.frameTypeInfo = engineInterface->typeSystem.RegisterStructType <Frame> ( "frame", rwobjTypeInfo );
+        objTypes.geometryTypeInfo = engineInterface->typeSystem.RegisterStructType <Geometry> ( "geometry", rwobjTypeInfo );
+        objTypes.materialTypeInfo = engineInterface->typeSystem.RegisterStructType <Material> ( "material", rwobjTypeInfo );
+        objTypes.textureTypeInfo = engineInterface->typeSystem.RegisterStructType <Texture> ( "material_texture", rwobjTypeInfo );
+        objTypes.atomicTypeInfo = engineInterface->typeSystem.RegisterStructType <Atomic> ( "atomic", rwobjTypeInfo );
+
+        clumpTypeInfo = engineInterface->typeSystem.RegisterStructType <Clump> ( "clump", rwobjTypeInfo );
+
+        if ( clumpTypeInfo )
+        {
+            // Register ourselves.
+            RegisterSerialization( engineInterface, CHUNK_CLUMP, clumpTypeInfo, this, RWSERIALIZE_ISOF );
+        }
+    }
+
+    inline void Shutdown( EngineInterface *engineInterface )
+    {
+        if ( RwTypeSystem::typeInfoBase *clumpTypeInfo = this->clumpTypeInfo )
+        {
+            // Unregister us again.
+            UnregisterSerialization( engineInterface, CHUNK_CLUMP, clumpTypeInfo, this );
+
+            engineInterface->typeSystem.DeleteType( clumpTypeInfo );
+        }
+
+        RwTypeSystem::typeInfoBase *objTypeInfos[] =
+        {
+            objTypes.atomicTypeInfo,
+            objTypes.textureTypeInfo,
+            objTypes.materialTypeInfo,
+            objTypes.geometryTypeInfo,
+            objTypes.frameTypeInfo
+        };
+
+        for ( RwTypeSystem::typeInfoBase *typeInfo : objTypeInfos )
+        {
+            if ( typeInfo )
+            {
+                engineInterface->typeSystem.DeleteType( typeInfo );
+            }
+        }
+    }
+
+    Clump* CreateClump( EngineInterface *engineInterface ) const
+    {
+        GenericRTTI *rttiObj = engineInterface->typeSystem.Construct( engineInterface, this->clumpTypeInfo, NULL );
+
+        if ( rttiObj == NULL )
+        {
+            return NULL;
+        }
+
+        return (Clump*)RwTypeSystem::GetObjectFromTypeStruct( rttiObj );
+    }
+
+    Clump* ToClump( EngineInterface *engineInterface, RwObject *rwObj ) const
+    {
+        if ( isRwObjectInheritingFrom( engineInterface, rwObj, this->clumpTypeInfo ) )
+        {
+            return (Clump*)rwObj;
+        }
+
+        return NULL;
+    }
+
+    const Clump* ToConstClump( EngineInterface *engineInterface, const RwObject *rwObj ) const
+    {
+        if ( isRwObjectInheritingFrom( engineInterface, rwObj, this->clumpTypeInfo ) )
+        {
+            return (const Clump*)rwObj;
+        }
+
+        return NULL;
+    }
+
+    void Serialize( Interface *engineInterface, BlockProvider& outputProvider, RwObject *objectToSerialize ) const
+    {
+        throw RwException( "clump serialization is not supported" );
+    }
+
+    void Deserialize( Interface *intf, BlockProvider& inputProvider, RwObject *objectToDeserialize ) const
+    {
+        EngineInterface *engineInterface = (EngineInterface*)intf;
+
+        Clump *clump = (Clump*)objectToDeserialize;
+
+        uint32 atomicCount = 0;
+        {
+            dffSection metaSection;
+
+            readDFFSection( inputProvider, CHUNK_STRUCT, "clump struct", metaSection );
+
+            dffMemoryReader metaReader( metaSection.data.data(), metaSection.data.size() );
+
+            atomicCount = metaReader.readValue <uint32> ();
+
+            if ( metaReader.remaining() >= 2 * sizeof( uint32 ) )
+            {
+                clump->lightCount = metaReader.readValue <uint32> ();
+                clump->cameraCount = metaReader.readValue <uint32> ();
+            }
+        }
+
+        // Fetch all sections first, so that the stream is only read sequentially.
+        dffSection frameListSection;
+
+        readDFFSection( inputProvider, CHUNK_FRAMELIST, "frame list", frameListSection );
+
+        std::vector <dffSection> geometrySections;
+        {
+            BlockProvider geomListBlock( &inputProvider );
+
+            geomListBlock.EnterContext();
+
+            try
+            {
+                if ( geomListBlock.getBlockID() != CHUNK_GEOMETRYLIST )
+                {
+                    throw RwException( "invalid clump: could not find geometry list (clumps without one are not supported)" );
+                }
+
+                dffSection metaSection;
+
+                readDFFSection( geomListBlock, CHUNK_STRUCT, "geometry list struct", metaSection );
+
+                dffMemoryReader metaReader( metaSection.data.data(), metaSection.data.size() );
+
+                uint32 geometryCount = metaReader.readValue <uint32> ();
+
+                // Every geometry has at least a chunk header.
+                if ( geometryCount > geomListBlock.getBlockLength() / 12 )
+                {
+                    throw RwException( "invalid clump: geometry count exceeds geometry list size" );
+                }
+
+                geometrySections.resize( geometryCount );
+
+                for ( dffSection& geomSection : geometrySections )
+                {
+                    readDFFSection( geomListBlock, CHUNK_GEOMETRY, "geometry", geomSection );
+                }
+            }
+            catch( ... )
+            {
+                geomListBlock.LeaveContext();
+
+                throw;
+            }
+
+            geomListBlock.LeaveContext();
+        }
+
+        std::vector <dffSection> atomicSections( atomicCount );
+
+        for ( dffSection& atomicSection : atomicSections )
+        {
+            readDFFSection( inputProvider, CHUNK_ATOMIC, "atomic", atomicSection );
+        }
+
+        // Lights are not interesting to us.
+        for ( uint32 n = 0; n < clump->lightCount; n++ )
+        {
+            skipDFFSection( inputProvider );    // struct
+            skipDFFSection( inputProvider );    // light
+        }
+
+        // Decode the sections.
+        decodeClumpFrameList( engineInterface, this->objTypes, frameListSection, clump->frameList );
+
+        size_t geometryCount = geometrySections.size();
+
+        // The objects are owned by the clump as soon as they exist, so they are released if decoding fails.
+        clump->geometryList.resize( geometryCount, NULL );
+        clump->atomicList.resize( atomicCount, NULL );
+
+        for ( Geometry*& geom : clump->geometryList )
+        {
+            geom = constructClumpObject <Geometry> ( engineInterface, this->objTypes.geometryTypeInfo );
+        }
+
+        for ( Atomic*& atomic : clump->atomicList )
+        {
+            atomic = constructClumpObject <Atomic> ( engineInterface, this->objTypes.atomicTypeInfo );
+        }
+
+        size_t totalSectionSize = 0;
+
+        for ( const dffSection& geomSection : geometrySections )
+        {
+            totalSectionSize += geomSection.data.size();
+        }
+
+        auto decodeSection = [&]( size_t sectionIndex )
+        {
+            if ( sectionIndex < geometryCount )
+            {
+                decodeClumpGeometry( engineInterface, this->objTypes, geometrySections[ sectionIndex ], clump->geometryList[ sectionIndex ] );
+            }
+            else
+            {
+                size_t atomicIndex = ( sectionIndex - geometryCount );
+
+                decodeClumpAtomic( atomicSections[ atomicIndex ], clump->atomicList[ atomicIndex ] );
+            }
+        };
+
+        size_t sectionCount = ( geometryCount + atomicCount );
+
+        if ( totalSectionSize >= dffParallelDecodeThreshold )
+        {
+            ParallelForEach( engineInterface, sectionCount, decodeSection );
+        }
+        else
+        {
+            for ( size_t n = 0; n < sectionCount; n++ )
+            {
+                decodeSection( n );
+            }
+        }
+
+        // Verify the links of the atomics.
+        for ( const Atomic *atomic : clump->atomicList )
+        {
+            if ( atomic->frameIndex < 0 || (size_t)atomic->frameIndex >= clump->frameList.size() ||
+                 atomic->geometryIndex < 0 || (size_t)atomic->geometryIndex >= geometryCount )
+            {
+                engineInterface->PushWarning( "clump atomic links to an invalid frame or geometry" );
+            }
+        }
+
+        // Read extensions.
+        engineInterface->DeserializeExtensions( clump, inputProvider );
+    }
+
+    RwTypeSystem::typeInfoBase *clumpTypeInfo;
+
+    clumpObjectTypes objTypes;
+};
+
+static PluginDependantStructRegister <clumpStreamPlugin, RwInterfaceFactory_t> clumpStreamStore;
+
+void Clump::GetTextureReferences( std::vector <std::string>& namesOut ) const
+{
+    for ( const Geometry *geom : this->geometryList )
+    {
+        for ( const Material *material : geom->materialList )
+        {
+            const Texture *texture = material->texture;
+
+            if ( texture == NULL )
+                continue;
+
+            const std::string *names[] = { &texture->name, &texture->maskName };
+
+            for ( const std::string *name : names )
+            {
+                if ( name->empty() == false && std::find( namesOut.begin(), namesOut.end(), *name ) == namesOut.end() )
+                {
+                    namesOut.push_back( *name );
+                }
+            }
+        }
+    }
+}
+
+Clump* CreateClump( Interface *intf )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    Clump *clumpOut = NULL;
+
+    clumpStreamPlugin *clumpStream = clumpStreamStore.GetPluginStruct( engineInterface );
+
+    if ( clumpStream )
+    {
+        clumpOut = clumpStream->CreateClump( engineInterface );
+    }
+
+    return clumpOut;
+}
+
+Clump* ToClump( Interface *intf, RwObject *rwObj )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    clumpStreamPlugin *clumpStream = clumpStreamStore.GetPluginStruct( engineInterface );
+
+    if ( clumpStream )
+    {
+        return clumpStream->ToClump( engineInterface, rwObj );
+    }
+
+    return NULL;
+}
+
+const Clump* ToConstClump( Interface *intf, const RwObject *rwObj )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    clumpStreamPlugin *clumpStream = clumpStreamStore.GetPluginStruct( engineInterface );
+
+    if ( clumpStream )
+    {
+        return clumpStream->ToConstClump( engineInterface, rwObj );
+    }
+
+    return NULL;
+}
+
+void registerClumpStreamPlugin( void )
+{
+    clumpStreamStore.RegisterPlugin( engineFactory );
+}
+
+};
@@ -709,7 +709,7 @@ inline void NativeImagePutToRaster_internal(
         nativeTexName = typeInfo->name;
     }
 
-    texNativeTypeProvider *rasterTypeMan = GetNativeTextureTypeProvider( engineInterface, nativeTex );
+    texNativeTypeProvider *rasterTypeMan = GetRasterNativeTypeProvider( raster );
 
     // Clear the raster from any previous data.
     rasterTypeMan->UnsetPixelDataFromTexture( engineInterface, nativeTex, true );
@@ -2,9 +2,15 @@
 
 #include "streamutil.hxx"
 
+#include <limits>
+
 namespace rw
 {
 
+// Size of the read-ahead buffer that root block providers use.
+// Reads that are bigger than this go to the stream directly.
+static const size_t blockReadBufferSize = 4096;
+
 struct rwBlockHeader
 {
     endian::little_endian <uint32> type;
@@ -161,19 +167,37 @@ LibraryVersion HeaderInfo::getVersion(void) const
 BlockProvider::BlockProvider( Stream *contextStream, eBlockMode blockMode )
 {
     this->parent = NULL;
+    this->rootProvider = this;
     this->blockMode = blockMode;
     this->isInContext = false;
     this->contextStream = contextStream;
     this->ignoreBlockRegions = contextStream->engineInterface->GetIgnoreSerializationBlockRegions();
+    this->initReadBuffer();
+    this->initWritePlan( RWBLOCKWRITE_PATCH, NULL );
 }
 
 BlockProvider::BlockProvider( Stream *contextStream, eBlockMode blockMode, bool ignoreBlockRegions )
 {
     this->parent = NULL;
+    this->rootProvider = this;
     this->blockMode = blockMode;
     this->isInContext = false;
     this->contextStream = contextStream;
     this->ignoreBlockRegions = ignoreBlockRegions;
+    this->initReadBuffer();
+    this->initWritePlan( RWBLOCKWRITE_PATCH, NULL );
+}
+
+BlockProvider::BlockProvider( Stream *contextStream, eBlockWriteMode writeMode, BlockWritePlan *writePlan )
+{
+    this->parent = NULL;
+    this->rootProvider = this;
+    this->blockMode = RWBLOCKMODE_WRITE;
+    this->isInContext = false;
+    this->contextStream = contextStream;
+    this->ignoreBlockRegions = contextStream->engineInterface->GetIgnoreSerializationBlockRegions();
+    this->initReadBuffer();
+    this->initWritePlan( writeMode, writePlan );
 }
 
 void BlockProvider::EnterContext( void ) throw( ... )
@@ -217,8 +241,64 @@ void BlockProvider::EnterContext( void ) throw( ... )
         
         this->blockContext.chunk_version = blockVer;
 
-        // Just skip the header.
-        this->skip_native( sizeof( rwBlockHeader ) );
+        BlockProvider *rootProvider = this->rootProvider;
+
+        eBlockWriteMode writeMode = rootProvider->writeMode;
+
+        if ( writeMode == RWBLOCKWRITE_PATCH )
+        {
+            // Just skip the header.
+            this->skip_native( sizeof( rwBlockHeader ) );
+        }
+        else
+        {
+            BlockWritePlan *writePlan = rootProvider->writePlan;
+
+            if ( writePlan == NULL )
+            {
+                throw RwBlockException( "forward-only block writing requires a write plan" );
+            }
+
+            rwBlockHeader blockHeader;
+
+            if ( writeMode == RWBLOCKWRITE_COUNT )
+            {
+                // Reserve our header; we know it once we leave the block.
+                this->blockContext.write_plan_index = writePlan->headers.size();
+
+                writePlan->headers.emplace_back();
+
+                blockHeader.type = 0;
+                blockHeader.length = 0;
+                blockHeader.libVer = packVersion( blockVer );
+            }
+            else
+            {
+                size_t planIndex = rootProvider->writePlanIndex++;
+
+                if ( planIndex >= writePlan->headers.size() )
+                {
+                    throw RwBlockException( "streamed block is missing from the write plan" );
+                }
+
+                const BlockWritePlan::blockHeader& plannedHeader = writePlan->headers[ planIndex ];
+
+                this->blockContext.write_plan_index = planIndex;
+
+                blockHeader.type = plannedHeader.chunk_id;
+                blockHeader.length = plannedHeader.chunk_length;
+                blockHeader.libVer = packVersion( plannedHeader.chunk_version );
+            }
+
+            // The header goes in front of the block contents right away.
+            // Our parent checks that it still fits into its own block.
+            if ( writeMode == RWBLOCKWRITE_STREAM && this->parent == NULL )
+            {
+                this->verifyStreamedWrite( sizeof( blockHeader ) );
+            }
+
+            this->write_native( &blockHeader, sizeof( blockHeader ) );
+        }
     }
 
     this->blockContext.chunk_beg_offset = this->tell_native();
@@ -227,6 +307,17 @@ void BlockProvider::EnterContext( void ) throw( ... )
 
     this->blockContext.context_seek = 0;
 
+    // We only want to ask the stream for its size once.
+    int64 streamSize = -1;
+
+    if ( this->blockMode == RWBLOCKMODE_READ )
+    {
+        if ( contextStream && contextStream->supportsSize() )
+        {
+            streamSize = contextStream->size();
+        }
+    }
+
     // Fix some block context things.
     if ( this->ignoreBlockRegions == false )
     {
@@ -237,7 +328,7 @@ void BlockProvider::EnterContext( void ) throw( ... )
             // see it as a wish, if we are in root-block mode. This allows for truncation incase the stream turns out
             // smaller than expected. For proper measure, we shall warn the runtime that stream block truncation was performed.
             // This is only possible if we can request a size from the stream.
-            if ( contextStream && contextStream->supportsSize() )
+            if ( streamSize >= 0 )
             {
                 int64 virtualSize = this->blockContext.chunk_length;
 
@@ -247,9 +338,7 @@ void BlockProvider::EnterContext( void ) throw( ... )
 
                     streamMemSlice_t virtualSpace( virtualOffset, virtualSize );
 
-                    int64 fileSize = contextStream->size();
-
-                    streamMemSlice_t fileSpace( 0, fileSize );
+                    streamMemSlice_t fileSpace( 0, streamSize );
 
                     streamMemSlice_t::eIntersectionResult intResult = fileSpace.intersectWith( virtualSpace );
 
@@ -279,9 +368,57 @@ void BlockProvider::EnterContext( void ) throw( ... )
     {
         if ( this->blockMode == RWBLOCKMODE_READ )
         {
-            streamMemSlice_t blockAccess( this->blockContext.chunk_beg_offset_absolute, this->blockContext.chunk_length );
+            int64 blockStart = this->blockContext.chunk_beg_offset_absolute;
+            int64 blockLength = this->blockContext.chunk_length;
 
-            this->verifyStreamAccess( blockAccess );
+            // The parent has already combined the bounds of all the blocks above us.
+            bool isBlockInParent =
+                ( parentProvider != NULL && blockLength >= 0 &&
+                  parentProvider->isReadAccessInBounds( blockStart, (size_t)blockLength ) );
+
+            if ( isBlockInParent == false )
+            {
+                streamMemSlice_t blockAccess( blockStart, blockLength );
+
+                this->verifyStreamAccess( blockAccess );
+            }
+        }
+    }
+
+    if ( this->blockMode == RWBLOCKMODE_READ )
+    {
+        // Combine the bounds of the whole block chain, so that reads can be verified
+        // without walking up the parents.
+        int64 readMin = 0;
+        int64 readMax = std::numeric_limits <int64>::max();
+
+        if ( parentProvider )
+        {
+            readMin = parentProvider->blockContext.read_min_absolute;
+            readMax = parentProvider->blockContext.read_max_absolute;
+        }
+        else if ( streamSize >= 0 )
+        {
+            readMax = streamSize;
+        }
+
+        if ( this->ignoreBlockRegions == false )
+        {
+            int64 blockStart = this->blockContext.chunk_beg_offset_absolute;
+            int64 blockEnd = ( blockStart + this->blockContext.chunk_length );
+
+            readMin = std::max( readMin, blockStart );
+            readMax = std::min( readMax, blockEnd );
+        }
+
+        this->blockContext.read_min_absolute = readMin;
+        this->blockContext.read_max_absolute = readMax;
+
+        // Only root blocks with a known end can read ahead.
+        // Without block regions we would not know where to stop.
+        if ( contextStream && this->ignoreBlockRegions == false )
+        {
+            this->beginReadBuffer();
         }
     }
 
@@ -296,18 +433,49 @@ void BlockProvider::LeaveContext( void )
 
     if ( this->blockMode == RWBLOCKMODE_WRITE )
     {
-        // Update the block information.
-        this->seek_native( this->blockContext.chunk_beg_offset - sizeof( rwBlockHeader ), RWSEEK_BEG );
+        BlockProvider *rootProvider = this->rootProvider;
+
+        eBlockWriteMode writeMode = rootProvider->writeMode;
+
+        if ( writeMode == RWBLOCKWRITE_PATCH )
+        {
+            // Update the block information.
+            this->seek_native( this->blockContext.chunk_beg_offset - sizeof( rwBlockHeader ), RWSEEK_BEG );
+
+            rwBlockHeader newHeader;
 
-        rwBlockHeader newHeader;
+            newHeader.type = this->blockContext.chunk_id;
+            newHeader.length = (uint32)this->blockContext.chunk_length;
+            newHeader.libVer = packVersion( this->blockContext.chunk_version );
 
-        newHeader.type = this->blockContext.chunk_id;
-        newHeader.length = (uint32)this->blockContext.chunk_length;
-        newHeader.libVer = packVersion( this->blockContext.chunk_version );
+            this->write_native( &newHeader, sizeof( newHeader ) );
 
-        this->write_native( &newHeader, sizeof( newHeader ) );
+            shouldJumpToEnd = true;
+        }
+        else
+        {
+            // Forward-only writing is always at the end of the block already.
+            BlockWritePlan::blockHeader& plannedHeader = rootProvider->writePlan->headers[ this->blockContext.write_plan_index ];
 
-        shouldJumpToEnd = true;
+            if ( writeMode == RWBLOCKWRITE_COUNT )
+            {
+                plannedHeader.chunk_id = this->blockContext.chunk_id;
+                plannedHeader.chunk_length = (uint32)this->blockContext.chunk_length;
+                plannedHeader.chunk_version = this->blockContext.chunk_version;
+            }
+            else
+            {
+                // We cannot throw here because we could be unwinding another exception.
+                // Any further write refuses to continue after a mismatch, and the caller
+                // checks for it after the serialization.
+                if ( plannedHeader.chunk_id != this->blockContext.chunk_id ||
+                     plannedHeader.chunk_length != (uint32)this->blockContext.chunk_length ||
+                     plannedHeader.chunk_version != this->blockContext.chunk_version )
+                {
+                    rootProvider->hasWritePlanMismatch = true;
+                }
+            }
+        }
     }
     else if ( this->blockMode == RWBLOCKMODE_READ )
     {
@@ -317,6 +485,12 @@ void BlockProvider::LeaveContext( void )
         }
     }
 
+    // Give the stream back in a state that matches our reading progress.
+    if ( this->readBuffer )
+    {
+        this->endReadBuffer( shouldJumpToEnd == false );
+    }
+
     if ( shouldJumpToEnd )
     {
         // Jump to the end of the block.
@@ -328,6 +502,52 @@ void BlockProvider::LeaveContext( void )
     this->isInContext = false;
 }
 
+void BlockProvider::beginReadBuffer( void )
+{
+    Stream *contextStream = this->contextStream;
+
+    assert( contextStream != NULL );
+    assert( this->readBuffer == NULL );
+
+    this->readBuffer = contextStream->engineInterface->MemAllocate( blockReadBufferSize );
+    this->readBufferOffset = contextStream->tell();
+    this->readBufferSize = 0;
+    this->readBufferPos = 0;
+}
+
+void BlockProvider::endReadBuffer( bool syncStream )
+{
+    Stream *contextStream = this->contextStream;
+
+    void *readBuffer = this->readBuffer;
+
+    assert( readBuffer != NULL );
+
+    if ( syncStream )
+    {
+        this->dropReadBuffer();
+    }
+
+    contextStream->engineInterface->MemFree( readBuffer );
+
+    this->initReadBuffer();
+}
+
+void BlockProvider::dropReadBuffer( void )
+{
+    int64 curPos = ( this->readBufferOffset + this->readBufferPos );
+
+    // The stream is ahead of the reading progress by the amount of unread bytes.
+    if ( this->readBufferPos != this->readBufferSize )
+    {
+        this->contextStream->seek( curPos, RWSEEK_BEG );
+    }
+
+    this->readBufferOffset = curPos;
+    this->readBufferSize = 0;
+    this->readBufferPos = 0;
+}
+
 void BlockProvider::read_native( void *out_buf, size_t readCount ) throw( ... )
 {
     Stream *contextStream = this->contextStream;
@@ -335,6 +555,67 @@ void BlockProvider::read_native( void *out_buf, size_t readCount ) throw( ... )
     // If we have no stream, try reading from the parent.
     if ( contextStream != NULL )
     {
+        if ( uint8 *readBuffer = (uint8*)this->readBuffer )
+        {
+            size_t bufferedCount = ( this->readBufferSize - this->readBufferPos );
+
+            if ( readCount <= bufferedCount )
+            {
+                memcpy( out_buf, readBuffer + this->readBufferPos, readCount );
+
+                this->readBufferPos += readCount;
+                return;
+            }
+
+            // Take what is left in the buffer, then fetch the rest.
+            memcpy( out_buf, readBuffer + this->readBufferPos, bufferedCount );
+
+            out_buf = ( (uint8*)out_buf + bufferedCount );
+            readCount -= bufferedCount;
+
+            this->readBufferOffset += this->readBufferSize;
+            this->readBufferSize = 0;
+            this->readBufferPos = 0;
+
+            if ( readCount >= blockReadBufferSize )
+            {
+                // Big reads are not worth buffering.
+                size_t actualReadCount = contextStream->read( out_buf, readCount );
+
+                this->readBufferOffset += actualReadCount;
+
+                if ( actualReadCount != readCount )
+                {
+                    throw RwBlockException( "unfinished block read exception" );
+                }
+                return;
+            }
+
+            // Never read ahead beyond the root block.
+            int64 fillMax = ( this->blockContext.read_max_absolute - this->readBufferOffset );
+
+            size_t fillCount = blockReadBufferSize;
+
+            if ( fillMax < (int64)fillCount )
+            {
+                fillCount = (size_t)std::max( fillMax, (int64)readCount );
+            }
+
+            size_t actualFillCount = contextStream->read( readBuffer, fillCount );
+
+            this->readBufferSize = actualFillCount;
+
+            if ( actualFillCount < readCount )
+            {
+                throw RwBlockException( "unfinished block read exception" );
+            }
+
+            memcpy( out_buf, readBuffer, readCount );
+
+            this->readBufferPos = readCount;
+            return;
+        }
+
         size_t actualReadCount = contextStream->read( out_buf, readCount );
 
         if ( actualReadCount != readCount )
@@ -368,7 +649,28 @@ void BlockProvider::read( void *out_buf, size_t readCount ) throw( ... )
     {
         int64 totalStreamOffset = this->tell_absolute();
 
+        // Fast path: the bounds of all parent blocks were checked at once, so we can
+        // read from the root directly.
+        if ( this->isReadAccessInBounds( totalStreamOffset, readCount ) )
+        {
+            this->rootProvider->read_native( out_buf, readCount );
+
+            // Advance the virtual seek of the entire chain.
+            BlockProvider *curProvider = this;
+
+            do
+            {
+                curProvider->blockContext.context_seek += readCount;
+
+                curProvider = curProvider->parent;
+            }
+            while ( curProvider );
+
+            return;
+        }
+
         // Verify this reading operation.
+        // This will throw the precise exception of the block that is violated.
         streamMemSlice_t readAccess( totalStreamOffset, readCount );
 
         this->verifyLocalStreamAccess( readAccess );
@@ -388,8 +690,34 @@ void BlockProvider::write_native( const void *in_buf, size_t writeCount ) throw(
     // If we have no stream ourselves, write it into the parent.
     if ( contextStream != NULL )
     {
+        eBlockWriteMode writeMode = this->writeMode;
+
+        if ( writeMode == RWBLOCKWRITE_COUNT )
+        {
+            this->writeOffset += writeCount;
+            return;
+        }
+
+        // Writing to a read block is odd, but keep the stream consistent.
+        bool hasReadBuffer = ( this->readBuffer != NULL );
+
+        if ( hasReadBuffer )
+        {
+            this->dropReadBuffer();
+        }
+
         size_t actualWriteCount = contextStream->write( in_buf, writeCount );
 
+        if ( hasReadBuffer )
+        {
+            this->readBufferOffset += actualWriteCount;
+        }
+
+        if ( writeMode == RWBLOCKWRITE_STREAM )
+        {
+            this->writeOffset += actualWriteCount;
+        }
+
         if ( actualWriteCount != writeCount )
         {
             throw RwBlockException( "unfinished block write exception" );
@@ -427,6 +755,10 @@ void BlockProvider::write( const void *in_buf, size_t writeCount ) throw( ... )
         // Verify this writing operation.
         this->verifyLocalStreamAccess( writeAccess );
     }
+    else
+    {
+        this->verifyStreamedWrite( writeCount );
+    }
 
     // Do the native operation.
     this->write_native( in_buf, writeCount );
@@ -459,6 +791,47 @@ void BlockProvider::skip_native( size_t skipCount ) throw( ... )
 
     if ( contextStream != NULL )
     {
+        eBlockWriteMode writeMode = this->writeMode;
+
+        if ( writeMode == RWBLOCKWRITE_COUNT )
+        {
+            this->writeOffset += skipCount;
+            return;
+        }
+
+        if ( writeMode == RWBLOCKWRITE_STREAM )
+        {
+            // We cannot skip ahead in forward-only streams, so fill the gap.
+            static const uint8 zeroes[ 256 ] = { 0 };
+
+            while ( skipCount > 0 )
+            {
+                size_t fillCount = std::min( skipCount, sizeof( zeroes ) );
+
+                this->write_native( zeroes, fillCount );
+
+                skipCount -= fillCount;
+            }
+            return;
+        }
+
+        if ( this->readBuffer )
+        {
+            size_t bufferedCount = ( this->readBufferSize - this->readBufferPos );
+
+            if ( skipCount <= bufferedCount )
+            {
+                this->readBufferPos += skipCount;
+                return;
+            }
+
+            skipCount -= bufferedCount;
+
+            this->readBufferOffset += ( this->readBufferSize + skipCount );
+            this->readBufferSize = 0;
+            this->readBufferPos = 0;
+        }
+
         contextStream->skip( skipCount );
     }
     else
@@ -483,6 +856,11 @@ void BlockProvider::skip( size_t skipCount ) throw( ... )
         throw RwBlockException( "not in a block context" );
     }
 
+    if ( this->blockMode == RWBLOCKMODE_WRITE )
+    {
+        this->verifyStreamedWrite( skipCount );
+    }
+
     // Do the native operation.
     this->skip_native( skipCount );
 
@@ -496,6 +874,61 @@ void BlockProvider::seek_native( int64 pos, eSeekMode mode )
 
     if ( contextStream )
     {
+        if ( this->writeMode != RWBLOCKWRITE_PATCH )
+        {
+            // Forward-only writing can only "seek" to where it already is.
+            int64 curPos = this->writeOffset;
+
+            int64 targetPos = pos;
+
+            if ( mode == RWSEEK_CUR )
+            {
+                targetPos += curPos;
+            }
+
+            if ( mode == RWSEEK_END || targetPos != curPos )
+            {
+                throw RwBlockException( "cannot seek in forward-only block writing" );
+            }
+            return;
+        }
+
+        if ( this->readBuffer )
+        {
+            if ( mode == RWSEEK_BEG || mode == RWSEEK_CUR )
+            {
+                int64 bufferStart = this->readBufferOffset;
+
+                int64 targetPos = pos;
+
+                if ( mode == RWSEEK_CUR )
+                {
+                    targetPos += ( bufferStart + this->readBufferPos );
+                }
+
+                // Seeking inside of the buffered data does not need the stream.
+                if ( targetPos >= bufferStart && targetPos <= bufferStart + (int64)this->readBufferSize )
+                {
+                    this->readBufferPos = (size_t)( targetPos - bufferStart );
+                    return;
+                }
+
+                contextStream->seek( targetPos, RWSEEK_BEG );
+
+                this->readBufferOffset = targetPos;
+                this->readBufferSize = 0;
+                this->readBufferPos = 0;
+                return;
+            }
+
+            this->dropReadBuffer();
+
+            contextStream->seek( pos, mode );
+
+            this->readBufferOffset = contextStream->tell();
+            return;
+        }
+
         contextStream->seek( pos, mode );
     }
     else
@@ -519,6 +952,16 @@ int64 BlockProvider::tell_native( void ) const
 
     if ( contextStream )
     {
+        if ( this->writeMode != RWBLOCKWRITE_PATCH )
+        {
+            return this->writeOffset;
+        }
+
+        if ( this->readBuffer )
+        {
+            return ( this->readBufferOffset + this->readBufferPos );
+        }
+
         return contextStream->tell();
     }
     
@@ -542,7 +985,18 @@ int64 BlockProvider::tell_absolute_native( void ) const
 
     if ( contextStream )
     {
-        returnAbsolutePos = contextStream->tell();
+        if ( this->writeMode != RWBLOCKWRITE_PATCH )
+        {
+            returnAbsolutePos = this->writeOffset;
+        }
+        else if ( this->readBuffer )
+        {
+            returnAbsolutePos = ( this->readBufferOffset + this->readBufferPos );
+        }
+        else
+        {
+            returnAbsolutePos = contextStream->tell();
+        }
     }
     else
     {
@@ -630,6 +1084,11 @@ void BlockProvider::check_read_ahead( size_t readCount ) const
         // Simulate a read access.
         int64 totalStreamOffset = this->tell_absolute();
 
+        if ( this->isReadAccessInBounds( totalStreamOffset, readCount ) )
+        {
+            return;
+        }
+
         // Verify this reading operation.
         streamMemSlice_t readAccess( totalStreamOffset, readCount );
 
@@ -766,4 +1225,29 @@ void BlockProvider::verifyStreamAccess( const streamMemSlice_t& requestedMemory
     }
 }
 
+void BlockProvider::verifyStreamedWrite( size_t writeCount ) const
+{
+    const BlockProvider *rootProvider = this->rootProvider;
+
+    if ( rootProvider->writeMode != RWBLOCKWRITE_STREAM )
+        return;
+
+    // Bytes on a forward-only stream cannot be taken back, so refuse to write anything
+    // that does not fit the header we already wrote.
+    if ( rootProvider->hasWritePlanMismatch )
+    {
+        throw RwBlockException( "streamed serialization did not match its counting pass" );
+    }
+
+    if ( this->isInContext )
+    {
+        const BlockWritePlan::blockHeader& plannedHeader = rootProvider->writePlan->headers[ this->blockContext.write_plan_index ];
+
+        if ( this->blockContext.context_seek + (int64)writeCount > (int64)plannedHeader.chunk_length )
+        {
+            throw RwBlockException( "streamed block is longer than its counting pass" );
+        }
+    }
+}
+
 };
\ No newline at end of file
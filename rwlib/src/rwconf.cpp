@@ -26,11 +26,14 @@ rwConfigBlock::rwConfigBlock( EngineInterface *intf )
     // Prefer the native toolchain.
     this->dxtRuntimeType = DXTRUNTIME_NATIVE;
 
+    this->etcQuality = ETCQUALITY_NORMAL;
+
     this->fixIncompatibleRasters = true;
     this->dxtPackedDecompression = false;
 
     this->compatibilityTransformNativeImaging = false;
     this->preferPackedSampleExport = true;
+    this->tgaRunLengthEncoding = false;
 
     this->ignoreSerializationBlockRegions = false;
 
@@ -66,6 +69,7 @@ rwConfigBlock::rwConfigBlock( const rwConfigBlock& right )
 
     this->palRuntimeType = right.palRuntimeType;
     this->dxtRuntimeType = right.dxtRuntimeType;
+    this->etcQuality = right.etcQuality;
 
     this->warningLevel = right.warningLevel;
     this->ignoreSecureWarnings = right.ignoreSecureWarnings;
@@ -75,6 +79,7 @@ rwConfigBlock::rwConfigBlock( const rwConfigBlock& right )
 
     this->compatibilityTransformNativeImaging = right.compatibilityTransformNativeImaging;
     this->preferPackedSampleExport = right.preferPackedSampleExport;
+    this->tgaRunLengthEncoding = right.tgaRunLengthEncoding;
 
     this->ignoreSerializationBlockRegions = right.ignoreSerializationBlockRegions;
 
@@ -208,6 +213,20 @@ eDXTCompressionMethod rwConfigBlock::GetDXTRuntime( void ) const
     return this->dxtRuntimeType;
 }
 
+void rwConfigBlock::SetETCCompressionQuality( eETCCompressionQuality quality )
+{
+    scoped_rwlock_writer <rwlock> lock( GetConfigLock() );
+
+    this->etcQuality = quality;
+}
+
+eETCCompressionQuality rwConfigBlock::GetETCCompressionQuality( void ) const
+{
+    scoped_rwlock_reader <rwlock> lock( GetConfigLock() );
+
+    return this->etcQuality;
+}
+
 void rwConfigBlock::SetFixIncompatibleRasters( bool enable )
 {
     scoped_rwlock_writer <rwlock> lock( GetConfigLock() );
@@ -264,6 +283,20 @@ bool rwConfigBlock::GetPreferPackedSampleExport( void ) const
     return this->preferPackedSampleExport;
 }
 
+void rwConfigBlock::SetTGARunLengthEncoding( bool enable )
+{
+    scoped_rwlock_writer <rwlock> lock( GetConfigLock() );
+
+    this->tgaRunLengthEncoding = enable;
+}
+
+bool rwConfigBlock::GetTGARunLengthEncoding( void ) const
+{
+    scoped_rwlock_reader <rwlock> lock( GetConfigLock() );
+
+    return this->tgaRunLengthEncoding;
+}
+
 void rwConfigBlock::SetIgnoreSerializationBlockRegions( bool ignore )
 {
     scoped_rwlock_writer <rwlock> lock( GetConfigLock() );
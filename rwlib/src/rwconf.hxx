@@ -40,6 +40,9 @@ struct rwConfigBlock
     void                        SetDXTRuntime( eDXTCompressionMethod method );
     eDXTCompressionMethod       GetDXTRuntime( void ) const;
 
+    void                        SetETCCompressionQuality( eETCCompressionQuality quality );
+    eETCCompressionQuality      GetETCCompressionQuality( void ) const;
+
     void                        SetFixIncompatibleRasters( bool doFix );
     bool                        GetFixIncompatibleRasters( void ) const;
 
@@ -52,6 +55,9 @@ struct rwConfigBlock
     void                        SetPreferPackedSampleExport( bool prefer );
     bool                        GetPreferPackedSampleExport( void ) const;
 
+    void                        SetTGARunLengthEncoding( bool enable );
+    bool                        GetTGARunLengthEncoding( void ) const;
+
     void                        SetIgnoreSerializationBlockRegions( bool doIgnore );
     bool                        GetIgnoreSerializationBlockRegions( void ) const;
 
@@ -66,6 +72,7 @@ private:
 
     ePaletteRuntimeType palRuntimeType;
     eDXTCompressionMethod dxtRuntimeType;
+    eETCCompressionQuality etcQuality;
     
     int warningLevel;
     bool ignoreSecureWarnings;
@@ -75,6 +82,7 @@ private:
 
     bool compatibilityTransformNativeImaging;
     bool preferPackedSampleExport;
+    bool tgaRunLengthEncoding;
 
     bool ignoreSerializationBlockRegions;
 
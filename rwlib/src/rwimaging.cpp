@@ -158,7 +158,7 @@ struct rwImagingEnv
 
     formatList_t registeredFormats;
 
-    inline bool Deserialize( Interface *engineInterface, Stream *inputStream, imagingLayerTraversal& layerOut ) const
+    inline bool Deserialize( Interface *engineInterface, Stream *inputStream, imagingLayerTraversal& layerOut, uint32 maxDimm = 0 ) const
     {
         // Loop through all imaging extensions and check which one identifies with the given stream.
         // For the one that identifies with it, try to deserialize the picture data with it.
@@ -213,7 +213,14 @@ struct rwImagingEnv
 
             // Fetch stuff.
             {
-                supportedExt->DeserializeImage( engineInterface, inputStream, fetchedLayer );
+                if ( maxDimm != 0 )
+                {
+                    supportedExt->DeserializeImageScaled( engineInterface, inputStream, maxDimm, fetchedLayer );
+                }
+                else
+                {
+                    supportedExt->DeserializeImage( engineInterface, inputStream, fetchedLayer );
+                }
             }
             // If an exception has been thrown, we just pass it along.
 
@@ -391,22 +398,20 @@ bool SerializeMipmapLayer( Stream *outputStream, const char *formatDescriptor, c
     return success;
 }
 
-// Those are generic routines for pushing RGBA data to image formats.
-// Most likely those image formats will be supported the most.
-bool DeserializeImage( Stream *inputStream, Bitmap& outputPixels )
+#ifdef RWLIB_INCLUDE_IMAGING
+static bool DeserializeImageBitmap( Stream *inputStream, uint32 maxDimm, Bitmap& outputPixels )
 {
     // If successful, we overwrite outputPixels with the new image data.
 
     bool success = false;
 
-#ifdef RWLIB_INCLUDE_IMAGING
     Interface *engineInterface = inputStream->engineInterface;
 
     if ( const rwImagingEnv *imgEnv = GetImagingEnvironment( engineInterface ) )
     {
         imagingLayerTraversal fetchedLayer;
 
-        bool hasFetchedLayer = imgEnv->Deserialize( engineInterface, inputStream, fetchedLayer );
+        bool hasFetchedLayer = imgEnv->Deserialize( engineInterface, inputStream, fetchedLayer, maxDimm );
 
         if ( hasFetchedLayer )
         {
@@ -549,11 +554,190 @@ bool DeserializeImage( Stream *inputStream, Bitmap& outputPixels )
             success = true;
         }
     }
+
+    return success;
+}
+#endif //RWLIB_INCLUDE_IMAGING
+
+// Those are generic routines for pushing RGBA data to image formats.
+// Most likely those image formats will be supported the most.
+bool DeserializeImage( Stream *inputStream, Bitmap& outputPixels )
+{
+    // If successful, we overwrite outputPixels with the new image data.
+
+    bool success = false;
+
+#ifdef RWLIB_INCLUDE_IMAGING
+    success = DeserializeImageBitmap( inputStream, 0, outputPixels );
 #endif //RWLIB_INCLUDE_IMAGING
 
     return success;
 }
 
+bool DecodeThumbnail( const Raster *raster, uint32 maxDimm, Bitmap& outputPixels )
+{
+    if ( maxDimm == 0 )
+    {
+        throw RwException( "invalid maximum dimension for thumbnail decoding" );
+    }
+
+    // Rasters without texels have nothing to preview.
+    if ( raster->getNativeDataTypeName() == NULL || raster->getMipmapCount() == 0 )
+        return false;
+
+    outputPixels = raster->getThumbnail( maxDimm );
+
+    return true;
+}
+
+// Previews RenderWare objects that carry a texture.
+static bool DecodeRwObjectThumbnail( Stream *inputStream, uint32 maxDimm, Bitmap& outputPixels )
+{
+    Interface *engineInterface = inputStream->engineInterface;
+
+    RwObject *rwObj = engineInterface->Deserialize( inputStream );
+
+    if ( rwObj == NULL )
+        return false;
+
+    bool success = false;
+
+    try
+    {
+        TextureBase *texHandle = NULL;
+
+        if ( TexDictionary *txd = ToTexDictionary( engineInterface, rwObj ) )
+        {
+            // TXDs are represented by their first texture.
+            TexDictionary::texIter_t iter( txd->GetTextureIterator() );
+
+            if ( !iter.IsEnd() )
+            {
+                texHandle = iter.Resolve();
+            }
+        }
+        else
+        {
+            texHandle = ToTexture( engineInterface, rwObj );
+        }
+
+        if ( texHandle != NULL )
+        {
+            if ( Raster *texRaster = texHandle->GetRaster() )
+            {
+                success = DecodeThumbnail( texRaster, maxDimm, outputPixels );
+            }
+        }
+    }
+    catch( ... )
+    {
+        engineInterface->DeleteRwObject( rwObj );
+
+        throw;
+    }
+
+    engineInterface->DeleteRwObject( rwObj );
+
+    return success;
+}
+
+bool DecodeThumbnail( Stream *inputStream, uint32 maxDimm, Bitmap& outputPixels )
+{
+    Interface *engineInterface = inputStream->engineInterface;
+
+    if ( maxDimm == 0 )
+    {
+        throw RwException( "invalid maximum dimension for thumbnail decoding" );
+    }
+
+    const int64 thumbStreamPos = inputStream->tell();
+
+    // Native images (DDS, PVR, ...) usually carry mipmaps, so we go through a raster for them.
+    if ( const char *nativeImageType = GetNativeImageTypeForStream( inputStream ) )
+    {
+        NativeImage *natImg = CreateNativeImage( engineInterface, nativeImageType );
+
+        if ( natImg == NULL )
+            return false;
+
+        Raster *thumbRaster = NULL;
+
+        bool success = false;
+
+        try
+        {
+            natImg->readFromStream( inputStream );
+
+            const char *nativeTexName = natImg->getRecommendedNativeTextureTarget();
+
+            if ( nativeTexName != NULL )
+            {
+                thumbRaster = CreateRaster( engineInterface );
+
+                if ( thumbRaster != NULL )
+                {
+                    thumbRaster->newNativeData( nativeTexName );
+
+                    natImg->putToRaster( thumbRaster );
+
+                    success = DecodeThumbnail( thumbRaster, maxDimm, outputPixels );
+                }
+            }
+        }
+        catch( ... )
+        {
+            if ( thumbRaster )
+            {
+                DeleteRaster( thumbRaster );
+            }
+
+            DeleteNativeImage( natImg );
+
+            throw;
+        }
+
+        if ( thumbRaster )
+        {
+            DeleteRaster( thumbRaster );
+        }
+
+        DeleteNativeImage( natImg );
+
+        return success;
+    }
+
+    bool success = false;
+
+#ifdef RWLIB_INCLUDE_IMAGING
+    Bitmap decodedPixels( engineInterface );
+
+    if ( DeserializeImageBitmap( inputStream, maxDimm, decodedPixels ) )
+    {
+        uint32 thumbWidth, thumbHeight;
+        GetThumbnailDimensions( decodedPixels.getWidth(), decodedPixels.getHeight(), maxDimm, thumbWidth, thumbHeight );
+
+        if ( thumbWidth != decodedPixels.getWidth() || thumbHeight != decodedPixels.getHeight() )
+        {
+            decodedPixels.scale( engineInterface, thumbWidth, thumbHeight );
+        }
+
+        outputPixels = std::move( decodedPixels );
+
+        success = true;
+    }
+#endif //RWLIB_INCLUDE_IMAGING
+
+    if ( !success )
+    {
+        // The imaging formats may have left the stream anywhere.
+        inputStream->seek( thumbStreamPos, RWSEEK_BEG );
+
+        success = DecodeRwObjectThumbnail( inputStream, maxDimm, outputPixels );
+    }
+
+    return success;
+}
+
 bool SerializeImage( Stream *outputStream, const char *formatDescriptor, const Bitmap& inputPixels )
 {
     bool success = false;
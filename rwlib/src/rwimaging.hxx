@@ -37,6 +37,13 @@ struct imagingFormatExtension abstract
     // Pull and fetch methods.
     virtual void DeserializeImage( Interface *engineInterface, Stream *inputStream, imagingLayerTraversal& outputPixels ) const = 0;
     virtual void SerializeImage( Interface *engineInterface, Stream *outputStream, const imagingLayerTraversal& inputPixels ) const = 0;
+
+    // Optional pull method for thumbnails. Formats that can decode at a reduced size cheaply should
+    // return an image whose larger side is close to (but not below) maxDimm; the caller does the final scale.
+    virtual void DeserializeImageScaled( Interface *engineInterface, Stream *inputStream, uint32 maxDimm, imagingLayerTraversal& outputPixels ) const
+    {
+        this->DeserializeImage( engineInterface, inputStream, outputPixels );
+    }
 };
 
 #define IMAGING_COUNT_EXT(x)    ( sizeof(x) / sizeof(*x) )
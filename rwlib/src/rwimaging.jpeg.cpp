@@ -305,7 +305,9 @@ struct jpegImagingExtension : public imagingFormatExtension
         return;
     }
 
-    void DeserializeImage( Interface *engineInterface, Stream *inputStream, imagingLayerTraversal& outputPixels ) const override
+    // Reads a JPEG image. If maxDimm is not zero then libjpeg is asked to decode at the smallest
+    // DCT scale (N/8) that still keeps the larger side at least maxDimm pixels.
+    void DeserializeJPEG( Interface *engineInterface, Stream *inputStream, uint32 maxDimm, imagingLayerTraversal& outputPixels ) const
     {
         // Alright. We should read this thing now.
         jpeg_decompress_struct decompress_info;
@@ -360,6 +362,21 @@ struct jpegImagingExtension : public imagingFormatExtension
                 // Alright, we begin doing the reading.
                 jpeg_read_header( &decompress_info, true );
 
+                if ( maxDimm != 0 )
+                {
+                    uint32 imageMaxDimm = std::max( (uint32)decompress_info.image_width, (uint32)decompress_info.image_height );
+
+                    if ( imageMaxDimm > maxDimm )
+                    {
+                        // Skipping the DCT coefficients we do not need is way cheaper than decoding everything.
+                        uint32 scaleNum = (uint32)( ( (uint64)maxDimm * 8 + imageMaxDimm - 1 ) / imageMaxDimm );
+
+                        decompress_info.scale_num = std::max( 1u, scaleNum );
+                        decompress_info.scale_denom = 8;
+                        decompress_info.dct_method = JDCT_IFAST;
+                    }
+                }
+
                 jpeg_start_decompress( &decompress_info );
 
                 uint32 width = decompress_info.output_width;
@@ -498,6 +515,16 @@ struct jpegImagingExtension : public imagingFormatExtension
         jpeg_destroy_decompress( &decompress_info );
     }
 
+    void DeserializeImage( Interface *engineInterface, Stream *inputStream, imagingLayerTraversal& outputPixels ) const override
+    {
+        DeserializeJPEG( engineInterface, inputStream, 0, outputPixels );
+    }
+
+    void DeserializeImageScaled( Interface *engineInterface, Stream *inputStream, uint32 maxDimm, imagingLayerTraversal& outputPixels ) const override
+    {
+        DeserializeJPEG( engineInterface, inputStream, maxDimm, outputPixels );
+    }
+
     struct stream_destination_manager : public jpeg_destination_mgr
     {
         Interface *engineInterface;
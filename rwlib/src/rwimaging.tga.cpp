@@ -1,5 +1,7 @@
 #include "StdInc.h"
 
+#include <cstring>
+
 #include "rwimaging.hxx"
 
 #include <PluginHelpers.h>
@@ -55,13 +57,320 @@ inline uint32 getTGARasterDataRowSize( uint32 width, uint32 depth )
     return getRasterDataRowSize( width, depth, getTGATexelDataRowAlignment() );
 }
 
+// TGA run-length packets: the high bit of the header marks a run of one repeated pixel,
+// otherwise a raw packet follows. The low seven bits store the pixel count minus one.
+#define TGA_RLE_RUN_PACKET      0x80
+#define TGA_RLE_MAX_PACKET      128
+
+// Buffered packet reader, so that we do not go through the stream for every packet.
+struct tgaRLEReadBuffer
+{
+    static const size_t BUFFER_SIZE = 16384;
+
+    inline tgaRLEReadBuffer( Stream *stream )
+    {
+        this->stream = stream;
+        this->readPos = 0;
+        this->available = 0;
+    }
+
+    inline const uint8* fetch( size_t count )
+    {
+        if ( this->available - this->readPos < count )
+        {
+            size_t remaining = ( this->available - this->readPos );
+
+            memmove( this->buffer, this->buffer + this->readPos, remaining );
+
+            size_t readCount = this->stream->read( this->buffer + remaining, BUFFER_SIZE - remaining );
+
+            this->readPos = 0;
+            this->available = ( remaining + readCount );
+
+            if ( this->available < count )
+            {
+                throw RwException( "unexpected end of .tga RLE image data" );
+            }
+        }
+
+        const uint8 *data = ( this->buffer + this->readPos );
+
+        this->readPos += count;
+
+        return data;
+    }
+
+    // Gives back the bytes that we have read ahead.
+    inline void finish( void )
+    {
+        size_t unusedCount = ( this->available - this->readPos );
+
+        if ( unusedCount != 0 )
+        {
+            this->stream->skip( -(int64)unusedCount );
+        }
+
+        this->readPos = 0;
+        this->available = 0;
+    }
+
+private:
+    Stream *stream;
+    size_t readPos;
+    size_t available;
+    uint8 buffer[ BUFFER_SIZE ];
+};
+
+// Fills runLength pixels with the same value. Runs are seeded with one pixel and then
+// doubled, so that the bulk is moved by wide memcpy instead of pixel by pixel.
+inline void expandTGAPixelRun( uint8 *dstPtr, const uint8 *pixel, uint32 pixelSize, uint32 runLength )
+{
+    if ( pixelSize == 1 )
+    {
+        memset( dstPtr, *pixel, runLength );
+        return;
+    }
+
+    size_t runSize = ( (size_t)runLength * pixelSize );
+
+    memcpy( dstPtr, pixel, pixelSize );
+
+    size_t filledSize = pixelSize;
+
+    while ( filledSize < runSize )
+    {
+        size_t copySize = std::min( filledSize, runSize - filledSize );
+
+        memcpy( dstPtr + filledSize, dstPtr, copySize );
+
+        filledSize += copySize;
+    }
+}
+
+// Expands RLE packets directly into the texel buffer. Packets may cross rows (older writers do that),
+// so we split them at row boundaries and place each row according to the image orientation.
+static void decodeTGARunLengthPixels(
+    Stream *inputStream, void *texelData, uint32 rowSize,
+    uint32 width, uint32 height, uint32 pixelSize, bool flip_vertical
+)
+{
+    tgaRLEReadBuffer readBuf( inputStream );
+
+    uint32 srcRow = 0;
+    uint32 srcCol = 0;
+
+    while ( srcRow < height )
+    {
+        uint8 packetHeader = *readBuf.fetch( 1 );
+
+        bool isRunPacket = ( packetHeader & TGA_RLE_RUN_PACKET ) != 0;
+
+        uint32 packetPixels = ( packetHeader & ~TGA_RLE_RUN_PACKET ) + 1;
+
+        const uint8 *srcPixels = readBuf.fetch( isRunPacket ? pixelSize : ( packetPixels * pixelSize ) );
+
+        while ( packetPixels != 0 && srcRow < height )
+        {
+            uint32 dstRow = ( flip_vertical ? ( height - srcRow - 1 ) : srcRow );
+
+            uint8 *dstPtr = (uint8*)getTexelDataRow( texelData, rowSize, dstRow ) + (size_t)srcCol * pixelSize;
+
+            uint32 spanPixels = std::min( packetPixels, width - srcCol );
+
+            if ( isRunPacket )
+            {
+                expandTGAPixelRun( dstPtr, srcPixels, pixelSize, spanPixels );
+            }
+            else
+            {
+                memcpy( dstPtr, srcPixels, (size_t)spanPixels * pixelSize );
+
+                srcPixels += (size_t)spanPixels * pixelSize;
+            }
+
+            packetPixels -= spanPixels;
+            srcCol += spanPixels;
+
+            if ( srcCol == width )
+            {
+                srcRow++;
+                srcCol = 0;
+            }
+        }
+    }
+
+    readBuf.finish();
+}
+
+// Reverses the pixel order of every row, for right-to-left TGA images.
+static void mirrorTGAPixelRows( void *texelData, uint32 rowSize, uint32 width, uint32 height, uint32 pixelSize )
+{
+    if ( width < 2 )
+        return;
+
+    for ( uint32 row = 0; row < height; row++ )
+    {
+        uint8 *leftPixel = (uint8*)getTexelDataRow( texelData, rowSize, row );
+        uint8 *rightPixel = ( leftPixel + (size_t)( width - 1 ) * pixelSize );
+
+        while ( leftPixel < rightPixel )
+        {
+            for ( uint32 n = 0; n < pixelSize; n++ )
+            {
+                std::swap( leftPixel[ n ], rightPixel[ n ] );
+            }
+
+            leftPixel += pixelSize;
+            rightPixel -= pixelSize;
+        }
+    }
+}
+
+template <uint32 pixelSize>
+inline bool isSameTGAPixel( const uint8 *left, const uint8 *right )
+{
+    return ( memcmp( left, right, pixelSize ) == 0 );
+}
+
+// Encodes one row into RLE packets. Packets never cross rows, as the TGA 2.0 specification asks for.
+// Returns the pointer behind the written packets.
+template <uint32 pixelSize>
+static uint8* encodeTGARunLengthRow( const uint8 *srcRow, uint32 width, uint8 *dstPtr )
+{
+    uint32 col = 0;
+
+    while ( col < width )
+    {
+        const uint8 *curPixel = ( srcRow + (size_t)col * pixelSize );
+
+        // Measure how often the current pixel repeats.
+        uint32 runLength = 1;
+
+        while ( col + runLength < width && runLength < TGA_RLE_MAX_PACKET &&
+                isSameTGAPixel <pixelSize> ( curPixel, curPixel + (size_t)runLength * pixelSize ) )
+        {
+            runLength++;
+        }
+
+        if ( runLength > 1 )
+        {
+            *dstPtr++ = (uint8)( TGA_RLE_RUN_PACKET | ( runLength - 1 ) );
+
+            memcpy( dstPtr, curPixel, pixelSize );
+            dstPtr += pixelSize;
+
+            col += runLength;
+        }
+        else
+        {
+            // Collect pixels until the next run starts.
+            uint32 rawLength = 0;
+
+            while ( col < width && rawLength < TGA_RLE_MAX_PACKET )
+            {
+                const uint8 *rawPixel = ( srcRow + (size_t)col * pixelSize );
+
+                if ( col + 1 < width && isSameTGAPixel <pixelSize> ( rawPixel, rawPixel + pixelSize ) )
+                    break;
+
+                col++;
+                rawLength++;
+            }
+
+            *dstPtr++ = (uint8)( rawLength - 1 );
+
+            memcpy( dstPtr, curPixel, (size_t)rawLength * pixelSize );
+            dstPtr += (size_t)rawLength * pixelSize;
+        }
+    }
+
+    return dstPtr;
+}
+
+template <uint32 pixelSize>
+static size_t encodeTGARunLengthPixels( const void *texelSource, uint32 rowSize, uint32 width, uint32 height, void *dstBuf )
+{
+    uint8 *dstPtr = (uint8*)dstBuf;
+
+    for ( uint32 row = 0; row < height; row++ )
+    {
+        const uint8 *srcRow = (const uint8*)getConstTexelDataRow( texelSource, rowSize, row );
+
+        dstPtr = encodeTGARunLengthRow <pixelSize> ( srcRow, width, dstPtr );
+    }
+
+    return ( dstPtr - (uint8*)dstBuf );
+}
+
+// Writes packed TGA texel rows, run-length encoded if requested.
+static void writeTGATexelData(
+    Interface *engineInterface, Stream *tgaStream,
+    const void *texelSource, uint32 rowSize, uint32 width, uint32 height, uint32 itemDepth,
+    bool runLengthEncode
+)
+{
+    if ( !runLengthEncode )
+    {
+        tgaStream->write( texelSource, getRasterDataSizeByRowSize( rowSize, height ) );
+        return;
+    }
+
+    uint32 pixelSize = ( itemDepth / 8 );
+
+    // Every packet holds at least one pixel, so worst case is one header byte per pixel.
+    size_t maxEncodedSize = ( (size_t)width * ( pixelSize + 1 ) ) * height;
+
+    void *encodedData = engineInterface->PixelAllocate( maxEncodedSize );
+
+    if ( encodedData == NULL )
+    {
+        throw RwException( "failed to allocate .tga RLE encoding buffer" );
+    }
+
+    try
+    {
+        size_t encodedSize = 0;
+
+        if ( pixelSize == 1 )
+        {
+            encodedSize = encodeTGARunLengthPixels <1> ( texelSource, rowSize, width, height, encodedData );
+        }
+        else if ( pixelSize == 2 )
+        {
+            encodedSize = encodeTGARunLengthPixels <2> ( texelSource, rowSize, width, height, encodedData );
+        }
+        else if ( pixelSize == 3 )
+        {
+            encodedSize = encodeTGARunLengthPixels <3> ( texelSource, rowSize, width, height, encodedData );
+        }
+        else if ( pixelSize == 4 )
+        {
+            encodedSize = encodeTGARunLengthPixels <4> ( texelSource, rowSize, width, height, encodedData );
+        }
+        else
+        {
+            throw RwException( "unsupported item depth for .tga RLE encoding" );
+        }
+
+        tgaStream->write( encodedData, encodedSize );
+    }
+    catch( ... )
+    {
+        engineInterface->PixelFree( encodedData );
+
+        throw;
+    }
+
+    engineInterface->PixelFree( encodedData );
+}
+
 static void writeTGAPixels(
     Interface *engineInterface,
     const void *texelSource, uint32 texWidth, uint32 texHeight,
     eRasterFormat srcRasterFormat, uint32 srcItemDepth, uint32 srcRowAlignment, ePaletteType srcPaletteType, const void *srcPaletteData, uint32 srcMaxPalette,
     eRasterFormat dstRasterFormat, uint32 dstItemDepth, uint32 dstRowAlignment,
     eColorOrdering srcColorOrder, eColorOrdering tgaColorOrder,
-    Stream *tgaStream
+    Stream *tgaStream, bool runLengthEncode
 )
 {
     // Get the row size of the source colors.
@@ -105,7 +414,7 @@ static void writeTGAPixels(
             );
 
             // Write the entire buffer at once.
-            tgaStream->write((const void*)tgaColors, texelDataSize);
+            writeTGATexelData( engineInterface, tgaStream, tgaColors, tgaRowSize, texWidth, texHeight, dstItemDepth, runLengthEncode );
         }
         catch( ... )
         {
@@ -121,9 +430,7 @@ static void writeTGAPixels(
     else
     {
         // Simply write the color source.
-        uint32 texelDataSize = getRasterDataSizeByRowSize( srcRowSize, texHeight );
-
-        tgaStream->write((const void*)texelSource, texelDataSize);
+        writeTGATexelData( engineInterface, tgaStream, texelSource, srcRowSize, texWidth, texHeight, srcItemDepth, runLengthEncode );
     }
 }
 
@@ -251,11 +558,15 @@ struct tgaImagingExtension : public imagingFormatExtension
         }
 
         // Now read the image data.
-        uint32 tgaRowSize = getRasterDataRowSize( possibleHeader.Width, possibleHeader.PixelDepth, getTGATexelDataRowAlignment() );
+        // RLE image data has no fixed size, so the deserializer has to verify it.
+        if ( ( possibleHeader.ImageType & 0x08 ) == 0 )
+        {
+            uint32 tgaRowSize = getRasterDataRowSize( possibleHeader.Width, possibleHeader.PixelDepth, getTGATexelDataRowAlignment() );
 
-        uint32 colorDataSize = getRasterDataSizeByRowSize( tgaRowSize, possibleHeader.Height );
+            uint32 colorDataSize = getRasterDataSizeByRowSize( tgaRowSize, possibleHeader.Height );
 
-        skipAvailable( inputStream, colorDataSize );
+            skipAvailable( inputStream, colorDataSize );
+        }
 
         return true;
     }
@@ -304,7 +615,14 @@ struct tgaImagingExtension : public imagingFormatExtension
         bool hasPalette = ( headerData.ColorMapType == 1 );
         bool requiresPalette = false;
 
-        if ( headerData.ImageType == 1 ) // with palette.
+        // Image types 9, 10 and 11 are the run-length encoded versions of 1, 2 and 3.
+        uint8 imageType = headerData.ImageType;
+
+        bool isRunLengthEncoded = ( imageType & 0x08 ) != 0;
+
+        imageType &= ~0x08;
+
+        if ( imageType == 1 ) // with palette.
         {
             if ( hasPalette == false )
             {
@@ -343,7 +661,7 @@ struct tgaImagingExtension : public imagingFormatExtension
 
             requiresPalette = true;
         }
-        else if ( headerData.ImageType == 2 ) // without palette, raw colors.
+        else if ( imageType == 2 ) // without palette, raw colors.
         {
             hasRasterFormat = getTGARasterFormat( headerData.PixelDepth, headerData.ImageDescriptor.numAttrBits, dstRasterFormat, dstDepth );
 
@@ -352,7 +670,7 @@ struct tgaImagingExtension : public imagingFormatExtension
                 dstItemDepth = dstDepth;
             }
         }
-        else if ( headerData.ImageType == 3 ) // grayscale.
+        else if ( imageType == 3 ) // grayscale.
         {
             if ( headerData.ImageDescriptor.numAttrBits == 0 )
             {
@@ -371,7 +689,7 @@ struct tgaImagingExtension : public imagingFormatExtension
                 hasRasterFormat = true;
             }
         }
-        else // TODO: add RLE support.
+        else
         {
             throw RwException( "unknown TGA image type" );
         }
@@ -380,6 +698,11 @@ struct tgaImagingExtension : public imagingFormatExtension
         {
             throw RwException( "unknown raster format mapping for .tga" );
         }
+
+        if ( isRunLengthEncoded && ( dstItemDepth % 8 ) != 0 )
+        {
+            throw RwException( "unsupported item depth for RLE .tga" );
+        }
         
         // Make sure we set proper orientation.
         eTGAOrientation tgaOrient = TGAORIENT_TOPLEFT;
@@ -494,7 +817,10 @@ struct tgaImagingExtension : public imagingFormatExtension
 
             uint32 rasterDataSize = getRasterDataSizeByRowSize( tgaRowSize, height );
 
-            checkAhead( inputStream, rasterDataSize );
+            if ( !isRunLengthEncoded )
+            {
+                checkAhead( inputStream, rasterDataSize );
+            }
 
             void *texelData = engineInterface->PixelAllocate( rasterDataSize );
 
@@ -505,7 +831,19 @@ struct tgaImagingExtension : public imagingFormatExtension
 
             try
             {
-                if ( canDirectlyAcquire )
+                if ( isRunLengthEncoded )
+                {
+                    // Packets are expanded straight into the texel buffer.
+                    uint32 pixelSize = ( dstItemDepth / 8 );
+
+                    decodeTGARunLengthPixels( inputStream, texelData, tgaRowSize, width, height, pixelSize, flip_vertical );
+
+                    if ( flip_horizontal )
+                    {
+                        mirrorTGAPixelRows( texelData, tgaRowSize, width, height, pixelSize );
+                    }
+                }
+                else if ( canDirectlyAcquire )
                 {
                     size_t rasterReadCount = inputStream->read( texelData, rasterDataSize );
 
@@ -682,6 +1020,8 @@ struct tgaImagingExtension : public imagingFormatExtension
         // TODO: make this an Interface property.
         const bool optimized = true;
 
+        const bool runLengthEncode = engineInterface->GetTGARunLengthEncoding();
+
         // Decide how to write the raster.
         eRasterFormat srcRasterFormat = inputTexels.rasterFormat;
         ePaletteType srcPaletteType = inputTexels.paletteType;
@@ -813,6 +1153,13 @@ struct tgaImagingExtension : public imagingFormatExtension
                 }
             }
 
+            // Run-length encoded image types are offset by 8.
+            // The item depth is always a multiple of 8 at this point, so every layout can be encoded.
+            if ( runLengthEncode )
+            {
+                imgType |= 0x08;
+            }
+
             // We want to write information about this software in the image id field.
             std::string _software_info = GetRunningSoftwareInformation( (EngineInterface*)engineInterface );
 
@@ -878,7 +1225,7 @@ struct tgaImagingExtension : public imagingFormatExtension
                     srcRasterFormat, pixelDepth, getPaletteRowAlignment(), PALETTE_NONE, NULL, 0,
                     dstRasterFormat, pixelDepth, getPaletteRowAlignment(),
                     colorOrder, COLOR_BGRA,
-                    outputStream
+                    outputStream, false
                 );
             }
 
@@ -910,7 +1257,7 @@ struct tgaImagingExtension : public imagingFormatExtension
                         srcRowAlignment, dstRowAlignment
                     );
 
-                    outputStream->write((const void*)fixedPalItems, texelDataSize);
+                    writeTGATexelData( engineInterface, outputStream, fixedPalItems, texelRowSize, width, height, dstItemDepth, runLengthEncode );
                 }
                 catch( ... )
                 {
@@ -931,7 +1278,7 @@ struct tgaImagingExtension : public imagingFormatExtension
                     srcRasterFormat, srcItemDepth, srcRowAlignment, srcPaletteType, paletteData, maxpalette,
                     dstRasterFormat, dstColorDepth, dstRowAlignment,
                     colorOrder, COLOR_BGRA,
-                    outputStream
+                    outputStream, runLengthEncode
                 );
             }
         }
@@ -6,6 +6,11 @@
 
 #include "pixelformat.hxx"
 
+#include "rwthreading.parallel.hxx"
+
+#include <cstring>
+#include <vector>
+
 #ifdef RWLIB_INCLUDE_TIFF_IMAGING
 
 #include <tiff.h>
@@ -368,6 +373,168 @@ struct tiffImagingExtension : public imagingFormatExtension
         return;
     }
 
+    // In-memory TIFF I/O. Decoding threads share one loaded file with a cursor each,
+    // and strip encoders write into a private buffer that we pick the encoded strips from.
+    struct tiff_memory_io_struct : public tiff_io_struct
+    {
+        inline tiff_memory_io_struct( Interface *engineInterface, const void *readData = NULL, size_t readSize = 0 )
+        {
+            this->engineInterface = engineInterface;
+            this->ioStream = NULL;
+            this->readData = (const uint8*)readData;
+            this->readSize = readSize;
+            this->seekPos = 0;
+        }
+
+        inline size_t GetDataSize( void ) const
+        {
+            return ( this->readData ? this->readSize : this->writeData.size() );
+        }
+
+        const uint8 *readData;
+        size_t readSize;
+
+        std::vector <uint8> writeData;
+
+        size_t seekPos;
+    };
+
+    static tmsize_t TIFFMemoryReadProc( thandle_t ioptr, void *outbuf, tmsize_t count )
+    {
+        tiff_memory_io_struct *io_struct = (tiff_memory_io_struct*)ioptr;
+
+        size_t dataSize = io_struct->GetDataSize();
+        size_t seekPos = io_struct->seekPos;
+
+        if ( seekPos >= dataSize || count <= 0 )
+        {
+            return 0;
+        }
+
+        size_t readCount = std::min( (size_t)count, dataSize - seekPos );
+
+        const uint8 *srcData = ( io_struct->readData ? io_struct->readData : io_struct->writeData.data() );
+
+        memcpy( outbuf, srcData + seekPos, readCount );
+
+        io_struct->seekPos = ( seekPos + readCount );
+
+        return (tmsize_t)readCount;
+    }
+
+    static tmsize_t TIFFMemoryWriteProc( thandle_t ioptr, void *const_buf, tmsize_t writeCount )
+    {
+        tiff_memory_io_struct *io_struct = (tiff_memory_io_struct*)ioptr;
+
+        if ( io_struct->readData || writeCount < 0 )
+        {
+            return 0;
+        }
+
+        size_t seekPos = io_struct->seekPos;
+        size_t endPos = ( seekPos + (size_t)writeCount );
+
+        if ( endPos > io_struct->writeData.size() )
+        {
+            io_struct->writeData.resize( endPos );
+        }
+
+        memcpy( io_struct->writeData.data() + seekPos, const_buf, (size_t)writeCount );
+
+        io_struct->seekPos = endPos;
+
+        return writeCount;
+    }
+
+    static toff_t TIFFMemorySeekProc( thandle_t ioptr, toff_t seekptr, int mode )
+    {
+        tiff_memory_io_struct *io_struct = (tiff_memory_io_struct*)ioptr;
+
+        int64 basePos = 0;
+
+        if ( mode == SEEK_SET )
+        {
+            basePos = 0;
+        }
+        else if ( mode == SEEK_CUR )
+        {
+            basePos = (int64)io_struct->seekPos;
+        }
+        else if ( mode == SEEK_END )
+        {
+            basePos = (int64)io_struct->GetDataSize();
+        }
+        else
+        {
+            throw RwException( "invalid TIFF seek mode" );
+        }
+
+        // Seek offsets are unsigned, but relative seeks are passed in two's complement.
+        int64 newPos = ( basePos + (int64)seekptr );
+
+        if ( newPos < 0 )
+        {
+            throw RwException( "TIFF seek before the beginning of the image data" );
+        }
+
+        io_struct->seekPos = (size_t)newPos;
+
+        return (toff_t)newPos;
+    }
+
+    static toff_t TIFFMemorySizeProc( thandle_t ioptr )
+    {
+        tiff_memory_io_struct *io_struct = (tiff_memory_io_struct*)ioptr;
+
+        return io_struct->GetDataSize();
+    }
+
+    static int TIFFMemoryMapFileProc( thandle_t ioptr, void **base, toff_t *size )
+    {
+        tiff_memory_io_struct *io_struct = (tiff_memory_io_struct*)ioptr;
+
+        // Loaded files can be mapped, so libtiff decodes strips without copying them first.
+        if ( const uint8 *readData = io_struct->readData )
+        {
+            *base = (void*)readData;
+            *size = io_struct->readSize;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    static TIFF* OpenMemoryTIFF( tiff_memory_io_struct& io_struct, const char *name, const char *mode )
+    {
+        TIFF *tif = TIFFClientOpen(
+            name, mode, &io_struct,
+            TIFFMemoryReadProc, TIFFMemoryWriteProc, TIFFMemorySeekProc, TIFFCloseProc, TIFFMemorySizeProc,
+            TIFFMemoryMapFileProc, TIFFUnmapFileProc
+        );
+
+        if ( tif == NULL )
+        {
+            throw RwException( "failed to establish TIFF memory I/O link" );
+        }
+
+        return tif;
+    }
+
+    // Splits a number of independent strips or tiles into one contiguous range per thread.
+    // Every range gets its own libtiff handle, because those are not thread-safe.
+    static inline uint32 GetTIFFChunkCount( uint32 itemCount )
+    {
+        uint32 threadCount = std::max( 1u, std::thread::hardware_concurrency() );
+
+        return std::max( 1u, std::min( threadCount, itemCount ) );
+    }
+
+    static inline void GetTIFFChunkRange( uint32 itemCount, uint32 chunkCount, size_t chunkIndex, uint32& firstOut, uint32& endOut )
+    {
+        firstOut = (uint32)( (uint64)itemCount * chunkIndex / chunkCount );
+        endOut = (uint32)( (uint64)itemCount * ( chunkIndex + 1 ) / chunkCount );
+    }
+
     inline static std::string va_to_string( const char *fmt, va_list argPtr )
     {
         int reqBufCount = _vsnprintf( NULL, 0, fmt, argPtr );
@@ -563,26 +730,290 @@ struct tiffImagingExtension : public imagingFormatExtension
         return hasRead;
     }
 
+    // Everything that is required to turn decoded TIFF rows into destination texels.
+    struct tiff_band_decode_params
+    {
+        uint32 image_width;
+        uint32 image_length;
+
+        // A band is either a strip or a row of tiles.
+        bool isTiled;
+        uint32 tile_width;
+        uint32 bandRowCount;
+
+        tmsize_t scanline_size;
+        bool canTexelsDirectlyAcquire;
+
+        eTIFF_ParseMode parseMode;
+        uint16 photometric_type;
+        uint16 bits_per_sample;
+        bool has_alpha_channel;
+
+        void *dstTexels;
+        uint32 dstRowSize;
+        eRasterFormat dstRasterFormat;
+        uint32 dstDepth;
+        eColorOrdering dstColorOrder;
+        ePaletteType dstPaletteType;
+        uint32 dstPaletteSize;
+    };
+
+    static void convertTIFFScanline( const tiff_band_decode_params& params, const colorModelDispatcher& putDispatch, const void *srcRowData, void *dstRowData )
+    {
+        uint32 image_width = params.image_width;
+        eTIFF_ParseMode parseMode = params.parseMode;
+
+        for ( uint32 col = 0; col < image_width; col++ )
+        {
+            if ( parseMode == TPARSEMODE_GRAYSCALE )
+            {
+                uint8 lum, alpha;
+
+                bool hasColor = read_tiff_grayscale( srcRowData, col, params.photometric_type, params.bits_per_sample, params.has_alpha_channel, lum, alpha );
+
+                if ( !hasColor )
+                {
+                    lum = 0;
+                    alpha = 0;
+                }
+
+                putDispatch.setLuminance( dstRowData, col, lum, alpha );
+            }
+            else if ( parseMode == TPARSEMODE_FULLCOLOR )
+            {
+                uint8 r, g, b, a;
+
+                bool hasColor = read_tiff_color( srcRowData, col, params.photometric_type, params.bits_per_sample, params.has_alpha_channel, r, g, b, a );
+
+                if ( !hasColor )
+                {
+                    r = 0;
+                    g = 0;
+                    b = 0;
+                    a = 0;
+                }
+
+                putDispatch.setRGBA( dstRowData, col, r, g, b, a );
+            }
+            else if ( parseMode == TPARSEMODE_PALETTE )
+            {
+                // Simple palette item copy.
+                copyPaletteItemGeneric(
+                    srcRowData, dstRowData,
+                    col, params.bits_per_sample, params.dstPaletteType,
+                    col, params.dstDepth, params.dstPaletteType,
+                    params.dstPaletteSize
+                );
+            }
+            else
+            {
+                assert( 0 );
+            }
+        }
+    }
+
+    // Decodes the bands [firstBand, endBand) with the given libtiff handle.
+    static void decodeTIFFBands( Interface *engineInterface, TIFF *tif, const tiff_band_decode_params& params, uint32 firstBand, uint32 endBand )
+    {
+        uint32 image_width = params.image_width;
+        uint32 image_length = params.image_length;
+        uint32 bandRowCount = params.bandRowCount;
+        tmsize_t scanline_size = params.scanline_size;
+
+        void *dstTexels = params.dstTexels;
+        uint32 dstRowSize = params.dstRowSize;
+
+        // Strips that need no transformation are decoded straight into the destination rows.
+        bool decodeIntoDestination = ( params.canTexelsDirectlyAcquire && !params.isTiled );
+
+        void *bandBuf = NULL;
+        void *tileBuf = NULL;
+
+        tmsize_t tile_size = 0;
+        tmsize_t tile_row_size = 0;
+
+        try
+        {
+            if ( !decodeIntoDestination )
+            {
+                bandBuf = engineInterface->PixelAllocate( (size_t)scanline_size * bandRowCount );
+
+                if ( bandBuf == NULL )
+                {
+                    throw RwException( "failed to allocate band buffer for TIFF deserialization" );
+                }
+            }
+
+            if ( params.isTiled )
+            {
+                tile_size = TIFFTileSize( tif );
+                tile_row_size = TIFFTileRowSize( tif );
+
+                if ( tile_size == 0 || tile_row_size == 0 )
+                {
+                    throw RwException( "cannot read TIFF whose tile size is zero" );
+                }
+
+                tileBuf = engineInterface->PixelAllocate( (size_t)tile_size );
+
+                if ( tileBuf == NULL )
+                {
+                    throw RwException( "failed to allocate tile buffer for TIFF deserialization" );
+                }
+            }
+
+            colorModelDispatcher putDispatch( params.dstRasterFormat, params.dstColorOrder, params.dstDepth, NULL, 0, PALETTE_NONE );
+
+            for ( uint32 band = firstBand; band < endBand; band++ )
+            {
+                uint32 firstRow = ( band * bandRowCount );
+                uint32 rowCount = std::min( bandRowCount, image_length - firstRow );
+
+                tmsize_t bandDataSize = ( scanline_size * rowCount );
+
+                if ( decodeIntoDestination )
+                {
+                    void *dstBandData = getTexelDataRow( dstTexels, dstRowSize, firstRow );
+
+                    if ( TIFFReadEncodedStrip( tif, band, dstBandData, bandDataSize ) < 0 )
+                    {
+                        throw RwException( "failed to directly read TIFF strip data" );
+                    }
+
+                    continue;
+                }
+
+                if ( params.isTiled )
+                {
+                    // Put the tiles of this band next to each other, so that we get full rows.
+                    uint32 tile_width = params.tile_width;
+
+                    uint32 tilesAcross = ( ( image_width + tile_width - 1 ) / tile_width );
+
+                    for ( uint32 tileX = 0; tileX < tilesAcross; tileX++ )
+                    {
+                        uint32 tileIndex = TIFFComputeTile( tif, tileX * tile_width, firstRow, 0, 0 );
+
+                        if ( TIFFReadEncodedTile( tif, tileIndex, tileBuf, tile_size ) < 0 )
+                        {
+                            throw RwException( "failed to read TIFF tile" );
+                        }
+
+                        // Tile widths are multiples of 16, so tiles always start at a byte boundary.
+                        tmsize_t rowOffset = ( tile_row_size * tileX );
+                        tmsize_t copySize = std::min( tile_row_size, scanline_size - rowOffset );
+
+                        for ( uint32 row = 0; row < rowCount; row++ )
+                        {
+                            memcpy(
+                                (uint8*)bandBuf + (size_t)scanline_size * row + rowOffset,
+                                (const uint8*)tileBuf + (size_t)tile_row_size * row,
+                                (size_t)copySize
+                            );
+                        }
+                    }
+                }
+                else
+                {
+                    if ( TIFFReadEncodedStrip( tif, band, bandBuf, bandDataSize ) < 0 )
+                    {
+                        throw RwException( "failed to read TIFF strip" );
+                    }
+                }
+
+                // Transform the rows into the destination buffer.
+                for ( uint32 row = 0; row < rowCount; row++ )
+                {
+                    const void *srcRowData = getConstTexelDataRow( bandBuf, (uint32)scanline_size, row );
+                    void *dstRowData = getTexelDataRow( dstTexels, dstRowSize, firstRow + row );
+
+                    if ( params.canTexelsDirectlyAcquire )
+                    {
+                        memcpy( dstRowData, srcRowData, (size_t)scanline_size );
+                    }
+                    else
+                    {
+                        convertTIFFScanline( params, putDispatch, srcRowData, dstRowData );
+                    }
+                }
+            }
+        }
+        catch( ... )
+        {
+            if ( bandBuf )
+            {
+                engineInterface->PixelFree( bandBuf );
+            }
+
+            if ( tileBuf )
+            {
+                engineInterface->PixelFree( tileBuf );
+            }
+
+            throw;
+        }
+
+        if ( bandBuf )
+        {
+            engineInterface->PixelFree( bandBuf );
+        }
+
+        if ( tileBuf )
+        {
+            engineInterface->PixelFree( tileBuf );
+        }
+    }
+
     void DeserializeImage( Interface *engineInterface, Stream *inputStream, imagingLayerTraversal& outputPixels ) const override
     {
-        // Since the TIFF format is very complicated, I cannot guarrantee that we can read all of them.
+        // We load the whole file into memory, so that strips and tiles can be decoded in parallel.
+        int64 tiffStartPos = inputStream->tell();
+        int64 tiffStreamSize = ( inputStream->size() - tiffStartPos );
 
-        // Let's use our libtiff library to read us out!
-        tiff_io_struct io_struct;
-        io_struct.engineInterface = engineInterface;
-        io_struct.ioStream = inputStream;
+        if ( tiffStreamSize <= 0 || (uint64)tiffStreamSize > (uint64)std::numeric_limits <size_t>::max() )
+        {
+            throw RwException( "invalid TIFF stream size" );
+        }
 
-        TIFF *tif = TIFFClientOpen(
-            "RwTIFFStreamLink_input", "r", &io_struct,
-            TIFFReadProc, TIFFWriteProc, TIFFSeekProc, TIFFCloseProc, TIFFSizeProc,
-            TIFFMapFileProc, TIFFUnmapFileProc
-        );
+        size_t tiffDataSize = (size_t)tiffStreamSize;
 
-        if ( tif == NULL )
+        void *tiffData = engineInterface->MemAllocate( tiffDataSize );
+
+        if ( tiffData == NULL )
+        {
+            throw RwException( "failed to allocate TIFF file buffer" );
+        }
+
+        try
         {
-            throw RwException( "failed to establish TIFF I/O stream" );
+            size_t readCount = inputStream->read( tiffData, tiffDataSize );
+
+            if ( readCount != tiffDataSize )
+            {
+                throw RwException( "failed to read TIFF file data" );
+            }
+
+            DeserializeTIFF( engineInterface, tiffData, tiffDataSize, outputPixels );
+        }
+        catch( ... )
+        {
+            engineInterface->MemFree( tiffData );
+
+            throw;
         }
 
+        engineInterface->MemFree( tiffData );
+    }
+
+    void DeserializeTIFF( Interface *engineInterface, const void *tiffData, size_t tiffDataSize, imagingLayerTraversal& outputPixels ) const
+    {
+        // Since the TIFF format is very complicated, I cannot guarrantee that we can read all of them.
+
+        // Let's use our libtiff library to read us out!
+        tiff_memory_io_struct io_struct( engineInterface, tiffData, tiffDataSize );
+
+        TIFF *tif = OpenMemoryTIFF( io_struct, "RwTIFFStreamLink_input", "r" );
+
         try
         {
             // Obtain TIFF tags.
@@ -597,6 +1028,7 @@ struct tiffImagingExtension : public imagingFormatExtension
             uint16 num_extra_samples; uint16 *extra_sample_types;
             uint16 sample_count;
             uint16 orientation;
+            uint16 planar_config;
 
             // Get TIFF properties.
             {
@@ -667,6 +1099,13 @@ struct tiffImagingExtension : public imagingFormatExtension
                 {
                     throw RwException( "failed to get the orientation property for TIFF" );
                 }
+
+                int planarConfigSuccess = TIFFGetFieldDefaulted( tif, TIFFTAG_PLANARCONFIG, &planar_config );
+
+                if ( planarConfigSuccess != 1 )
+                {
+                    throw RwException( "failed to get the planar configuration for TIFF" );
+                }
             }
 
             // Check some obvious things.
@@ -705,7 +1144,8 @@ struct tiffImagingExtension : public imagingFormatExtension
             eTIFF_ParseMode parseMode;
 
             // TODO: allow for direct acquisition even if the orientation is off.
-            if ( orientation == ORIENTATION_TOPLEFT )
+            // Separate sample planes cannot be read as bands of whole pixels, so those go through the RGBA interface.
+            if ( orientation == ORIENTATION_TOPLEFT && ( planar_config == PLANARCONFIG_CONTIG || sample_count == 1 ) )
             {
                 if ( photometric_type == PHOTOMETRIC_MINISWHITE ||
                      photometric_type == PHOTOMETRIC_MINISBLACK )
@@ -755,7 +1195,7 @@ struct tiffImagingExtension : public imagingFormatExtension
                                 dstDepth = 32;
 
                                 tiffRasterFormat = RASTER_8888;
-                                tiffDepth = 8;
+                                tiffDepth = 32;
                             }
                             else
                             {
@@ -876,11 +1316,12 @@ struct tiffImagingExtension : public imagingFormatExtension
                             if ( dstPaletteType == PALETTE_NONE )
                             {
                                 // We have a good chance to directly aquire the colors from raw images.
-                                canColorDirectlyAcquire = 
+                                canColorDirectlyAcquire =
+                                    tiffRasterFormat != RASTER_DEFAULT &&
                                     doRawMipmapBuffersNeedConversion(
                                         tiffRasterFormat, tiffDepth, tiffColorOrder, PALETTE_NONE,
                                         dstRasterFormat, dstDepth, dstColorOrder, PALETTE_NONE
-                                    );
+                                    ) == false;
 
                                 canTexelsDirectlyAcquire = canColorDirectlyAcquire;
                             }
@@ -895,108 +1336,95 @@ struct tiffImagingExtension : public imagingFormatExtension
                             }
                         }
 
-                        if ( canTexelsDirectlyAcquire )
+                        // Strips and tiles are compressed independently, so we cut the image into bands
+                        // (a strip or a row of tiles) and decode ranges of bands in parallel.
+                        tiff_band_decode_params params;
+                        params.image_width = image_width;
+                        params.image_length = image_length;
+                        params.isTiled = ( TIFFIsTiled( tif ) != 0 );
+                        params.tile_width = 0;
+                        params.bandRowCount = 0;
+                        params.scanline_size = scanline_size;
+                        params.canTexelsDirectlyAcquire = canTexelsDirectlyAcquire;
+                        params.parseMode = parseMode;
+                        params.photometric_type = photometric_type;
+                        params.bits_per_sample = bits_per_sample;
+                        params.has_alpha_channel = tiff_has_alpha_channel;
+                        params.dstTexels = dstTexels;
+                        params.dstRowSize = dstRowSize;
+                        params.dstRasterFormat = dstRasterFormat;
+                        params.dstDepth = dstDepth;
+                        params.dstColorOrder = dstColorOrder;
+                        params.dstPaletteType = dstPaletteType;
+                        params.dstPaletteSize = dstPaletteSize;
+
+                        if ( params.isTiled )
                         {
-                            // Just read to our destination buffer.
-                            for ( uint32 row = 0; row < image_length; row++ )
-                            {
-                                void *dstRowData = getTexelDataRow( dstTexels, dstRowSize, row );
+                            uint32 tile_length;
 
-                                int rowReadError = TIFFReadScanline( tif, dstRowData, row );
+                            if ( TIFFGetField( tif, TIFFTAG_TILEWIDTH, &params.tile_width ) != 1 ||
+                                 TIFFGetField( tif, TIFFTAG_TILELENGTH, &tile_length ) != 1 )
+                            {
+                                throw RwException( "failed to get tile dimensions for TIFF" );
+                            }
 
-                                if ( rowReadError != 1 )
-                                {
-                                    throw RwException( "failed to directly read TIFF row data" );
-                                }
+                            if ( params.tile_width == 0 )
+                            {
+                                throw RwException( "TIFF has zero tile width" );
                             }
+
+                            params.bandRowCount = tile_length;
                         }
                         else
                         {
-                            // Create a put dispatch.
-                            colorModelDispatcher putDispatch( dstRasterFormat, dstColorOrder, dstDepth, NULL, 0, PALETTE_NONE );
+                            uint32 rows_per_strip;
 
-                            void *scanlineBuf = engineInterface->PixelAllocate( scanline_size );
+                            if ( TIFFGetFieldDefaulted( tif, TIFFTAG_ROWSPERSTRIP, &rows_per_strip ) != 1 )
+                            {
+                                throw RwException( "failed to get the strip size for TIFF" );
+                            }
 
-                            if ( scanlineBuf == NULL )
+                            params.bandRowCount = std::min( rows_per_strip, image_length );
+                        }
+
+                        if ( params.bandRowCount == 0 )
+                        {
+                            throw RwException( "TIFF has zero rows per strip or tile" );
+                        }
+
+                        uint32 bandCount = ( ( image_length + params.bandRowCount - 1 ) / params.bandRowCount );
+
+                        uint32 chunkCount = GetTIFFChunkCount( bandCount );
+
+                        ParallelForEach( engineInterface, chunkCount,
+                            [&]( size_t chunkIndex )
+                        {
+                            uint32 firstBand, endBand;
+                            GetTIFFChunkRange( bandCount, chunkCount, chunkIndex, firstBand, endBand );
+
+                            if ( chunkCount == 1 )
                             {
-                                throw RwException( "failed to allocate scanline buffer for TIFF deserialization" );
+                                decodeTIFFBands( engineInterface, tif, params, firstBand, endBand );
+                                return;
                             }
 
+                            tiff_memory_io_struct band_io( engineInterface, tiffData, tiffDataSize );
+
+                            TIFF *bandTif = OpenMemoryTIFF( band_io, "RwTIFFBandDecoder", "r" );
+
                             try
                             {
-                                // We read item by item and transform the items into the destination buffer.
-                                for ( uint32 row = 0; row < image_length; row++ )
-                                {
-                                    int error = TIFFReadScanline( tif, scanlineBuf, row );
-
-                                    if ( error != 1 )
-                                    {
-                                        throw RwException( "failed to read TIFF scanline" );
-                                    }
-
-                                    // Convert it over to our buffer.
-                                    void *dstRowData = getTexelDataRow( dstTexels, dstRowSize, row );
-
-                                    for ( uint32 col = 0; col < image_width; col++ )
-                                    {
-                                        if ( parseMode == TPARSEMODE_GRAYSCALE )
-                                        {
-                                            uint8 lum, alpha;
-
-                                            bool hasColor = read_tiff_grayscale( scanlineBuf, col, photometric_type, bits_per_sample, tiff_has_alpha_channel, lum, alpha );
-
-                                            if ( !hasColor )
-                                            {
-                                                lum = 0;
-                                                alpha = 0;
-                                            }
-
-                                            putDispatch.setLuminance( dstRowData, col, lum, alpha );
-                                        }
-                                        else if ( parseMode == TPARSEMODE_FULLCOLOR )
-                                        {
-                                            uint8 r, g, b, a;
-
-                                            bool hasColor = read_tiff_color( scanlineBuf, col, photometric_type, bits_per_sample, tiff_has_alpha_channel, r, g, b, a );
-
-                                            if ( !hasColor )
-                                            {
-                                                r = 0;
-                                                g = 0;
-                                                b = 0;
-                                                a = 0;
-                                            }
-
-                                            putDispatch.setRGBA( dstRowData, col, r, g, b, a );
-                                        }
-                                        else if ( parseMode == TPARSEMODE_PALETTE )
-                                        {
-                                            // Simple palette item copy.
-                                            assert( num_extra_samples == 0 );
-
-                                            copyPaletteItemGeneric(
-                                                scanlineBuf, dstRowData,
-                                                col, bits_per_sample, dstPaletteType,
-                                                col, dstDepth, dstPaletteType,
-                                                dstPaletteSize
-                                            );
-                                        }
-                                        else
-                                        {
-                                            assert( 0 );
-                                        }
-                                    }
-                                }
+                                decodeTIFFBands( engineInterface, bandTif, params, firstBand, endBand );
                             }
                             catch( ... )
                             {
-                                engineInterface->PixelFree( scanlineBuf );
+                                TIFFClose( bandTif );
 
                                 throw;
                             }
 
-                            engineInterface->PixelFree( scanlineBuf );
-                        }
+                            TIFFClose( bandTif );
+                        });
 
                         // Copy palette colors.
                         if ( dstPaletteType != PALETTE_NONE )
@@ -1092,6 +1520,142 @@ struct tiffImagingExtension : public imagingFormatExtension
         TIFFClose( tif );
     }
 
+    // Fields that every handle of one TIFF output has to agree on.
+    // Strip encoders use scratch handles, so the strip layout has to match the real output.
+    struct tiff_write_fields
+    {
+        uint32 width, height;
+        uint16 photometric_type;
+        uint16 bits_per_sample;
+        uint16 sample_count;
+        uint16 num_extra_samples;
+        uint16 *extra_sample_types;
+        uint16 *colormap_red, *colormap_green, *colormap_blue;
+        uint32 rowsPerStrip;
+    };
+
+    static void setTIFFWriteFields( TIFF *tif, const tiff_write_fields& fields )
+    {
+        TIFFSetField( tif, TIFFTAG_IMAGEWIDTH, fields.width );
+        TIFFSetField( tif, TIFFTAG_IMAGELENGTH, fields.height );
+        TIFFSetField( tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG );
+
+        // Differencing neighbouring samples helps deflate a lot on photographic data, but not on palette indices.
+        bool hasPalette = ( fields.photometric_type == PHOTOMETRIC_PALETTE );
+
+        TIFFSetField( tif, TIFFTAG_COMPRESSION, COMPRESSION_ADOBE_DEFLATE );
+        TIFFSetField( tif, TIFFTAG_PREDICTOR, ( hasPalette ? PREDICTOR_NONE : PREDICTOR_HORIZONTAL ) );
+        TIFFSetField( tif, TIFFTAG_SAMPLESPERPIXEL, fields.sample_count + fields.num_extra_samples );
+        TIFFSetField( tif, TIFFTAG_EXTRASAMPLES, fields.num_extra_samples, fields.extra_sample_types );
+        TIFFSetField( tif, TIFFTAG_PHOTOMETRIC, fields.photometric_type );
+        TIFFSetField( tif, TIFFTAG_BITSPERSAMPLE, fields.bits_per_sample );
+        TIFFSetField( tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT );
+
+        if ( fields.colormap_red != NULL && fields.colormap_green != NULL && fields.colormap_blue != NULL )
+        {
+            TIFFSetField( tif, TIFFTAG_COLORMAP, fields.colormap_red, fields.colormap_green, fields.colormap_blue );
+        }
+
+        TIFFSetField( tif, TIFFTAG_ROWSPERSTRIP, fields.rowsPerStrip );
+    }
+
+    struct tiff_strip_encode_params
+    {
+        uint32 width, height;
+        uint32 rowsPerStrip;
+        uint32 tiffRowSize;
+        bool canDirectlyWrite;
+
+        const void *srcTexels;
+        uint32 srcRowSize;
+        eRasterFormat srcRasterFormat;
+        uint32 srcDepth;
+        uint32 srcRowAlignment;
+        eColorOrdering srcColorOrder;
+        ePaletteType srcPaletteType;
+        uint32 srcPaletteSize;
+
+        eRasterFormat tiffRasterFormat;
+        uint32 tiffDepth;
+        uint32 tiffRowAlignment;
+        eColorOrdering tiffColorOrder;
+        ePaletteType tiffPaletteType;
+        uint32 tiffPaletteSize;
+    };
+
+    // Compresses a range of strips on a scratch handle and takes the encoded bytes out of its memory file.
+    static void encodeTIFFStrips(
+        Interface *engineInterface, TIFF *stripTif, tiff_memory_io_struct& strip_io,
+        const tiff_strip_encode_params& params, uint32 firstStrip, uint32 endStrip,
+        std::vector <std::vector <uint8>>& encodedStrips
+    )
+    {
+        uint32 width = params.width;
+        uint32 height = params.height;
+        uint32 tiffRowSize = params.tiffRowSize;
+
+        // libtiff predicts in-place, so we always hand it a copy of the source rows.
+        void *stripBuf = engineInterface->PixelAllocate( (size_t)tiffRowSize * params.rowsPerStrip );
+
+        if ( stripBuf == NULL )
+        {
+            throw RwException( "failed to allocate TIFF strip buffer in serialization routine" );
+        }
+
+        try
+        {
+            for ( uint32 strip = firstStrip; strip < endStrip; strip++ )
+            {
+                uint32 firstRow = ( strip * params.rowsPerStrip );
+                uint32 rowCount = std::min( params.rowsPerStrip, height - firstRow );
+
+                if ( params.canDirectlyWrite )
+                {
+                    for ( uint32 n = 0; n < rowCount; n++ )
+                    {
+                        const void *srcRowData = getConstTexelDataRow( params.srcTexels, params.srcRowSize, firstRow + n );
+
+                        memcpy( getTexelDataRow( stripBuf, tiffRowSize, n ), srcRowData, tiffRowSize );
+                    }
+                }
+                else
+                {
+                    moveTexels(
+                        params.srcTexels, stripBuf,
+                        0, firstRow,
+                        0, 0,
+                        width, rowCount,
+                        width, height,
+                        params.srcRasterFormat, params.srcDepth, params.srcRowAlignment, params.srcColorOrder, params.srcPaletteType, params.srcPaletteSize,
+                        params.tiffRasterFormat, params.tiffDepth, params.tiffRowAlignment, params.tiffColorOrder, params.tiffPaletteType, params.tiffPaletteSize
+                    );
+                }
+
+                size_t encodedStart = strip_io.writeData.size();
+
+                tmsize_t tiffWriteResult = TIFFWriteEncodedStrip( stripTif, strip, stripBuf, (tmsize_t)tiffRowSize * rowCount );
+
+                if ( tiffWriteResult == -1 )
+                {
+                    throw RwException( "failed to encode TIFF strip in serialization routine" );
+                }
+
+                // Every strip is appended to the end of the scratch file.
+                std::vector <uint8>& writeData = strip_io.writeData;
+
+                encodedStrips[ strip ].assign( writeData.begin() + encodedStart, writeData.end() );
+            }
+        }
+        catch( ... )
+        {
+            engineInterface->PixelFree( stripBuf );
+
+            throw;
+        }
+
+        engineInterface->PixelFree( stripBuf );
+    }
+
     void SerializeImage( Interface *engineInterface, Stream *outputStream, const imagingLayerTraversal& inputPixels ) const override
     {
         // Make sure we receive uncompressed raster data.
@@ -1308,29 +1872,37 @@ struct tiffImagingExtension : public imagingFormatExtension
                     extra_sample_types = tiff_alpha_configuration;
                 }
 
+                tiff_write_fields fields;
+                fields.width = width;
+                fields.height = height;
+                fields.photometric_type = photometric_type;
+                fields.bits_per_sample = bits_per_sample;
+                fields.sample_count = sample_count;
+                fields.num_extra_samples = num_extra_samples;
+                fields.extra_sample_types = extra_sample_types;
+                fields.colormap_red = colormap_red;
+                fields.colormap_green = colormap_green;
+                fields.colormap_blue = colormap_blue;
+                fields.rowsPerStrip = 1;
+
                 // Apply common TIFF fields.
-                TIFFSetField( tif, TIFFTAG_IMAGEWIDTH, (uint16)width );
-                TIFFSetField( tif, TIFFTAG_IMAGELENGTH, (uint16)height );
-                TIFFSetField( tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG );
-                TIFFSetField( tif, TIFFTAG_COMPRESSION, COMPRESSION_NONE );
-                TIFFSetField( tif, TIFFTAG_SAMPLESPERPIXEL, sample_count + num_extra_samples );
-                TIFFSetField( tif, TIFFTAG_EXTRASAMPLES, num_extra_samples, extra_sample_types );
-                TIFFSetField( tif, TIFFTAG_PHOTOMETRIC, photometric_type );
-                TIFFSetField( tif, TIFFTAG_BITSPERSAMPLE, bits_per_sample );
-                TIFFSetField( tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT );
-
-                if ( colormap_red != NULL && colormap_green != NULL && colormap_blue != NULL )
-                {
-                    TIFFSetField( tif, TIFFTAG_COLORMAP, colormap_red, colormap_green, colormap_blue );
-                }
+                setTIFFWriteFields( tif, fields );
 
-                // Now write our data, on a scanline-by-scanline basis.
                 uint32 tiffRowSize = (uint32)TIFFScanlineSize( tif );
 
                 uint32 srcRowSize = getRasterDataRowSize( width, srcDepth, srcRowAlignment );
 
-                // We need to set strip size, apparently.
-                TIFFSetField( tif, TIFFTAG_ROWSPERSTRIP, TIFFDefaultStripSize( tif, width * sample_count ) );
+                // Strips are compressed independently, so they are our unit of parallel work.
+                // Keep them at a size that deflate can still find its patterns in.
+                const uint32 tiffStripTargetSize = 256 * 1024;
+
+                uint32 rowsPerStrip = std::max( 1u, std::min( height, tiffStripTargetSize / std::max( 1u, tiffRowSize ) ) );
+
+                fields.rowsPerStrip = rowsPerStrip;
+
+                TIFFSetField( tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip );
+
+                uint32 stripCount = ( ( height + rowsPerStrip - 1 ) / rowsPerStrip );
 
                 // We first have to know if we can just directly write our data into the TIFF stream.
                 // If we can, then we will do so very very fast!
@@ -1354,64 +1926,75 @@ struct tiffImagingExtension : public imagingFormatExtension
                         ( tiffRowSize == srcRowSize );
                 }
 
-                if ( canDirectlyWrite )
+                tiff_strip_encode_params params;
+                params.width = width;
+                params.height = height;
+                params.rowsPerStrip = rowsPerStrip;
+                params.tiffRowSize = tiffRowSize;
+                params.canDirectlyWrite = canDirectlyWrite;
+                params.srcTexels = srcTexels;
+                params.srcRowSize = srcRowSize;
+                params.srcRasterFormat = srcRasterFormat;
+                params.srcDepth = srcDepth;
+                params.srcRowAlignment = srcRowAlignment;
+                params.srcColorOrder = srcColorOrder;
+                params.srcPaletteType = srcPaletteType;
+                params.srcPaletteSize = srcPaletteSize;
+                params.tiffRasterFormat = tiffRasterFormat;
+                params.tiffDepth = tiffDepth;
+                params.tiffRowAlignment = tiffRowAlignment;
+                params.tiffColorOrder = tiffColorOrder;
+                params.tiffPaletteType = tiffPaletteType;
+                params.tiffPaletteSize = tiffPaletteSize;
+
+                // Compress the strips in parallel, each thread into its own scratch file.
+                std::vector <std::vector <uint8>> encodedStrips( stripCount );
+
+                uint32 chunkCount = GetTIFFChunkCount( stripCount );
+
+                ParallelForEach( engineInterface, chunkCount,
+                    [&]( size_t chunkIndex )
                 {
-                    // We just iterate through our rows and write them texels.
-                    for ( uint32 row = 0; row < height; row++ )
-                    {
-                        const void *srcRowData = getConstTexelDataRow( srcTexels, srcRowSize, row );
+                    uint32 firstStrip, endStrip;
+                    GetTIFFChunkRange( stripCount, chunkCount, chunkIndex, firstStrip, endStrip );
 
-                        int tiffWriteError = TIFFWriteScanline( tif, (uint32*)srcRowData, row );
+                    tiff_memory_io_struct strip_io( engineInterface );
 
-                        if ( tiffWriteError != 1 )
-                        {
-                            throw RwException( "failed to write TIFF data row directly in serialization routine" );
-                        }
-                    }
-                }
-                else
-                {
-                    // We need a transformation buffer to write texels to.
-                    void *rowbuf = engineInterface->PixelAllocate( tiffRowSize );
-
-                    if ( rowbuf == NULL )
-                    {
-                        throw RwException( "failed to allocate TIFF auxiliary transformation row buffer in serialization routine" ); 
-                    }
+                    TIFF *stripTif = OpenMemoryTIFF( strip_io, "RwTIFFStripEncoder", "w" );
 
                     try
                     {
-                        for ( uint32 row = 0; row < height; row++ )
-                        {
-                            // Transform our row.
-                            moveTexels(
-                                srcTexels, rowbuf,
-                                0, row,
-                                0, 0,
-                                width, 1,
-                                width, height,
-                                srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder, srcPaletteType, srcPaletteSize,
-                                tiffRasterFormat, tiffDepth, tiffRowAlignment, tiffColorOrder, tiffPaletteType, tiffPaletteSize
-                            );
+                        setTIFFWriteFields( stripTif, fields );
 
-                            // Write the row.
-                            int tiffWriteError = TIFFWriteScanline( tif, rowbuf, row );
-
-                            if ( tiffWriteError != 1 )
-                            {
-                                throw RwException( "failed to write transform TIFF row in serialization routine" );
-                            }
-                        }
+                        encodeTIFFStrips( engineInterface, stripTif, strip_io, params, firstStrip, endStrip, encodedStrips );
                     }
                     catch( ... )
                     {
-                        engineInterface->PixelFree( rowbuf );
+                        TIFFClose( stripTif );
 
                         throw;
                     }
 
-                    // Clean up some stuff that aint required anymore.
-                    engineInterface->PixelFree( rowbuf );
+                    // The scratch file is thrown away, so it does not matter what libtiff flushes into it.
+                    TIFFClose( stripTif );
+                });
+
+                // Splice the encoded strips into the output in order.
+                for ( uint32 strip = 0; strip < stripCount; strip++ )
+                {
+                    std::vector <uint8>& encodedStrip = encodedStrips[ strip ];
+
+                    tmsize_t encodedSize = (tmsize_t)encodedStrip.size();
+
+                    tmsize_t tiffWriteResult = TIFFWriteRawStrip( tif, strip, encodedStrip.data(), encodedSize );
+
+                    if ( tiffWriteResult != encodedSize )
+                    {
+                        throw RwException( "failed to write TIFF strip in serialization routine" );
+                    }
+
+                    // Release the memory as we go.
+                    std::vector <uint8> ().swap( encodedStrip );
                 }
             }
             catch( ... )
@@ -1424,6 +2007,12 @@ struct tiffImagingExtension : public imagingFormatExtension
 
                 throw;
             }
+
+            // libtiff keeps its own copy of the colormap.
+            if ( colormap )
+            {
+                engineInterface->PixelFree( colormap );
+            }
         }
         catch( ... )
         {
@@ -491,6 +491,20 @@ eDXTCompressionMethod Interface::GetDXTRuntime( void ) const
     return GetConstEnvironmentConfigBlock( engineInterface ).GetDXTRuntime();
 }
 
+void Interface::SetETCCompressionQuality( eETCCompressionQuality quality )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    GetEnvironmentConfigBlock( engineInterface ).SetETCCompressionQuality( quality );
+}
+
+eETCCompressionQuality Interface::GetETCCompressionQuality( void ) const
+{
+    const EngineInterface *engineInterface = (const EngineInterface*)this;
+
+    return GetConstEnvironmentConfigBlock( engineInterface ).GetETCCompressionQuality();
+}
+
 void Interface::SetFixIncompatibleRasters( bool doFix )
 {
     EngineInterface *engineInterface = (EngineInterface*)this;
@@ -533,6 +547,20 @@ bool Interface::GetPreferPackedSampleExport( void ) const
     return GetConstEnvironmentConfigBlock( engineInterface ).GetPreferPackedSampleExport();
 }
 
+void Interface::SetTGARunLengthEncoding( bool enable )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    GetEnvironmentConfigBlock( engineInterface ).SetTGARunLengthEncoding( enable );
+}
+
+bool Interface::GetTGARunLengthEncoding( void ) const
+{
+    const EngineInterface *engineInterface = (const EngineInterface*)this;
+
+    return GetConstEnvironmentConfigBlock( engineInterface ).GetTGARunLengthEncoding();
+}
+
 void Interface::SetDXTPackedDecompression( bool packedDecompress )
 {
     EngineInterface *engineInterface = (EngineInterface*)this;
@@ -565,8 +593,10 @@ bool Interface::GetIgnoreSerializationBlockRegions( void ) const
 extern void registerConfigurationEnvironment( void );
 extern void registerThreadingEnvironment( void );
 extern void registerWarningHandlerEnvironment( void );
+extern void registerProfilerEnvironment( void );
 extern void registerEventSystem( void );
 extern void registerTXDPlugins( void );
+extern void registerClumpStreamPlugin( void );
 extern void registerObjectExtensionsPlugins( void );
 extern void registerSerializationPlugins( void );
 extern void registerStreamGlobalPlugins( void );
@@ -617,12 +647,14 @@ Interface* CreateEngine( LibraryVersion theVersion )
             // Now do the main modules.
             registerThreadingEnvironment();
             registerWarningHandlerEnvironment();
+            registerProfilerEnvironment();
             registerEventSystem();
             registerStreamGlobalPlugins();
             registerFileSystemDataRepository();
             registerSerializationPlugins();
             registerObjectExtensionsPlugins();
             registerTXDPlugins();
+            registerClumpStreamPlugin();
             registerImagingPlugin();
             registerNativeImagePluginEnvironment();
             registerWindowingSystem();
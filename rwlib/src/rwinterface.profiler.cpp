@@ -0,0 +1,582 @@
+// RenderWare hot-path profiling.
+// Threads record timed zones and counters into their own log, so recording does not contend.
+// The logs can be dumped as Chrome trace event JSON, which loads into chrome://tracing or Perfetto.
+#include "StdInc.h"
+
+#include "rwinterface.hxx"
+
+#include "rwthreading.hxx"
+
+#include <chrono>
+
+using namespace NativeExecutive;
+
+namespace rw
+{
+
+std::atomic <uint32> profilingEnabledCount( 0 );
+
+// Zones shorter than this are not recorded, since the trace has microsecond resolution anyway.
+static const uint64 PROFILE_MIN_ZONE_NANOSECONDS = 1000;
+
+// Upper limit of recorded zones per thread, so that long mass conversions cannot exhaust memory.
+static const size_t PROFILE_MAX_EVENTS_PER_THREAD = 1000000;
+
+// Engines that lock waits are reported to.
+static const size_t PROFILE_MAX_ENGINES = 4;
+
+static std::atomic <EngineInterface*> profilingEngines[ PROFILE_MAX_ENGINES ];
+
+uint64 ProfileGetTimestamp( void )
+{
+    return (uint64)std::chrono::duration_cast <std::chrono::nanoseconds> ( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+struct profileEvent
+{
+    const char *zoneName;
+    uint64 startTime;
+    uint64 duration;
+};
+
+struct profileThreadLog
+{
+    uint32 threadIndex;
+
+    // Zones are only appended by the owning thread, but dumping can happen from any thread.
+    // We use the native lock because rwlock waits are profiled themselves.
+    CReadWriteLock *eventLock;
+
+    std::vector <profileEvent> events;
+    std::vector <profileEvent> openZones;
+    uint64 droppedEventCount;
+
+    std::atomic <uint64> counters[ PROFILE_COUNTER_COUNT ];
+};
+
+struct profilerThreadEnv
+{
+    profileThreadLog *threadLog;
+};
+
+struct profilerThreadEnvPluginInterface : public threadPluginInterface
+{
+    bool OnPluginConstruct( CExecThread *theThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override
+    {
+        profilerThreadEnv *env = pluginId.RESOLVE_STRUCT <profilerThreadEnv> ( theThread, pluginOffset );
+
+        if ( !env )
+            return false;
+
+        // The log is created on first use and is owned by the engine, so it survives the thread.
+        env->threadLog = NULL;
+        return true;
+    }
+
+    void OnPluginDestruct( CExecThread *theThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override
+    {
+        return;
+    }
+
+    bool OnPluginAssign( CExecThread *dstThread, const CExecThread *srcThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override
+    {
+        // Every thread has its own log.
+        return true;
+    }
+};
+
+struct profilerEnv
+{
+    inline void Initialize( EngineInterface *engineInterface )
+    {
+        this->isEnabled = false;
+        this->engineSlot = PROFILE_MAX_ENGINES;
+        this->startTime = ProfileGetTimestamp();
+        this->logListLock = NULL;
+
+        this->_threadEnvPluginOffset = ExecutiveManager::threadPluginContainer_t::INVALID_PLUGIN_OFFSET;
+
+        CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+        if ( nativeMan )
+        {
+            this->logListLock = nativeMan->CreateReadWriteLock();
+
+            this->_threadEnvPluginOffset =
+                nativeMan->RegisterThreadPlugin( sizeof( profilerThreadEnv ), &_threadEnvPluginIntf );
+        }
+    }
+
+    inline void Shutdown( EngineInterface *engineInterface )
+    {
+        this->SetEnabled( engineInterface, false );
+
+        CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+        if ( nativeMan )
+        {
+            if ( ExecutiveManager::threadPluginContainer_t::IsOffsetValid( this->_threadEnvPluginOffset ) )
+            {
+                nativeMan->UnregisterThreadPlugin( this->_threadEnvPluginOffset );
+            }
+
+            for ( profileThreadLog *threadLog : this->threadLogs )
+            {
+                nativeMan->CloseReadWriteLock( threadLog->eventLock );
+
+                delete threadLog;
+            }
+
+            if ( CReadWriteLock *logListLock = this->logListLock )
+            {
+                nativeMan->CloseReadWriteLock( logListLock );
+            }
+        }
+
+        this->threadLogs.clear();
+    }
+
+    void SetEnabled( EngineInterface *engineInterface, bool enabled )
+    {
+        if ( this->isEnabled == enabled )
+            return;
+
+        if ( enabled )
+        {
+            // Take a slot so that lock waits find us.
+            for ( size_t n = 0; n < PROFILE_MAX_ENGINES; n++ )
+            {
+                EngineInterface *expected = NULL;
+
+                if ( profilingEngines[ n ].compare_exchange_strong( expected, engineInterface ) )
+                {
+                    this->engineSlot = n;
+                    break;
+                }
+            }
+
+            profilingEnabledCount++;
+        }
+        else
+        {
+            if ( this->engineSlot < PROFILE_MAX_ENGINES )
+            {
+                profilingEngines[ this->engineSlot ] = NULL;
+
+                this->engineSlot = PROFILE_MAX_ENGINES;
+            }
+
+            profilingEnabledCount--;
+        }
+
+        this->isEnabled = enabled;
+    }
+
+    profileThreadLog* GetCurrentThreadLog( EngineInterface *engineInterface )
+    {
+        if ( !this->isEnabled )
+            return NULL;
+
+        CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+        if ( !nativeMan || !ExecutiveManager::threadPluginContainer_t::IsOffsetValid( this->_threadEnvPluginOffset ) )
+            return NULL;
+
+        CExecThread *curThread = nativeMan->GetCurrentThread();
+
+        if ( !curThread )
+            return NULL;
+
+        profilerThreadEnv *threadEnv =
+            ExecutiveManager::threadPluginContainer_t::RESOLVE_STRUCT <profilerThreadEnv> ( curThread, this->_threadEnvPluginOffset );
+
+        if ( !threadEnv )
+            return NULL;
+
+        profileThreadLog *threadLog = threadEnv->threadLog;
+
+        if ( !threadLog )
+        {
+            threadLog = new profileThreadLog;
+            threadLog->eventLock = nativeMan->CreateReadWriteLock();
+            threadLog->droppedEventCount = 0;
+
+            for ( std::atomic <uint64>& counter : threadLog->counters )
+            {
+                counter = 0;
+            }
+
+            this->logListLock->EnterCriticalWriteRegion();
+
+            threadLog->threadIndex = (uint32)this->threadLogs.size();
+
+            this->threadLogs.push_back( threadLog );
+
+            this->logListLock->LeaveCriticalWriteRegion();
+
+            threadEnv->threadLog = threadLog;
+        }
+
+        return threadLog;
+    }
+
+    std::atomic <bool> isEnabled;     // read by every zone without locking
+    size_t engineSlot;
+    uint64 startTime;
+
+    CReadWriteLock *logListLock;
+    std::vector <profileThreadLog*> threadLogs;
+
+    profilerThreadEnvPluginInterface _threadEnvPluginIntf;
+    threadPluginOffset _threadEnvPluginOffset;
+};
+
+static PluginDependantStructRegister <profilerEnv, RwInterfaceFactory_t> profilerEnvRegister;
+
+profileThreadLog* ProfileBeginZone( EngineInterface *engineInterface, const char *zoneName )
+{
+    profilerEnv *env = profilerEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !env )
+        return NULL;
+
+    profileThreadLog *threadLog = env->GetCurrentThreadLog( engineInterface );
+
+    if ( threadLog )
+    {
+        profileEvent openZone;
+        openZone.zoneName = zoneName;
+        openZone.startTime = ProfileGetTimestamp();
+        openZone.duration = 0;
+
+        threadLog->openZones.push_back( openZone );
+    }
+
+    return threadLog;
+}
+
+void ProfileEndZone( profileThreadLog *threadLog )
+{
+    assert( threadLog->openZones.empty() == false );
+
+    profileEvent zone = threadLog->openZones.back();
+
+    threadLog->openZones.pop_back();
+
+    zone.duration = ( ProfileGetTimestamp() - zone.startTime );
+
+    if ( zone.duration < PROFILE_MIN_ZONE_NANOSECONDS )
+        return;
+
+    threadLog->eventLock->EnterCriticalWriteRegion();
+
+    if ( threadLog->events.size() < PROFILE_MAX_EVENTS_PER_THREAD )
+    {
+        threadLog->events.push_back( zone );
+    }
+    else
+    {
+        threadLog->droppedEventCount++;
+    }
+
+    threadLog->eventLock->LeaveCriticalWriteRegion();
+}
+
+void ProfileAddCounter( EngineInterface *engineInterface, eProfileCounter counter, uint64 value )
+{
+    profilerEnv *env = profilerEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !env )
+        return;
+
+    if ( profileThreadLog *threadLog = env->GetCurrentThreadLog( engineInterface ) )
+    {
+        threadLog->counters[ counter ].fetch_add( value, std::memory_order_relaxed );
+    }
+}
+
+void ProfileAddLockWait( uint64 waitNanoseconds )
+{
+    for ( std::atomic <EngineInterface*>& engineSlot : profilingEngines )
+    {
+        if ( EngineInterface *engineInterface = engineSlot.load() )
+        {
+            ProfileAddCounter( engineInterface, PROFILE_COUNTER_LOCK_WAITS, 1 );
+            ProfileAddCounter( engineInterface, PROFILE_COUNTER_LOCK_WAIT_NANOSECONDS, waitNanoseconds );
+        }
+    }
+}
+
+void Interface::SetProfilingEnabled( bool enabled )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    profilerEnv *env = profilerEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( env )
+    {
+        scoped_rwlock_writer <rwlock> lock( GetReadWriteLock( engineInterface ) );
+
+        env->SetEnabled( engineInterface, enabled );
+    }
+}
+
+bool Interface::GetProfilingEnabled( void ) const
+{
+    const EngineInterface *engineInterface = (const EngineInterface*)this;
+
+    const profilerEnv *env = profilerEnvRegister.GetConstPluginStruct( engineInterface );
+
+    if ( env )
+    {
+        return env->isEnabled;
+    }
+
+    return false;
+}
+
+void Interface::ResetProfilingData( void )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    profilerEnv *env = profilerEnvRegister.GetPluginStruct( engineInterface );
+
+    if ( !env || !env->logListLock )
+        return;
+
+    // The logs stay alive because threads may be inside of zones right now.
+    env->logListLock->EnterCriticalReadRegion();
+
+    env->startTime = ProfileGetTimestamp();
+
+    for ( profileThreadLog *threadLog : env->threadLogs )
+    {
+        threadLog->eventLock->EnterCriticalWriteRegion();
+
+        threadLog->events.clear();
+        threadLog->droppedEventCount = 0;
+
+        for ( std::atomic <uint64>& counter : threadLog->counters )
+        {
+            counter = 0;
+        }
+
+        threadLog->eventLock->LeaveCriticalWriteRegion();
+    }
+
+    env->logListLock->LeaveCriticalReadRegion();
+}
+
+inline void fetchThreadCounters( const profileThreadLog *threadLog, profilingThreadCounters& countersOut )
+{
+    countersOut.threadIndex = threadLog->threadIndex;
+    countersOut.bytesConverted = threadLog->counters[ PROFILE_COUNTER_BYTES_CONVERTED ];
+    countersOut.allocationCount = threadLog->counters[ PROFILE_COUNTER_ALLOCATIONS ];
+    countersOut.allocationBytes = threadLog->counters[ PROFILE_COUNTER_ALLOCATION_BYTES ];
+    countersOut.lockWaitCount = threadLog->counters[ PROFILE_COUNTER_LOCK_WAITS ];
+    countersOut.lockWaitMicroseconds = ( threadLog->counters[ PROFILE_COUNTER_LOCK_WAIT_NANOSECONDS ] / 1000 );
+    countersOut.streamBytesRead = threadLog->counters[ PROFILE_COUNTER_STREAM_BYTES_READ ];
+    countersOut.streamBytesWritten = threadLog->counters[ PROFILE_COUNTER_STREAM_BYTES_WRITTEN ];
+}
+
+void Interface::GetProfilingCounters( profilingCounterList_t& countersOut ) const
+{
+    const EngineInterface *engineInterface = (const EngineInterface*)this;
+
+    const profilerEnv *env = profilerEnvRegister.GetConstPluginStruct( engineInterface );
+
+    countersOut.clear();
+
+    if ( !env || !env->logListLock )
+        return;
+
+    env->logListLock->EnterCriticalReadRegion();
+
+    for ( const profileThreadLog *threadLog : env->threadLogs )
+    {
+        profilingThreadCounters counters;
+
+        fetchThreadCounters( threadLog, counters );
+
+        countersOut.push_back( counters );
+    }
+
+    env->logListLock->LeaveCriticalReadRegion();
+}
+
+// Chrome trace timestamps are microseconds.
+inline void writeTraceTime( std::string& json, uint64 nanoseconds )
+{
+    char buf[ 32 ];
+
+    _snprintf( buf, sizeof( buf ), "%llu.%03u", (unsigned long long)( nanoseconds / 1000 ), (unsigned int)( nanoseconds % 1000 ) );
+
+    json += buf;
+}
+
+inline void writeTraceCounters( std::string& json, const profilingThreadCounters& counters, uint64 timestamp )
+{
+    char buf[ 512 ];
+
+    json += "{\"name\":\"thread ";
+    json += std::to_string( counters.threadIndex );
+    json += " counters\",\"ph\":\"C\",\"pid\":1,\"tid\":";
+    json += std::to_string( counters.threadIndex );
+    json += ",\"ts\":";
+    writeTraceTime( json, timestamp );
+
+    _snprintf( buf, sizeof( buf ),
+        ",\"args\":{\"bytes_converted\":%llu,\"allocations\":%llu,\"allocation_bytes\":%llu,"
+        "\"lock_waits\":%llu,\"lock_wait_us\":%llu,\"stream_bytes_read\":%llu,\"stream_bytes_written\":%llu}}",
+        (unsigned long long)counters.bytesConverted,
+        (unsigned long long)counters.allocationCount,
+        (unsigned long long)counters.allocationBytes,
+        (unsigned long long)counters.lockWaitCount,
+        (unsigned long long)counters.lockWaitMicroseconds,
+        (unsigned long long)counters.streamBytesRead,
+        (unsigned long long)counters.streamBytesWritten
+    );
+
+    json += buf;
+}
+
+void Interface::DumpProfilingTrace( Stream *outputStream ) const
+{
+    const EngineInterface *engineInterface = (const EngineInterface*)this;
+
+    const profilerEnv *env = profilerEnvRegister.GetConstPluginStruct( engineInterface );
+
+    if ( !env || !env->logListLock )
+    {
+        throw RwException( "profiling is not available" );
+    }
+
+    uint64 startTime = env->startTime;
+    uint64 endTime = ( ProfileGetTimestamp() - startTime );
+
+    // Take a copy of the logs first, because writing to the stream records zones itself.
+    // Ending those zones takes the event lock of our thread, so we must not hold any lock while writing.
+    struct threadLogSnapshot
+    {
+        uint32 threadIndex;
+        std::vector <profileEvent> events;
+        profilingThreadCounters counters;
+    };
+
+    std::vector <threadLogSnapshot> snapshots;
+
+    uint64 droppedEventCount = 0;
+
+    env->logListLock->EnterCriticalReadRegion();
+
+    try
+    {
+        snapshots.resize( env->threadLogs.size() );
+
+        size_t logIndex = 0;
+
+        for ( const profileThreadLog *threadLog : env->threadLogs )
+        {
+            threadLogSnapshot& snapshot = snapshots[ logIndex++ ];
+
+            snapshot.threadIndex = threadLog->threadIndex;
+
+            threadLog->eventLock->EnterCriticalReadRegion();
+
+            try
+            {
+                snapshot.events = threadLog->events;
+
+                droppedEventCount += threadLog->droppedEventCount;
+            }
+            catch( ... )
+            {
+                threadLog->eventLock->LeaveCriticalReadRegion();
+                throw;
+            }
+
+            threadLog->eventLock->LeaveCriticalReadRegion();
+
+            fetchThreadCounters( threadLog, snapshot.counters );
+        }
+    }
+    catch( ... )
+    {
+        env->logListLock->LeaveCriticalReadRegion();
+        throw;
+    }
+
+    env->logListLock->LeaveCriticalReadRegion();
+
+    // Write the trace in chunks, so that huge traces do not need to be in memory twice.
+    static const size_t flushSize = 0x10000;
+
+    std::string json = "{\"traceEvents\":[";
+
+    bool isFirstEvent = true;
+
+    auto beginEvent = [&]( void )
+    {
+        if ( !isFirstEvent )
+        {
+            json += ",";
+        }
+
+        json += "\n";
+
+        isFirstEvent = false;
+    };
+
+    auto flush = [&]( void )
+    {
+        outputStream->write( json.c_str(), json.size() );
+
+        json.clear();
+    };
+
+    for ( const threadLogSnapshot& snapshot : snapshots )
+    {
+        std::string threadIndex = std::to_string( snapshot.threadIndex );
+
+        beginEvent();
+
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + threadIndex + ",\"args\":{\"name\":\"rwlib thread " + threadIndex + "\"}}";
+
+        for ( const profileEvent& zone : snapshot.events )
+        {
+            // Zones that were opened before the last reset.
+            if ( zone.startTime < startTime )
+                continue;
+
+            beginEvent();
+
+            json += "{\"name\":\"";
+            json += zone.zoneName;
+            json += "\",\"cat\":\"rwlib\",\"ph\":\"X\",\"pid\":1,\"tid\":" + threadIndex + ",\"ts\":";
+            writeTraceTime( json, zone.startTime - startTime );
+            json += ",\"dur\":";
+            writeTraceTime( json, zone.duration );
+            json += "}";
+
+            if ( json.size() >= flushSize )
+            {
+                flush();
+            }
+        }
+
+        beginEvent();
+
+        writeTraceCounters( json, snapshot.counters, endTime );
+    }
+
+    json += "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" + std::to_string( droppedEventCount ) + "}}\n";
+
+    flush();
+}
+
+void registerProfilerEnvironment( void )
+{
+    profilerEnvRegister.RegisterPlugin( engineFactory );
+}
+
+};
@@ -11,11 +11,25 @@ using namespace NativeExecutive;
 namespace rw
 {
 
+// Number of warnings a thread can buffer during a batch before they are delivered anyway.
+#define WARNING_BATCH_CAPACITY 64
+
 struct warningHandlerThreadEnv
 {
+    inline warningHandlerThreadEnv( void )
+    {
+        this->batchDepth = 0;
+    }
+
     // The purpose of the warning handler stack is to fetch warning output requests and to reroute them
     // so that they make more sense.
     std::vector <WarningHandler*> warningHandlerStack;
+
+    // Warnings of the current batch, oldest first.
+    // Only the owning thread touches them, so no locking is required.
+    std::vector <std::string> pendingWarnings;
+
+    uint32 batchDepth;
 };
 
 struct warningHandlerThreadEnvPluginInterface : public threadPluginInterface
@@ -47,7 +61,8 @@ struct warningHandlerThreadEnvPluginInterface : public threadPluginInterface
         const warningHandlerThreadEnv *srcEnv = pluginId.RESOLVE_STRUCT <warningHandlerThreadEnv> ( srcThread, pluginOffset );
         warningHandlerThreadEnv *dstEnv = pluginId.RESOLVE_STRUCT <warningHandlerThreadEnv> ( dstThread, pluginOffset );
 
-        *dstEnv = *srcEnv;
+        // Pending warnings belong to the thread that issued them, so only the handlers are taken over.
+        dstEnv->warningHandlerStack = srcEnv->warningHandlerStack;
         return true;
     }
 };
@@ -66,10 +81,19 @@ struct warningHandlerPlugin
             this->_warningEnvThreadPluginOffset =
                 nativeMan->RegisterThreadPlugin( sizeof( warningHandlerThreadEnv ), &_warningEnvThreadPluginIntf );
         }
+
+        // Warning managers are application code that does not expect concurrent calls.
+        // This lock only serializes the delivery, so threads that push warnings do not wait on the engine.
+        this->deliveryLock = CreateReadWriteLock( engineInterface );
     }
 
     inline void Shutdown( EngineInterface *engineInterface )
     {
+        if ( rwlock *deliveryLock = this->deliveryLock )
+        {
+            CloseReadWriteLock( engineInterface, deliveryLock );
+        }
+
         // Unregister the thread env, if registered.
         if ( ExecutiveManager::threadPluginContainer_t::IsOffsetValid( this->_warningEnvThreadPluginOffset ) )
         {
@@ -87,8 +111,58 @@ struct warningHandlerPlugin
         return ExecutiveManager::threadPluginContainer_t::RESOLVE_STRUCT <warningHandlerThreadEnv> ( theThread, this->_warningEnvThreadPluginOffset );
     }
 
+    // Resolves the warning environment of the calling thread.
+    // Thread handles are stored in TLS, so this does not take any lock once the thread is known.
+    inline warningHandlerThreadEnv* GetCurrentWarningHandlers( EngineInterface *engineInterface ) const
+    {
+        CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+        if ( nativeMan )
+        {
+            CExecThread *curThread = nativeMan->GetCurrentThread();
+
+            if ( curThread )
+            {
+                return GetWarningHandlers( curThread );
+            }
+        }
+
+        return NULL;
+    }
+
+    // Gives warnings to the warning manager of the calling thread as one uninterrupted sequence.
+    inline void DeliverWarnings( EngineInterface *engineInterface, std::string *messages, size_t messageCount )
+    {
+        const rwConfigBlock& cfgBlock = GetConstEnvironmentConfigBlock( engineInterface );
+
+        if ( WarningManagerInterface *warningMan = cfgBlock.GetWarningManager() )
+        {
+            scoped_rwlock_writer <rwlock> lock( this->deliveryLock );
+
+            for ( size_t n = 0; n < messageCount; n++ )
+            {
+                warningMan->OnWarning( std::move( messages[ n ] ) );
+            }
+        }
+    }
+
+    inline void FlushWarnings( EngineInterface *engineInterface, warningHandlerThreadEnv *threadEnv )
+    {
+        if ( threadEnv->pendingWarnings.empty() )
+            return;
+
+        // Take the messages out of the batch, so it is free for the next one.
+        std::vector <std::string> messages = std::move( threadEnv->pendingWarnings );
+
+        threadEnv->pendingWarnings.clear();
+
+        DeliverWarnings( engineInterface, messages.data(), messages.size() );
+    }
+
     warningHandlerThreadEnvPluginInterface _warningEnvThreadPluginIntf;
     threadPluginOffset _warningEnvThreadPluginOffset;
+
+    rwlock *deliveryLock;
 };
 
 static PluginDependantStructRegister <warningHandlerPlugin, RwInterfaceFactory_t> warningHandlerPluginRegister;
@@ -97,58 +171,100 @@ void Interface::PushWarning( std::string&& message )
 {
     EngineInterface *engineInterface = (EngineInterface*)this;
 
-    scoped_rwlock_writer <rwlock> lock( GetReadWriteLock( engineInterface ) );
-
+    // We do not take the engine lock here: the handler stack and the warning batch are private to the
+    // calling thread, and delivery to the warning manager is serialized by the warning plugin.
     const rwConfigBlock& cfgBlock = GetConstEnvironmentConfigBlock( engineInterface );
 
     if ( cfgBlock.GetWarningLevel() > 0 )
     {
-        // If we have a warning handler, we redirect the message to it instead.
-        // The warning handler is supposed to be an internal class that only the library has access to.
-        WarningHandler *currentWarningHandler = NULL;
-        {
-            CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+        warningHandlerPlugin *whandlerEnv = warningHandlerPluginRegister.GetPluginStruct( engineInterface );
 
-            if ( nativeMan )
+        if ( !whandlerEnv )
+            return;
+
+        warningHandlerThreadEnv *threadEnv = whandlerEnv->GetCurrentWarningHandlers( engineInterface );
+
+        if ( threadEnv )
+        {
+            // If we have a warning handler, we redirect the message to it instead.
+            // The warning handler is supposed to be an internal class that only the library has access to.
+            if ( !threadEnv->warningHandlerStack.empty() )
             {
-                CExecThread *curThread = nativeMan->GetCurrentThread();
+                WarningHandler *currentWarningHandler = threadEnv->warningHandlerStack.back();
 
-                if ( curThread )
+                // Give it the warning.
+                currentWarningHandler->OnWarningMessage( std::move( message ) );
+                return;
+            }
+
+            // Inside of a batch we keep the warning until the batch is flushed.
+            if ( threadEnv->batchDepth > 0 )
+            {
+                if ( threadEnv->pendingWarnings.size() == WARNING_BATCH_CAPACITY )
                 {
-                    warningHandlerPlugin *whandlerEnv = warningHandlerPluginRegister.GetPluginStruct( engineInterface );
-
-                    if ( whandlerEnv )
-                    {
-                        warningHandlerThreadEnv *threadEnv = whandlerEnv->GetWarningHandlers( curThread );
-
-                        if ( threadEnv )
-                        {
-                            if ( !threadEnv->warningHandlerStack.empty() )
-                            {
-                                currentWarningHandler = threadEnv->warningHandlerStack.back();
-                            }
-                        }
-                    }
+                    whandlerEnv->FlushWarnings( engineInterface, threadEnv );
                 }
+
+                threadEnv->pendingWarnings.push_back( std::move( message ) );
+                return;
             }
         }
 
-        if ( currentWarningHandler )
+        // Else we just post the warning to the runtime.
+        whandlerEnv->DeliverWarnings( engineInterface, &message, 1 );
+    }
+}
+
+void Interface::BeginWarningBatch( void )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    warningHandlerPlugin *whandlerEnv = warningHandlerPluginRegister.GetPluginStruct( engineInterface );
+
+    if ( whandlerEnv )
+    {
+        if ( warningHandlerThreadEnv *threadEnv = whandlerEnv->GetCurrentWarningHandlers( engineInterface ) )
         {
-            // Give it the warning.
-            currentWarningHandler->OnWarningMessage( std::move( message ) );
+            threadEnv->batchDepth++;
         }
-        else
+    }
+}
+
+void Interface::EndWarningBatch( void )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    warningHandlerPlugin *whandlerEnv = warningHandlerPluginRegister.GetPluginStruct( engineInterface );
+
+    if ( whandlerEnv )
+    {
+        if ( warningHandlerThreadEnv *threadEnv = whandlerEnv->GetCurrentWarningHandlers( engineInterface ) )
         {
-            // Else we just post the warning to the runtime.
-            if ( WarningManagerInterface *warningMan = cfgBlock.GetWarningManager() )
+            assert( threadEnv->batchDepth > 0 );
+
+            if ( --threadEnv->batchDepth == 0 )
             {
-                warningMan->OnWarning( std::move( message ) );
+                whandlerEnv->FlushWarnings( engineInterface, threadEnv );
             }
         }
     }
 }
 
+void Interface::FlushWarnings( void )
+{
+    EngineInterface *engineInterface = (EngineInterface*)this;
+
+    warningHandlerPlugin *whandlerEnv = warningHandlerPluginRegister.GetPluginStruct( engineInterface );
+
+    if ( whandlerEnv )
+    {
+        if ( warningHandlerThreadEnv *threadEnv = whandlerEnv->GetCurrentWarningHandlers( engineInterface ) )
+        {
+            whandlerEnv->FlushWarnings( engineInterface, threadEnv );
+        }
+    }
+}
+
 void Interface::PushObjWarningVerb( const RwObject *theObj, const std::string& verbMsg )
 {
     // TODO: actually make this smarter.
@@ -7,6 +7,12 @@ namespace rw
 // These should be used by the entire library.
 void* Interface::MemAllocate( size_t memSize )
 {
+    if ( IsProfilingActive() )
+    {
+        ProfileCount( this, PROFILE_COUNTER_ALLOCATIONS, 1 );
+        ProfileCount( this, PROFILE_COUNTER_ALLOCATION_BYTES, memSize );
+    }
+
     return new uint8[ memSize ];
 }
 
@@ -17,6 +23,12 @@ void Interface::MemFree( void *ptr )
 
 void* Interface::PixelAllocate( size_t memSize )
 {
+    if ( IsProfilingActive() )
+    {
+        ProfileCount( this, PROFILE_COUNTER_ALLOCATIONS, 1 );
+        ProfileCount( this, PROFILE_COUNTER_ALLOCATION_BYTES, memSize );
+    }
+
     return new uint8[ memSize ];
 }
 
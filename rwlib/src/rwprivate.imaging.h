@@ -13,4 +13,26 @@ bool SerializeMipmapLayer( Stream *outputStream, const char *formatDescriptor, c
 void NativeImagePutToRasterNoLock( NativeImage *nativeImg, Raster *raster );
 void NativeImageFetchFromRasterNoLock( NativeImage *nativeImg, Raster *raster, const char *nativeTexName, bool& needsRefOut );
 
+// Fits an image into a maxDimm square while keeping the aspect ratio. Never upscales.
+inline void GetThumbnailDimensions( uint32 width, uint32 height, uint32 maxDimm, uint32& thumbWidthOut, uint32& thumbHeightOut )
+{
+    if ( width <= maxDimm && height <= maxDimm )
+    {
+        thumbWidthOut = width;
+        thumbHeightOut = height;
+        return;
+    }
+
+    if ( width >= height )
+    {
+        thumbWidthOut = maxDimm;
+        thumbHeightOut = std::max( 1u, (uint32)( (uint64)height * maxDimm / width ) );
+    }
+    else
+    {
+        thumbWidthOut = std::max( 1u, (uint32)( (uint64)width * maxDimm / height ) );
+        thumbHeightOut = maxDimm;
+    }
+}
+
 #endif //_RENDERWARE_PRIVATE_IMAGING_
\ No newline at end of file
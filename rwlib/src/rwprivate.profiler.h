@@ -0,0 +1,73 @@
+// RenderWare private global include file about hot-path profiling.
+
+#ifndef _RENDERWARE_PRIVATE_PROFILER_
+#define _RENDERWARE_PRIVATE_PROFILER_
+
+// Counters that are kept per thread while profiling.
+enum eProfileCounter
+{
+    PROFILE_COUNTER_BYTES_CONVERTED,
+    PROFILE_COUNTER_ALLOCATIONS,
+    PROFILE_COUNTER_ALLOCATION_BYTES,
+    PROFILE_COUNTER_LOCK_WAITS,
+    PROFILE_COUNTER_LOCK_WAIT_NANOSECONDS,
+    PROFILE_COUNTER_STREAM_BYTES_READ,
+    PROFILE_COUNTER_STREAM_BYTES_WRITTEN,
+
+    PROFILE_COUNTER_COUNT
+};
+
+struct profileThreadLog;
+
+// Number of engines that have profiling enabled.
+// Every profiling site checks this first, so disabled profiling costs a single load.
+extern std::atomic <uint32> profilingEnabledCount;
+
+inline bool IsProfilingActive( void )
+{
+    return ( profilingEnabledCount.load( std::memory_order_relaxed ) != 0 );
+}
+
+uint64 ProfileGetTimestamp( void );
+
+profileThreadLog* ProfileBeginZone( EngineInterface *engineInterface, const char *zoneName );
+void ProfileEndZone( profileThreadLog *threadLog );
+void ProfileAddCounter( EngineInterface *engineInterface, eProfileCounter counter, uint64 value );
+
+// Locks do not know their engine, so the wait is accounted to every profiling engine.
+void ProfileAddLockWait( uint64 waitNanoseconds );
+
+// Times the enclosing scope. The zone name has to be a string literal.
+struct scoped_profile_zone
+{
+    inline scoped_profile_zone( Interface *engineInterface, const char *zoneName )
+    {
+        this->threadLog = NULL;
+
+        if ( IsProfilingActive() )
+        {
+            this->threadLog = ProfileBeginZone( (EngineInterface*)engineInterface, zoneName );
+        }
+    }
+
+    inline ~scoped_profile_zone( void )
+    {
+        if ( profileThreadLog *threadLog = this->threadLog )
+        {
+            ProfileEndZone( threadLog );
+        }
+    }
+
+private:
+    profileThreadLog *threadLog;
+};
+
+inline void ProfileCount( Interface *engineInterface, eProfileCounter counter, uint64 value )
+{
+    if ( IsProfilingActive() )
+    {
+        ProfileAddCounter( (EngineInterface*)engineInterface, counter, value );
+    }
+}
+
+#endif //_RENDERWARE_PRIVATE_PROFILER_
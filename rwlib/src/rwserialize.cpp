@@ -215,6 +215,29 @@ void Interface::Serialize( RwObject *objectToStore, Stream *outputStream )
     this->SerializeBlock( objectToStore, mainBlock );
 }
 
+void Interface::SerializeStreaming( RwObject *objectToStore, Stream *outputStream )
+{
+    // Block headers store the length of their block, so we have to know it before writing
+    // anything. Run the serialization once without output to record all the headers.
+    BlockWritePlan writePlan;
+    {
+        BlockProvider countingBlock( outputStream, RWBLOCKWRITE_COUNT, &writePlan );
+
+        this->SerializeBlock( objectToStore, countingBlock );
+    }
+
+    // Now write for real, emitting every header in front of its block.
+    BlockProvider mainBlock( outputStream, RWBLOCKWRITE_STREAM, &writePlan );
+
+    this->SerializeBlock( objectToStore, mainBlock );
+
+    // The serializers have to produce the same blocks each time or the headers are wrong.
+    if ( mainBlock.doesMismatchWritePlan() )
+    {
+        throw RwBlockException( "streamed serialization did not match its counting pass" );
+    }
+}
+
 RwObject* Interface::DeserializeBlock( BlockProvider& inputProvider )
 {
     EngineInterface *engineInterface = (EngineInterface*)this;
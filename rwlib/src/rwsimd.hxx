@@ -0,0 +1,16 @@
+// RenderWare SIMD availability helpers.
+// Vectorized routines must always keep a scalar path; include this header
+// and test RWLIB_HAS_SSE2 before touching any SSE2 intrinsics.
+
+#ifndef _RENDERWARE_SIMD_
+#define _RENDERWARE_SIMD_
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define RWLIB_HAS_SSE2
+#endif
+
+#ifdef RWLIB_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+#endif //_RENDERWARE_SIMD_
@@ -71,7 +71,11 @@ struct FileStream : public Stream
 
         if ( Interface *engineInterface = this->engineInterface )
         {
+            scoped_profile_zone profileZone( engineInterface, "FileStream::read" );
+
             actualReadCount = engineInterface->GetFileInterface()->ReadStream( this->file_handle, out_buf, readCount );
+
+            ProfileCount( engineInterface, PROFILE_COUNTER_STREAM_BYTES_READ, actualReadCount );
         }
 
         return actualReadCount;
@@ -83,7 +87,11 @@ struct FileStream : public Stream
 
         if ( Interface *engineInterface = this->engineInterface )
         {
+            scoped_profile_zone profileZone( engineInterface, "FileStream::write" );
+
             actualWriteCount = engineInterface->GetFileInterface()->WriteStream( this->file_handle, in_buf, writeCount );
+
+            ProfileCount( engineInterface, PROFILE_COUNTER_STREAM_BYTES_WRITTEN, actualWriteCount );
         }
 
         return actualWriteCount;
@@ -212,9 +220,13 @@ struct CustomStream : public Stream
 
         if ( customStreamInterface *streamProvider = this->streamProvider )
         {
+            scoped_profile_zone profileZone( this->engineInterface, "CustomStream::read" );
+
             void *metaBuf = ( this + 1 );
 
             actualReadCount = streamProvider->Read( metaBuf, out_buf, readCount );
+
+            ProfileCount( this->engineInterface, PROFILE_COUNTER_STREAM_BYTES_READ, actualReadCount );
         }
 
         return actualReadCount;
@@ -226,9 +238,13 @@ struct CustomStream : public Stream
 
         if ( customStreamInterface *streamProvider = this->streamProvider )
         {
+            scoped_profile_zone profileZone( this->engineInterface, "CustomStream::write" );
+
             void *metaBuf = ( this + 1 );
 
             actualWriteCount = streamProvider->Write( metaBuf, in_buf, writeCount );
+
+            ProfileCount( this->engineInterface, PROFILE_COUNTER_STREAM_BYTES_WRITTEN, actualWriteCount );
         }
 
         return actualWriteCount;
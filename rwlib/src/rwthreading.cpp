@@ -22,7 +22,23 @@ inline void* GetRWLockObject( rwlock *theLock )
 // Read/Write lock implementation.
 void rwlock::enter_read( void )
 {
-    ((CReadWriteLock*)GetRWLockObject( this ))->EnterCriticalReadRegion();
+    CReadWriteLock *nativeLock = (CReadWriteLock*)GetRWLockObject( this );
+
+    // Measure how long we were blocked, if profiling.
+    if ( IsProfilingActive() )
+    {
+        if ( nativeLock->TryEnterCriticalReadRegion() )
+            return;
+
+        uint64 waitStartTime = ProfileGetTimestamp();
+
+        nativeLock->EnterCriticalReadRegion();
+
+        ProfileAddLockWait( ProfileGetTimestamp() - waitStartTime );
+        return;
+    }
+
+    nativeLock->EnterCriticalReadRegion();
 }
 
 void rwlock::leave_read( void )
@@ -32,7 +48,22 @@ void rwlock::leave_read( void )
 
 void rwlock::enter_write( void )
 {
-    ((CReadWriteLock*)GetRWLockObject( this ))->EnterCriticalWriteRegion();
+    CReadWriteLock *nativeLock = (CReadWriteLock*)GetRWLockObject( this );
+
+    if ( IsProfilingActive() )
+    {
+        if ( nativeLock->TryEnterCriticalWriteRegion() )
+            return;
+
+        uint64 waitStartTime = ProfileGetTimestamp();
+
+        nativeLock->EnterCriticalWriteRegion();
+
+        ProfileAddLockWait( ProfileGetTimestamp() - waitStartTime );
+        return;
+    }
+
+    nativeLock->EnterCriticalWriteRegion();
 }
 
 void rwlock::leave_write( void )
@@ -329,6 +360,129 @@ void PurgeActiveThreadingObjects( EngineInterface *engineInterface )
     threadEnv->nativeMan->PurgeActiveObjects();
 }
 
+// Per-thread marker for code that runs inside of a parallel loop.
+// Nested loops check it so that they do not spawn threads on top of the running workers.
+struct parallelRegionThreadEnv
+{
+    uint32 parallelDepth;
+};
+
+struct parallelRegionThreadEnvPluginInterface : public threadPluginInterface
+{
+    bool OnPluginConstruct( CExecThread *theThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override
+    {
+        parallelRegionThreadEnv *env = pluginId.RESOLVE_STRUCT <parallelRegionThreadEnv> ( theThread, pluginOffset );
+
+        if ( !env )
+            return false;
+
+        env->parallelDepth = 0;
+        return true;
+    }
+
+    void OnPluginDestruct( CExecThread *theThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override
+    {
+        return;
+    }
+
+    bool OnPluginAssign( CExecThread *dstThread, const CExecThread *srcThread, threadPluginOffset pluginOffset, ExecutiveManager::threadPluginContainer_t::pluginDescriptor pluginId ) override
+    {
+        // The marker belongs to the thread that entered the region.
+        return true;
+    }
+};
+
+struct parallelRegionPlugin
+{
+    inline void Initialize( EngineInterface *engineInterface )
+    {
+        this->_regionThreadPluginOffset = ExecutiveManager::threadPluginContainer_t::INVALID_PLUGIN_OFFSET;
+
+        CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+        if ( nativeMan )
+        {
+            this->_regionThreadPluginOffset =
+                nativeMan->RegisterThreadPlugin( sizeof( parallelRegionThreadEnv ), &_regionThreadPluginIntf );
+        }
+    }
+
+    inline void Shutdown( EngineInterface *engineInterface )
+    {
+        if ( ExecutiveManager::threadPluginContainer_t::IsOffsetValid( this->_regionThreadPluginOffset ) )
+        {
+            CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+            if ( nativeMan )
+            {
+                nativeMan->UnregisterThreadPlugin( this->_regionThreadPluginOffset );
+            }
+        }
+    }
+
+    inline parallelRegionThreadEnv* GetCurrentRegionEnv( EngineInterface *engineInterface ) const
+    {
+        if ( ExecutiveManager::threadPluginContainer_t::IsOffsetValid( this->_regionThreadPluginOffset ) )
+        {
+            CExecutiveManager *nativeMan = GetNativeExecutive( engineInterface );
+
+            if ( nativeMan )
+            {
+                CExecThread *curThread = nativeMan->GetCurrentThread();
+
+                if ( curThread )
+                {
+                    return ExecutiveManager::threadPluginContainer_t::RESOLVE_STRUCT <parallelRegionThreadEnv> ( curThread, this->_regionThreadPluginOffset );
+                }
+            }
+        }
+
+        return NULL;
+    }
+
+    parallelRegionThreadEnvPluginInterface _regionThreadPluginIntf;
+    threadPluginOffset _regionThreadPluginOffset;
+};
+
+static PluginDependantStructRegister <parallelRegionPlugin, RwInterfaceFactory_t> parallelRegionPluginRegister;
+
+bool IsInsideParallelRegion( EngineInterface *engineInterface )
+{
+    if ( parallelRegionPlugin *regionEnv = parallelRegionPluginRegister.GetPluginStruct( engineInterface ) )
+    {
+        if ( parallelRegionThreadEnv *threadEnv = regionEnv->GetCurrentRegionEnv( engineInterface ) )
+        {
+            return ( threadEnv->parallelDepth != 0 );
+        }
+    }
+
+    return false;
+}
+
+void EnterParallelRegion( EngineInterface *engineInterface )
+{
+    if ( parallelRegionPlugin *regionEnv = parallelRegionPluginRegister.GetPluginStruct( engineInterface ) )
+    {
+        if ( parallelRegionThreadEnv *threadEnv = regionEnv->GetCurrentRegionEnv( engineInterface ) )
+        {
+            threadEnv->parallelDepth++;
+        }
+    }
+}
+
+void LeaveParallelRegion( EngineInterface *engineInterface )
+{
+    if ( parallelRegionPlugin *regionEnv = parallelRegionPluginRegister.GetPluginStruct( engineInterface ) )
+    {
+        if ( parallelRegionThreadEnv *threadEnv = regionEnv->GetCurrentRegionEnv( engineInterface ) )
+        {
+            assert( threadEnv->parallelDepth != 0 );
+
+            threadEnv->parallelDepth--;
+        }
+    }
+}
+
 void* GetThreadingNativeManager( Interface *intf )
 {
     EngineInterface *engineInterface = (EngineInterface*)intf;
@@ -340,6 +494,9 @@ void* GetThreadingNativeManager( Interface *intf )
 void registerThreadingEnvironment( void )
 {
     threadingEnv.RegisterPlugin( engineFactory );
+
+    // Needs the native executive, so it comes after the threading environment.
+    parallelRegionPluginRegister.RegisterPlugin( engineFactory );
 }
 
 };
\ No newline at end of file
@@ -1,5 +1,8 @@
 // RenderWare Threading shared include.
 
+#ifndef _RENDERWARE_THREADING_SHARED_
+#define _RENDERWARE_THREADING_SHARED_
+
 #include <CExecutiveManager.h>
 
 #include "pluginutil.hxx"
@@ -47,4 +50,11 @@ inline NativeExecutive::CExecutiveManager* GetNativeExecutive( const EngineInter
 // Private API.
 void PurgeActiveThreadingObjects( EngineInterface *engineInterface );
 
-};
\ No newline at end of file
+// Tells whether the calling thread is running items of a parallel loop.
+bool IsInsideParallelRegion( EngineInterface *engineInterface );
+void EnterParallelRegion( EngineInterface *engineInterface );
+void LeaveParallelRegion( EngineInterface *engineInterface );
+
+};
+
+#endif //_RENDERWARE_THREADING_SHARED_
\ No newline at end of file
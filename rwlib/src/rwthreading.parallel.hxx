@@ -0,0 +1,179 @@
+// RenderWare parallel loop helper.
+
+#ifndef _RENDERWARE_THREADING_PARALLEL_
+#define _RENDERWARE_THREADING_PARALLEL_
+
+#include <thread>
+
+#include "rwthreading.hxx"
+
+namespace rw
+{
+
+// Runs a callback for every index in [0, itemCount) on worker threads of the engine.
+// The calling thread takes part in the work, so no threads are spawned for a single item.
+// If any callback fails, the remaining items are abandoned and the error is rethrown here.
+// Loops that are started from inside of another parallel loop run on the calling thread,
+// because the outer loop already keeps every core busy.
+template <typename callbackType>
+inline void ParallelForEach( Interface *engineInterface, size_t itemCount, const callbackType& cb )
+{
+    size_t workerCount = std::thread::hardware_concurrency();
+
+    if ( IsInsideParallelRegion( (EngineInterface*)engineInterface ) )
+    {
+        workerCount = 1;
+    }
+
+    if ( workerCount > itemCount )
+    {
+        workerCount = itemCount;
+    }
+
+    if ( workerCount <= 1 )
+    {
+        for ( size_t n = 0; n < itemCount; n++ )
+        {
+            cb( n );
+        }
+
+        return;
+    }
+
+    struct parallelJob
+    {
+        const callbackType *cb;
+        size_t itemCount;
+
+        std::atomic <size_t> nextItem;
+        std::atomic <bool> hasFailed;
+
+        std::string errorMessage;
+
+        inline void RunItems( void )
+        {
+            while ( this->hasFailed == false )
+            {
+                size_t itemIndex = this->nextItem++;
+
+                if ( itemIndex >= this->itemCount )
+                    break;
+
+                try
+                {
+                    (*this->cb)( itemIndex );
+                }
+                catch( RwException& except )
+                {
+                    this->Fail( except.message );
+                }
+                catch( ... )
+                {
+                    this->Fail( "unknown exception in parallel worker" );
+                }
+            }
+        }
+
+        inline void Fail( const std::string& message )
+        {
+            bool wasFailed = false;
+
+            // Only the first error is reported.
+            if ( this->hasFailed.compare_exchange_strong( wasFailed, true ) )
+            {
+                this->errorMessage = message;
+            }
+        }
+
+    };
+
+    struct parallelWorker
+    {
+        struct warningQueue : public WarningHandler
+        {
+            void OnWarningMessage( std::string&& theMessage ) override
+            {
+                this->messages.push_back( std::move( theMessage ) );
+            }
+
+            std::vector <std::string> messages;
+        };
+
+        parallelJob *job;
+        warningQueue warnings;
+
+        static void __cdecl _worker_entry( thread_t threadHandle, Interface *engineInterface, void *ud )
+        {
+            parallelWorker *worker = (parallelWorker*)ud;
+
+            // Helpers keep their warnings until they are joined, so the calling thread
+            // can put them into its own batch.
+            GlobalPushWarningHandler( (EngineInterface*)engineInterface, &worker->warnings );
+
+            EnterParallelRegion( (EngineInterface*)engineInterface );
+
+            worker->job->RunItems();
+
+            LeaveParallelRegion( (EngineInterface*)engineInterface );
+
+            GlobalPopWarningHandler( (EngineInterface*)engineInterface );
+        }
+    };
+
+    parallelJob job;
+    job.cb = &cb;
+    job.itemCount = itemCount;
+    job.nextItem = 0;
+    job.hasFailed = false;
+
+    // Spawn the helpers; we are the last worker ourselves.
+    // The worker array must not move while the helpers run.
+    std::vector <parallelWorker> workers( workerCount - 1 );
+    std::vector <thread_t> workerThreads;
+    workerThreads.reserve( workerCount - 1 );
+
+    for ( parallelWorker& worker : workers )
+    {
+        worker.job = &job;
+
+        thread_t workerThread = MakeThread( engineInterface, parallelWorker::_worker_entry, &worker );
+
+        if ( workerThread == NULL )
+            break;
+
+        ResumeThread( engineInterface, workerThread );
+
+        workerThreads.push_back( workerThread );
+    }
+
+    // Callbacks on this thread count as parallel work, too.
+    EnterParallelRegion( (EngineInterface*)engineInterface );
+
+    job.RunItems();
+
+    LeaveParallelRegion( (EngineInterface*)engineInterface );
+
+    for ( size_t n = 0; n < workerThreads.size(); n++ )
+    {
+        thread_t workerThread = workerThreads[ n ];
+
+        JoinThread( engineInterface, workerThread );
+
+        CloseThread( engineInterface, workerThread );
+
+        // Hand the warnings of the helper to the calling thread, in the order they were issued.
+        for ( std::string& message : workers[ n ].warnings.messages )
+        {
+            engineInterface->PushWarning( std::move( message ) );
+        }
+    }
+
+    if ( job.hasFailed )
+    {
+        throw RwException( std::move( job.errorMessage ) );
+    }
+}
+
+};
+
+#endif //_RENDERWARE_THREADING_PARALLEL_
\ No newline at end of file
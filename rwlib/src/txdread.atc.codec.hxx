@@ -0,0 +1,996 @@
+#ifndef _RENDERWARE_ATC_CODEC_
+#define _RENDERWARE_ATC_CODEC_
+
+// ATI texture compression (ATC) codec.
+// ATC is a close relative of DXT: blocks cover 4x4 pixels and the alpha blocks are exactly
+// the ones of DXT3 and DXT5. Only the color block differs, its first endpoint is a 555 color
+// whose top bit selects between two palette layouts.
+
+#include <algorithm>
+#include <cmath>
+
+#include "txdread.d3d.dxt.hxx"
+
+#include "rwthreading.parallel.hxx"
+
+#include "rwsimd.hxx"
+
+namespace rw
+{
+
+namespace atc
+{
+
+enum eATCAlphaMode
+{
+    ATC_ALPHA_NONE,
+    ATC_ALPHA_EXPLICIT,         // 4bit alpha per pixel, as in DXT3
+    ATC_ALPHA_INTERPOLATED      // two alpha endpoints with 3bit indices, as in DXT5
+};
+
+// WARNING: little endian types!
+struct rgb555_atc
+{
+    union
+    {
+        struct
+        {
+            unsigned short blue : 5;
+            unsigned short green : 5;
+            unsigned short red : 5;
+            unsigned short mode : 1;
+        };
+        unsigned short val;
+    };
+};
+
+template <template <typename numberType> class endianness>
+struct atc_color_block
+{
+    endianness <rgb555_atc> col0;
+    endianness <rgb565> col1;
+
+    endianness <uint32> indexList;
+};
+static_assert( sizeof( atc_color_block <endian::little_endian> ) == 8, "ATC color block must be 8 bytes in size!" );
+
+template <template <typename numberType> class endianness>
+struct atc_explicit_block
+{
+    endianness <uint64> alphaList;
+
+    atc_color_block <endianness> colorBlock;
+};
+static_assert( sizeof( atc_explicit_block <endian::little_endian> ) == 16, "ATC explicit alpha block must be 16 bytes in size!" );
+
+template <template <typename numberType> class endianness>
+struct atc_interpolated_block
+{
+    uint8 alphaPreMult[2];
+    uint8 alphaList[6];         // 3bit indices, little endian
+
+    atc_color_block <endianness> colorBlock;
+};
+static_assert( sizeof( atc_interpolated_block <endian::little_endian> ) == 16, "ATC interpolated alpha block must be 16 bytes in size!" );
+
+inline uint32 getATCBlockSize( eATCAlphaMode alphaMode )
+{
+    if ( alphaMode == ATC_ALPHA_NONE )
+    {
+        return 8;
+    }
+
+    return 16;
+}
+
+AINLINE uint32 expandATCChannel( uint32 value, uint32 bitCount )
+{
+    // Replicate the top bits into the free low bits, like the hardware does.
+    return ( ( value << ( 8 - bitCount ) ) | ( value >> ( bitCount * 2 - 8 ) ) );
+}
+
+AINLINE uint32 packATCTexel( uint32 red, uint32 green, uint32 blue, uint32 alpha )
+{
+    const uint8 texel[4] = { (uint8)red, (uint8)green, (uint8)blue, (uint8)alpha };
+
+    uint32 packed;
+    memcpy( &packed, texel, sizeof( packed ) );
+
+    return packed;
+}
+
+// Builds the four RGB colors that a color block can reference.
+// In mode 0 the endpoints are interpolated in eighths, in mode 1 the palette is
+// black, a darkened first endpoint and both endpoints.
+inline void getATCColorPalette( const rgb555_atc& col0, const rgb565& col1, uint32 paletteOut[4][3] )
+{
+    const int32 c0[3] =
+    {
+        (int32)expandATCChannel( col0.red, 5 ),
+        (int32)expandATCChannel( col0.green, 5 ),
+        (int32)expandATCChannel( col0.blue, 5 )
+    };
+
+    const int32 c1[3] =
+    {
+        (int32)expandATCChannel( col1.red, 5 ),
+        (int32)expandATCChannel( col1.green, 6 ),
+        (int32)expandATCChannel( col1.blue, 5 )
+    };
+
+    bool isModeOne = ( col0.mode != 0 );
+
+    for ( uint32 channel = 0; channel < 3; channel++ )
+    {
+        int32 first = c0[ channel ];
+        int32 second = c1[ channel ];
+
+        if ( !isModeOne )
+        {
+            paletteOut[0][ channel ] = first;
+            paletteOut[1][ channel ] = ( 5 * first + 3 * second ) / 8;
+            paletteOut[2][ channel ] = ( 3 * first + 5 * second ) / 8;
+            paletteOut[3][ channel ] = second;
+        }
+        else
+        {
+            paletteOut[0][ channel ] = 0;
+            paletteOut[1][ channel ] = std::max( 0, first - second / 4 );
+            paletteOut[2][ channel ] = first;
+            paletteOut[3][ channel ] = second;
+        }
+    }
+}
+
+AINLINE uint64 getATCInterpolatedAlphaIndices( const uint8 alphaList[6] )
+{
+    uint64 indices = 0;
+
+    for ( uint32 n = 0; n < 6; n++ )
+    {
+        indices |= ( (uint64)alphaList[ n ] << ( n * 8 ) );
+    }
+
+    return indices;
+}
+
+#ifdef RWLIB_HAS_SSE2
+
+AINLINE __m128i blendATCLanesSSE2( __m128i mask, __m128i ifSet, __m128i ifClear )
+{
+    return _mm_or_si128( _mm_and_si128( mask, ifSet ), _mm_andnot_si128( mask, ifClear ) );
+}
+
+AINLINE __m128i isATCIndexBitSetSSE2( __m128i indexBits, __m128i bitMask )
+{
+    return _mm_cmpeq_epi32( _mm_and_si128( indexBits, bitMask ), bitMask );
+}
+
+// SSE2 has no variable shuffle, so the palette entry of every pixel is picked by
+// testing its index bits and blending between the candidates.
+// groupIndices holds the 2bit indices of four pixels.
+AINLINE __m128i selectATCColorsSSE2( uint32 groupIndices, const __m128i colors[4] )
+{
+    __m128i indexBits = _mm_set1_epi32( (int)groupIndices );
+
+    __m128i isLowSet = isATCIndexBitSetSSE2( indexBits, _mm_setr_epi32( 0x01, 0x04, 0x10, 0x40 ) );
+    __m128i isHighSet = isATCIndexBitSetSSE2( indexBits, _mm_setr_epi32( 0x02, 0x08, 0x20, 0x80 ) );
+
+    return blendATCLanesSSE2( isHighSet,
+        blendATCLanesSSE2( isLowSet, colors[3], colors[2] ),
+        blendATCLanesSSE2( isLowSet, colors[1], colors[0] )
+    );
+}
+
+// Same for the 3bit indices of interpolated alpha.
+AINLINE __m128i selectATCAlphasSSE2( uint32 groupIndices, const __m128i alphas[8] )
+{
+    __m128i indexBits = _mm_set1_epi32( (int)groupIndices );
+
+    __m128i isFirstSet = isATCIndexBitSetSSE2( indexBits, _mm_setr_epi32( 0x001, 0x008, 0x040, 0x200 ) );
+    __m128i isSecondSet = isATCIndexBitSetSSE2( indexBits, _mm_setr_epi32( 0x002, 0x010, 0x080, 0x400 ) );
+    __m128i isThirdSet = isATCIndexBitSetSSE2( indexBits, _mm_setr_epi32( 0x004, 0x020, 0x100, 0x800 ) );
+
+    __m128i lowHalf = blendATCLanesSSE2( isSecondSet,
+        blendATCLanesSSE2( isFirstSet, alphas[3], alphas[2] ),
+        blendATCLanesSSE2( isFirstSet, alphas[1], alphas[0] )
+    );
+
+    __m128i highHalf = blendATCLanesSSE2( isSecondSet,
+        blendATCLanesSSE2( isFirstSet, alphas[7], alphas[6] ),
+        blendATCLanesSSE2( isFirstSet, alphas[5], alphas[4] )
+    );
+
+    return blendATCLanesSSE2( isThirdSet, highHalf, lowHalf );
+}
+
+// Expands the 4bit explicit alphas of all pixels into the top byte of four texel groups.
+AINLINE void getATCExplicitAlphasSSE2( uint64 alphaList, __m128i alphasOut[4] )
+{
+    const __m128i nibbleMask = _mm_set1_epi8( 0x0F );
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i packedAlphas = _mm_set_epi32( 0, 0, (int)( alphaList >> 32 ), (int)alphaList );
+
+    // Pixel 2n is the low nibble of byte n.
+    __m128i alphas = _mm_unpacklo_epi8(
+        _mm_and_si128( packedAlphas, nibbleMask ),
+        _mm_and_si128( _mm_srli_epi16( packedAlphas, 4 ), nibbleMask )
+    );
+
+    // Multiply by 17; the nibbles cannot carry into the neighbouring byte.
+    alphas = _mm_or_si128( alphas, _mm_slli_epi16( alphas, 4 ) );
+
+    __m128i lowAlphas = _mm_unpacklo_epi8( zero, alphas );
+    __m128i highAlphas = _mm_unpackhi_epi8( zero, alphas );
+
+    alphasOut[0] = _mm_unpacklo_epi16( zero, lowAlphas );
+    alphasOut[1] = _mm_unpackhi_epi16( zero, lowAlphas );
+    alphasOut[2] = _mm_unpacklo_epi16( zero, highAlphas );
+    alphasOut[3] = _mm_unpackhi_epi16( zero, highAlphas );
+}
+
+#endif //RWLIB_HAS_SSE2
+
+// Decodes a single block into 4x4 RGBA texels.
+// Every palette is resolved into packed texels once, so each pixel costs a table lookup.
+// With SSE2 four pixels are decoded at once; both paths produce the same texels.
+inline void decompressATCBlock( eATCAlphaMode alphaMode, const void *blockData, uint32 texelsOut[16] )
+{
+    typedef atc_color_block <endian::little_endian> color_block_t;
+
+    const color_block_t *colorBlock;
+
+#ifdef RWLIB_HAS_SSE2
+    // Alpha of every group of four pixels, already in the top byte of the texel.
+    __m128i alphaGroups[4];
+#else
+    uint8 alphas[16];
+#endif //RWLIB_HAS_SSE2
+
+    if ( alphaMode == ATC_ALPHA_EXPLICIT )
+    {
+        const atc_explicit_block <endian::little_endian> *block = (const atc_explicit_block <endian::little_endian>*)blockData;
+
+        uint64 alphaList = block->alphaList;
+
+#ifdef RWLIB_HAS_SSE2
+        getATCExplicitAlphasSSE2( alphaList, alphaGroups );
+#else
+        for ( uint32 n = 0; n < 16; n++ )
+        {
+            alphas[ n ] = (uint8)( ( ( alphaList >> ( n * 4 ) ) & 0xF ) * 17 );
+        }
+#endif //RWLIB_HAS_SSE2
+
+        colorBlock = &block->colorBlock;
+    }
+    else if ( alphaMode == ATC_ALPHA_INTERPOLATED )
+    {
+        const atc_interpolated_block <endian::little_endian> *block = (const atc_interpolated_block <endian::little_endian>*)blockData;
+
+        uint8 first_alpha = block->alphaPreMult[0];
+        uint8 second_alpha = block->alphaPreMult[1];
+
+        uint8 alphaPalette[8];
+
+        for ( uint32 n = 0; n < 8; n++ )
+        {
+            alphaPalette[ n ] = dxt4_5_block <endian::little_endian>::getAlphaByIndex( first_alpha, second_alpha, n );
+        }
+
+        uint64 alphaList = getATCInterpolatedAlphaIndices( block->alphaList );
+
+#ifdef RWLIB_HAS_SSE2
+        __m128i alphaCandidates[8];
+
+        for ( uint32 n = 0; n < 8; n++ )
+        {
+            alphaCandidates[ n ] = _mm_set1_epi32( (int)( (uint32)alphaPalette[ n ] << 24 ) );
+        }
+
+        for ( uint32 group = 0; group < 4; group++ )
+        {
+            alphaGroups[ group ] = selectATCAlphasSSE2( (uint32)( alphaList >> ( group * 12 ) ), alphaCandidates );
+        }
+#else
+        for ( uint32 n = 0; n < 16; n++ )
+        {
+            alphas[ n ] = alphaPalette[ ( alphaList >> ( n * 3 ) ) & 0x7 ];
+        }
+#endif //RWLIB_HAS_SSE2
+
+        colorBlock = &block->colorBlock;
+    }
+    else
+    {
+#ifdef RWLIB_HAS_SSE2
+        for ( uint32 group = 0; group < 4; group++ )
+        {
+            alphaGroups[ group ] = _mm_set1_epi32( (int)0xFF000000 );
+        }
+#else
+        memset( alphas, 255, sizeof( alphas ) );
+#endif //RWLIB_HAS_SSE2
+
+        colorBlock = (const color_block_t*)blockData;
+    }
+
+    uint32 palette[4][3];
+
+    getATCColorPalette( colorBlock->col0, colorBlock->col1, palette );
+
+    uint32 indexList = colorBlock->indexList;
+
+#ifdef RWLIB_HAS_SSE2
+    __m128i colors[4];
+
+    for ( uint32 index = 0; index < 4; index++ )
+    {
+        const uint32 *color = palette[ index ];
+
+        colors[ index ] = _mm_set1_epi32( (int)packATCTexel( color[0], color[1], color[2], 0 ) );
+    }
+
+    for ( uint32 group = 0; group < 4; group++ )
+    {
+        __m128i texels = _mm_or_si128( selectATCColorsSSE2( indexList >> ( group * 8 ), colors ), alphaGroups[ group ] );
+
+        _mm_storeu_si128( (__m128i*)( texelsOut + group * 4 ), texels );
+    }
+#else
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        const uint32 *color = palette[ ( indexList >> ( n * 2 ) ) & 0x3 ];
+
+        texelsOut[ n ] = packATCTexel( color[0], color[1], color[2], alphas[ n ] );
+    }
+#endif //RWLIB_HAS_SSE2
+}
+
+// Decodes ATC blocks into 32bit RGBA texels with tightly packed rows.
+inline void decompressATC( Interface *engineInterface, eATCAlphaMode alphaMode, uint32 width, uint32 height, const void *srcData, void *dstTexels )
+{
+    uint32 blocksWide = ALIGN_SIZE( width, 4u ) / 4;
+    uint32 blocksHigh = ALIGN_SIZE( height, 4u ) / 4;
+
+    uint32 blockSize = getATCBlockSize( alphaMode );
+
+    const uint8 *srcBlocks = (const uint8*)srcData;
+    uint8 *dstPixels = (uint8*)dstTexels;
+
+    ParallelForEach( engineInterface, blocksHigh,
+        [&]( size_t blockY )
+    {
+        uint32 firstRow = ( (uint32)blockY * 4 );
+        uint32 rowCount = std::min( 4u, height - firstRow );
+
+        for ( uint32 blockX = 0; blockX < blocksWide; blockX++ )
+        {
+            uint32 texels[16];
+
+            decompressATCBlock( alphaMode, srcBlocks + ( (uint32)blockY * blocksWide + blockX ) * blockSize, texels );
+
+            uint32 firstColumn = ( blockX * 4 );
+            uint32 columnCount = std::min( 4u, width - firstColumn );
+
+            for ( uint32 y = 0; y < rowCount; y++ )
+            {
+                memcpy(
+                    dstPixels + ( ( firstRow + y ) * width + firstColumn ) * 4,
+                    texels + getDXTLocalBlockIndex( 0, y ),
+                    columnCount * sizeof( uint32 )
+                );
+            }
+        }
+    });
+}
+
+// *** Encoder ***
+
+// Number of least-squares endpoint refits per color block.
+#define ATC_REFINEMENT_PASSES   2
+
+// Pixels of a block that is being encoded. Pixels outside of the surface are not part of the fit.
+struct atcEncodeBlock
+{
+    uint8 pixels[16][4];
+    bool isValid[16];
+};
+
+// Interpolation weight of the second endpoint per mode 0 index.
+static const float atcModeZeroWeights[4] = { 0.0f, 3.0f / 8.0f, 5.0f / 8.0f, 1.0f };
+
+AINLINE uint32 quantizeATCChannel( float value, uint32 bitCount )
+{
+    uint32 maxValue = ( ( 1u << bitCount ) - 1 );
+
+    float scaled = ( std::min( 255.0f, std::max( 0.0f, value ) ) * maxValue / 255.0f );
+
+    return (uint32)( scaled + 0.5f );
+}
+
+AINLINE uint32 getATCColorError( const uint8 *pixel, const uint32 color[3] )
+{
+    int32 redDiff = ( (int32)pixel[0] - (int32)color[0] );
+    int32 greenDiff = ( (int32)pixel[1] - (int32)color[1] );
+    int32 blueDiff = ( (int32)pixel[2] - (int32)color[2] );
+
+    return (uint32)( redDiff * redDiff + greenDiff * greenDiff + blueDiff * blueDiff );
+}
+
+#ifdef RWLIB_HAS_SSE2
+
+// Squared color distances of four pixels to one palette entry.
+// Alpha is cleared in both operands, so it does not count.
+AINLINE __m128i getATCColorErrorsSSE2( __m128i lowPixels, __m128i highPixels, __m128i paletteColor )
+{
+    __m128i lowDiff = _mm_sub_epi16( lowPixels, paletteColor );
+    __m128i highDiff = _mm_sub_epi16( highPixels, paletteColor );
+
+    // Every pixel ends up as ( r*r + g*g, b*b ) in two 32bit lanes.
+    __m128i lowSums = _mm_madd_epi16( lowDiff, lowDiff );
+    __m128i highSums = _mm_madd_epi16( highDiff, highDiff );
+
+    lowSums = _mm_add_epi32( lowSums, _mm_shuffle_epi32( lowSums, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    highSums = _mm_add_epi32( highSums, _mm_shuffle_epi32( highSums, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+    return _mm_castps_si128( _mm_shuffle_ps( _mm_castsi128_ps( lowSums ), _mm_castsi128_ps( highSums ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+}
+
+#endif //RWLIB_HAS_SSE2
+
+// Picks the closest palette entry for every pixel and returns the summed error.
+// This is the inner loop of the endpoint search; with SSE2 four pixels are matched at once.
+// Both paths pick the first palette entry of smallest error, so they produce the same blocks.
+inline uint32 findATCColorIndices( const atcEncodeBlock& block, const rgb555_atc& col0, const rgb565& col1, uint32& indexListOut )
+{
+    uint32 palette[4][3];
+
+    getATCColorPalette( col0, col1, palette );
+
+    uint32 indexList = 0;
+    uint32 totalError = 0;
+
+#ifdef RWLIB_HAS_SSE2
+    __m128i paletteColors[4];
+
+    for ( uint32 index = 0; index < 4; index++ )
+    {
+        short red = (short)palette[ index ][0];
+        short green = (short)palette[ index ][1];
+        short blue = (short)palette[ index ][2];
+
+        paletteColors[ index ] = _mm_setr_epi16( red, green, blue, 0, red, green, blue, 0 );
+    }
+
+    const __m128i colorMask = _mm_set1_epi32( 0x00FFFFFF );
+    const __m128i zero = _mm_setzero_si128();
+
+    for ( uint32 n = 0; n < 16; n += 4 )
+    {
+        __m128i pixels = _mm_and_si128( _mm_loadu_si128( (const __m128i*)block.pixels[ n ] ), colorMask );
+
+        __m128i lowPixels = _mm_unpacklo_epi8( pixels, zero );
+        __m128i highPixels = _mm_unpackhi_epi8( pixels, zero );
+
+        __m128i bestErrors = getATCColorErrorsSSE2( lowPixels, highPixels, paletteColors[0] );
+        __m128i bestIndices = zero;
+
+        for ( uint32 index = 1; index < 4; index++ )
+        {
+            __m128i errors = getATCColorErrorsSSE2( lowPixels, highPixels, paletteColors[ index ] );
+
+            // Errors stay below 2^18, so the signed compare is fine.
+            __m128i isBetter = _mm_cmplt_epi32( errors, bestErrors );
+
+            bestErrors = _mm_or_si128( _mm_and_si128( isBetter, errors ), _mm_andnot_si128( isBetter, bestErrors ) );
+            bestIndices = _mm_or_si128( _mm_and_si128( isBetter, _mm_set1_epi32( index ) ), _mm_andnot_si128( isBetter, bestIndices ) );
+        }
+
+        uint32 errorValues[4];
+        uint32 indexValues[4];
+
+        _mm_storeu_si128( (__m128i*)errorValues, bestErrors );
+        _mm_storeu_si128( (__m128i*)indexValues, bestIndices );
+
+        for ( uint32 lane = 0; lane < 4; lane++ )
+        {
+            if ( !block.isValid[ n + lane ] )
+                continue;
+
+            indexlist_put( indexList, n + lane, 2u, indexValues[ lane ] );
+
+            totalError += errorValues[ lane ];
+        }
+    }
+#else
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        if ( !block.isValid[ n ] )
+            continue;
+
+        uint32 bestIndex = 0;
+        uint32 bestError = 0xFFFFFFFF;
+
+        for ( uint32 index = 0; index < 4; index++ )
+        {
+            uint32 error = getATCColorError( block.pixels[ n ], palette[ index ] );
+
+            if ( error < bestError )
+            {
+                bestError = error;
+                bestIndex = index;
+            }
+        }
+
+        indexlist_put( indexList, n, 2u, bestIndex );
+
+        totalError += bestError;
+    }
+#endif //RWLIB_HAS_SSE2
+
+    indexListOut = indexList;
+
+    return totalError;
+}
+
+AINLINE rgb555_atc makeATCFirstEndpoint( const float color[3], bool isModeOne )
+{
+    rgb555_atc result;
+    result.red = quantizeATCChannel( color[0], 5 );
+    result.green = quantizeATCChannel( color[1], 5 );
+    result.blue = quantizeATCChannel( color[2], 5 );
+    result.mode = ( isModeOne ? 1 : 0 );
+
+    return result;
+}
+
+AINLINE rgb565 makeATCSecondEndpoint( const float color[3] )
+{
+    rgb565 result;
+    result.red = quantizeATCChannel( color[0], 5 );
+    result.green = quantizeATCChannel( color[1], 6 );
+    result.blue = quantizeATCChannel( color[2], 5 );
+
+    return result;
+}
+
+// Initial endpoints along the principal axis of the block colors.
+inline bool estimateATCColorEndpoints( const atcEncodeBlock& block, float lowOut[3], float highOut[3] )
+{
+    float mean[3] = { 0, 0, 0 };
+    uint32 validCount = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        if ( !block.isValid[ n ] )
+            continue;
+
+        for ( uint32 channel = 0; channel < 3; channel++ )
+        {
+            mean[ channel ] += block.pixels[ n ][ channel ];
+        }
+
+        validCount++;
+    }
+
+    if ( validCount == 0 )
+        return false;
+
+    for ( uint32 channel = 0; channel < 3; channel++ )
+    {
+        mean[ channel ] /= validCount;
+    }
+
+    float covariance[3][3] = { { 0 } };
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        if ( !block.isValid[ n ] )
+            continue;
+
+        float diff[3];
+
+        for ( uint32 channel = 0; channel < 3; channel++ )
+        {
+            diff[ channel ] = ( block.pixels[ n ][ channel ] - mean[ channel ] );
+        }
+
+        for ( uint32 row = 0; row < 3; row++ )
+        {
+            for ( uint32 column = 0; column < 3; column++ )
+            {
+                covariance[ row ][ column ] += diff[ row ] * diff[ column ];
+            }
+        }
+    }
+
+    // Power iteration for the dominant eigenvector.
+    float axis[3] = { 1, 1, 1 };
+
+    for ( uint32 iter = 0; iter < 8; iter++ )
+    {
+        float next[3];
+        float length = 0;
+
+        for ( uint32 row = 0; row < 3; row++ )
+        {
+            next[ row ] = ( covariance[ row ][0] * axis[0] + covariance[ row ][1] * axis[1] + covariance[ row ][2] * axis[2] );
+
+            length = std::max( length, std::abs( next[ row ] ) );
+        }
+
+        if ( length < 1e-6f )
+            break;
+
+        for ( uint32 row = 0; row < 3; row++ )
+        {
+            axis[ row ] = ( next[ row ] / length );
+        }
+    }
+
+    float minProj = 0, maxProj = 0;
+    bool hasProj = false;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        if ( !block.isValid[ n ] )
+            continue;
+
+        float proj = 0;
+
+        for ( uint32 channel = 0; channel < 3; channel++ )
+        {
+            proj += ( block.pixels[ n ][ channel ] - mean[ channel ] ) * axis[ channel ];
+        }
+
+        if ( !hasProj )
+        {
+            minProj = proj;
+            maxProj = proj;
+
+            hasProj = true;
+        }
+        else
+        {
+            minProj = std::min( minProj, proj );
+            maxProj = std::max( maxProj, proj );
+        }
+    }
+
+    float axisLengthSq = ( axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] );
+
+    for ( uint32 channel = 0; channel < 3; channel++ )
+    {
+        float axisPart = ( axisLengthSq > 0 ? axis[ channel ] / axisLengthSq : 0 );
+
+        lowOut[ channel ] = ( mean[ channel ] + axisPart * minProj );
+        highOut[ channel ] = ( mean[ channel ] + axisPart * maxProj );
+    }
+
+    return true;
+}
+
+// Solves the endpoints that best reproduce the block for fixed mode 0 indices.
+inline bool refitATCColorEndpoints( const atcEncodeBlock& block, uint32 indexList, float firstOut[3], float secondOut[3] )
+{
+    float a00 = 0, a01 = 0, a11 = 0;
+    float b0[3] = { 0, 0, 0 };
+    float b1[3] = { 0, 0, 0 };
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        if ( !block.isValid[ n ] )
+            continue;
+
+        float weight = atcModeZeroWeights[ indexlist_lookup( indexList, n, 2u ) ];
+        float invWeight = ( 1.0f - weight );
+
+        a00 += invWeight * invWeight;
+        a01 += invWeight * weight;
+        a11 += weight * weight;
+
+        for ( uint32 channel = 0; channel < 3; channel++ )
+        {
+            b0[ channel ] += invWeight * block.pixels[ n ][ channel ];
+            b1[ channel ] += weight * block.pixels[ n ][ channel ];
+        }
+    }
+
+    float det = ( a00 * a11 - a01 * a01 );
+
+    if ( std::abs( det ) < 1e-6f )
+        return false;
+
+    for ( uint32 channel = 0; channel < 3; channel++ )
+    {
+        firstOut[ channel ] = ( a11 * b0[ channel ] - a01 * b1[ channel ] ) / det;
+        secondOut[ channel ] = ( a00 * b1[ channel ] - a01 * b0[ channel ] ) / det;
+    }
+
+    return true;
+}
+
+inline void compressATCColorBlock( const atcEncodeBlock& block, atc_color_block <endian::little_endian>& blockOut )
+{
+    float low[3], high[3];
+
+    if ( !estimateATCColorEndpoints( block, low, high ) )
+    {
+        rgb555_atc col0;
+        col0.val = 0;
+
+        rgb565 col1;
+        col1.val = 0;
+
+        blockOut.col0 = col0;
+        blockOut.col1 = col1;
+        blockOut.indexList = 0;
+        return;
+    }
+
+    rgb555_atc bestCol0;
+    rgb565 bestCol1;
+    uint32 bestIndexList = 0;
+    uint32 bestError = 0xFFFFFFFF;
+
+    // Endpoints in the orientation of the best mode 0 candidate, for the refit.
+    float first[3] = { low[0], low[1], low[2] };
+    float second[3] = { high[0], high[1], high[2] };
+
+    auto tryEndpoints = [&]( const float *firstColor, const float *secondColor, bool isModeOne )
+    {
+        rgb555_atc col0 = makeATCFirstEndpoint( firstColor, isModeOne );
+        rgb565 col1 = makeATCSecondEndpoint( secondColor );
+
+        uint32 indexList;
+        uint32 error = findATCColorIndices( block, col0, col1, indexList );
+
+        if ( error < bestError )
+        {
+            bestError = error;
+            bestCol0 = col0;
+            bestCol1 = col1;
+            bestIndexList = indexList;
+
+            if ( !isModeOne )
+            {
+                for ( uint32 channel = 0; channel < 3; channel++ )
+                {
+                    first[ channel ] = firstColor[ channel ];
+                    second[ channel ] = secondColor[ channel ];
+                }
+            }
+        }
+
+        return error;
+    };
+
+    // The first endpoint has less green precision, so try both orientations.
+    tryEndpoints( low, high, false );
+    tryEndpoints( high, low, false );
+
+    for ( uint32 pass = 0; pass < ATC_REFINEMENT_PASSES && bestError != 0; pass++ )
+    {
+        if ( bestCol0.mode != 0 )
+            break;
+
+        float refitFirst[3], refitSecond[3];
+
+        if ( !refitATCColorEndpoints( block, bestIndexList, refitFirst, refitSecond ) )
+            break;
+
+        uint32 prevError = bestError;
+
+        tryEndpoints( refitFirst, refitSecond, false );
+
+        if ( bestError >= prevError )
+            break;
+    }
+
+    // Mode 1 can reach black and a darker shade, which suits blocks with dark detail.
+    if ( bestError != 0 )
+    {
+        tryEndpoints( low, high, true );
+        tryEndpoints( first, second, true );
+    }
+
+    blockOut.col0 = bestCol0;
+    blockOut.col1 = bestCol1;
+    blockOut.indexList = bestIndexList;
+}
+
+inline uint64 compressATCExplicitAlpha( const atcEncodeBlock& block )
+{
+    uint64 alphaList = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        uint64 alpha = ( ( (uint32)block.pixels[ n ][ 3 ] * 15 + 127 ) / 255 );
+
+        indexlist_put( alphaList, (uint64)n, (uint64)4, alpha );
+    }
+
+    return alphaList;
+}
+
+// Tries both DXT5 alpha palette layouts and keeps the better one.
+inline void compressATCInterpolatedAlpha( const atcEncodeBlock& block, atc_interpolated_block <endian::little_endian>& blockOut )
+{
+    uint32 minAlpha = 255, maxAlpha = 0;
+    uint32 innerMin = 255, innerMax = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        if ( !block.isValid[ n ] )
+            continue;
+
+        uint32 alpha = block.pixels[ n ][ 3 ];
+
+        minAlpha = std::min( minAlpha, alpha );
+        maxAlpha = std::max( maxAlpha, alpha );
+
+        // The six value layout has exact 0 and 255, so those do not need to be in range.
+        if ( alpha != 0 && alpha != 255 )
+        {
+            innerMin = std::min( innerMin, alpha );
+            innerMax = std::max( innerMax, alpha );
+        }
+    }
+
+    if ( minAlpha > maxAlpha )
+    {
+        minAlpha = maxAlpha = 255;
+    }
+
+    if ( innerMin > innerMax )
+    {
+        innerMin = minAlpha;
+        innerMax = maxAlpha;
+    }
+
+    uint64 bestIndices = 0;
+    uint32 bestError = 0xFFFFFFFF;
+    uint8 bestFirst = 0, bestSecond = 0;
+
+    auto tryEndpoints = [&]( uint8 first_alpha, uint8 second_alpha )
+    {
+        uint8 alphaPalette[8];
+
+        for ( uint32 n = 0; n < 8; n++ )
+        {
+            alphaPalette[ n ] = dxt4_5_block <endian::little_endian>::getAlphaByIndex( first_alpha, second_alpha, n );
+        }
+
+        uint64 indices = 0;
+        uint32 totalError = 0;
+
+        for ( uint32 n = 0; n < 16; n++ )
+        {
+            if ( !block.isValid[ n ] )
+                continue;
+
+            int32 alpha = block.pixels[ n ][ 3 ];
+
+            uint32 bestIndex = 0;
+            uint32 bestIndexError = 0xFFFFFFFF;
+
+            for ( uint32 index = 0; index < 8; index++ )
+            {
+                int32 diff = ( alpha - (int32)alphaPalette[ index ] );
+
+                uint32 error = (uint32)( diff * diff );
+
+                if ( error < bestIndexError )
+                {
+                    bestIndexError = error;
+                    bestIndex = index;
+                }
+            }
+
+            indexlist_put( indices, (uint64)n, (uint64)3, (uint64)bestIndex );
+
+            totalError += bestIndexError;
+        }
+
+        if ( totalError < bestError )
+        {
+            bestError = totalError;
+            bestIndices = indices;
+            bestFirst = first_alpha;
+            bestSecond = second_alpha;
+        }
+    };
+
+    // Eight value layout requires the first endpoint to be the greater one.
+    tryEndpoints( (uint8)maxAlpha, (uint8)minAlpha );
+
+    if ( bestError != 0 )
+    {
+        tryEndpoints( (uint8)innerMin, (uint8)innerMax );
+    }
+
+    blockOut.alphaPreMult[0] = bestFirst;
+    blockOut.alphaPreMult[1] = bestSecond;
+
+    for ( uint32 n = 0; n < 6; n++ )
+    {
+        blockOut.alphaList[ n ] = (uint8)( bestIndices >> ( n * 8 ) );
+    }
+}
+
+// Compresses 32bit RGBA texels with tightly packed rows into ATC blocks.
+// Blocks are independent, so every block row is encoded in parallel.
+inline void compressATC( Interface *engineInterface, eATCAlphaMode alphaMode, uint32 width, uint32 height, const void *srcTexels, void *dstData )
+{
+    uint32 blocksWide = ALIGN_SIZE( width, 4u ) / 4;
+    uint32 blocksHigh = ALIGN_SIZE( height, 4u ) / 4;
+
+    uint32 blockSize = getATCBlockSize( alphaMode );
+
+    const uint8 *srcPixels = (const uint8*)srcTexels;
+    uint8 *dstBlocks = (uint8*)dstData;
+
+    ParallelForEach( engineInterface, blocksHigh,
+        [&]( size_t blockY )
+    {
+        for ( uint32 blockX = 0; blockX < blocksWide; blockX++ )
+        {
+            atcEncodeBlock block;
+
+            for ( uint32 y = 0; y < 4; y++ )
+            {
+                for ( uint32 x = 0; x < 4; x++ )
+                {
+                    uint32 localIndex = getDXTLocalBlockIndex( x, y );
+
+                    uint32 pixelX = ( blockX * 4 + x );
+                    uint32 pixelY = ( (uint32)blockY * 4 + y );
+
+                    bool isValid = ( pixelX < width && pixelY < height );
+
+                    block.isValid[ localIndex ] = isValid;
+
+                    if ( isValid )
+                    {
+                        memcpy( block.pixels[ localIndex ], srcPixels + ( pixelY * width + pixelX ) * 4, 4 );
+                    }
+                    else
+                    {
+                        memset( block.pixels[ localIndex ], 255, 4 );
+                    }
+                }
+            }
+
+            void *dstBlock = ( dstBlocks + ( (uint32)blockY * blocksWide + blockX ) * blockSize );
+
+            if ( alphaMode == ATC_ALPHA_EXPLICIT )
+            {
+                atc_explicit_block <endian::little_endian>& outBlock = *(atc_explicit_block <endian::little_endian>*)dstBlock;
+
+                outBlock.alphaList = compressATCExplicitAlpha( block );
+
+                compressATCColorBlock( block, outBlock.colorBlock );
+            }
+            else if ( alphaMode == ATC_ALPHA_INTERPOLATED )
+            {
+                atc_interpolated_block <endian::little_endian>& outBlock = *(atc_interpolated_block <endian::little_endian>*)dstBlock;
+
+                compressATCInterpolatedAlpha( block, outBlock );
+
+                compressATCColorBlock( block, outBlock.colorBlock );
+            }
+            else
+            {
+                compressATCColorBlock( block, *(atc_color_block <endian::little_endian>*)dstBlock );
+            }
+        }
+    });
+}
+
+};
+
+};
+
+#endif //_RENDERWARE_ATC_CODEC_
@@ -6,6 +6,8 @@
 
 #include "txdread.atc.hxx"
 
+#include "txdread.atc.codec.hxx"
+
 #include "txdread.common.hxx"
 
 #include "streamutil.hxx"
@@ -234,51 +236,48 @@ void atcNativeTextureTypeProvider::DeserializeTexture( TextureBase *theTexture,
     engineInterface->DeserializeExtensions( theTexture, inputProvider );
 }
 
-inline CMP_FORMAT getAMDTCFormatFromInternalFormat( eATCInternalFormat internalFormat )
+inline atc::eATCAlphaMode getATCAlphaModeFromInternalFormat( eATCInternalFormat internalFormat )
 {
-    CMP_FORMAT actualFormat;
+    atc::eATCAlphaMode alphaMode = atc::ATC_ALPHA_NONE;
 
     if ( internalFormat == ATC_RGB_AMD )
     {
-        actualFormat = CMP_FORMAT_ATC_RGB;
+        alphaMode = atc::ATC_ALPHA_NONE;
     }
     else if ( internalFormat == ATC_RGBA_EXPLICIT_ALPHA_AMD )
     {
-        actualFormat = CMP_FORMAT_ATC_RGBA_Explicit;
+        alphaMode = atc::ATC_ALPHA_EXPLICIT;
     }
     else if ( internalFormat == ATC_RGBA_INTERPOLATED_ALPHA_AMD )
     {
-        actualFormat = CMP_FORMAT_ATC_RGBA_Interpolated;
+        alphaMode = atc::ATC_ALPHA_INTERPOLATED;
     }
     else
     {
         assert( 0 );
     }
 
-    return actualFormat;
+    return alphaMode;
 }
 
-inline void getAMDTCFormatTargetParams(
-    eATCInternalFormat internalFormat,CMP_FORMAT& requiredOutputCodec,
-    eRasterFormat& outputCodecRasterFormat, uint32& outputCodecDepth, eColorOrdering& outputCodecColorOrder
+// The codec works on tightly packed 32bit RGBA texels.
+inline void getATCCodecFormatParams(
+    eATCInternalFormat internalFormat,
+    eRasterFormat& codecRasterFormat, uint32& codecDepth, eColorOrdering& codecColorOrder
 )
 {
     if ( internalFormat == ATC_RGB_AMD )
     {
-        requiredOutputCodec = CMP_FORMAT_ARGB_8888;
-
-        outputCodecRasterFormat = RASTER_888;
-        outputCodecDepth = 32;
-        outputCodecColorOrder = COLOR_BGRA;
+        codecRasterFormat = RASTER_888;
+        codecDepth = 32;
+        codecColorOrder = COLOR_RGBA;
     }
     else if ( internalFormat == ATC_RGBA_EXPLICIT_ALPHA_AMD ||
               internalFormat == ATC_RGBA_INTERPOLATED_ALPHA_AMD )
     {
-        requiredOutputCodec = CMP_FORMAT_ARGB_8888;
-
-        outputCodecRasterFormat = RASTER_8888;
-        outputCodecDepth = 32;
-        outputCodecColorOrder = COLOR_BGRA;
+        codecRasterFormat = RASTER_8888;
+        codecDepth = 32;
+        codecColorOrder = COLOR_RGBA;
     }
     else
     {
@@ -289,55 +288,32 @@ inline void getAMDTCFormatTargetParams(
 // Pixel API.
 inline void DecompressATCMipmap(
     Interface *engineInterface,
-    uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels, uint32 srcDataSize,
+    uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels,
     eRasterFormat atcRasterFormat, uint32 atcDepth, eColorOrdering atcColorOrder,
     eRasterFormat targetRasterFormat, uint32 targetDepth, uint32 targetRowAlignment, eColorOrdering targetColorOrder,
-    CMP_FORMAT srcRasterATITCFormat, CMP_FORMAT dstRasterATITCFormat,
+    atc::eATCAlphaMode alphaMode,
     void*& dstTexelsOut, uint32& dstDataSizeOut
 )
 {
-    CMP_Texture srcTexture;
-    srcTexture.dwSize = sizeof( CMP_Texture );
-    srcTexture.dwWidth = mipWidth;
-    srcTexture.dwHeight = mipHeight;
-    srcTexture.dwPitch = 0;
-    srcTexture.format = srcRasterATITCFormat;
-    srcTexture.dwDataSize = srcDataSize;
-    srcTexture.pData = (CMP_BYTE*)srcTexels;
-
-    CMP_Texture dstTexture;
-    dstTexture.dwSize = sizeof( CMP_Texture );
-    dstTexture.dwWidth = mipWidth;
-    dstTexture.dwHeight = mipHeight;
-    dstTexture.dwPitch = 0;
-    dstTexture.format = dstRasterATITCFormat;
-    dstTexture.dwDataSize = CMP_CalculateBufferSize( &dstTexture );
-
-    void *atcTexels = engineInterface->PixelAllocate( dstTexture.dwDataSize );
-
-    dstTexture.pData = (CMP_BYTE*)atcTexels;
-
-    if ( !dstTexture.pData )
+    uint32 atcRowAlignment = getATCToolTextureDataRowAlignment();
+
+    uint32 atcDataSize = getRasterDataSizeByRowSize( getRasterDataRowSize( mipWidth, atcDepth, atcRowAlignment ), mipHeight );
+
+    void *atcTexels = engineInterface->PixelAllocate( atcDataSize );
+
+    if ( !atcTexels )
     {
-        throw RwException( "failed to allocate decompression surface buffer for AMDCompress decompression task" );
+        throw RwException( "failed to allocate decompression surface buffer for ATC decompression task" );
     }
 
     void *dstTexels = atcTexels;
-    uint32 dstDataSize = dstTexture.dwDataSize;
+    uint32 dstDataSize = atcDataSize;
 
     try
     {
-        // Decompress, wazaaa!
-        CMP_ERROR atcErrorCode = CMP_ConvertTexture( &srcTexture, &dstTexture, NULL, NULL, NULL, NULL );
-
-        if ( atcErrorCode != CMP_OK )
-        {
-            throw RwException( "failed to decompress AMDCompress native texture surface data" );
-        }
+        atc::decompressATC( engineInterface, alphaMode, mipWidth, mipHeight, srcTexels, atcTexels );
 
         // Put the texels into a format we want.
-        uint32 atcRowAlignment = getATCToolTextureDataRowAlignment();
-
         bool needsNewBuffer = shouldAllocateNewRasterBuffer( mipWidth, atcDepth, atcRowAlignment, targetDepth, targetRowAlignment );
 
         if ( atcRasterFormat != targetRasterFormat || mipWidth != layerWidth || mipHeight != layerHeight || needsNewBuffer || atcColorOrder != targetColorOrder )
@@ -412,17 +388,14 @@ void atcNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
 
     pixelsOut.mipmaps.resize( mipmapCount );
 
-    // Calculate the properties of the ATI TC source and destination textures.
-    CMP_FORMAT srcRasterATITCFormat = getAMDTCFormatFromInternalFormat( internalFormat );
+    atc::eATCAlphaMode alphaMode = getATCAlphaModeFromInternalFormat( internalFormat );
 
-    // Fetch format properties that are required as decompression destination surface.
+    // Fetch format properties of the decompression destination surface.
     eRasterFormat atcRasterFormat = RASTER_8888;
     uint32 atcDepth = 32;
     eColorOrdering atcColorOrder = COLOR_RGBA;
 
-    CMP_FORMAT dstRasterATITCFormat;
-
-    getAMDTCFormatTargetParams( internalFormat, dstRasterATITCFormat, atcRasterFormat, atcDepth, atcColorOrder );
+    getATCCodecFormatParams( internalFormat, atcRasterFormat, atcDepth, atcColorOrder );
 
     for ( uint32 n = 0; n < mipmapCount; n++ )
     {
@@ -450,10 +423,10 @@ void atcNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
         
         DecompressATCMipmap(
             engineInterface,
-            mipWidth, mipHeight, layerWidth, layerHeight, mipLayer.texels, mipLayer.dataSize,
+            mipWidth, mipHeight, layerWidth, layerHeight, mipLayer.texels,
             atcRasterFormat, atcDepth, atcColorOrder,
             targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
-            srcRasterATITCFormat, dstRasterATITCFormat,
+            alphaMode,
             mipTexels, texDataSize
         );
 
@@ -490,14 +463,14 @@ inline void CompressMipmapToATC(
     eRasterFormat srcRasterFormat, uint32 srcDepth, uint32 srcRowAlignment, eColorOrdering srcColorOrder, ePaletteType srcPaletteType, const void *srcPaletteData, uint32 srcPaletteSize,
     eRasterFormat feedRasterFormat, uint32 feedDepth, eColorOrdering feedColorOrder,
     uint32 compressionBlockSize,
-    CMP_FORMAT srcTextureFormat, CMP_FORMAT dstTextureFormat,
+    atc::eATCAlphaMode alphaMode,
     uint32& dstWidthOut, uint32& dstHeightOut,
     void*& dstTexelsOut, uint32& dstDataSizeOut
 )
 {
     uint32 srcLayerRowSize = getRasterDataRowSize( mipWidth, srcDepth, srcRowAlignment );
 
-    // Put this mipmap in a ATI_Compress compatible texture.
+    // Put this mipmap into the format of our encoder.
     uint32 feedLayerTexRowSize = getRasterDataRowSize( mipWidth, feedDepth, getATCToolTextureDataRowAlignment() );
 
     uint32 feedTextureDataSize = getRasterDataSizeByRowSize( feedLayerTexRowSize, mipHeight );
@@ -547,32 +520,7 @@ inline void CompressMipmapToATC(
         {
             // Compress the texture now.
             {
-                CMP_Texture srcTexture;
-                srcTexture.dwSize = sizeof( srcTexture );
-                srcTexture.dwWidth = mipWidth;
-                srcTexture.dwHeight = mipHeight;
-                srcTexture.dwPitch = 0;
-                srcTexture.format = srcTextureFormat;
-                srcTexture.dwDataSize = feedTextureDataSize;
-                srcTexture.pData = (CMP_BYTE*)feedTexels;
-
-                CMP_Texture dstTexture;
-                dstTexture.dwSize = sizeof( dstTexture );
-                dstTexture.dwWidth = mipWidth;
-                dstTexture.dwHeight = mipHeight;
-                dstTexture.dwPitch = 0;
-                dstTexture.format = dstTextureFormat;
-                dstTexture.dwDataSize = dstDataSize;
-                dstTexture.pData = (CMP_BYTE*)dstTexels;
-
-                // Do the conversion.
-                CMP_ERROR atcErrorCode =
-                    CMP_ConvertTexture( &srcTexture, &dstTexture, NULL, NULL, NULL, NULL );
-
-                if ( atcErrorCode != CMP_OK )
-                {
-                    throw RwException( "unknown error in ATC mipmap encoding" );
-                }
+                atc::compressATC( engineInterface, alphaMode, mipWidth, mipHeight, feedTexels, dstTexels );
 
                 // Return stuff.
                 outWidth = compressWidth;
@@ -656,13 +604,11 @@ void atcNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
         // Get the format that we will output the feed-in texture as.
         eRasterFormat feedRasterFormat = RASTER_8888;
         uint32 feedDepth = 32;
-        eColorOrdering feedColorOrder = COLOR_BGRA;
-
-        CMP_FORMAT srcTextureFormat;
+        eColorOrdering feedColorOrder = COLOR_RGBA;
 
-        getAMDTCFormatTargetParams( internalFormat, srcTextureFormat, feedRasterFormat, feedDepth, feedColorOrder );
+        getATCCodecFormatParams( internalFormat, feedRasterFormat, feedDepth, feedColorOrder );
 
-        CMP_FORMAT dstTextureFormat = getAMDTCFormatFromInternalFormat( internalFormat );
+        atc::eATCAlphaMode alphaMode = getATCAlphaModeFromInternalFormat( internalFormat );
 
         uint32 compressionBlockSize = getATCCompressionBlockSize( internalFormat );
 
@@ -693,7 +639,7 @@ void atcNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
                 srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder, srcPaletteType, srcPaletteData, srcPaletteSize,
                 feedRasterFormat, feedDepth, feedColorOrder,
                 compressionBlockSize,
-                srcTextureFormat, dstTextureFormat,
+                alphaMode,
                 compressWidth, compressHeight,
                 dstTexels, dstDataSize
             );
@@ -788,7 +734,6 @@ struct atcMipmapManager
         uint32 layerHeight = mipLayer.layerHeight;
 
         const void *srcTexels = mipLayer.texels;
-        uint32 srcDataSize = mipLayer.dataSize;
 
         // Decompress the texels into a good format.
         eRasterFormat targetRasterFormat = RASTER_8888;
@@ -802,11 +747,9 @@ struct atcMipmapManager
         uint32 atcDepth;
         eColorOrdering atcColorOrder;
 
-        CMP_FORMAT dstRasterATITCFormat;
+        getATCCodecFormatParams( internalFormat, atcRasterFormat, atcDepth, atcColorOrder );
 
-        getAMDTCFormatTargetParams( internalFormat, dstRasterATITCFormat, atcRasterFormat, atcDepth, atcColorOrder );
-
-        CMP_FORMAT srcRasterATITCFormat = getAMDTCFormatFromInternalFormat( internalFormat );
+        atc::eATCAlphaMode alphaMode = getATCAlphaModeFromInternalFormat( internalFormat );
 
         // Perform it.
         void *dstTexels = NULL;
@@ -814,10 +757,10 @@ struct atcMipmapManager
 
         DecompressATCMipmap(
             engineInterface,
-            mipWidth, mipHeight, layerWidth, layerHeight, srcTexels, srcDataSize,
+            mipWidth, mipHeight, layerWidth, layerHeight, srcTexels,
             atcRasterFormat, atcDepth, atcColorOrder,
             targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
-            srcRasterATITCFormat, dstRasterATITCFormat,
+            alphaMode,
             dstTexels, dstDataSize
         );
 
@@ -907,13 +850,11 @@ struct atcMipmapManager
         // Get the format that we will output the feed-in texture as.
         eRasterFormat feedRasterFormat = RASTER_8888;
         uint32 feedDepth = 32;
-        eColorOrdering feedColorOrder = COLOR_BGRA;
-
-        CMP_FORMAT srcTextureFormat;
+        eColorOrdering feedColorOrder = COLOR_RGBA;
 
-        getAMDTCFormatTargetParams( internalFormat, srcTextureFormat, feedRasterFormat, feedDepth, feedColorOrder );
+        getATCCodecFormatParams( internalFormat, feedRasterFormat, feedDepth, feedColorOrder );
 
-        CMP_FORMAT dstTextureFormat = getAMDTCFormatFromInternalFormat( internalFormat );
+        atc::eATCAlphaMode alphaMode = getATCAlphaModeFromInternalFormat( internalFormat );
 
         uint32 compressionBlockSize = getATCCompressionBlockSize( internalFormat );
 
@@ -929,7 +870,7 @@ struct atcMipmapManager
             rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteData, paletteSize,
             feedRasterFormat, feedDepth, feedColorOrder,
             compressionBlockSize,
-            srcTextureFormat, dstTextureFormat,
+            alphaMode,
             compressedWidth, compressedHeight,
             dstTexels, dstDataSize
         );
@@ -6,11 +6,6 @@
 
 #include "txdread.common.hxx"
 
-// AMDCompress does include windows.h
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-#include <Compressonator.h>
-
 #define PLATFORM_ATC    11
 
 namespace rw
@@ -19,8 +14,7 @@ namespace rw
 inline uint32 getATCToolTextureDataRowAlignment( void )
 {
     // Once again we have no row alignment in our stored texel data.
-    // But we have to pass texels to a compression tool, and this is what
-    // it most likely expects.
+    // The ATC codec works on 32bit texels, so its rows are always tightly packed.
     return 4;
 }
 
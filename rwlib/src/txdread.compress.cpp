@@ -16,7 +16,7 @@ void Raster::optimizeForLowEnd(float quality)
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -215,6 +215,7 @@ void Raster::compress( float quality )
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     // A pretty complicated algorithm that can be used to optimally compress rasters.
     // Currently this only supports DXT.
@@ -228,7 +229,7 @@ void Raster::compress( float quality )
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -317,6 +318,7 @@ void Raster::compressCustom(eCompressionType targetCompressionType)
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -327,7 +329,7 @@ void Raster::compressCustom(eCompressionType targetCompressionType)
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -354,7 +356,7 @@ bool Raster::isCompressed( void ) const
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -377,7 +379,7 @@ eCompressionType Raster::getCompressionFormat( void ) const
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
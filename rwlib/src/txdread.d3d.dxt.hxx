@@ -501,6 +501,8 @@ inline void compressTexelsUsingDXT(
     uint32& realWidthOut, uint32& realHeightOut
 )
 {
+    scoped_profile_zone profileZone( engineInterface, "DXT compress" );
+
     // Make sure the texture dimensions are aligned by 4.
     uint32 alignedMipWidth = ALIGN_SIZE( mipWidth, 4u );
     uint32 alignedMipHeight = ALIGN_SIZE( mipHeight, 4u );
@@ -682,6 +684,8 @@ inline bool genericDecompressTexelsUsingDXT(
     void*& dstTexelsOut, uint32& dstTexelsDataSizeOut
 )
 {
+    scoped_profile_zone profileZone( engineInterface, "DXT decompress" );
+
     // Allocate the new texel array.
 	uint32 rowSize = getRasterDataRowSize( texLayerWidth, putDepth, texRowAlignment );
 
@@ -5,9 +5,87 @@
 
 #include "txdread.d3d9.hxx"
 
+#include "rwthreading.parallel.hxx"
+
 namespace rw
 {
 
+// Returns whether the texels of an anonymous format texture can be handed out as RW texels without conversion.
+inline bool d3d9CanUseAnonymousTexelsInPlace( const NativeTextureD3D9 *platformTex, const d3dpublic::nativeTextureFormatHandler *formatHandler, uint32 rwDepth )
+{
+    if ( formatHandler->IsTextureDataRWCompatible() == false )
+        return false;
+
+    // Do not trust the handler with buffers that are too small for the RW representation.
+    for ( const NativeTextureD3D9::mipmapLayer& mipLayer : platformTex->mipmaps )
+    {
+        uint32 rwRowSize = getD3DRasterDataRowSize( mipLayer.layerWidth, rwDepth );
+
+        if ( mipLayer.dataSize < getRasterDataSizeByRowSize( rwRowSize, mipLayer.layerHeight ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Converts one layer of anonymous texels into the RW format of its format handler.
+// If the handler can convert rows separately, big layers are split into bands that are converted in parallel.
+inline void d3d9ConvertAnonymousLayerToRW(
+    Interface *engineInterface, const d3dpublic::nativeTextureFormatHandler *formatHandler,
+    const void *srcTexels, uint32 srcDataSize, uint32 mipWidth, uint32 mipHeight,
+    uint32 dstRowSize, void *dstTexels
+)
+{
+    // Keep bands big enough to be worth a thread.
+    const uint32 bandTargetSize = 256 * 1024;
+
+    uint32 rowsPerBand = std::max( 1u, bandTargetSize / std::max( 1u, dstRowSize ) );
+
+    uint32 bandCount = ( ( mipHeight + rowsPerBand - 1 ) / rowsPerBand );
+
+    if ( bandCount > 1 )
+    {
+        // The first band tells us whether the handler supports it at all.
+        bool canConvertRows =
+            formatHandler->ConvertRowsToRW(
+                srcTexels, mipWidth, mipHeight, dstRowSize, srcDataSize,
+                0, rowsPerBand,
+                dstTexels
+            );
+
+        if ( canConvertRows )
+        {
+            ParallelForEach( engineInterface, bandCount - 1,
+                [&]( size_t bandIndex )
+            {
+                uint32 firstRow = (uint32)( bandIndex + 1 ) * rowsPerBand;
+                uint32 rowCount = std::min( rowsPerBand, mipHeight - firstRow );
+
+                bool hasConverted =
+                    formatHandler->ConvertRowsToRW(
+                        srcTexels, mipWidth, mipHeight, dstRowSize, srcDataSize,
+                        firstRow, rowCount,
+                        dstTexels
+                    );
+
+                if ( !hasConverted )
+                {
+                    throw RwException( "Direct3D 9 native format handler failed to convert texel rows" );
+                }
+            });
+
+            return;
+        }
+    }
+
+    formatHandler->ConvertToRW(
+        srcTexels, mipWidth, mipHeight, dstRowSize, srcDataSize,
+        dstTexels
+    );
+}
+
 template <typename defaultedMipmapLayerType, typename mipmapVectorType>
 AINLINE void d3d9FetchPixelDataFromTexture(
     Interface *engineInterface,
@@ -57,9 +135,9 @@ AINLINE void d3d9FetchPixelDataFromTexture(
             dstPaletteData = NULL;
             dstPaletteSize = 0;
 
-            // We always newly allocate if there is a native format plugin.
-            // For simplicity sake.
-            isNewlyAllocated = true;
+            // We have to newly allocate if there is a native format plugin,
+            // unless its texels can be used in-place.
+            isNewlyAllocated = ( d3d9CanUseAnonymousTexelsInPlace( platformTex, useFormatHandler, dstDepth ) == false );
         }
         else
         {
@@ -106,29 +184,35 @@ AINLINE void d3d9FetchPixelDataFromTexture(
             mipWidth = layerWidth;
             mipHeight = layerHeight;
 
-            // Create a new storage pointer.
             uint32 dstRowSize = getD3DRasterDataRowSize( mipWidth, dstDepth );
 
-            texelDataSize = getRasterDataSizeByRowSize( dstRowSize, mipHeight );
-
-            void *newtexels = engineInterface->PixelAllocate( texelDataSize );
+            uint32 dstDataSize = getRasterDataSizeByRowSize( dstRowSize, mipHeight );
 
-            try
+            if ( isNewlyAllocated )
             {
-                // Ask the format handler to convert it to something useful.
-                useFormatHandler->ConvertToRW(
-                    srcTexels, mipWidth, mipHeight, dstRowSize, texelDataSize,
-                    newtexels
-                );
-            }
-            catch( ... )
-            {
-                engineInterface->PixelFree( newtexels );
-
-                throw;
+                // Create a new storage pointer.
+                void *newtexels = engineInterface->PixelAllocate( dstDataSize );
+
+                try
+                {
+                    // Ask the format handler to convert it to something useful.
+                    d3d9ConvertAnonymousLayerToRW(
+                        engineInterface, useFormatHandler,
+                        srcTexels, texelDataSize, mipWidth, mipHeight,
+                        dstRowSize, newtexels
+                    );
+                }
+                catch( ... )
+                {
+                    engineInterface->PixelFree( newtexels );
+
+                    throw;
+                }
+
+                srcTexels = newtexels;
             }
 
-            srcTexels = newtexels;
+            texelDataSize = dstDataSize;
         }
 
         defaultedMipmapLayerType newLayer;
@@ -18,7 +18,7 @@ bool DebugDrawMipmaps( Interface *engineInterface, Raster *debugRaster, Bitmap&
     if ( !platformTex )
         return false;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( debugRaster );
 
     if ( !texProvider )
         return false;
@@ -0,0 +1,1188 @@
+#ifndef _RENDERWARE_ETC_CODEC_
+#define _RENDERWARE_ETC_CODEC_
+
+// Ericsson texture compression (ETC1) and its OpenGL ES 3.0 successor ETC2.
+// Every 4x4 block is a big endian 64bit word. ETC1 splits the block into two halves that
+// each carry a base color and a luminance modifier table. ETC2 keeps that layout but hides
+// three more color modes in differential encodings that would overflow in ETC1, so ETC1 data
+// decodes the same under both. ETC2 RGBA puts an 8 byte EAC block for alpha in front.
+
+#include <algorithm>
+#include <cmath>
+
+#include "txdread.d3d.dxt.hxx"
+
+#include "rwthreading.parallel.hxx"
+
+#include "rwsimd.hxx"
+
+namespace rw
+{
+
+namespace etc
+{
+
+enum eETCCodecFormat
+{
+    ETC_CODEC_ETC1,
+    ETC_CODEC_ETC2_RGB,
+    ETC_CODEC_ETC2_RGBA         // EAC alpha block followed by an ETC2 color block
+};
+
+inline uint32 getETCBlockSize( eETCCodecFormat codecFormat )
+{
+    if ( codecFormat == ETC_CODEC_ETC2_RGBA )
+    {
+        return 16;
+    }
+
+    return 8;
+}
+
+// Luminance modifiers per table, in the order of the 2bit pixel indices.
+static const int32 etcModifierTables[8][4] =
+{
+    { 2, 8, -2, -8 },
+    { 5, 17, -5, -17 },
+    { 9, 29, -9, -29 },
+    { 13, 42, -13, -42 },
+    { 18, 60, -18, -60 },
+    { 24, 80, -24, -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 }
+};
+
+// Distances of the ETC2 T and H modes.
+static const int32 etcDistanceTable[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+// EAC alpha modifiers per table, negative ones first.
+static const int32 eacModifierTables[16][8] =
+{
+    { -3, -6, -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5, -8, -13, 1, 4, 7, 12 },
+    { -2, -4, -6, -13, 1, 3, 5, 12 },
+    { -3, -6, -8, -12, 2, 5, 7, 11 },
+    { -3, -7, -9, -11, 2, 6, 8, 10 },
+    { -4, -7, -8, -11, 3, 6, 7, 10 },
+    { -3, -5, -8, -11, 2, 4, 7, 10 },
+    { -2, -6, -8, -10, 1, 5, 7, 9 },
+    { -2, -5, -8, -10, 1, 4, 7, 9 },
+    { -2, -4, -8, -10, 1, 3, 7, 9 },
+    { -2, -5, -7, -10, 1, 4, 6, 9 },
+    { -3, -4, -7, -10, 2, 3, 6, 9 },
+    { -1, -2, -3, -10, 0, 1, 2, 9 },
+    { -4, -6, -8, -9, 3, 5, 7, 8 },
+    { -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+// Table 13 has a zero modifier, which is used for flat alpha.
+#define EAC_FLAT_TABLE          13
+
+// Bit positions count from the most significant bit of the block word, which is 63.
+AINLINE uint32 getETCBits( uint64 block, uint32 bitCount, uint32 highestBit )
+{
+    return (uint32)( ( block >> ( highestBit + 1 - bitCount ) ) & ( ( 1u << bitCount ) - 1 ) );
+}
+
+AINLINE void putETCBits( uint64& block, uint32 bitCount, uint32 highestBit, uint32 value )
+{
+    uint32 shift = ( highestBit + 1 - bitCount );
+    uint64 mask = ( ( (uint64)1 << bitCount ) - 1 );
+
+    block = ( ( block & ~( mask << shift ) ) | ( ( (uint64)value & mask ) << shift ) );
+}
+
+AINLINE int32 getETCSignedDelta( uint32 value )
+{
+    // 3bit two's complement.
+    return ( value >= 4 ? (int32)value - 8 : (int32)value );
+}
+
+AINLINE int32 expandETCChannel( uint32 value, uint32 bitCount )
+{
+    // Replicate the top bits into the free low bits.
+    return (int32)( ( value << ( 8 - bitCount ) ) | ( value >> ( bitCount * 2 - 8 ) ) );
+}
+
+AINLINE uint8 clampETCChannel( int32 value )
+{
+    return (uint8)std::min( 255, std::max( 0, value ) );
+}
+
+// Pixels are indexed column by column. The high bits of the index live in the upper half word.
+AINLINE uint32 getETCPixelBit( uint32 x, uint32 y )
+{
+    return ( x * 4 + y );
+}
+
+AINLINE uint32 getETCPixelIndex( uint64 block, uint32 x, uint32 y )
+{
+    uint32 pixelBit = getETCPixelBit( x, y );
+
+    return (uint32)( ( ( ( block >> ( pixelBit + 16 ) ) & 1 ) << 1 ) | ( ( block >> pixelBit ) & 1 ) );
+}
+
+AINLINE void putETCPixelIndex( uint32& selectors, uint32 x, uint32 y, uint32 index )
+{
+    uint32 pixelBit = getETCPixelBit( x, y );
+
+    selectors |= ( ( ( index >> 1 ) & 1 ) << ( pixelBit + 16 ) );
+    selectors |= ( ( index & 1 ) << pixelBit );
+}
+
+AINLINE bool isETCSubblockPixel( bool flip, uint32 subblock, uint32 x, uint32 y )
+{
+    // Unflipped blocks are split into a left and right half, flipped ones into top and bottom.
+    uint32 pixelSubblock = ( flip ? ( y >> 1 ) : ( x >> 1 ) );
+
+    return ( pixelSubblock == subblock );
+}
+
+AINLINE uint32 packETCTexel( uint32 red, uint32 green, uint32 blue, uint32 alpha )
+{
+    const uint8 texel[4] = { (uint8)red, (uint8)green, (uint8)blue, (uint8)alpha };
+
+    uint32 packed;
+    memcpy( &packed, texel, sizeof( packed ) );
+
+    return packed;
+}
+
+// *** Decoder ***
+
+// Resolves every pixel of a color block into RGB, in row-major order.
+// Modes with shared colors build a small palette first, so each pixel costs a table lookup.
+inline void decompressETCColorBlock( uint64 block, uint8 colorsOut[16][3] )
+{
+    int32 palettes[2][4][3];
+    bool flip = false;
+    bool isPaletteMode = true;
+
+    bool isDifferential = ( getETCBits( block, 1, 33 ) != 0 );
+
+    int32 redSum = 0, greenSum = 0, blueSum = 0;
+
+    if ( isDifferential )
+    {
+        redSum = ( (int32)getETCBits( block, 5, 63 ) + getETCSignedDelta( getETCBits( block, 3, 58 ) ) );
+        greenSum = ( (int32)getETCBits( block, 5, 55 ) + getETCSignedDelta( getETCBits( block, 3, 50 ) ) );
+        blueSum = ( (int32)getETCBits( block, 5, 47 ) + getETCSignedDelta( getETCBits( block, 3, 42 ) ) );
+    }
+
+    if ( isDifferential && ( redSum < 0 || redSum > 31 ) )
+    {
+        // T mode.
+        int32 first[3] =
+        {
+            expandETCChannel( ( getETCBits( block, 2, 60 ) << 2 ) | getETCBits( block, 2, 57 ), 4 ),
+            expandETCChannel( getETCBits( block, 4, 55 ), 4 ),
+            expandETCChannel( getETCBits( block, 4, 51 ), 4 )
+        };
+
+        int32 second[3] =
+        {
+            expandETCChannel( getETCBits( block, 4, 47 ), 4 ),
+            expandETCChannel( getETCBits( block, 4, 43 ), 4 ),
+            expandETCChannel( getETCBits( block, 4, 39 ), 4 )
+        };
+
+        int32 distance = etcDistanceTable[ ( getETCBits( block, 2, 35 ) << 1 ) | getETCBits( block, 1, 32 ) ];
+
+        for ( uint32 channel = 0; channel < 3; channel++ )
+        {
+            palettes[0][0][ channel ] = first[ channel ];
+            palettes[0][1][ channel ] = second[ channel ] + distance;
+            palettes[0][2][ channel ] = second[ channel ];
+            palettes[0][3][ channel ] = second[ channel ] - distance;
+        }
+    }
+    else if ( isDifferential && ( greenSum < 0 || greenSum > 31 ) )
+    {
+        // H mode.
+        uint32 first[3] =
+        {
+            getETCBits( block, 4, 62 ),
+            ( getETCBits( block, 3, 58 ) << 1 ) | getETCBits( block, 1, 52 ),
+            ( getETCBits( block, 1, 51 ) << 3 ) | getETCBits( block, 3, 49 )
+        };
+
+        uint32 second[3] =
+        {
+            getETCBits( block, 4, 46 ),
+            getETCBits( block, 4, 42 ),
+            getETCBits( block, 4, 38 )
+        };
+
+        // The lowest distance bit is implied by the order of the colors.
+        uint32 distanceIndex = ( ( getETCBits( block, 1, 34 ) << 2 ) | ( getETCBits( block, 1, 32 ) << 1 ) );
+
+        uint32 firstValue = ( ( first[0] << 8 ) | ( first[1] << 4 ) | first[2] );
+        uint32 secondValue = ( ( second[0] << 8 ) | ( second[1] << 4 ) | second[2] );
+
+        if ( firstValue >= secondValue )
+        {
+            distanceIndex |= 1;
+        }
+
+        int32 distance = etcDistanceTable[ distanceIndex ];
+
+        for ( uint32 channel = 0; channel < 3; channel++ )
+        {
+            int32 firstColor = expandETCChannel( first[ channel ], 4 );
+            int32 secondColor = expandETCChannel( second[ channel ], 4 );
+
+            palettes[0][0][ channel ] = firstColor + distance;
+            palettes[0][1][ channel ] = firstColor - distance;
+            palettes[0][2][ channel ] = secondColor + distance;
+            palettes[0][3][ channel ] = secondColor - distance;
+        }
+    }
+    else if ( isDifferential && ( blueSum < 0 || blueSum > 31 ) )
+    {
+        // Planar mode, every pixel is interpolated from three colors.
+        int32 origin[3] =
+        {
+            expandETCChannel( getETCBits( block, 6, 62 ), 6 ),
+            expandETCChannel( ( getETCBits( block, 1, 56 ) << 6 ) | getETCBits( block, 6, 54 ), 7 ),
+            expandETCChannel( ( getETCBits( block, 1, 48 ) << 5 ) | ( getETCBits( block, 2, 44 ) << 3 ) | getETCBits( block, 3, 41 ), 6 )
+        };
+
+        int32 horizontal[3] =
+        {
+            expandETCChannel( ( getETCBits( block, 5, 38 ) << 1 ) | getETCBits( block, 1, 32 ), 6 ),
+            expandETCChannel( getETCBits( block, 7, 31 ), 7 ),
+            expandETCChannel( getETCBits( block, 6, 24 ), 6 )
+        };
+
+        int32 vertical[3] =
+        {
+            expandETCChannel( getETCBits( block, 6, 18 ), 6 ),
+            expandETCChannel( getETCBits( block, 7, 12 ), 7 ),
+            expandETCChannel( getETCBits( block, 6, 5 ), 6 )
+        };
+
+        for ( uint32 y = 0; y < 4; y++ )
+        {
+            for ( uint32 x = 0; x < 4; x++ )
+            {
+                uint8 *color = colorsOut[ getDXTLocalBlockIndex( x, y ) ];
+
+                for ( uint32 channel = 0; channel < 3; channel++ )
+                {
+                    int32 value =
+                        ( (int32)x * ( horizontal[ channel ] - origin[ channel ] ) +
+                          (int32)y * ( vertical[ channel ] - origin[ channel ] ) +
+                          4 * origin[ channel ] + 2 ) >> 2;
+
+                    color[ channel ] = clampETCChannel( value );
+                }
+            }
+        }
+
+        isPaletteMode = false;
+    }
+    else
+    {
+        // Individual or differential ETC1 mode.
+        int32 baseColors[2][3];
+
+        for ( uint32 channel = 0; channel < 3; channel++ )
+        {
+            uint32 channelBit = ( 63 - channel * 8 );
+
+            if ( isDifferential )
+            {
+                uint32 firstValue = getETCBits( block, 5, channelBit );
+                int32 delta = getETCSignedDelta( getETCBits( block, 3, channelBit - 5 ) );
+
+                baseColors[0][ channel ] = expandETCChannel( firstValue, 5 );
+                baseColors[1][ channel ] = expandETCChannel( (uint32)( (int32)firstValue + delta ), 5 );
+            }
+            else
+            {
+                baseColors[0][ channel ] = expandETCChannel( getETCBits( block, 4, channelBit ), 4 );
+                baseColors[1][ channel ] = expandETCChannel( getETCBits( block, 4, channelBit - 4 ), 4 );
+            }
+        }
+
+        const int32 *modifiers[2] =
+        {
+            etcModifierTables[ getETCBits( block, 3, 39 ) ],
+            etcModifierTables[ getETCBits( block, 3, 36 ) ]
+        };
+
+        for ( uint32 subblock = 0; subblock < 2; subblock++ )
+        {
+            for ( uint32 index = 0; index < 4; index++ )
+            {
+                for ( uint32 channel = 0; channel < 3; channel++ )
+                {
+                    palettes[ subblock ][ index ][ channel ] = ( baseColors[ subblock ][ channel ] + modifiers[ subblock ][ index ] );
+                }
+            }
+        }
+
+        flip = ( getETCBits( block, 1, 32 ) != 0 );
+    }
+
+    if ( isPaletteMode )
+    {
+        // T and H modes only use the first palette.
+        bool hasSubblocks = ( !isDifferential || ( redSum >= 0 && redSum <= 31 && greenSum >= 0 && greenSum <= 31 ) );
+
+        uint8 clampedPalettes[2][4][3];
+
+        for ( uint32 subblock = 0; subblock < ( hasSubblocks ? 2u : 1u ); subblock++ )
+        {
+            for ( uint32 index = 0; index < 4; index++ )
+            {
+                for ( uint32 channel = 0; channel < 3; channel++ )
+                {
+                    clampedPalettes[ subblock ][ index ][ channel ] = clampETCChannel( palettes[ subblock ][ index ][ channel ] );
+                }
+            }
+        }
+
+        for ( uint32 y = 0; y < 4; y++ )
+        {
+            for ( uint32 x = 0; x < 4; x++ )
+            {
+                uint32 subblock = 0;
+
+                if ( hasSubblocks )
+                {
+                    subblock = ( flip ? ( y >> 1 ) : ( x >> 1 ) );
+                }
+
+                const uint8 *color = clampedPalettes[ subblock ][ getETCPixelIndex( block, x, y ) ];
+
+                memcpy( colorsOut[ getDXTLocalBlockIndex( x, y ) ], color, 3 );
+            }
+        }
+    }
+}
+
+// Resolves every alpha value of an EAC block, in row-major order.
+inline void decompressEACAlphaBlock( uint64 block, uint8 alphasOut[16] )
+{
+    int32 base = (int32)getETCBits( block, 8, 63 );
+    int32 multiplier = (int32)getETCBits( block, 4, 55 );
+
+    const int32 *modifiers = eacModifierTables[ getETCBits( block, 4, 51 ) ];
+
+    uint8 alphaPalette[8];
+
+    for ( uint32 n = 0; n < 8; n++ )
+    {
+        alphaPalette[ n ] = clampETCChannel( base + modifiers[ n ] * multiplier );
+    }
+
+    for ( uint32 y = 0; y < 4; y++ )
+    {
+        for ( uint32 x = 0; x < 4; x++ )
+        {
+            uint32 indexShift = ( 45 - getETCPixelBit( x, y ) * 3 );
+
+            alphasOut[ getDXTLocalBlockIndex( x, y ) ] = alphaPalette[ ( block >> indexShift ) & 0x7 ];
+        }
+    }
+}
+
+// Decodes a single block into 4x4 RGBA texels.
+inline void decompressETCBlock( eETCCodecFormat codecFormat, const void *blockData, uint32 texelsOut[16] )
+{
+    const endian::big_endian <uint64> *blockWords = (const endian::big_endian <uint64>*)blockData;
+
+    uint8 alphas[16];
+
+    uint64 colorBlock;
+
+    if ( codecFormat == ETC_CODEC_ETC2_RGBA )
+    {
+        decompressEACAlphaBlock( blockWords[0], alphas );
+
+        colorBlock = blockWords[1];
+    }
+    else
+    {
+        memset( alphas, 255, sizeof( alphas ) );
+
+        colorBlock = blockWords[0];
+    }
+
+    uint8 colors[16][3];
+
+    decompressETCColorBlock( colorBlock, colors );
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        texelsOut[ n ] = packETCTexel( colors[ n ][0], colors[ n ][1], colors[ n ][2], alphas[ n ] );
+    }
+}
+
+// Decodes ETC blocks into 32bit RGBA texels with tightly packed rows.
+inline void decompressETC( Interface *engineInterface, eETCCodecFormat codecFormat, uint32 width, uint32 height, const void *srcData, void *dstTexels )
+{
+    scoped_profile_zone profileZone( engineInterface, "ETC decompress" );
+
+    uint32 blocksWide = ALIGN_SIZE( width, 4u ) / 4;
+    uint32 blocksHigh = ALIGN_SIZE( height, 4u ) / 4;
+
+    uint32 blockSize = getETCBlockSize( codecFormat );
+
+    const uint8 *srcBlocks = (const uint8*)srcData;
+    uint8 *dstPixels = (uint8*)dstTexels;
+
+    ParallelForEach( engineInterface, blocksHigh,
+        [&]( size_t blockY )
+    {
+        uint32 firstRow = ( (uint32)blockY * 4 );
+        uint32 rowCount = std::min( 4u, height - firstRow );
+
+        for ( uint32 blockX = 0; blockX < blocksWide; blockX++ )
+        {
+            uint32 texels[16];
+
+            decompressETCBlock( codecFormat, srcBlocks + ( (uint32)blockY * blocksWide + blockX ) * blockSize, texels );
+
+            uint32 firstColumn = ( blockX * 4 );
+            uint32 columnCount = std::min( 4u, width - firstColumn );
+
+            for ( uint32 y = 0; y < rowCount; y++ )
+            {
+                memcpy(
+                    dstPixels + ( ( firstRow + y ) * width + firstColumn ) * 4,
+                    texels + getDXTLocalBlockIndex( 0, y ),
+                    columnCount * sizeof( uint32 )
+                );
+            }
+        }
+    });
+}
+
+// *** Encoder ***
+
+// Pixels of a block that is being encoded, in row-major order.
+// Pixels outside of the surface are not part of the fit.
+struct etcEncodeBlock
+{
+    uint8 pixels[16][4];
+    bool isValid[16];
+};
+
+// Best encoding of one half of an ETC1 style block.
+struct etcSubblockChoice
+{
+    int32 base[3];          // quantized base color
+    uint32 table;
+    uint32 selectors;       // pixel index bits of this half only
+    uint32 error;
+};
+
+AINLINE uint32 quantizeETCChannel( float value, uint32 bitCount )
+{
+    uint32 maxValue = ( ( 1u << bitCount ) - 1 );
+
+    float scaled = ( std::min( 255.0f, std::max( 0.0f, value ) ) * maxValue / 255.0f );
+
+    return (uint32)( scaled + 0.5f );
+}
+
+AINLINE uint32 getETCColorError( const uint8 *pixel, int32 red, int32 green, int32 blue )
+{
+    int32 redDiff = ( (int32)pixel[0] - (int32)clampETCChannel( red ) );
+    int32 greenDiff = ( (int32)pixel[1] - (int32)clampETCChannel( green ) );
+    int32 blueDiff = ( (int32)pixel[2] - (int32)clampETCChannel( blue ) );
+
+    return (uint32)( redDiff * redDiff + greenDiff * greenDiff + blueDiff * blueDiff );
+}
+
+#ifdef RWLIB_HAS_SSE2
+
+// The four clamped colors of a modifier table, two per vector with zero alpha.
+AINLINE void getETCTableColorsSSE2( const int32 baseColor[3], const int32 modifiers[4], __m128i colorsOut[2] )
+{
+    __m128i base = _mm_setr_epi16(
+        (short)baseColor[0], (short)baseColor[1], (short)baseColor[2], 0,
+        (short)baseColor[0], (short)baseColor[1], (short)baseColor[2], 0
+    );
+
+    const __m128i colorMask = _mm_setr_epi16( -1, -1, -1, 0, -1, -1, -1, 0 );
+
+    for ( uint32 n = 0; n < 2; n++ )
+    {
+        short firstModifier = (short)modifiers[ n * 2 ];
+        short secondModifier = (short)modifiers[ n * 2 + 1 ];
+
+        __m128i colors = _mm_add_epi16( base, _mm_setr_epi16( firstModifier, firstModifier, firstModifier, 0, secondModifier, secondModifier, secondModifier, 0 ) );
+
+        colors = _mm_min_epi16( _mm_max_epi16( colors, _mm_setzero_si128() ), _mm_set1_epi16( 255 ) );
+
+        colorsOut[ n ] = _mm_and_si128( colors, colorMask );
+    }
+}
+
+// Same as getETCColorError for all four colors of a modifier table.
+AINLINE void getETCTableErrorsSSE2( const uint8 *pixel, const __m128i tableColors[2], uint32 errorsOut[4] )
+{
+    uint32 packed;
+    memcpy( &packed, pixel, sizeof( packed ) );
+
+    __m128i channels = _mm_unpacklo_epi8( _mm_cvtsi32_si128( (int)( packed & 0x00FFFFFF ) ), _mm_setzero_si128() );
+
+    channels = _mm_unpacklo_epi64( channels, channels );
+
+    __m128i lowDiff = _mm_sub_epi16( tableColors[0], channels );
+    __m128i highDiff = _mm_sub_epi16( tableColors[1], channels );
+
+    __m128i lowSums = _mm_madd_epi16( lowDiff, lowDiff );
+    __m128i highSums = _mm_madd_epi16( highDiff, highDiff );
+
+    lowSums = _mm_add_epi32( lowSums, _mm_shuffle_epi32( lowSums, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    highSums = _mm_add_epi32( highSums, _mm_shuffle_epi32( highSums, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+    __m128i errors = _mm_castps_si128( _mm_shuffle_ps( _mm_castsi128_ps( lowSums ), _mm_castsi128_ps( highSums ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+
+    _mm_storeu_si128( (__m128i*)errorsOut, errors );
+}
+
+#endif //RWLIB_HAS_SSE2
+
+// Picks the modifier table and pixel indices that reproduce a half block best for a base color.
+// This is the innermost loop of the encoder; with SSE2 the four colors of a table are matched at once.
+inline uint32 fitETCSubblockTables( const etcEncodeBlock& block, bool flip, uint32 subblock, const int32 baseColor[3], uint32& tableOut, uint32& selectorsOut )
+{
+    uint32 bestError = 0xFFFFFFFF;
+    uint32 bestTable = 0;
+    uint32 bestSelectors = 0;
+
+    for ( uint32 table = 0; table < 8; table++ )
+    {
+        const int32 *modifiers = etcModifierTables[ table ];
+
+#ifdef RWLIB_HAS_SSE2
+        __m128i tableColors[2];
+
+        getETCTableColorsSSE2( baseColor, modifiers, tableColors );
+#endif //RWLIB_HAS_SSE2
+
+        uint32 error = 0;
+        uint32 selectors = 0;
+
+        for ( uint32 y = 0; y < 4 && error < bestError; y++ )
+        {
+            for ( uint32 x = 0; x < 4; x++ )
+            {
+                uint32 localIndex = getDXTLocalBlockIndex( x, y );
+
+                if ( !block.isValid[ localIndex ] || !isETCSubblockPixel( flip, subblock, x, y ) )
+                    continue;
+
+                const uint8 *pixel = block.pixels[ localIndex ];
+
+                uint32 bestIndex = 0;
+                uint32 bestIndexError = 0xFFFFFFFF;
+
+#ifdef RWLIB_HAS_SSE2
+                uint32 indexErrors[4];
+
+                getETCTableErrorsSSE2( pixel, tableColors, indexErrors );
+#endif //RWLIB_HAS_SSE2
+
+                for ( uint32 index = 0; index < 4; index++ )
+                {
+#ifdef RWLIB_HAS_SSE2
+                    uint32 indexError = indexErrors[ index ];
+#else
+                    int32 modifier = modifiers[ index ];
+
+                    uint32 indexError = getETCColorError( pixel, baseColor[0] + modifier, baseColor[1] + modifier, baseColor[2] + modifier );
+#endif //RWLIB_HAS_SSE2
+
+                    if ( indexError < bestIndexError )
+                    {
+                        bestIndexError = indexError;
+                        bestIndex = index;
+                    }
+                }
+
+                putETCPixelIndex( selectors, x, y, bestIndex );
+
+                error += bestIndexError;
+            }
+        }
+
+        if ( error < bestError )
+        {
+            bestError = error;
+            bestTable = table;
+            bestSelectors = selectors;
+        }
+    }
+
+    tableOut = bestTable;
+    selectorsOut = bestSelectors;
+
+    return bestError;
+}
+
+// Quantized values of one base color channel that are worth trying.
+// The search depth is what the quality tiers differ in.
+inline uint32 getETCBaseCandidates( float average, uint32 bitCount, eETCCompressionQuality quality, int32 candidatesOut[4] )
+{
+    int32 maxValue = ( ( 1 << bitCount ) - 1 );
+
+    float scaled = ( average * maxValue / 255.0f );
+
+    int32 lower = (int32)std::floor( scaled );
+
+    uint32 candidateCount = 0;
+
+    if ( quality == ETCQUALITY_FAST )
+    {
+        candidatesOut[ candidateCount++ ] = (int32)( scaled + 0.5f );
+    }
+    else if ( quality == ETCQUALITY_NORMAL )
+    {
+        candidatesOut[ candidateCount++ ] = lower;
+        candidatesOut[ candidateCount++ ] = lower + 1;
+    }
+    else
+    {
+        candidatesOut[ candidateCount++ ] = lower - 1;
+        candidatesOut[ candidateCount++ ] = lower;
+        candidatesOut[ candidateCount++ ] = lower + 1;
+        candidatesOut[ candidateCount++ ] = lower + 2;
+    }
+
+    for ( uint32 n = 0; n < candidateCount; n++ )
+    {
+        candidatesOut[ n ] = std::min( maxValue, std::max( 0, candidatesOut[ n ] ) );
+    }
+
+    return candidateCount;
+}
+
+// Searches the base color of one half block.
+// In differential mode one half is fit freely and the other one has to stay within the delta range of it.
+inline void searchETCSubblock(
+    const etcEncodeBlock& block, bool flip, uint32 subblock, uint32 bitCount, eETCCompressionQuality quality,
+    const int32 *otherBase, etcSubblockChoice& choiceOut
+)
+{
+    float average[3] = { 0, 0, 0 };
+    uint32 validCount = 0;
+
+    for ( uint32 y = 0; y < 4; y++ )
+    {
+        for ( uint32 x = 0; x < 4; x++ )
+        {
+            uint32 localIndex = getDXTLocalBlockIndex( x, y );
+
+            if ( !block.isValid[ localIndex ] || !isETCSubblockPixel( flip, subblock, x, y ) )
+                continue;
+
+            for ( uint32 channel = 0; channel < 3; channel++ )
+            {
+                average[ channel ] += block.pixels[ localIndex ][ channel ];
+            }
+
+            validCount++;
+        }
+    }
+
+    if ( validCount != 0 )
+    {
+        for ( uint32 channel = 0; channel < 3; channel++ )
+        {
+            average[ channel ] /= validCount;
+        }
+    }
+
+    int32 candidates[3][4];
+    uint32 candidateCounts[3];
+
+    for ( uint32 channel = 0; channel < 3; channel++ )
+    {
+        candidateCounts[ channel ] = getETCBaseCandidates( average[ channel ], bitCount, quality, candidates[ channel ] );
+
+        if ( otherBase )
+        {
+            // The delta is stored from the first half to the second one.
+            int32 lowest = ( subblock == 1 ? otherBase[ channel ] - 4 : otherBase[ channel ] - 3 );
+            int32 highest = ( subblock == 1 ? otherBase[ channel ] + 3 : otherBase[ channel ] + 4 );
+
+            for ( uint32 n = 0; n < candidateCounts[ channel ]; n++ )
+            {
+                candidates[ channel ][ n ] = std::min( highest, std::max( lowest, candidates[ channel ][ n ] ) );
+            }
+        }
+    }
+
+    choiceOut.error = 0xFFFFFFFF;
+
+    for ( uint32 redIter = 0; redIter < candidateCounts[0]; redIter++ )
+    {
+        for ( uint32 greenIter = 0; greenIter < candidateCounts[1]; greenIter++ )
+        {
+            for ( uint32 blueIter = 0; blueIter < candidateCounts[2]; blueIter++ )
+            {
+                int32 base[3] = { candidates[0][ redIter ], candidates[1][ greenIter ], candidates[2][ blueIter ] };
+
+                int32 baseColor[3];
+
+                for ( uint32 channel = 0; channel < 3; channel++ )
+                {
+                    baseColor[ channel ] = expandETCChannel( (uint32)base[ channel ], bitCount );
+                }
+
+                uint32 table, selectors;
+                uint32 error = fitETCSubblockTables( block, flip, subblock, baseColor, table, selectors );
+
+                if ( error < choiceOut.error )
+                {
+                    for ( uint32 channel = 0; channel < 3; channel++ )
+                    {
+                        choiceOut.base[ channel ] = base[ channel ];
+                    }
+
+                    choiceOut.table = table;
+                    choiceOut.selectors = selectors;
+                    choiceOut.error = error;
+                }
+
+                if ( error == 0 )
+                    return;
+            }
+        }
+    }
+}
+
+inline uint64 makeETCSubblockWord( bool isDifferential, bool flip, const etcSubblockChoice& first, const etcSubblockChoice& second )
+{
+    uint64 block = 0;
+
+    for ( uint32 channel = 0; channel < 3; channel++ )
+    {
+        uint32 channelBit = ( 63 - channel * 8 );
+
+        if ( isDifferential )
+        {
+            putETCBits( block, 5, channelBit, (uint32)first.base[ channel ] );
+            putETCBits( block, 3, channelBit - 5, (uint32)( second.base[ channel ] - first.base[ channel ] ) );
+        }
+        else
+        {
+            putETCBits( block, 4, channelBit, (uint32)first.base[ channel ] );
+            putETCBits( block, 4, channelBit - 4, (uint32)second.base[ channel ] );
+        }
+    }
+
+    putETCBits( block, 3, 39, first.table );
+    putETCBits( block, 3, 36, second.table );
+    putETCBits( block, 1, 33, ( isDifferential ? 1 : 0 ) );
+    putETCBits( block, 1, 32, ( flip ? 1 : 0 ) );
+
+    block |= ( first.selectors | second.selectors );
+
+    return block;
+}
+
+inline uint32 getETCColorBlockError( const etcEncodeBlock& block, uint64 colorBlock )
+{
+    uint8 colors[16][3];
+
+    decompressETCColorBlock( colorBlock, colors );
+
+    uint32 error = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        if ( block.isValid[ n ] )
+        {
+            error += getETCColorError( block.pixels[ n ], colors[ n ][0], colors[ n ][1], colors[ n ][2] );
+        }
+    }
+
+    return error;
+}
+
+// Fits a plane through every color channel and stores it as ETC2 planar block.
+// Returns false if the valid pixels cannot define a plane.
+inline bool makeETCPlanarBlock( const etcEncodeBlock& block, uint64& blockOut )
+{
+    float n = 0, sumX = 0, sumY = 0, sumXX = 0, sumYY = 0, sumXY = 0;
+    float sumC[3] = { 0, 0, 0 };
+    float sumXC[3] = { 0, 0, 0 };
+    float sumYC[3] = { 0, 0, 0 };
+
+    for ( uint32 y = 0; y < 4; y++ )
+    {
+        for ( uint32 x = 0; x < 4; x++ )
+        {
+            uint32 localIndex = getDXTLocalBlockIndex( x, y );
+
+            if ( !block.isValid[ localIndex ] )
+                continue;
+
+            float fx = (float)x;
+            float fy = (float)y;
+
+            n += 1;
+            sumX += fx;
+            sumY += fy;
+            sumXX += fx * fx;
+            sumYY += fy * fy;
+            sumXY += fx * fy;
+
+            for ( uint32 channel = 0; channel < 3; channel++ )
+            {
+                float value = block.pixels[ localIndex ][ channel ];
+
+                sumC[ channel ] += value;
+                sumXC[ channel ] += fx * value;
+                sumYC[ channel ] += fy * value;
+            }
+        }
+    }
+
+    // Least squares through Cramer's rule.
+    float det =
+        n * ( sumXX * sumYY - sumXY * sumXY ) -
+        sumX * ( sumX * sumYY - sumXY * sumY ) +
+        sumY * ( sumX * sumXY - sumXX * sumY );
+
+    if ( std::abs( det ) < 1e-3f )
+        return false;
+
+    uint32 origin[3], horizontal[3], vertical[3];
+
+    for ( uint32 channel = 0; channel < 3; channel++ )
+    {
+        float c = sumC[ channel ], xc = sumXC[ channel ], yc = sumYC[ channel ];
+
+        float constant =
+            ( c * ( sumXX * sumYY - sumXY * sumXY ) -
+              sumX * ( xc * sumYY - sumXY * yc ) +
+              sumY * ( xc * sumXY - sumXX * yc ) ) / det;
+
+        float slopeX =
+            ( n * ( xc * sumYY - sumXY * yc ) -
+              c * ( sumX * sumYY - sumXY * sumY ) +
+              sumY * ( sumX * yc - xc * sumY ) ) / det;
+
+        float slopeY =
+            ( n * ( sumXX * yc - xc * sumXY ) -
+              sumX * ( sumX * yc - xc * sumY ) +
+              c * ( sumX * sumXY - sumXX * sumY ) ) / det;
+
+        uint32 bitCount = ( channel == 1 ? 7 : 6 );
+
+        origin[ channel ] = quantizeETCChannel( constant, bitCount );
+        horizontal[ channel ] = quantizeETCChannel( constant + 4 * slopeX, bitCount );
+        vertical[ channel ] = quantizeETCChannel( constant + 4 * slopeY, bitCount );
+    }
+
+    uint64 planarBlock = 0;
+
+    putETCBits( planarBlock, 6, 62, origin[0] );
+    putETCBits( planarBlock, 1, 56, origin[1] >> 6 );
+    putETCBits( planarBlock, 6, 54, origin[1] );
+    putETCBits( planarBlock, 1, 48, origin[2] >> 5 );
+    putETCBits( planarBlock, 2, 44, origin[2] >> 3 );
+    putETCBits( planarBlock, 3, 41, origin[2] );
+    putETCBits( planarBlock, 5, 38, horizontal[0] >> 1 );
+    putETCBits( planarBlock, 1, 33, 1 );
+    putETCBits( planarBlock, 1, 32, horizontal[0] );
+    putETCBits( planarBlock, 7, 31, horizontal[1] );
+    putETCBits( planarBlock, 6, 24, horizontal[2] );
+    putETCBits( planarBlock, 6, 18, vertical[0] );
+    putETCBits( planarBlock, 7, 12, vertical[1] );
+    putETCBits( planarBlock, 6, 5, vertical[2] );
+
+    // The free bits have to make red and green decode in range while blue overflows.
+    if ( (int32)getETCBits( planarBlock, 5, 63 ) + getETCSignedDelta( getETCBits( planarBlock, 3, 58 ) ) < 0 )
+    {
+        putETCBits( planarBlock, 1, 63, 1 );
+    }
+
+    if ( (int32)getETCBits( planarBlock, 5, 55 ) + getETCSignedDelta( getETCBits( planarBlock, 3, 50 ) ) < 0 )
+    {
+        putETCBits( planarBlock, 1, 55, 1 );
+    }
+
+    if ( getETCBits( planarBlock, 2, 44 ) + getETCBits( planarBlock, 2, 41 ) < 4 )
+    {
+        // Small base with a negative delta.
+        putETCBits( planarBlock, 1, 42, 1 );
+    }
+    else
+    {
+        // Big base with a positive delta.
+        putETCBits( planarBlock, 3, 47, 7 );
+    }
+
+    blockOut = planarBlock;
+    return true;
+}
+
+// Encodes the color of a block. ETC1 output only uses the individual and differential modes.
+inline uint64 compressETCColorBlock( const etcEncodeBlock& block, bool allowETC2, eETCCompressionQuality quality )
+{
+    uint64 bestBlock = 0;
+    uint32 bestError = 0xFFFFFFFF;
+
+    for ( uint32 flipIter = 0; flipIter < 2 && bestError != 0; flipIter++ )
+    {
+        bool flip = ( flipIter != 0 );
+
+        // Individual mode has two independent 444 base colors.
+        {
+            etcSubblockChoice first, second;
+
+            searchETCSubblock( block, flip, 0, 4, quality, NULL, first );
+            searchETCSubblock( block, flip, 1, 4, quality, NULL, second );
+
+            uint32 error = ( first.error + second.error );
+
+            if ( error < bestError )
+            {
+                bestError = error;
+                bestBlock = makeETCSubblockWord( false, flip, first, second );
+            }
+        }
+
+        // Differential mode has a 555 base color and a small delta to it.
+        // Either half can be the one that is fit freely.
+        for ( uint32 freeSubblock = 0; freeSubblock < 2 && bestError != 0; freeSubblock++ )
+        {
+            if ( freeSubblock == 1 && quality == ETCQUALITY_FAST )
+                break;
+
+            etcSubblockChoice choices[2];
+
+            searchETCSubblock( block, flip, freeSubblock, 5, quality, NULL, choices[ freeSubblock ] );
+            searchETCSubblock( block, flip, 1 - freeSubblock, 5, quality, choices[ freeSubblock ].base, choices[ 1 - freeSubblock ] );
+
+            uint32 error = ( choices[0].error + choices[1].error );
+
+            if ( error < bestError )
+            {
+                bestError = error;
+                bestBlock = makeETCSubblockWord( true, flip, choices[0], choices[1] );
+            }
+        }
+    }
+
+    // Smooth gradients are served much better by the planar mode.
+    if ( allowETC2 && quality != ETCQUALITY_FAST && bestError != 0 )
+    {
+        uint64 planarBlock;
+
+        if ( makeETCPlanarBlock( block, planarBlock ) )
+        {
+            uint32 error = getETCColorBlockError( block, planarBlock );
+
+            if ( error < bestError )
+            {
+                bestError = error;
+                bestBlock = planarBlock;
+            }
+        }
+    }
+
+    return bestBlock;
+}
+
+// Encodes the alpha of a block as EAC.
+inline uint64 compressEACAlphaBlock( const etcEncodeBlock& block, eETCCompressionQuality quality )
+{
+    int32 minAlpha = 255, maxAlpha = 0;
+
+    for ( uint32 n = 0; n < 16; n++ )
+    {
+        if ( !block.isValid[ n ] )
+            continue;
+
+        int32 alpha = block.pixels[ n ][ 3 ];
+
+        minAlpha = std::min( minAlpha, alpha );
+        maxAlpha = std::max( maxAlpha, alpha );
+    }
+
+    if ( minAlpha > maxAlpha )
+    {
+        minAlpha = maxAlpha = 255;
+    }
+
+    uint64 bestBlock = 0;
+    uint32 bestError = 0xFFFFFFFF;
+
+    auto tryEncoding = [&]( int32 base, int32 multiplier, uint32 table )
+    {
+        if ( base < 0 || base > 255 || multiplier < 1 || multiplier > 15 )
+            return;
+
+        const int32 *modifiers = eacModifierTables[ table ];
+
+        uint8 alphaPalette[8];
+
+        for ( uint32 n = 0; n < 8; n++ )
+        {
+            alphaPalette[ n ] = clampETCChannel( base + modifiers[ n ] * multiplier );
+        }
+
+        uint64 alphaBlock = 0;
+
+        putETCBits( alphaBlock, 8, 63, (uint32)base );
+        putETCBits( alphaBlock, 4, 55, (uint32)multiplier );
+        putETCBits( alphaBlock, 4, 51, table );
+
+        uint32 error = 0;
+
+        for ( uint32 y = 0; y < 4 && error < bestError; y++ )
+        {
+            for ( uint32 x = 0; x < 4; x++ )
+            {
+                uint32 localIndex = getDXTLocalBlockIndex( x, y );
+
+                int32 alpha = ( block.isValid[ localIndex ] ? block.pixels[ localIndex ][ 3 ] : alphaPalette[0] );
+
+                uint32 bestIndex = 0;
+                uint32 bestIndexError = 0xFFFFFFFF;
+
+                for ( uint32 index = 0; index < 8; index++ )
+                {
+                    int32 diff = ( alpha - (int32)alphaPalette[ index ] );
+
+                    uint32 indexError = (uint32)( diff * diff );
+
+                    if ( indexError < bestIndexError )
+                    {
+                        bestIndexError = indexError;
+                        bestIndex = index;
+                    }
+                }
+
+                alphaBlock |= ( (uint64)bestIndex << ( 45 - getETCPixelBit( x, y ) * 3 ) );
+
+                error += bestIndexError;
+            }
+        }
+
+        if ( error < bestError )
+        {
+            bestError = error;
+            bestBlock = alphaBlock;
+        }
+    };
+
+    // Flat alpha is stored exactly.
+    if ( minAlpha == maxAlpha )
+    {
+        tryEncoding( minAlpha, 1, EAC_FLAT_TABLE );
+
+        return bestBlock;
+    }
+
+    int32 searchRadius = 0;
+
+    if ( quality == ETCQUALITY_NORMAL )
+    {
+        searchRadius = 1;
+    }
+    else if ( quality == ETCQUALITY_HIGH )
+    {
+        searchRadius = 2;
+    }
+
+    for ( uint32 table = 0; table < 16 && bestError != 0; table++ )
+    {
+        const int32 *modifiers = eacModifierTables[ table ];
+
+        // Span the alpha range with the outermost modifiers of the table.
+        int32 modifierRange = ( modifiers[7] - modifiers[3] );
+
+        int32 multiplier = std::max( 1, ( maxAlpha - minAlpha + modifierRange / 2 ) / modifierRange );
+        int32 base = ( minAlpha - modifiers[3] * multiplier );
+
+        for ( int32 multiplierOffset = -searchRadius; multiplierOffset <= searchRadius; multiplierOffset++ )
+        {
+            for ( int32 baseOffset = -searchRadius; baseOffset <= searchRadius; baseOffset++ )
+            {
+                tryEncoding( std::min( 255, std::max( 0, base + baseOffset ) ), std::min( 15, multiplier + multiplierOffset ), table );
+            }
+        }
+    }
+
+    return bestBlock;
+}
+
+// Compresses 32bit RGBA texels with tightly packed rows into ETC blocks.
+// Blocks are independent, so every block row is encoded in parallel.
+inline void compressETC( Interface *engineInterface, eETCCodecFormat codecFormat, eETCCompressionQuality quality, uint32 width, uint32 height, const void *srcTexels, void *dstData )
+{
+    scoped_profile_zone profileZone( engineInterface, "ETC compress" );
+
+    uint32 blocksWide = ALIGN_SIZE( width, 4u ) / 4;
+    uint32 blocksHigh = ALIGN_SIZE( height, 4u ) / 4;
+
+    uint32 blockSize = getETCBlockSize( codecFormat );
+
+    bool allowETC2 = ( codecFormat != ETC_CODEC_ETC1 );
+
+    const uint8 *srcPixels = (const uint8*)srcTexels;
+    uint8 *dstBlocks = (uint8*)dstData;
+
+    ParallelForEach( engineInterface, blocksHigh,
+        [&]( size_t blockY )
+    {
+        for ( uint32 blockX = 0; blockX < blocksWide; blockX++ )
+        {
+            etcEncodeBlock block;
+
+            for ( uint32 y = 0; y < 4; y++ )
+            {
+                for ( uint32 x = 0; x < 4; x++ )
+                {
+                    uint32 localIndex = getDXTLocalBlockIndex( x, y );
+
+                    uint32 pixelX = ( blockX * 4 + x );
+                    uint32 pixelY = ( (uint32)blockY * 4 + y );
+
+                    bool isValid = ( pixelX < width && pixelY < height );
+
+                    block.isValid[ localIndex ] = isValid;
+
+                    if ( isValid )
+                    {
+                        memcpy( block.pixels[ localIndex ], srcPixels + ( pixelY * width + pixelX ) * 4, 4 );
+                    }
+                    else
+                    {
+                        memset( block.pixels[ localIndex ], 255, 4 );
+                    }
+                }
+            }
+
+            endian::big_endian <uint64> *dstWords = (endian::big_endian <uint64>*)( dstBlocks + ( (uint32)blockY * blocksWide + blockX ) * blockSize );
+
+            if ( codecFormat == ETC_CODEC_ETC2_RGBA )
+            {
+                dstWords[0] = compressEACAlphaBlock( block, quality );
+                dstWords[1] = compressETCColorBlock( block, allowETC2, quality );
+            }
+            else
+            {
+                dstWords[0] = compressETCColorBlock( block, allowETC2, quality );
+            }
+        }
+    });
+}
+
+};
+
+};
+
+#endif //_RENDERWARE_ETC_CODEC_
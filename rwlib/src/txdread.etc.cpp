@@ -0,0 +1,983 @@
+#include "StdInc.h"
+
+#ifdef RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
+
+#include "pixelformat.hxx"
+
+#include "txdread.etc.hxx"
+
+#include "txdread.etc.codec.hxx"
+
+#include "txdread.common.hxx"
+
+#include "streamutil.hxx"
+
+#include "pluginutil.hxx"
+
+#include "txdread.miputil.hxx"
+
+namespace rw
+{
+
+void etcNativeTextureTypeProvider::DeserializeTexture( TextureBase *theTexture, PlatformTexture *nativeTex, BlockProvider& inputProvider ) const
+{
+    Interface *engineInterface = theTexture->engineInterface;
+
+    // Read the native image struct.
+    {
+        BlockProvider texNativeImageStruct( &inputProvider );
+
+        texNativeImageStruct.EnterContext();
+
+        try
+        {
+            if ( texNativeImageStruct.getBlockID() == CHUNK_STRUCT )
+            {
+                etcmobile::textureNativeGenericHeader metaHeader;
+                texNativeImageStruct.read( &metaHeader, sizeof(metaHeader) );
+
+                uint32 platform = metaHeader.platformDescriptor;
+
+                if (platform != PLATFORM_ETC)
+                {
+                    throw RwException( "invalid platform type in ETC texture reading" );
+                }
+
+                // Cast our native texture.
+                NativeTextureETC *platformTex = (NativeTextureETC*)nativeTex;
+
+                // Read the format info.
+                metaHeader.formatInfo.parse( *theTexture );
+
+                // Read the texture names.
+                {
+                    char tmpbuf[ sizeof( metaHeader.name ) + 1 ];
+
+                    // Make sure the name buffer is zero terminted.
+                    tmpbuf[ sizeof( metaHeader.name ) ] = '\0';
+
+                    // Move over the texture name.
+                    memcpy( tmpbuf, metaHeader.name, sizeof( metaHeader.name ) );
+
+                    theTexture->SetName( tmpbuf );
+
+                    // Move over the texture mask name.
+                    memcpy( tmpbuf, metaHeader.maskName, sizeof( metaHeader.maskName ) );
+
+                    theTexture->SetMaskName( tmpbuf );
+                }
+
+                // Check the internal format for validity.
+                eETCInternalFormat internalFormat = metaHeader.internalFormat;
+
+                if ( internalFormat != ETC1_RGB8_OES &&
+                     internalFormat != COMPRESSED_RGB8_ETC2 &&
+                     internalFormat != COMPRESSED_RGBA8_ETC2_EAC )
+                {
+                    throw RwException( "texture " + theTexture->GetName() + " has an invalid ETC compression type" );
+                }
+
+                platformTex->internalFormat = internalFormat;
+
+                platformTex->hasAlpha = metaHeader.hasAlpha;
+
+                // Read the data sizes and keep track of how much we have read already.
+                uint32 validImageStreamSize = metaHeader.imageSectionStreamSize;
+
+                uint32 maybeMipmapCount = metaHeader.mipmapCount;
+
+                // First comes a list of mipmap data sizes.
+                // Read them into a temporary buffer.
+                std::vector <uint32> mipDataSizes;
+
+                mipDataSizes.resize( maybeMipmapCount );
+
+                // Keep track of how much we have read.
+                uint32 imageDataSectionSize = 0;
+
+                for ( uint32 n = 0; n < maybeMipmapCount; n++ )
+                {
+                    uint32 dataSize = texNativeImageStruct.readUInt32();
+                    
+                    imageDataSectionSize += sizeof( uint32 );
+                    imageDataSectionSize += dataSize;
+
+                    mipDataSizes[ n ] = dataSize;
+                }
+
+                // Read the mipmap layers.
+                uint32 compressionBlockSize = getETCCompressionBlockSize( internalFormat );
+
+                if ( compressionBlockSize == 0 )
+                {
+                    throw RwException( "failed to determine compression block size for texture " + theTexture->GetName() );
+                }
+
+                mipGenLevelGenerator mipLevelGen( metaHeader.width, metaHeader.height );
+
+                if ( !mipLevelGen.isValidLevel() )
+                {
+                    throw RwException( "texture " + theTexture->GetName() + " has invalid dimensions" );
+                }
+
+                uint32 mipmapCount = 0;
+
+                for ( uint32 n = 0; n < maybeMipmapCount; n++ )
+                {
+                    bool couldEstablishLevel = true;
+
+                    if ( n > 0 )
+                    {
+                        couldEstablishLevel = mipLevelGen.incrementLevel();
+                    }
+
+                    if ( !couldEstablishLevel )
+                    {
+                        break;
+                    }
+
+                    // Read the data.
+                    NativeTextureETC::mipmapLayer newLayer;
+
+                    newLayer.layerWidth = mipLevelGen.getLevelWidth();
+                    newLayer.layerHeight = mipLevelGen.getLevelHeight();
+
+                    uint32 texWidth = newLayer.layerWidth;
+                    uint32 texHeight = newLayer.layerHeight;
+                    {
+                        // We are compressing in 4x4 blocks.
+                        texWidth = ALIGN_SIZE( texWidth, 4u );
+                        texHeight = ALIGN_SIZE( texHeight, 4u );
+                    }
+
+                    newLayer.width = texWidth;
+                    newLayer.height = texHeight;
+
+                    // Verify the data size.
+                    uint32 compressedItemCount = ( texWidth * texHeight ) / 16;
+
+                    uint32 texReqDataSize = ( compressedItemCount * compressionBlockSize );
+
+                    uint32 actualDataSize = mipDataSizes[ n ];
+
+                    if ( texReqDataSize != actualDataSize )
+                    {
+                        throw RwException( "texture " + theTexture->GetName() + " has damaged mipmaps" );
+                    }
+
+                    // Add the layer.
+                    newLayer.dataSize = texReqDataSize;
+
+                    // Verify that we even have that much data in the stream.
+                    texNativeImageStruct.check_read_ahead( texReqDataSize );
+
+                    newLayer.texels = engineInterface->PixelAllocate( texReqDataSize );
+
+                    try
+                    {
+                        texNativeImageStruct.read( newLayer.texels, texReqDataSize );
+                    }
+                    catch( ... )
+                    {
+                        engineInterface->PixelFree( newLayer.texels );
+
+                        throw;
+                    }
+
+                    platformTex->mipmaps.push_back( newLayer );
+
+                    // Increment our mipmap count.
+                    mipmapCount++;
+                }
+
+                if ( mipmapCount == 0 )
+                {
+                    throw RwException( "texture " + theTexture->GetName() + " is empty" );
+                }
+
+                // Fix filtering mode.
+                fixFilteringMode( *theTexture, mipmapCount );
+
+                // Increment past any mipmap data that we skipped.
+                if ( mipmapCount < maybeMipmapCount )
+                {
+                    for ( uint32 n = mipmapCount; n < maybeMipmapCount; n++ )
+                    {
+                        uint32 skipDataSize = mipDataSizes[ n ];
+
+                        texNativeImageStruct.skip( skipDataSize );
+                    }
+                }
+            }
+            else
+            {
+                engineInterface->PushWarning( "could not find image data struct inside of ETC texture native" );
+            }
+        }
+        catch( ... )
+        {
+            texNativeImageStruct.LeaveContext();
+
+            throw;
+        }
+
+        texNativeImageStruct.LeaveContext();
+    }
+
+    // Deserialize extensions.
+    engineInterface->DeserializeExtensions( theTexture, inputProvider );
+}
+
+inline etc::eETCCodecFormat getETCCodecFormatFromInternalFormat( eETCInternalFormat internalFormat )
+{
+    etc::eETCCodecFormat codecFormat = etc::ETC_CODEC_ETC1;
+
+    if ( internalFormat == ETC1_RGB8_OES )
+    {
+        codecFormat = etc::ETC_CODEC_ETC1;
+    }
+    else if ( internalFormat == COMPRESSED_RGB8_ETC2 )
+    {
+        codecFormat = etc::ETC_CODEC_ETC2_RGB;
+    }
+    else if ( internalFormat == COMPRESSED_RGBA8_ETC2_EAC )
+    {
+        codecFormat = etc::ETC_CODEC_ETC2_RGBA;
+    }
+    else
+    {
+        assert( 0 );
+    }
+
+    return codecFormat;
+}
+
+// The codec works on tightly packed 32bit RGBA texels.
+inline void getETCCodecFormatParams(
+    eETCInternalFormat internalFormat,
+    eRasterFormat& codecRasterFormat, uint32& codecDepth, eColorOrdering& codecColorOrder
+)
+{
+    if ( internalFormat == ETC1_RGB8_OES ||
+         internalFormat == COMPRESSED_RGB8_ETC2 )
+    {
+        codecRasterFormat = RASTER_888;
+        codecDepth = 32;
+        codecColorOrder = COLOR_RGBA;
+    }
+    else if ( internalFormat == COMPRESSED_RGBA8_ETC2_EAC )
+    {
+        codecRasterFormat = RASTER_8888;
+        codecDepth = 32;
+        codecColorOrder = COLOR_RGBA;
+    }
+    else
+    {
+        assert( 0 );
+    }
+}
+
+// Pixel API.
+inline void DecompressETCMipmap(
+    Interface *engineInterface,
+    uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels,
+    eRasterFormat etcRasterFormat, uint32 etcDepth, eColorOrdering etcColorOrder,
+    eRasterFormat targetRasterFormat, uint32 targetDepth, uint32 targetRowAlignment, eColorOrdering targetColorOrder,
+    etc::eETCCodecFormat codecFormat,
+    void*& dstTexelsOut, uint32& dstDataSizeOut
+)
+{
+    uint32 etcRowAlignment = getETCToolTextureDataRowAlignment();
+
+    uint32 etcDataSize = getRasterDataSizeByRowSize( getRasterDataRowSize( mipWidth, etcDepth, etcRowAlignment ), mipHeight );
+
+    void *etcTexels = engineInterface->PixelAllocate( etcDataSize );
+
+    if ( !etcTexels )
+    {
+        throw RwException( "failed to allocate decompression surface buffer for ETC decompression task" );
+    }
+
+    void *dstTexels = etcTexels;
+    uint32 dstDataSize = etcDataSize;
+
+    try
+    {
+        etc::decompressETC( engineInterface, codecFormat, mipWidth, mipHeight, srcTexels, etcTexels );
+
+        // Put the texels into a format we want.
+        bool needsNewBuffer = shouldAllocateNewRasterBuffer( mipWidth, etcDepth, etcRowAlignment, targetDepth, targetRowAlignment );
+
+        if ( etcRasterFormat != targetRasterFormat || mipWidth != layerWidth || mipHeight != layerHeight || needsNewBuffer || etcColorOrder != targetColorOrder )
+        {
+            uint32 etcRowSize = getRasterDataRowSize( mipWidth, etcDepth, etcRowAlignment );
+
+            uint32 dstRowSize = getRasterDataRowSize( layerWidth, targetDepth, targetRowAlignment );
+
+            if ( mipWidth != layerWidth || mipHeight != layerHeight || needsNewBuffer )
+            {
+                dstDataSize = getRasterDataSizeByRowSize( dstRowSize, mipHeight );
+
+                dstTexels = engineInterface->PixelAllocate( dstDataSize );
+            }
+
+            try
+            {
+                colorModelDispatcher fetchSrcDispatch( etcRasterFormat, etcColorOrder, etcDepth, NULL, 0, PALETTE_NONE );
+                colorModelDispatcher putDispatch( targetRasterFormat, targetColorOrder, targetDepth, NULL, 0, PALETTE_NONE );
+
+                copyTexelDataEx(
+                    etcTexels, dstTexels,
+                    fetchSrcDispatch, putDispatch,
+                    layerWidth, layerHeight,
+                    0, 0,
+                    0, 0,
+                    etcRowSize, dstRowSize
+                );
+            }
+            catch( ... )
+            {
+                if ( dstTexels != etcTexels )
+                {
+                    engineInterface->PixelFree( dstTexels );
+                }
+            
+                throw;
+            }
+        }
+    }
+    catch( ... )
+    {
+        engineInterface->PixelFree( etcTexels );
+
+        throw;
+    }
+
+    if ( dstTexels != etcTexels )
+    {
+        engineInterface->PixelFree( etcTexels );
+    }
+
+    dstTexelsOut = dstTexels;
+    dstDataSizeOut = dstDataSize;
+}
+
+void etcNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInterface, void *objMem, pixelDataTraversal& pixelsOut )
+{
+    NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+    // Get properties of the compressed texture.
+    eETCInternalFormat internalFormat = nativeTex->internalFormat;
+
+    // Decompress the texels into a good format.
+    eRasterFormat targetRasterFormat = RASTER_8888;
+    uint32 targetDepth = 32;
+    eColorOrdering targetColorOrder = COLOR_RGBA;
+
+    uint32 targetRowAlignment = getETCExportTextureDataRowAlignment();
+
+    uint32 mipmapCount = (uint32)nativeTex->mipmaps.size();
+
+    pixelsOut.mipmaps.resize( mipmapCount );
+
+    etc::eETCCodecFormat codecFormat = getETCCodecFormatFromInternalFormat( internalFormat );
+
+    // Fetch format properties of the decompression destination surface.
+    eRasterFormat etcRasterFormat = RASTER_8888;
+    uint32 etcDepth = 32;
+    eColorOrdering etcColorOrder = COLOR_RGBA;
+
+    getETCCodecFormatParams( internalFormat, etcRasterFormat, etcDepth, etcColorOrder );
+
+    for ( uint32 n = 0; n < mipmapCount; n++ )
+    {
+        const NativeTextureETC::mipmapLayer& mipLayer = nativeTex->mipmaps[ n ];
+
+        // Get important properties onto the stack.
+        uint32 mipWidth = mipLayer.width;
+        uint32 mipHeight = mipLayer.height;
+
+        uint32 layerWidth = mipLayer.layerWidth;
+        uint32 layerHeight = mipLayer.layerHeight;
+
+        pixelDataTraversal::mipmapResource newLayer;
+
+        // We will end up with an uncompressed texture, so the layer dimensions match the raw dimensions.
+        newLayer.width = layerWidth;
+        newLayer.height = layerHeight;
+
+        newLayer.layerWidth = layerWidth;
+        newLayer.layerHeight = layerHeight;
+
+        // Decompress now.
+        uint32 texDataSize = 0;
+        void *mipTexels = NULL;
+        
+        DecompressETCMipmap(
+            engineInterface,
+            mipWidth, mipHeight, layerWidth, layerHeight, mipLayer.texels,
+            etcRasterFormat, etcDepth, etcColorOrder,
+            targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
+            codecFormat,
+            mipTexels, texDataSize
+        );
+
+        // Apply the data to the mipmap layer.
+        newLayer.texels = mipTexels;
+        newLayer.dataSize = texDataSize;
+
+        // Store the layer.
+        pixelsOut.mipmaps[ n ] = std::move( newLayer );
+    }
+
+    // Give the raster format to the runtime.
+    pixelsOut.rasterFormat = targetRasterFormat;
+    pixelsOut.depth = targetDepth;
+    pixelsOut.colorOrder = targetColorOrder;
+    pixelsOut.paletteType = PALETTE_NONE;
+    pixelsOut.paletteData = NULL;
+    pixelsOut.paletteSize = 0;
+    pixelsOut.hasAlpha = nativeTex->hasAlpha;
+    
+    pixelsOut.cubeTexture = false;
+    pixelsOut.autoMipmaps = false;
+    pixelsOut.rasterType = 4;
+
+    pixelsOut.compressionType = RWCOMPRESS_NONE;
+
+    // Since we decompress our texels, we are always newly allocated.
+    pixelsOut.isNewlyAllocated = true;
+}
+
+inline void CompressMipmapToETC(
+    Interface *engineInterface,
+    uint32 mipWidth, uint32 mipHeight, const void *srcTexels,
+    eRasterFormat srcRasterFormat, uint32 srcDepth, uint32 srcRowAlignment, eColorOrdering srcColorOrder, ePaletteType srcPaletteType, const void *srcPaletteData, uint32 srcPaletteSize,
+    eRasterFormat feedRasterFormat, uint32 feedDepth, eColorOrdering feedColorOrder,
+    uint32 compressionBlockSize,
+    etc::eETCCodecFormat codecFormat,
+    uint32& dstWidthOut, uint32& dstHeightOut,
+    void*& dstTexelsOut, uint32& dstDataSizeOut
+)
+{
+    uint32 srcLayerRowSize = getRasterDataRowSize( mipWidth, srcDepth, srcRowAlignment );
+
+    // Put this mipmap into the format of our encoder.
+    uint32 feedLayerTexRowSize = getRasterDataRowSize( mipWidth, feedDepth, getETCToolTextureDataRowAlignment() );
+
+    uint32 feedTextureDataSize = getRasterDataSizeByRowSize( feedLayerTexRowSize, mipHeight );
+
+    void *feedTexels = engineInterface->PixelAllocate( feedTextureDataSize );
+
+    if ( feedTexels == NULL )
+    {
+        throw RwException( "failed to allocate traversal texel buffer for ETC mipmap encoding" );
+    }
+
+    void *outTexels = NULL;
+    uint32 outTexelsDataSize = 0;
+    uint32 outWidth, outHeight;
+
+    try
+    {
+        colorModelDispatcher fetchDispatch( srcRasterFormat, srcColorOrder, srcDepth, srcPaletteData, srcPaletteSize, srcPaletteType );
+        colorModelDispatcher putDispatch( feedRasterFormat, feedColorOrder, feedDepth, NULL, 0, PALETTE_NONE );
+
+        copyTexelDataEx(
+            srcTexels, feedTexels,
+            fetchDispatch, putDispatch,
+            mipWidth, mipHeight,
+            0, 0,
+            0, 0,
+            srcLayerRowSize, feedLayerTexRowSize
+        );
+
+        // Determine the compressed texture dimensions.
+        uint32 compressWidth = ALIGN_SIZE( mipWidth, 4u );
+        uint32 compressHeight = ALIGN_SIZE( mipHeight, 4u );
+
+        uint32 compressionBlockCount = ( compressWidth * compressHeight ) / 16;
+
+        // Allocate the output buffer.
+        uint32 dstDataSize = ( compressionBlockCount * compressionBlockSize );
+
+        void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
+
+        if ( dstTexels == NULL )
+        {
+            throw RwException( "failed to allocate output texel buffer for ETC mipmap encoding" );
+        }
+
+        try
+        {
+            // Compress the texture now.
+            {
+                etc::compressETC( engineInterface, codecFormat, engineInterface->GetETCCompressionQuality(), mipWidth, mipHeight, feedTexels, dstTexels );
+
+                // Return stuff.
+                outWidth = compressWidth;
+                outHeight = compressHeight;
+                outTexels = dstTexels;
+                outTexelsDataSize = dstDataSize;
+            }
+        }
+        catch( ... )
+        {
+            engineInterface->PixelFree( dstTexels );
+
+            throw;
+        }
+    }
+    catch( ... )
+    {
+        engineInterface->PixelFree( feedTexels );
+
+        throw;
+    }
+
+    // Free the feedTexture that was used as a proxy.
+    engineInterface->PixelFree( feedTexels );
+
+    // Give parameters to the runtime.
+    dstWidthOut = outWidth;
+    dstHeightOut = outHeight;
+    dstTexelsOut = outTexels;
+    dstDataSizeOut = outTexelsDataSize;
+}
+
+void etcNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInterface, void *objMem, const pixelDataTraversal& pixelsIn, acquireFeedback_t& feedbackOut )
+{
+    NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+    // We expect raw bitmaps here.
+    assert( pixelsIn.compressionType == RWCOMPRESS_NONE );
+
+    // Verify some qualities of the pixel data.
+    {
+        nativeTextureSizeRules sizeRules;
+        getETCMipmapSizeRules( sizeRules );
+
+        bool isValid = sizeRules.verifyPixelData( pixelsIn );
+
+        if ( !isValid )
+        {
+            throw RwException( "invalid mipmap dimensions in ETC native texture pixel acquisition" );
+        }
+    }
+
+    // Free any image data that may have been there.
+    //nativeTex->clearImageData();
+
+    // Get the pixel properties onto stack, as we have to compress them.
+    eRasterFormat srcRasterFormat = pixelsIn.rasterFormat;
+    uint32 srcDepth = pixelsIn.depth;
+    uint32 srcRowAlignment = pixelsIn.rowAlignment;
+    eColorOrdering srcColorOrder = pixelsIn.colorOrder;
+    ePaletteType srcPaletteType = pixelsIn.paletteType;
+    const void *srcPaletteData = pixelsIn.paletteData;
+    uint32 srcPaletteSize = pixelsIn.paletteSize;
+
+    bool hasAlpha = pixelsIn.hasAlpha;
+
+    // Determine how to compress the texture.
+    // Opaque textures stay ETC1 so that every device can load them, only alpha requires ETC2.
+    eETCInternalFormat internalFormat = ETC1_RGB8_OES;
+
+    if ( hasAlpha )
+    {
+        internalFormat = COMPRESSED_RGBA8_ETC2_EAC;
+    }
+    else
+    {
+        internalFormat = ETC1_RGB8_OES;
+    }
+
+    // Do it.
+    {
+        // Get the format that we will output the feed-in texture as.
+        eRasterFormat feedRasterFormat = RASTER_8888;
+        uint32 feedDepth = 32;
+        eColorOrdering feedColorOrder = COLOR_RGBA;
+
+        getETCCodecFormatParams( internalFormat, feedRasterFormat, feedDepth, feedColorOrder );
+
+        etc::eETCCodecFormat codecFormat = getETCCodecFormatFromInternalFormat( internalFormat );
+
+        uint32 compressionBlockSize = getETCCompressionBlockSize( internalFormat );
+
+        // Parse all mipmaps.
+        size_t mipmapCount = pixelsIn.mipmaps.size();
+
+        nativeTex->mipmaps.resize( mipmapCount );
+
+        for ( size_t n = 0; n < mipmapCount; n++ )
+        {
+            const pixelDataTraversal::mipmapResource& mipLayer = pixelsIn.mipmaps[ n ];
+
+            // Get important properties onto stack.
+            uint32 mipWidth = mipLayer.width;
+            uint32 mipHeight = mipLayer.height;
+
+            const void *srcTexels = mipLayer.texels;
+
+            // Compress the level.
+            uint32 compressWidth, compressHeight;
+
+            void *dstTexels = NULL;
+            uint32 dstDataSize = 0;
+
+            CompressMipmapToETC(
+                engineInterface,
+                mipWidth, mipHeight, srcTexels,
+                srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder, srcPaletteType, srcPaletteData, srcPaletteSize,
+                feedRasterFormat, feedDepth, feedColorOrder,
+                compressionBlockSize,
+                codecFormat,
+                compressWidth, compressHeight,
+                dstTexels, dstDataSize
+            );
+
+            // Create a new mipmap layer with the texel information.
+            NativeTextureETC::mipmapLayer newLayer;
+
+            newLayer.width = compressWidth;
+            newLayer.height = compressHeight;
+
+            newLayer.layerWidth = mipLayer.layerWidth;
+            newLayer.layerHeight = mipLayer.layerHeight;
+
+            newLayer.dataSize = dstDataSize;
+            newLayer.texels = dstTexels;
+
+            // Store this new layer.
+            nativeTex->mipmaps[ n ] = newLayer;
+        }
+    }
+
+    // Store texture properties.
+    nativeTex->internalFormat = internalFormat;
+    nativeTex->hasAlpha = hasAlpha;
+
+    // Since we compress from the pixels, we cannot directly acquire.
+    feedbackOut.hasDirectlyAcquired = false;
+}
+
+void etcNativeTextureTypeProvider::UnsetPixelDataFromTexture( Interface *engineInterface, void *objMem, bool deallocate )
+{
+    NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+    // Remove texel links from this texture.
+    if ( deallocate )
+    {
+        // Delete mipmap layers.
+        deleteMipmapLayers( engineInterface, nativeTex->mipmaps );
+    }
+
+    // Clear the mipmap layers.
+    nativeTex->mipmaps.clear();
+
+    // Reset our format properties for cleanlyness sake.
+    nativeTex->internalFormat = ETC1_RGB8_OES;
+    nativeTex->hasAlpha = false;
+}
+
+struct etcMipmapManager
+{
+    NativeTextureETC *nativeTex;
+
+    inline etcMipmapManager( NativeTextureETC *nativeTex )
+    {
+        this->nativeTex = nativeTex;
+    }
+
+    inline void GetLayerDimensions(
+        const NativeTextureETC::mipmapLayer& mipLayer,
+        uint32& layerWidth, uint32& layerHeight
+    )
+    {
+        layerWidth = mipLayer.layerWidth;
+        layerHeight = mipLayer.layerHeight;
+    }
+
+    inline void GetSizeRules( nativeTextureSizeRules& rulesOut ) const
+    {
+        getETCMipmapSizeRules( rulesOut );
+    }
+
+    inline void Deinternalize(
+        Interface *engineInterface,
+        const NativeTextureETC::mipmapLayer& mipLayer,
+        uint32& widthOut, uint32& heightOut, uint32& layerWidthOut, uint32& layerHeightOut,
+        eRasterFormat& dstRasterFormat, eColorOrdering& dstColorOrder, uint32& dstDepth,
+        uint32& dstRowAlignment,
+        ePaletteType& dstPaletteType, void*& dstPaletteData, uint32& dstPaletteSize,
+        eCompressionType& dstCompressionType, bool& hasAlpha,
+        void*& dstTexelsOut, uint32& dstDataSizeOut,
+        bool& isNewlyAllocatedOut, bool& isPaletteNewlyAllocated
+    )
+    {
+        eETCInternalFormat internalFormat = nativeTex->internalFormat;
+
+        uint32 mipWidth = mipLayer.width;
+        uint32 mipHeight = mipLayer.height;
+
+        uint32 layerWidth = mipLayer.layerWidth;
+        uint32 layerHeight = mipLayer.layerHeight;
+
+        const void *srcTexels = mipLayer.texels;
+
+        // Decompress the texels into a good format.
+        eRasterFormat targetRasterFormat = RASTER_8888;
+        uint32 targetDepth = 32;
+        eColorOrdering targetColorOrder = COLOR_RGBA;
+
+        uint32 targetRowAlignment = getETCExportTextureDataRowAlignment();
+
+        // We decompress the layer and give it as new texels.
+        eRasterFormat etcRasterFormat;
+        uint32 etcDepth;
+        eColorOrdering etcColorOrder;
+
+        getETCCodecFormatParams( internalFormat, etcRasterFormat, etcDepth, etcColorOrder );
+
+        etc::eETCCodecFormat codecFormat = getETCCodecFormatFromInternalFormat( internalFormat );
+
+        // Perform it.
+        void *dstTexels = NULL;
+        uint32 dstDataSize = 0;
+
+        DecompressETCMipmap(
+            engineInterface,
+            mipWidth, mipHeight, layerWidth, layerHeight, srcTexels,
+            etcRasterFormat, etcDepth, etcColorOrder,
+            targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
+            codecFormat,
+            dstTexels, dstDataSize
+        );
+
+        // Give to the runtime.
+        widthOut = layerWidth;
+        heightOut = layerHeight;
+        layerWidthOut = layerWidth;
+        layerHeightOut = layerHeight;
+
+        dstRasterFormat = targetRasterFormat;
+        dstDepth = targetDepth;
+        dstRowAlignment = targetRowAlignment;
+        dstColorOrder = targetColorOrder;
+
+        dstPaletteType = PALETTE_NONE;
+        dstPaletteData = NULL;
+        dstPaletteSize = 0;
+
+        dstCompressionType = RWCOMPRESS_NONE;
+
+        hasAlpha = nativeTex->hasAlpha;
+
+        dstTexelsOut = dstTexels;
+        dstDataSizeOut = dstDataSize;
+
+        isNewlyAllocatedOut = true;
+        isPaletteNewlyAllocated = false;
+    }
+
+    inline void Internalize(
+        Interface *engineInterface,
+        NativeTextureETC::mipmapLayer& mipLayer,
+        uint32 width, uint32 height, uint32 layerWidth, uint32 layerHeight, void *srcTexels, uint32 dataSize,
+        eRasterFormat rasterFormat, eColorOrdering colorOrder, uint32 depth,
+        uint32 rowAlignment,
+        ePaletteType paletteType, void *paletteData, uint32 paletteSize,
+        eCompressionType compressionType, bool hasAlpha,
+        bool& hasDirectlyAcquiredOut
+    )
+    {
+        // We need to compress the same way as the texture is compressed as.
+        eETCInternalFormat internalFormat = nativeTex->internalFormat;
+
+        // If the input is not in raw bitmap format, convert it to raw format.
+        bool srcTexelsNewlyAllocated = false;
+
+        if ( compressionType != RWCOMPRESS_NONE )
+        {
+            eRasterFormat targetRasterFormat = RASTER_8888;
+            uint32 targetDepth = 32;
+            eColorOrdering targetColorOrder = COLOR_BGRA;
+
+            uint32 targetRowAlignment = getETCToolTextureDataRowAlignment();
+
+            bool hasChanged =
+                ConvertMipmapLayerNative(
+                    engineInterface,
+                    width, height, layerWidth, layerHeight, srcTexels, dataSize,
+                    rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteData, paletteSize, compressionType,
+                    targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder, PALETTE_NONE, NULL, 0, RWCOMPRESS_NONE,
+                    false,
+                    width, height,
+                    srcTexels, dataSize
+                );
+
+            if ( hasChanged == false )
+            {
+                throw RwException( "failed to decompress in ETC native texture mipmap manager" );
+            }
+
+            // We are now in raw format.
+            compressionType = RWCOMPRESS_NONE;
+
+            rasterFormat = targetRasterFormat;
+            depth = targetDepth;
+            colorOrder = targetColorOrder;
+
+            rowAlignment = targetRowAlignment;
+
+            paletteType = PALETTE_NONE;
+            paletteData = NULL;
+            paletteSize = 0;
+
+            srcTexelsNewlyAllocated = true;
+        }
+
+        // Get the format that we will output the feed-in texture as.
+        eRasterFormat feedRasterFormat = RASTER_8888;
+        uint32 feedDepth = 32;
+        eColorOrdering feedColorOrder = COLOR_RGBA;
+
+        getETCCodecFormatParams( internalFormat, feedRasterFormat, feedDepth, feedColorOrder );
+
+        etc::eETCCodecFormat codecFormat = getETCCodecFormatFromInternalFormat( internalFormat );
+
+        uint32 compressionBlockSize = getETCCompressionBlockSize( internalFormat );
+
+        // Do it.
+        uint32 compressedWidth, compressedHeight;
+
+        void *dstTexels = NULL;
+        uint32 dstDataSize = 0;
+
+        CompressMipmapToETC(
+            engineInterface,
+            width, height, srcTexels,
+            rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteData, paletteSize,
+            feedRasterFormat, feedDepth, feedColorOrder,
+            compressionBlockSize,
+            codecFormat,
+            compressedWidth, compressedHeight,
+            dstTexels, dstDataSize
+        );
+
+        if ( srcTexelsNewlyAllocated )
+        {
+            engineInterface->PixelFree( srcTexels );
+        }
+
+        // Store this new layer.
+        mipLayer.width = compressedWidth;
+        mipLayer.height = compressedHeight;
+
+        mipLayer.layerWidth = layerWidth;
+        mipLayer.layerHeight = layerHeight;
+
+        mipLayer.texels = dstTexels;
+        mipLayer.dataSize = dstDataSize;
+
+        hasDirectlyAcquiredOut = false;
+    }
+};
+
+bool etcNativeTextureTypeProvider::GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut )
+{
+    NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+    etcMipmapManager mipMan( nativeTex );
+
+    return
+        virtualGetMipmapLayer <NativeTextureETC::mipmapLayer> (
+            engineInterface, mipMan,
+            mipIndex,
+            nativeTex->mipmaps, layerOut
+        );
+}
+
+bool etcNativeTextureTypeProvider::AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut )
+{
+    NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+    etcMipmapManager mipMan( nativeTex );
+
+    return
+        virtualAddMipmapLayer <NativeTextureETC::mipmapLayer> (
+            engineInterface, mipMan,
+            nativeTex->mipmaps, layerIn,
+            feedbackOut
+        );
+}
+
+void etcNativeTextureTypeProvider::ClearMipmaps( Interface *engineInterface, void *objMem )
+{
+    NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+    virtualClearMipmaps <NativeTextureETC::mipmapLayer> ( engineInterface, nativeTex->mipmaps );
+}
+
+void etcNativeTextureTypeProvider::GetTextureInfo( Interface *engineInterface, void *objMem, nativeTextureBatchedInfo& infoOut )
+{
+    NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+    uint32 mipmapCount = (uint32)nativeTex->mipmaps.size();
+
+    infoOut.mipmapCount = mipmapCount;
+
+    uint32 baseWidth = 0;
+    uint32 baseHeight = 0;
+
+    if ( mipmapCount > 0 )
+    {
+        baseWidth = nativeTex->mipmaps[ 0 ].layerWidth;
+        baseHeight = nativeTex->mipmaps[ 0 ].layerHeight;
+    }
+
+    infoOut.baseWidth = baseWidth;
+    infoOut.baseHeight = baseHeight;
+}
+
+void etcNativeTextureTypeProvider::GetTextureFormatString( Interface *engineInterface, void *objMem, char *buf, size_t bufLen, size_t& lengthOut ) const
+{
+    // Return a good information string about the internalFormat.
+    NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+    std::string fmtString = "ETC";
+
+    eETCInternalFormat internalFormat = nativeTex->internalFormat;
+
+    if ( internalFormat == eETCInternalFormat::ETC1_RGB8_OES )
+    {
+        fmtString += "1 RGB";
+    }
+    else if ( internalFormat == eETCInternalFormat::COMPRESSED_RGB8_ETC2 )
+    {
+        fmtString += "2 RGB";
+    }
+    else if ( internalFormat == eETCInternalFormat::COMPRESSED_RGBA8_ETC2_EAC )
+    {
+        fmtString += "2 RGBA";
+    }
+
+    if ( buf )
+    {
+        strncpy( buf, fmtString.c_str(), bufLen );
+    }
+
+    lengthOut = fmtString.size();
+}
+
+static PluginDependantStructRegister <etcNativeTextureTypeProvider, RwInterfaceFactory_t> etcNativeTexturePluginStore;
+
+void registerETCNativePlugin( void )
+{
+    etcNativeTexturePluginStore.RegisterPlugin( engineFactory );
+}
+
+};
+
+#endif //RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
\ No newline at end of file
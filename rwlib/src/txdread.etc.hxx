@@ -0,0 +1,277 @@
+#ifdef RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
+
+#include "txdread.nativetex.hxx"
+
+#include "txdread.d3d.genmip.hxx"
+
+#include "txdread.common.hxx"
+
+// Not used by any game, the War Drum layout is extended by this id.
+#define PLATFORM_ETC    13
+
+namespace rw
+{
+
+inline uint32 getETCToolTextureDataRowAlignment( void )
+{
+    // The ETC codec works on 32bit texels, so its rows are always tightly packed.
+    return 4;
+}
+
+inline uint32 getETCExportTextureDataRowAlignment( void )
+{
+    // Return a size that is preferred by the framework.
+    return 4;
+}
+
+// The OpenGL ES enums of the formats.
+// ETC1 is available on practically all Android hardware, ETC2 from OpenGL ES 3.0 on.
+enum eETCInternalFormat
+{
+    ETC1_RGB8_OES = 0x8D64,
+    COMPRESSED_RGB8_ETC2 = 0x9274,
+    COMPRESSED_RGBA8_ETC2_EAC = 0x9278
+};
+
+inline uint32 getETCCompressionBlockSize( eETCInternalFormat internalFormat )
+{
+    uint32 theSize = 0;
+
+    if ( internalFormat == ETC1_RGB8_OES )
+    {
+        theSize = 8;
+    }
+    else if ( internalFormat == COMPRESSED_RGB8_ETC2 )
+    {
+        theSize = 8;
+    }
+    else if ( internalFormat == COMPRESSED_RGBA8_ETC2_EAC )
+    {
+        theSize = 16;
+    }
+
+    return theSize;
+}
+
+inline void getETCMipmapSizeRules( nativeTextureSizeRules& rulesOut )
+{
+    rulesOut.powerOfTwo = false;
+    rulesOut.squared = false;
+    rulesOut.multipleOf = true;
+    rulesOut.multipleOfValue = 4u;
+    rulesOut.maximum = true;
+    rulesOut.maxVal = 2048;
+}
+
+struct NativeTextureETC
+{
+    Interface *engineInterface;
+
+    LibraryVersion texVersion;
+
+    inline NativeTextureETC( Interface *engineInterface )
+    {
+        this->engineInterface = engineInterface;
+        this->texVersion = engineInterface->GetVersion();
+
+        this->internalFormat = ETC1_RGB8_OES;
+        this->hasAlpha = false;
+    }
+
+    inline NativeTextureETC( const NativeTextureETC& right )
+    {
+        // Copy parameters.
+        this->engineInterface = right.engineInterface;
+        this->texVersion = right.texVersion;
+        this->internalFormat = right.internalFormat;
+        this->hasAlpha = right.hasAlpha;
+
+        // Copy mipmaps.
+        copyMipmapLayers( this->engineInterface, right.mipmaps, this->mipmaps );
+    }
+
+    inline void clearImageData( void )
+    {
+        // Delete mipmap layers.
+        deleteMipmapLayers( this->engineInterface, this->mipmaps );
+    }
+
+    inline ~NativeTextureETC( void )
+    {
+        this->clearImageData();
+    }
+
+    typedef genmip::mipmapLayer mipmapLayer;
+
+    std::vector <mipmapLayer> mipmaps;
+
+    // Custom parameters.
+    eETCInternalFormat internalFormat;
+
+    bool hasAlpha;
+};
+
+struct etcNativeTextureTypeProvider : public texNativeTypeProvider
+{
+    void ConstructTexture( Interface *engineInterface, void *objMem, size_t memSize ) override
+    {
+        new (objMem) NativeTextureETC( engineInterface );
+    }
+
+    void CopyConstructTexture( Interface *engineInterface, void *objMem, const void *srcObjMem, size_t memSize ) override
+    {
+        new (objMem) NativeTextureETC( *(const NativeTextureETC*)srcObjMem );
+    }
+    
+    void DestroyTexture( Interface *engineInterface, void *objMem, size_t memSize ) override
+    {
+        ( *(NativeTextureETC*)objMem ).~NativeTextureETC();
+    }
+
+    eTexNativeCompatibility IsCompatibleTextureBlock( BlockProvider& inputProvider ) const;
+
+    void SerializeTexture( TextureBase *theTexture, PlatformTexture *nativeTex, BlockProvider& outputProvider ) const;
+    void DeserializeTexture( TextureBase *theTexture, PlatformTexture *nativeTex, BlockProvider& inputProvider ) const;
+
+    void GetPixelCapabilities( pixelCapabilities& capsOut ) const override
+    {
+        capsOut.supportsDXT1 = false;
+        capsOut.supportsDXT2 = false;
+        capsOut.supportsDXT3 = false;
+        capsOut.supportsDXT4 = false;
+        capsOut.supportsDXT5 = false;
+        capsOut.supportsPalette = true;
+    }
+
+    void GetStorageCapabilities( storageCapabilities& storeCaps ) const override
+    {
+        storeCaps.pixelCaps.supportsDXT1 = false;
+        storeCaps.pixelCaps.supportsDXT2 = false;
+        storeCaps.pixelCaps.supportsDXT3 = false;
+        storeCaps.pixelCaps.supportsDXT4 = false;
+        storeCaps.pixelCaps.supportsDXT5 = false;
+        storeCaps.pixelCaps.supportsPalette = false;
+
+        storeCaps.isCompressedFormat = true;
+    }
+
+    void GetPixelDataFromTexture( Interface *engineInterface, void *objMem, pixelDataTraversal& pixelsOut );
+    void SetPixelDataToTexture( Interface *engineInterface, void *objMem, const pixelDataTraversal& pixelsIn, acquireFeedback_t& feedbackOut );
+    void UnsetPixelDataFromTexture( Interface *engineInterface, void *objMem, bool deallocate );
+
+    void SetTextureVersion( Interface *engineInterface, void *objMem, LibraryVersion version ) override
+    {
+        NativeTextureETC *nativeTex = (NativeTextureETC*)objMem;
+
+        nativeTex->texVersion = version;
+    }
+
+    LibraryVersion GetTextureVersion( const void *objMem ) override
+    {
+        const NativeTextureETC *nativeTex = (const NativeTextureETC*)objMem;
+
+        return nativeTex->texVersion;
+    }
+
+    bool GetMipmapLayer( Interface *engineInterface, void *objMem, uint32 mipIndex, rawMipmapLayer& layerOut );
+    bool AddMipmapLayer( Interface *engineInterface, void *objMem, const rawMipmapLayer& layerIn, acquireFeedback_t& feedbackOut );
+    void ClearMipmaps( Interface *engineInterface, void *objMem );
+
+    void GetTextureInfo( Interface *engineInterface, void *objMem, nativeTextureBatchedInfo& infoOut );
+    void GetTextureFormatString( Interface *engineInterface, void *objMem, char *buf, size_t bufLen, size_t& lengthOut ) const;
+
+    eRasterFormat GetTextureRasterFormat( const void *objMem ) override
+    {
+        return RASTER_DEFAULT;
+    }
+
+    ePaletteType GetTexturePaletteType( const void *objMem ) override
+    {
+        return PALETTE_NONE;
+    }
+
+    bool IsTextureCompressed( const void *objMem ) override
+    {
+        return true;
+    }
+
+    eCompressionType GetTextureCompressionFormat( const void *objMem ) override
+    {
+        return RWCOMPRESS_NONE;
+    }
+
+    bool DoesTextureHaveAlpha( const void *objMem ) override
+    {
+        const NativeTextureETC *nativeTex = (const NativeTextureETC*)objMem;
+
+        return nativeTex->hasAlpha;
+    }
+
+    uint32 GetTextureDataRowAlignment( void ) const override
+    {
+        // Will never be called, because we do not store raw texel data.
+        return 0;
+    }
+
+    void GetFormatSizeRules( const pixelFormat& format, nativeTextureSizeRules& rulesOut ) const override
+    {
+        getETCMipmapSizeRules( rulesOut );
+    }
+
+    void GetTextureSizeRules( const void *objMem, nativeTextureSizeRules& rulesOut ) const override
+    {
+        // The size rules do not depend on the native texture.
+        // This is because the format of the native texture does not change very much.
+        getETCMipmapSizeRules( rulesOut );
+    }
+
+    uint32 GetDriverIdentifier( void *objMem ) const override
+    {
+        // This was never defined.
+        return 0;
+    }
+
+    inline void Initialize( Interface *engineInterface )
+    {
+        RegisterNativeTextureType( engineInterface, "etc_mobile", this, sizeof( NativeTextureETC ) );
+    }
+
+    inline void Shutdown( Interface *engineInterface )
+    {
+        UnregisterNativeTextureType( engineInterface, "etc_mobile" );
+    }
+};
+
+namespace etcmobile
+{
+#pragma pack(push, 1)
+struct textureNativeGenericHeader
+{
+    endian::little_endian <uint32> platformDescriptor;
+
+    wardrumFormatInfo formatInfo;
+
+    uint8 pad1[0x10];
+
+    char name[32];
+    char maskName[32];
+
+    uint8 mipmapCount;
+    uint8 reserved1;
+    bool hasAlpha;
+
+    uint8 pad2;
+
+    endian::little_endian <uint16> width, height;
+
+    endian::little_endian <eETCInternalFormat> internalFormat;
+
+    endian::little_endian <uint32> imageSectionStreamSize;
+    endian::little_endian <uint32> reserved2;
+};
+#pragma pack(pop)
+};
+
+};
+
+#endif //RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
\ No newline at end of file
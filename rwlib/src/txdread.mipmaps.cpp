@@ -14,7 +14,7 @@ uint32 Raster::getMipmapCount( void ) const
 
     if ( PlatformTexture *platformTex = this->platformData )
     {
-        texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+        texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
         if ( texProvider )
         {
@@ -31,6 +31,7 @@ void Raster::clearMipmaps( void )
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     Interface *engineInterface = this->engineInterface;
 
@@ -38,7 +39,7 @@ void Raster::clearMipmaps( void )
         
     if ( platformTex )
     {
-        texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+        texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
         // Clear mipmaps. This is image data starting from level index 1.
         nativeTextureBatchedInfo info;
@@ -190,6 +191,8 @@ inline void ensurePutIntoArray( dataType dataToPut, containerType& container, ui
 
 void Raster::generateMipmaps( uint32 maxMipmapCount, eMipmapGenerationMode mipGenMode )
 {
+    scoped_profile_zone profileZone( this->engineInterface, "Raster::generateMipmaps" );
+
     // Grab the bitmap of this texture, so we can generate mipmaps.
     Bitmap textureBitmap = this->getBitmap();
 
@@ -197,6 +200,7 @@ void Raster::generateMipmaps( uint32 maxMipmapCount, eMipmapGenerationMode mipGe
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -207,7 +211,7 @@ void Raster::generateMipmaps( uint32 maxMipmapCount, eMipmapGenerationMode mipGe
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
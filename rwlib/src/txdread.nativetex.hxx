@@ -170,11 +170,18 @@ struct nativeTextureSizeRules
     }
 };
 
+// Interned native texture type name.
+// Resolve it once using GetNativeTextureTypeHandle and keep it around.
+typedef uint32 nativeTexTypeHandle_t;
+
+#define NATIVE_TEXTURE_TYPE_HANDLE_INVALID  ( (nativeTexTypeHandle_t)0 )
+
 struct texNativeTypeProvider abstract
 {
     inline texNativeTypeProvider( void )
     {
         this->managerData.rwTexType = NULL;
+        this->managerData.typeHandle = NATIVE_TEXTURE_TYPE_HANDLE_INVALID;
         this->managerData.isRegistered = false;
     }
 
@@ -293,6 +300,7 @@ struct texNativeTypeProvider abstract
     struct
     {
         RwTypeSystem::typeInfoBase *rwTexType;
+        nativeTexTypeHandle_t typeHandle;
 
         RwListEntry <texNativeTypeProvider> managerNode;
 
@@ -310,8 +318,38 @@ typedef void (*texNativeTypeProviderCallback_t)( texNativeTypeProvider *prov, vo
 void ExploreNativeTextureTypeProviders( Interface *intf, texNativeTypeProviderCallback_t cb, void *ud );
 texNativeTypeProvider* GetNativeTextureTypeProvider( Interface *engineInterface, void *platformData );
 texNativeTypeProvider* GetNativeTextureTypeProviderByName( Interface *engineInterface, const char *typeName );
+nativeTexTypeHandle_t GetNativeTextureTypeHandle( Interface *engineInterface, const char *typeName );
+texNativeTypeProvider* GetNativeTextureTypeProviderByHandle( Interface *engineInterface, nativeTexTypeHandle_t typeHandle );
+
+// ConvertRasterTo for callers that interned the destination type name already.
+bool ConvertRasterToNativeType( Raster *theRaster, nativeTexTypeHandle_t dstTypeHandle );
 uint32 GetNativeTextureMipmapCount( Interface *engineInterface, PlatformTexture *nativeTexture, texNativeTypeProvider *texTypeProvider );
 
+// Direct native-to-native transcoding.
+// Transcoders are asked by ConvertRasterTo before the generic pixel format negotiation, so
+// pixel data that both native texture types can store as-is does not have to be decoded.
+enum eNativeTranscodeFormat
+{
+    NATIVE_TRANSCODE_ANY,
+    NATIVE_TRANSCODE_RAW,
+    NATIVE_TRANSCODE_PALETTE,
+    NATIVE_TRANSCODE_DXT
+};
+
+struct nativeTextureTranscoder abstract
+{
+    // Has to make pixelData acceptable for dstProvider and return true.
+    // If it cannot, it has to return false and leave pixelData untouched.
+    virtual bool TranscodePixelData( Interface *engineInterface, texNativeTypeProvider *srcProvider, texNativeTypeProvider *dstProvider, pixelDataTraversal& pixelData ) const = 0;
+};
+
+// Passing NULL as type name matches every native texture type.
+bool RegisterNativeTextureTranscoder( Interface *engineInterface, const char *srcTypeName, const char *dstTypeName, eNativeTranscodeFormat format, nativeTextureTranscoder *transcoder );
+bool UnregisterNativeTextureTranscoder( Interface *engineInterface, nativeTextureTranscoder *transcoder );
+
+eNativeTranscodeFormat GetPixelDataTranscodeFormat( const pixelDataTraversal& pixelData );
+bool TranscodeNativePixelData( Interface *engineInterface, texNativeTypeProvider *srcProvider, texNativeTypeProvider *dstProvider, pixelDataTraversal& pixelData );
+
 // Private RW obj API.
 uint16 GetTexDictionaryRecommendedDriverID( Interface *engineInterface, const TexDictionary *txdObj, texNativeTypeProvider **driverOut = NULL );
 
@@ -149,6 +149,8 @@ static void _fetch_image_data_libquant(liq_color row_out[], int row_index, int w
 // This routine is called by ConvertPixelData. It should not be called from anywhere else.
 void PalettizePixelData( Interface *engineInterface, pixelDataTraversal& pixelData, const pixelFormat& dstPixelFormat )
 {
+    scoped_profile_zone profileZone( engineInterface, "PalettizePixelData" );
+
     // Make sure the pixelData is not compressed.
     assert( pixelData.compressionType == RWCOMPRESS_NONE );
     assert( dstPixelFormat.compressionType == RWCOMPRESS_NONE );
@@ -660,6 +662,7 @@ void Raster::convertToPalette( ePaletteType paletteType, eRasterFormat newRaster
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     // NULL operation.
     if ( paletteType == PALETTE_NONE )
@@ -674,7 +677,7 @@ void Raster::convertToPalette( ePaletteType paletteType, eRasterFormat newRaster
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -821,7 +824,7 @@ ePaletteType Raster::getPaletteType( void ) const
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -881,6 +884,8 @@ void RemapMipmapLayer(
     void*& dstTexelsOut, uint32& dstTexelDataSizeOut
 )
 {
+    scoped_profile_zone profileZone( engineInterface, "RemapMipmapLayer" );
+
     // Determine with what algorithm we should map.
     ePaletteRuntimeType palRuntimeType = engineInterface->GetPaletteRuntime();
 
@@ -1128,10 +1128,24 @@ inline bool isPaletteTypeBigger( ePaletteType left, ePaletteType right )
 
 bool ConvertPixelData( Interface *engineInterface, pixelDataTraversal& pixelsToConvert, const pixelFormat pixFormat )
 {
+    scoped_profile_zone profileZone( engineInterface, "ConvertPixelData" );
+
     // We must have stand-alone pixel data.
     // Otherwise we could mess up pretty badly!
     assert( pixelsToConvert.isNewlyAllocated == true );
 
+    if ( IsProfilingActive() )
+    {
+        uint64 srcDataSize = 0;
+
+        for ( const pixelDataTraversal::mipmapResource& mipLayer : pixelsToConvert.mipmaps )
+        {
+            srcDataSize += mipLayer.dataSize;
+        }
+
+        ProfileCount( engineInterface, PROFILE_COUNTER_BYTES_CONVERTED, srcDataSize );
+    }
+
     // Decide how to convert stuff.
     bool hasUpdated = false;
 
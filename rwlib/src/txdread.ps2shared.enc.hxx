@@ -1,44 +1,320 @@
 // Shared, encoding-based routines based on Sony PS2 architecture.
 // This header was made to keep heavy routines local to the code that needs them.
 
+#include "rwsimd.hxx"
+
 namespace rw
 {
 
 // Color routines.
-inline double clampcolor( double theColor )
+// The PS2 stores alpha in the range [0, 128] while the PC uses [0, 255].
+// Both tables follow floor( clamp( pcAlpha / 255 ) * 128 + 0.5 ) and floor( clamp( ps2Alpha / 128 ) * 255 + 0.495 ).
+static const uint8 _pcAlphaToPS2AlphaTable[ 256 ] =
 {
-    return std::min( 1.0, std::max( 0.0, theColor ) );
-}
+    0x00, 0x01, 0x01, 0x02, 0x02, 0x03, 0x03, 0x04, 0x04, 0x05, 0x05, 0x06, 0x06, 0x07, 0x07, 0x08,
+    0x08, 0x09, 0x09, 0x0a, 0x0a, 0x0b, 0x0b, 0x0c, 0x0c, 0x0d, 0x0d, 0x0e, 0x0e, 0x0f, 0x0f, 0x10,
+    0x10, 0x11, 0x11, 0x12, 0x12, 0x13, 0x13, 0x14, 0x14, 0x15, 0x15, 0x16, 0x16, 0x17, 0x17, 0x18,
+    0x18, 0x19, 0x19, 0x1a, 0x1a, 0x1b, 0x1b, 0x1c, 0x1c, 0x1d, 0x1d, 0x1e, 0x1e, 0x1f, 0x1f, 0x20,
+    0x20, 0x21, 0x21, 0x22, 0x22, 0x23, 0x23, 0x24, 0x24, 0x25, 0x25, 0x26, 0x26, 0x27, 0x27, 0x28,
+    0x28, 0x29, 0x29, 0x2a, 0x2a, 0x2b, 0x2b, 0x2c, 0x2c, 0x2d, 0x2d, 0x2e, 0x2e, 0x2f, 0x2f, 0x30,
+    0x30, 0x31, 0x31, 0x32, 0x32, 0x33, 0x33, 0x34, 0x34, 0x35, 0x35, 0x36, 0x36, 0x37, 0x37, 0x38,
+    0x38, 0x39, 0x39, 0x3a, 0x3a, 0x3b, 0x3b, 0x3c, 0x3c, 0x3d, 0x3d, 0x3e, 0x3e, 0x3f, 0x3f, 0x40,
+    0x40, 0x41, 0x41, 0x42, 0x42, 0x43, 0x43, 0x44, 0x44, 0x45, 0x45, 0x46, 0x46, 0x47, 0x47, 0x48,
+    0x48, 0x49, 0x49, 0x4a, 0x4a, 0x4b, 0x4b, 0x4c, 0x4c, 0x4d, 0x4d, 0x4e, 0x4e, 0x4f, 0x4f, 0x50,
+    0x50, 0x51, 0x51, 0x52, 0x52, 0x53, 0x53, 0x54, 0x54, 0x55, 0x55, 0x56, 0x56, 0x57, 0x57, 0x58,
+    0x58, 0x59, 0x59, 0x5a, 0x5a, 0x5b, 0x5b, 0x5c, 0x5c, 0x5d, 0x5d, 0x5e, 0x5e, 0x5f, 0x5f, 0x60,
+    0x60, 0x61, 0x61, 0x62, 0x62, 0x63, 0x63, 0x64, 0x64, 0x65, 0x65, 0x66, 0x66, 0x67, 0x67, 0x68,
+    0x68, 0x69, 0x69, 0x6a, 0x6a, 0x6b, 0x6b, 0x6c, 0x6c, 0x6d, 0x6d, 0x6e, 0x6e, 0x6f, 0x6f, 0x70,
+    0x70, 0x71, 0x71, 0x72, 0x72, 0x73, 0x73, 0x74, 0x74, 0x75, 0x75, 0x76, 0x76, 0x77, 0x77, 0x78,
+    0x78, 0x79, 0x79, 0x7a, 0x7a, 0x7b, 0x7b, 0x7c, 0x7c, 0x7d, 0x7d, 0x7e, 0x7e, 0x7f, 0x7f, 0x80
+};
+
+static const uint8 _ps2AlphaToPCAlphaTable[ 256 ] =
+{
+    0x00, 0x02, 0x04, 0x06, 0x08, 0x0a, 0x0c, 0x0e, 0x10, 0x12, 0x14, 0x16, 0x18, 0x1a, 0x1c, 0x1e,
+    0x20, 0x22, 0x24, 0x26, 0x28, 0x2a, 0x2c, 0x2e, 0x30, 0x32, 0x34, 0x36, 0x38, 0x3a, 0x3c, 0x3e,
+    0x40, 0x42, 0x44, 0x46, 0x48, 0x4a, 0x4c, 0x4e, 0x50, 0x52, 0x54, 0x56, 0x58, 0x5a, 0x5c, 0x5e,
+    0x60, 0x62, 0x64, 0x66, 0x68, 0x6a, 0x6c, 0x6e, 0x70, 0x72, 0x74, 0x76, 0x78, 0x7a, 0x7c, 0x7e,
+    0x7f, 0x81, 0x83, 0x85, 0x87, 0x89, 0x8b, 0x8d, 0x8f, 0x91, 0x93, 0x95, 0x97, 0x99, 0x9b, 0x9d,
+    0x9f, 0xa1, 0xa3, 0xa5, 0xa7, 0xa9, 0xab, 0xad, 0xaf, 0xb1, 0xb3, 0xb5, 0xb7, 0xb9, 0xbb, 0xbd,
+    0xbf, 0xc1, 0xc3, 0xc5, 0xc7, 0xc9, 0xcb, 0xcd, 0xcf, 0xd1, 0xd3, 0xd5, 0xd7, 0xd9, 0xdb, 0xdd,
+    0xdf, 0xe1, 0xe3, 0xe5, 0xe7, 0xe9, 0xeb, 0xed, 0xef, 0xf1, 0xf3, 0xf5, 0xf7, 0xf9, 0xfb, 0xfd,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
 
 inline uint8 convertPCAlpha2PS2Alpha( uint8 pcAlpha )
 {
-    // TODO: generate a table that maps PC alpha to PS2 alpha.
+    return _pcAlphaToPS2AlphaTable[ pcAlpha ];
+}
+
+inline uint8 convertPS2Alpha2PCAlpha( uint8 ps2Alpha )
+{
+    return _ps2AlphaToPCAlphaTable[ ps2Alpha ];
+}
+
+enum ePS2AlphaTransform
+{
+    PS2ALPHA_KEEP,
+    PS2ALPHA_TO_PC,
+    PS2ALPHA_TO_PS2
+};
+
+// Transforms a run of RASTER_8888 texels (PSMCT32) that are in either RGBA or BGRA order.
+// Where SSE2 is available four texels are done per step; the alpha arithmetic matches the alpha tables bit-exactly.
+// The scalar loop handles the remaining texels, or all of them on targets without SSE2.
+inline void transformPS2Texels8888(
+    const void *srcTexels, void *dstTexels, uint32 texelCount,
+    bool swapRedBlue, ePS2AlphaTransform alphaTransform
+)
+{
+    const uint8 *srcBytes = (const uint8*)srcTexels;
+    uint8 *dstBytes = (uint8*)dstTexels;
+
+    uint32 n = 0;
+
+#ifdef RWLIB_HAS_SSE2
+    const __m128i redBlueMask = _mm_set1_epi32( 0x00FF00FF );
+    const __m128i greenAlphaMask = _mm_set1_epi32( 0xFF00FF00 );
+    const __m128i colorMask = _mm_set1_epi32( 0x00FFFFFF );
+
+    for ( ; n + 4 <= texelCount; n += 4 )
+    {
+        __m128i texels = _mm_loadu_si128( (const __m128i*)( srcBytes + n * 4 ) );
+
+        if ( swapRedBlue )
+        {
+            __m128i redBlue = _mm_and_si128( texels, redBlueMask );
+            __m128i greenAlpha = _mm_and_si128( texels, greenAlphaMask );
+
+            redBlue = _mm_or_si128( _mm_slli_epi32( redBlue, 16 ), _mm_srli_epi32( redBlue, 16 ) );
+
+            texels = _mm_or_si128( redBlue, greenAlpha );
+        }
+
+        if ( alphaTransform != PS2ALPHA_KEEP )
+        {
+            // Every alpha value sits in the low word of its 32bit lane, the high words stay zero.
+            __m128i alpha = _mm_srli_epi32( texels, 24 );
+
+            if ( alphaTransform == PS2ALPHA_TO_PC )
+            {
+                // ( min( alpha, 128 ) * 255 + 63 ) / 128
+                alpha = _mm_min_epi16( alpha, _mm_set1_epi16( 128 ) );
+                alpha = _mm_mullo_epi16( alpha, _mm_set1_epi16( 255 ) );
+                alpha = _mm_add_epi16( alpha, _mm_set1_epi16( 63 ) );
+                alpha = _mm_srli_epi16( alpha, 7 );
+            }
+            else
+            {
+                // ( alpha * 128 + 127 ) / 255
+                __m128i scaled = _mm_add_epi16( _mm_slli_epi16( alpha, 7 ), _mm_set1_epi16( 127 ) );
+
+                scaled = _mm_add_epi16( _mm_add_epi16( scaled, _mm_set1_epi16( 1 ) ), _mm_srli_epi16( scaled, 8 ) );
+
+                alpha = _mm_srli_epi16( scaled, 8 );
+            }
+
+            texels = _mm_or_si128( _mm_and_si128( texels, colorMask ), _mm_slli_epi32( alpha, 24 ) );
+        }
+
+        _mm_storeu_si128( (__m128i*)( dstBytes + n * 4 ), texels );
+    }
+#endif //RWLIB_HAS_SSE2
+
+    const uint8 *alphaTable = NULL;
+
+    if ( alphaTransform == PS2ALPHA_TO_PC )
+    {
+        alphaTable = _ps2AlphaToPCAlphaTable;
+    }
+    else if ( alphaTransform == PS2ALPHA_TO_PS2 )
+    {
+        alphaTable = _pcAlphaToPS2AlphaTable;
+    }
+
+    for ( ; n < texelCount; n++ )
+    {
+        const uint8 *srcTexel = ( srcBytes + n * 4 );
+        uint8 *dstTexel = ( dstBytes + n * 4 );
+
+        uint8 first = srcTexel[0];
+        uint8 second = srcTexel[1];
+        uint8 third = srcTexel[2];
+        uint8 alpha = srcTexel[3];
+
+        if ( swapRedBlue )
+        {
+            std::swap( first, third );
+        }
+
+        if ( alphaTable )
+        {
+            alpha = alphaTable[ alpha ];
+        }
+
+        dstTexel[0] = first;
+        dstTexel[1] = second;
+        dstTexel[2] = third;
+        dstTexel[3] = alpha;
+    }
+}
+
+// Returns true if the texels were transformed using the PSMCT32 kernel.
+inline bool tryTransformPS2Texels8888(
+    const void *srcTexels, void *dstTexels, uint32 mipWidth, uint32 mipHeight,
+    eRasterFormat srcRasterFormat, uint32 srcDepth, uint32 srcRowAlignment, eColorOrdering srcColorOrder,
+    eRasterFormat dstRasterFormat, uint32 dstDepth, uint32 dstRowAlignment, eColorOrdering dstColorOrder,
+    ePS2AlphaTransform alphaTransform
+)
+{
+    if ( srcRasterFormat != RASTER_8888 || dstRasterFormat != RASTER_8888 ||
+         srcDepth != 32 || dstDepth != 32 )
+    {
+        return false;
+    }
 
-    double pcAlphaDouble = clampcolor( (double)pcAlpha / 255.0 );
+    if ( ( srcColorOrder != COLOR_RGBA && srcColorOrder != COLOR_BGRA ) ||
+         ( dstColorOrder != COLOR_RGBA && dstColorOrder != COLOR_BGRA ) )
+    {
+        return false;
+    }
 
-    double ps2AlphaDouble = pcAlphaDouble * 128.0;
+    bool swapRedBlue = ( srcColorOrder != dstColorOrder );
 
-    ps2AlphaDouble = floor( ps2AlphaDouble + 0.5 );
+    uint32 srcRowSize = getRasterDataRowSize( mipWidth, srcDepth, srcRowAlignment );
+    uint32 dstRowSize = getRasterDataRowSize( mipWidth, dstDepth, dstRowAlignment );
 
-    uint8 ps2Alpha = (uint8)( ps2AlphaDouble );
+    for ( uint32 row = 0; row < mipHeight; row++ )
+    {
+        const void *srcRow = getConstTexelDataRow( srcTexels, srcRowSize, row );
+        void *dstRow = getTexelDataRow( dstTexels, dstRowSize, row );
 
-    return ps2Alpha;
+        transformPS2Texels8888( srcRow, dstRow, mipWidth, swapRedBlue, alphaTransform );
+    }
+
+    return true;
 }
 
-inline uint8 convertPS2Alpha2PCAlpha( uint8 ps2Alpha )
+// The color dispatcher rescales the 5bit channels of RASTER_1555 to 8bit and back again.
+// That round trip does not give back every value, so this table holds its result:
+// (uint8)( round( c / 31 * 255 ) / 255 * 31 ), evaluated in float like the dispatcher does.
+static const uint8 _ps2Color5BitRoundTripTable[ 32 ] =
 {
-    // TODO: generate a table that maps PS2 alpha to PC alpha
-    // it has to conform with the table in convertPCAlpha2PS2Alpha
+    0x00, 0x00, 0x01, 0x03, 0x04, 0x04, 0x05, 0x07, 0x08, 0x08, 0x09, 0x0a, 0x0c, 0x0d, 0x0d, 0x0e,
+    0x10, 0x11, 0x11, 0x12, 0x14, 0x15, 0x16, 0x16, 0x17, 0x19, 0x1a, 0x1a, 0x1b, 0x1d, 0x1e, 0x1f
+};
 
-    double ps2AlphaDouble = clampcolor( (double)ps2Alpha / 128.0 );
+#ifdef RWLIB_HAS_SSE2
 
-    double pcAlphaDouble = ps2AlphaDouble * 255.0;
+// Gives the same results as _ps2Color5BitRoundTripTable for all 32 channel values.
+AINLINE __m128i roundTripPS2Color5BitSSE2( __m128i channel )
+{
+    // ( c * 255 + 15 ) / 31 is the rounded 8bit value; the division is done as a multiply.
+    __m128i expanded = _mm_add_epi16( _mm_mullo_epi16( channel, _mm_set1_epi16( 255 ) ), _mm_set1_epi16( 15 ) );
 
-    pcAlphaDouble = floor( pcAlphaDouble + 0.495 );
+    expanded = _mm_srli_epi16( _mm_mulhi_epu16( expanded, _mm_set1_epi16( 4229 ) ), 1 );
 
-    uint8 pcAlpha = (uint8)( pcAlphaDouble );
+    // ( v * 31 ) / 255 truncates back to 5bit.
+    __m128i reduced = _mm_mullo_epi16( expanded, _mm_set1_epi16( 31 ) );
 
-    return pcAlpha;
+    return _mm_srli_epi16( _mm_mulhi_epu16( reduced, _mm_set1_epi16( 4113 ) ), 4 );
+}
+
+#endif //RWLIB_HAS_SSE2
+
+// Transforms a run of 16bit RASTER_1555 texels (PSMCT16) that are in either RGBA or BGRA order.
+// The alpha bit survives both alpha transforms, so only the colors change.
+// Where SSE2 is available eight texels are done per step; both paths match the color dispatcher.
+inline void transformPS2Texels1555(
+    const void *srcTexels, void *dstTexels, uint32 texelCount,
+    bool swapRedBlue
+)
+{
+    const uint16 *srcItems = (const uint16*)srcTexels;
+    uint16 *dstItems = (uint16*)dstTexels;
+
+    uint32 n = 0;
+
+#ifdef RWLIB_HAS_SSE2
+    const __m128i channelMask = _mm_set1_epi16( 0x1F );
+    const __m128i alphaMask = _mm_set1_epi16( (short)0x8000 );
+
+    for ( ; n + 8 <= texelCount; n += 8 )
+    {
+        __m128i texels = _mm_loadu_si128( (const __m128i*)( srcItems + n ) );
+
+        __m128i first = roundTripPS2Color5BitSSE2( _mm_and_si128( texels, channelMask ) );
+        __m128i second = roundTripPS2Color5BitSSE2( _mm_and_si128( _mm_srli_epi16( texels, 5 ), channelMask ) );
+        __m128i third = roundTripPS2Color5BitSSE2( _mm_and_si128( _mm_srli_epi16( texels, 10 ), channelMask ) );
+
+        if ( swapRedBlue )
+        {
+            std::swap( first, third );
+        }
+
+        __m128i colors = _mm_or_si128( first, _mm_or_si128( _mm_slli_epi16( second, 5 ), _mm_slli_epi16( third, 10 ) ) );
+
+        _mm_storeu_si128( (__m128i*)( dstItems + n ), _mm_or_si128( _mm_and_si128( texels, alphaMask ), colors ) );
+    }
+#endif //RWLIB_HAS_SSE2
+
+    for ( ; n < texelCount; n++ )
+    {
+        uint16 texel = srcItems[ n ];
+
+        uint16 first = _ps2Color5BitRoundTripTable[ texel & 0x1F ];
+        uint16 second = _ps2Color5BitRoundTripTable[ ( texel >> 5 ) & 0x1F ];
+        uint16 third = _ps2Color5BitRoundTripTable[ ( texel >> 10 ) & 0x1F ];
+
+        if ( swapRedBlue )
+        {
+            std::swap( first, third );
+        }
+
+        dstItems[ n ] = (uint16)( ( texel & 0x8000 ) | first | ( second << 5 ) | ( third << 10 ) );
+    }
+}
+
+// Returns true if the texels were transformed using the PSMCT16 kernel.
+inline bool tryTransformPS2Texels1555(
+    const void *srcTexels, void *dstTexels, uint32 mipWidth, uint32 mipHeight,
+    eRasterFormat srcRasterFormat, uint32 srcDepth, uint32 srcRowAlignment, eColorOrdering srcColorOrder,
+    eRasterFormat dstRasterFormat, uint32 dstDepth, uint32 dstRowAlignment, eColorOrdering dstColorOrder
+)
+{
+    if ( srcRasterFormat != RASTER_1555 || dstRasterFormat != RASTER_1555 ||
+         srcDepth != 16 || dstDepth != 16 )
+    {
+        return false;
+    }
+
+    if ( ( srcColorOrder != COLOR_RGBA && srcColorOrder != COLOR_BGRA ) ||
+         ( dstColorOrder != COLOR_RGBA && dstColorOrder != COLOR_BGRA ) )
+    {
+        return false;
+    }
+
+    bool swapRedBlue = ( srcColorOrder != dstColorOrder );
+
+    uint32 srcRowSize = getRasterDataRowSize( mipWidth, srcDepth, srcRowAlignment );
+    uint32 dstRowSize = getRasterDataRowSize( mipWidth, dstDepth, dstRowAlignment );
+
+    for ( uint32 row = 0; row < mipHeight; row++ )
+    {
+        const void *srcRow = getConstTexelDataRow( srcTexels, srcRowSize, row );
+        void *dstRow = getTexelDataRow( dstTexels, dstRowSize, row );
+
+        transformPS2Texels1555( srcRow, dstRow, mipWidth, swapRedBlue );
+    }
+
+    return true;
 }
 
 static inline bool doesRequirePlatformDestinationConversion(
@@ -77,6 +353,22 @@ inline void convertTexelsFromPS2(
         )
     )
     {
+        bool couldTransformFast =
+            tryTransformPS2Texels8888(
+                texelSource, dstTexels, mipWidth, mipHeight,
+                srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder,
+                dstRasterFormat, dstDepth, dstRowAlignment, dstColorOrder,
+                ( fixAlpha ? PS2ALPHA_TO_PC : PS2ALPHA_KEEP )
+            ) ||
+            tryTransformPS2Texels1555(
+                texelSource, dstTexels, mipWidth, mipHeight,
+                srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder,
+                dstRasterFormat, dstDepth, dstRowAlignment, dstColorOrder
+            );
+
+        if ( couldTransformFast )
+            return;
+
         colorModelDispatcher fetchDispatch( srcRasterFormat, srcColorOrder, srcDepth, NULL, 0, PALETTE_NONE );
         colorModelDispatcher putDispatch( dstRasterFormat, dstColorOrder, dstDepth, NULL, 0, PALETTE_NONE );
 
@@ -133,6 +425,22 @@ inline void convertTexelsToPS2(
         )
     )
     {
+        bool couldTransformFast =
+            tryTransformPS2Texels8888(
+                srcTexelData, dstTexelData, mipWidth, mipHeight,
+                srcRasterFormat, srcItemDepth, srcRowAlignment, srcColorOrder,
+                dstRasterFormat, dstItemDepth, dstRowAlignment, ps2ColorOrder,
+                ( fixAlpha ? PS2ALPHA_TO_PS2 : PS2ALPHA_KEEP )
+            ) ||
+            tryTransformPS2Texels1555(
+                srcTexelData, dstTexelData, mipWidth, mipHeight,
+                srcRasterFormat, srcItemDepth, srcRowAlignment, srcColorOrder,
+                dstRasterFormat, dstItemDepth, dstRowAlignment, ps2ColorOrder
+            );
+
+        if ( couldTransformFast )
+            return;
+
         colorModelDispatcher fetchDispatch( srcRasterFormat, srcColorOrder, srcItemDepth, NULL, 0, PALETTE_NONE );
         colorModelDispatcher putDispatch( dstRasterFormat, ps2ColorOrder, dstItemDepth, NULL, 0, PALETTE_NONE );
 
@@ -178,6 +486,51 @@ const static uint32 _clut_permute_psmct32[] =
     0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
 };
 
+// The PSMCT32 CLUT permutation works on blocks of 16x2 entries and swaps the entries 8..15
+// of the first row with the entries 0..7 of the second row.
+// If the CLUT is made of whole blocks we can do that using block copies.
+inline bool tryPermuteCLUTBlocks(
+    const void *srcTexels, void *dstTexels,
+    uint32 clutWidth, uint32 clutHeight, uint32 itemDepth, uint32 clutDataSize
+)
+{
+    if ( clutWidth == 0 || ( clutWidth % 16 ) != 0 || ( clutHeight % 2 ) != 0 || ( itemDepth % 8 ) != 0 )
+        return false;
+
+    const uint32 itemSize = ( itemDepth / 8 );
+    const uint32 rowSize = ( itemSize * clutWidth );
+
+    if ( clutDataSize < rowSize * clutHeight )
+        return false;
+
+    const uint32 blocksWide = ( clutWidth / 16 );
+    const uint32 halfSize = ( itemSize * 8 );
+
+    const uint8 *srcBytes = (const uint8*)srcTexels;
+    uint8 *dstBytes = (uint8*)dstTexels;
+
+    for ( uint32 row = 0; row < clutHeight; row += 2 )
+    {
+        const uint8 *srcFirstRow = ( srcBytes + row * rowSize );
+        const uint8 *srcSecondRow = ( srcFirstRow + rowSize );
+
+        uint8 *dstFirstRow = ( dstBytes + row * rowSize );
+        uint8 *dstSecondRow = ( dstFirstRow + rowSize );
+
+        for ( uint32 block = 0; block < blocksWide; block++ )
+        {
+            uint32 blockOffset = ( block * halfSize * 2 );
+
+            memcpy( dstFirstRow + blockOffset, srcFirstRow + blockOffset, halfSize );
+            memcpy( dstFirstRow + blockOffset + halfSize, srcSecondRow + blockOffset, halfSize );
+            memcpy( dstSecondRow + blockOffset, srcFirstRow + blockOffset + halfSize, halfSize );
+            memcpy( dstSecondRow + blockOffset + halfSize, srcSecondRow + blockOffset + halfSize, halfSize );
+        }
+    }
+
+    return true;
+}
+
 static bool clut(
     Interface *engineInterface,
     ePaletteType paletteType, void *srcTexels,
@@ -227,15 +580,25 @@ static bool clut(
             const uint32 clutRequiredRowAlignment = 1;
 
             // Perform the permutation.
-            memcodec::permutationUtilities::permuteArray(
-                srcTexels, clutWidth, clutHeight, itemDepth, permuteWidth, permuteHeight,
-                dstTexels, clutWidth, clutHeight, itemDepth, permuteWidth, permuteHeight,
-                colsWidth, colsHeight,
-                permuteData, permuteData, permuteWidth, permuteHeight,
-                1, 1,
-                clutRequiredRowAlignment, clutRequiredRowAlignment,
-                false
-            );
+            bool couldPermuteFast = false;
+
+            if ( permuteData == _clut_permute_psmct32 )
+            {
+                couldPermuteFast = tryPermuteCLUTBlocks( srcTexels, dstTexels, clutWidth, clutHeight, itemDepth, clutDataSize );
+            }
+
+            if ( !couldPermuteFast )
+            {
+                memcodec::permutationUtilities::permuteArray(
+                    srcTexels, clutWidth, clutHeight, itemDepth, permuteWidth, permuteHeight,
+                    dstTexels, clutWidth, clutHeight, itemDepth, permuteWidth, permuteHeight,
+                    colsWidth, colsHeight,
+                    permuteData, permuteData, permuteWidth, permuteHeight,
+                    1, 1,
+                    clutRequiredRowAlignment, clutRequiredRowAlignment,
+                    false
+                );
+            }
 
             // Return the new texels.
             newTexels = dstTexels;
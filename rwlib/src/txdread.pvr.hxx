@@ -2,13 +2,10 @@
 
 #include "txdread.nativetex.hxx"
 
-// The PowerVR stuff includes the Windows header.
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-#include <PVRTextureUtilities.h>
-
 #include "txdread.d3d.genmip.hxx"
 
+#include "txdread.pvrtc.hxx"
+
 #include "txdread.common.hxx"
 
 #include "pluginutil.hxx"
@@ -23,7 +20,7 @@ namespace rw
 inline uint32 getPVRToolTextureDataRowAlignment( void )
 {
     // Since PowerVR is a compressed format, there is no real row alignment.
-    // This row alignment is supposedly what the PowerVR encoding tool expects.
+    // The PVRTC codec works on tightly packed 32bit RGBA rows, which this alignment keeps.
     return 4;
 }
 
@@ -63,6 +60,12 @@ inline uint32 getDepthByPVRFormat( ePVRInternalFormat theFormat )
     return formatDepth;
 }
 
+inline bool doesPVRFormatHaveAlpha( ePVRInternalFormat theFormat )
+{
+    return ( theFormat == GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG ||
+             theFormat == GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG );
+}
+
 inline bool getPVRCompressionBlockDimensions( uint32 formatDepth, uint32& blockWidthOut, uint32& blockHeightOut )
 {
     if ( formatDepth == 2 )
@@ -189,18 +192,12 @@ struct pvrNativeTextureTypeProvider : public texNativeTypeProvider
         storeCaps.isCompressedFormat = true;
     }
 
-    // Public API.
-    typedef void* PVRTextureHeader;
-    typedef void* PVRTexture;
-    typedef void* PVRPixelType;
-
     // Transformation pipeline functions.
     void DecompressPVRMipmap(
         Interface *engineInterface,
         uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels,
-        eRasterFormat pvrRasterFormat, uint32 pvrDepth, eColorOrdering pvrColorOrder,
+        ePVRInternalFormat internalFormat,
         eRasterFormat targetRasterFormat, uint32 targetDepth, uint32 targetRowAlignment, eColorOrdering targetColorOrder,
-        PVRPixelType pvrSrcPixelType, PVRPixelType pvrDstPixelType,
         void*& dstTexelsOut, uint32& dstDataSizeOut
     );
     template <typename srcDispatchType>
@@ -208,115 +205,103 @@ struct pvrNativeTextureTypeProvider : public texNativeTypeProvider
         Interface *engineInterface,
         uint32 mipWidth, uint32 mipHeight, const void *srcTexels,
         srcDispatchType& fetchDispatch, uint32 srcDepth, uint32 srcRowAlignment,
-        eRasterFormat pvrRasterFormat, uint32 pvrDepth, eColorOrdering pvrColorOrder,
-        PVRPixelType pvrSrcPixelType, PVRPixelType pvrDstPixelType,
-        uint32 pvrBlockWidth, uint32 pvrBlockHeight,
-        uint32 pvrBlockDepth,
+        ePVRInternalFormat internalFormat,
         uint32& widthOut, uint32& heightOut,
         void*& dstTexelsOut, uint32& dstDataSizeOut
     )
     {
-        // Create a PVR texture.
-        uint32 srcRowSize = getRasterDataRowSize( mipWidth, srcDepth, srcRowAlignment );
+        // Determine the block dimensions of the PVR destination texture.
+        uint32 pvrDepth = getDepthByPVRFormat( internalFormat );
 
-        // We need to determine dimensions that the PVR texture has to use.
-        uint32 pvrTexWidth = ALIGN_SIZE( mipWidth, pvrBlockWidth );
-        uint32 pvrTexHeight = ALIGN_SIZE( mipHeight, pvrBlockHeight );
+        uint32 pvrBlockWidth, pvrBlockHeight;
 
-        uint32 pvrRowSize = getRasterDataRowSize( pvrTexWidth, pvrDepth, getPVRToolTextureDataRowAlignment() );
+        bool gotDimms = getPVRCompressionBlockDimensions( pvrDepth, pvrBlockWidth, pvrBlockHeight );
 
-        PVRTextureHeader pvrHeader = PVRTextureHeaderCreate( PVRPixelTypeGetID( pvrSrcPixelType ), pvrTexHeight, pvrTexWidth );
-
-        if ( !pvrHeader )
+        if ( !gotDimms )
         {
-            throw RwException( "failed to create PVRTexLib texture header" );
+            throw RwException( "failed to get PVR block compression dimensions in PowerVR native texture mipmap compression" );
         }
 
-        try
-        {
-            // Copy stuff into the PVR texture properly.
-            PVRTexture pvrTexture = PVRTextureCreate( pvrHeader );
+        uint32 srcRowSize = getRasterDataRowSize( mipWidth, srcDepth, srcRowAlignment );
 
-            if ( !pvrTexture )
-            {
-                throw RwException( "failed to create PVRTexLib texture handle" );
-            }
+        // We need to determine dimensions that the PVR texture has to use.
+        uint32 pvrTexWidth = ALIGN_SIZE( mipWidth, pvrBlockWidth );
+        uint32 pvrTexHeight = ALIGN_SIZE( mipHeight, pvrBlockHeight );
 
-            try
-            {
-                // Process the colors into the PowerVR texture.
-                {
-                    void *pvrDstBuf = PVRTextureGetDataPtr( pvrTexture );
+        pvrtc::pvrtcSurface pvrSurface( pvrTexWidth, pvrTexHeight, ( pvrDepth == 2 ) );
 
-                    colorModelDispatcher putDispatch( pvrRasterFormat, pvrColorOrder, pvrDepth, NULL, 0, PALETTE_NONE );
+        if ( !pvrSurface.isValid() )
+        {
+            throw RwException( "invalid mipmap dimensions in PowerVR native texture mipmap compression" );
+        }
 
-                    copyTexelDataBounded(
-                        srcTexels, pvrDstBuf,
-                        fetchDispatch, putDispatch,
-                        mipWidth, mipHeight,
-                        pvrTexWidth, pvrTexHeight,
-                        0, 0,
-                        0, 0,
-                        srcRowSize, pvrRowSize
-                    );
-                }
+        // The codec takes 32bit RGBA colors.
+        uint32 rgbaRowSize = getRasterDataRowSize( pvrTexWidth, 32, getPVRToolTextureDataRowAlignment() );
 
-                // Transcode it.
-                bool transcodeSuccess =
-                    PVRTranscode( pvrTexture, pvrDstPixelType, ePVRTVarTypeUnsignedByteNorm, ePVRTCSpacelRGB );
+        uint32 rgbaDataSize = getRasterDataSizeByRowSize( rgbaRowSize, pvrTexHeight );
 
-                if ( transcodeSuccess == false )
-                {
-                    throw RwException( "failed to compress texture data to PVRTC using PVRTexLib" );
-                }
+        void *rgbaTexels = engineInterface->PixelAllocate( rgbaDataSize );
 
-                // Copy the PowerVR pixels into a local array.
-                uint32 dstDataSize = getPackedRasterDataSize(pvrTexWidth * pvrTexHeight, pvrBlockDepth);
+        if ( !rgbaTexels )
+        {
+            throw RwException( "failed to allocate color buffer in PowerVR native texture mipmap compression" );
+        }
 
-                PVRTextureHeaderCheckDataSize( pvrTexture, dstDataSize );
+        try
+        {
+            colorModelDispatcher putDispatch( RASTER_8888, COLOR_RGBA, 32, NULL, 0, PALETTE_NONE );
 
-                void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
+            copyTexelDataBounded(
+                srcTexels, rgbaTexels,
+                fetchDispatch, putDispatch,
+                mipWidth, mipHeight,
+                pvrTexWidth, pvrTexHeight,
+                0, 0,
+                0, 0,
+                srcRowSize, rgbaRowSize
+            );
 
-                if ( !dstTexels )
-                {
-                    throw RwException( "failed to allocate copy-buffer for PVRTC compressed data in PowerVR native texture mipmap compression" );
-                }
+            uint32 dstDataSize = pvrSurface.getDataSize();
 
-                memcpy( dstTexels, PVRTextureGetDataPtr( pvrTexture ), dstDataSize );
+            void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
 
-                // Give parameters to the runtime.
-                widthOut = pvrTexWidth;
-                heightOut = pvrTexHeight;
+            if ( !dstTexels )
+            {
+                throw RwException( "failed to allocate PVRTC compressed data in PowerVR native texture mipmap compression" );
+            }
 
-                dstTexelsOut = dstTexels;
-                dstDataSizeOut = dstDataSize;
+            try
+            {
+                pvrtc::compressPVRTC( engineInterface, pvrSurface, rgbaTexels, doesPVRFormatHaveAlpha( internalFormat ), dstTexels );
             }
             catch( ... )
             {
-                PVRTextureDelete( pvrTexture );
+                engineInterface->PixelFree( dstTexels );
 
                 throw;
             }
 
-            PVRTextureDelete( pvrTexture );
+            // Give parameters to the runtime.
+            widthOut = pvrTexWidth;
+            heightOut = pvrTexHeight;
+
+            dstTexelsOut = dstTexels;
+            dstDataSizeOut = dstDataSize;
         }
         catch( ... )
         {
-            PVRTextureHeaderDelete( pvrHeader );
+            engineInterface->PixelFree( rgbaTexels );
 
             throw;
         }
 
-        PVRTextureHeaderDelete( pvrHeader );
+        engineInterface->PixelFree( rgbaTexels );
     }
     void pvrNativeTextureTypeProvider::CompressMipmapToPVR(
         Interface *engineInterface,
         uint32 mipWidth, uint32 mipHeight, const void *srcTexels,
         eRasterFormat srcRasterFormat, uint32 srcDepth, uint32 srcRowAlignment, eColorOrdering srcColorOrder, ePaletteType srcPaletteType, const void *srcPaletteData, uint32 srcPaletteSize,
-        eRasterFormat pvrRasterFormat, uint32 pvrDepth, eColorOrdering pvrColorOrder,
-        PVRPixelType pvrSrcPixelType, PVRPixelType pvrDstPixelType,
-        uint32 pvrBlockWidth, uint32 pvrBlockHeight,
-        uint32 pvrBlockDepth,
+        ePVRInternalFormat internalFormat,
         uint32& widthOut, uint32& heightOut,
         void*& dstTexelsOut, uint32& dstDataSizeOut
     )
@@ -327,10 +312,7 @@ struct pvrNativeTextureTypeProvider : public texNativeTypeProvider
             engineInterface,
             mipWidth, mipHeight, srcTexels,
             fetchDispatch, srcDepth, srcRowAlignment,
-            pvrRasterFormat, pvrDepth, pvrColorOrder,
-            pvrSrcPixelType, pvrDstPixelType,
-            pvrBlockWidth, pvrBlockHeight,
-            pvrBlockDepth,
+            internalFormat,
             widthOut, heightOut,
             dstTexelsOut, dstDataSizeOut
         );
@@ -443,354 +425,12 @@ struct pvrNativeTextureTypeProvider : public texNativeTypeProvider
         return 0;
     }
 
-private:
-    static constexpr size_t FUTURE_BUFFER_EXAPAND = 128u;
-
-    typedef void (__thiscall* PVRTextureHeader_constructor_t)(
-        void *memory,
-        pvrtexture::uint64 pixelFormat,
-        pvrtexture::uint32 height, pvrtexture::uint32 width,
-        pvrtexture::uint32 depth,
-        pvrtexture::uint32 numMipmaps,
-        pvrtexture::uint32 numArrayMembers,
-        pvrtexture::uint32 numFaces,
-        EPVRTColourSpace colorSpace,
-        EPVRTVariableType varType,
-        bool preMultiplied
-    );
-    typedef void (__thiscall* PVRTextureHeader_destructor_t)( pvrtexture::CPVRTextureHeader *header );
-    typedef pvrtexture::uint32 (__thiscall* PVRTextureHeader_getDataSize_t)( const pvrtexture::CPVRTextureHeader *header, pvrtexture::int32 iMipLevel, bool bAllSurfaces, bool bAllFaces );
-
-    typedef void (__thiscall* PVRTexture_constructor_t)( void *memory, const pvrtexture::CPVRTextureHeader& pvrHeader, const void *pData );
-    typedef void (__thiscall* PVRTexture_destructor_t)( pvrtexture::CPVRTexture *texture );
-    typedef void* (__thiscall* PVRTexture_getDataPtr_t)( const pvrtexture::CPVRTexture *texture, pvrtexture::uint32 uiMIPLevel, pvrtexture::uint32 uiArrayMember, pvrtexture::uint32 uiFaceNumber );
-
-    typedef void (__thiscall* PVRPixelType_constructor_byFormat_t)( void *memory, pvrtexture::uint64 format );
-    typedef void (__thiscall* PVRPixelType_constructor_t)( void *memory, pvrtexture::uint8 C1Name, pvrtexture::uint8 C2Name, pvrtexture::uint8 C3Name, pvrtexture::uint8 C4Name, pvrtexture::uint8 C1Bits, pvrtexture::uint8 C2Bits, pvrtexture::uint8 C3Bits, pvrtexture::uint8 C4Bits );
-
-    typedef bool (__cdecl* PVRTranscode_t)( pvrtexture::CPVRTexture& sTexture, const pvrtexture::PixelType ptFormat, const EPVRTVariableType eChannelType, const EPVRTColourSpace eColourspace, const pvrtexture::ECompressorQuality eQuality, const bool bDoDither );
-
-    // We want to have dynamic access to PVRTexLib functions, because Imagination Technologies refuses to ship static libraries.
-    PVRTextureHeader_constructor_t pvrHeaderConstructor;
-    PVRTextureHeader_destructor_t pvrHeaderDestructor;
-    PVRTextureHeader_getDataSize_t pvrHeaderGetDataSize;
-
-    PVRTexture_constructor_t pvrTextureConstructor;
-    PVRTexture_destructor_t pvrTextureDestructor;
-    PVRTexture_getDataPtr_t pvrTextureGetDataPtr;
-
-    PVRPixelType_constructor_byFormat_t pvrPixelTypeConstructorByFormat;
-    PVRPixelType_constructor_t pvrPixelTypeConstructor;
-
-    PVRTranscode_t pvrTranscode;
-
     bool wasRegistered;
-    HMODULE pvrModule;
-    
-public:
-    // Cached pixel type things.
-    PVRPixelType pvrPixelType_pvrtc_2bpp_rgb;
-    PVRPixelType pvrPixelType_pvrtc_2bpp_rgba;
-    PVRPixelType pvrPixelType_pvrtc_4bpp_rgb;
-    PVRPixelType pvrPixelType_pvrtc_4bpp_rgba;
-
-    PVRPixelType pvrPixelType_rgba8888;
-
-    PVRTextureHeader PVRTextureHeaderCreate(
-        pvrtexture::uint64 pixelFormat,
-        pvrtexture::uint32 height, pvrtexture::uint32 width,
-        pvrtexture::uint32 depth = 1,
-        pvrtexture::uint32 numMipmaps = 1,
-        pvrtexture::uint32 numArrayMembers = 1,
-        pvrtexture::uint32 numFaces = 1,
-        EPVRTColourSpace colorSpace = ePVRTCSpacelRGB,
-        EPVRTVariableType varType = ePVRTVarTypeUnsignedByteNorm,
-        bool preMultiplied = false
-    )
-    {
-        if ( auto pvrHeaderConstructor = this->pvrHeaderConstructor )
-        {
-            void *headerMem = new char[ sizeof( pvrtexture::CPVRTextureHeader ) + FUTURE_BUFFER_EXAPAND ];
-
-            if ( headerMem )
-            {
-                try
-                {
-                    pvrHeaderConstructor( headerMem, pixelFormat, height, width, depth, numMipmaps, numArrayMembers, numFaces, colorSpace, varType, preMultiplied );
-
-                    return (PVRTextureHeader)headerMem;
-                }
-                catch( ... )
-                {
-                    delete [] headerMem;
-
-                    throw;
-                }
-            }
-        }
-
-        return NULL;
-    }
-
-    void PVRTextureHeaderDelete( PVRTextureHeader header )
-    {
-        auto pvrHeaderDestructor = this->pvrHeaderDestructor;
-
-        assert( pvrHeaderDestructor != NULL );
-        {
-            pvrtexture::CPVRTextureHeader *pvrHeader = (pvrtexture::CPVRTextureHeader*)header;
-
-            pvrHeaderDestructor( pvrHeader );
-        }
-
-        delete [] (char*)header;
-    }
-
-    void PVRTextureHeaderCheckDataSize( PVRTextureHeader header, uint32 minDataSize )
-    {
-        if ( auto pvrHeaderGetDataSize = this->pvrHeaderGetDataSize )
-        {
-            pvrtexture::CPVRTextureHeader *pvrHeader = (pvrtexture::CPVRTextureHeader*)header;
-
-            uint32 actualDataSize = pvrHeaderGetDataSize( pvrHeader, PVRTEX_ALLMIPLEVELS, true, true );
-
-            assert( actualDataSize >= minDataSize );
-        }
-    }
-
-    PVRTexture PVRTextureCreate( PVRTextureHeader header, const void *dataPtr = NULL )
-    {
-        if ( auto pvrTextureConstructor = this->pvrTextureConstructor )
-        {
-            void *texMem = new char[ sizeof( pvrtexture::CPVRTexture ) + FUTURE_BUFFER_EXAPAND ];
-
-            if ( texMem )
-            {
-                try
-                {
-                    pvrtexture::CPVRTextureHeader *pvrHeader = (pvrtexture::CPVRTextureHeader*)header;
-
-                    pvrTextureConstructor( texMem, *pvrHeader, dataPtr );
-
-                    return (PVRTexture)texMem;
-                }
-                catch( ... )
-                {
-                    delete [] texMem;
-
-                    throw;
-                }
-            }
-        }
-        
-        return NULL;
-    }
-
-    void PVRTextureDelete( PVRTexture texture )
-    {
-        auto pvrTextureDestructor = this->pvrTextureDestructor;
-
-        assert( pvrTextureDestructor != NULL );
-        {
-            pvrtexture::CPVRTexture *pvrTexture = (pvrtexture::CPVRTexture*)texture;
-
-            pvrTextureDestructor( pvrTexture );
-        }
-
-        delete [] (char*)texture;
-    }
-
-    void* PVRTextureGetDataPtr( PVRTexture texture )
-    {
-        if ( auto pvrTextureGetDataPtr = this->pvrTextureGetDataPtr )
-        {
-            pvrtexture::CPVRTexture *pvrTexture = (pvrtexture::CPVRTexture*)texture;
-
-            return pvrTextureGetDataPtr( pvrTexture, 0, 0, 0 );
-        }
-
-        return NULL;
-    }
-
-    PVRPixelType PVRPixelTypeCreateByFormat( pvrtexture::uint64 format )
-    {
-        if ( auto pvrPixelTypeConstructorByFormat = this->pvrPixelTypeConstructorByFormat )
-        {
-            void *pixelTypeMem = new char[ sizeof( pvrtexture::PixelType ) + FUTURE_BUFFER_EXAPAND ];
-
-            if ( pixelTypeMem )
-            {
-                try
-                {
-                    pvrPixelTypeConstructorByFormat( pixelTypeMem, format );
-
-                    pvrtexture::PixelType *pvrPixelType = (pvrtexture::PixelType*)pixelTypeMem;
-
-                    return (PVRPixelType)pvrPixelType;
-                }
-                catch( ... )
-                {
-                    delete [] pixelTypeMem;
-
-                    throw;
-                }
-            }
-        }
-
-        return NULL;
-    }
-
-    PVRPixelType PVRPixelTypeCreate( pvrtexture::uint8 C1Name, pvrtexture::uint8 C2Name, pvrtexture::uint8 C3Name, pvrtexture::uint8 C4Name, pvrtexture::uint8 C1Bits, pvrtexture::uint8 C2Bits, pvrtexture::uint8 C3Bits, pvrtexture::uint8 C4Bits )
-    {
-        if ( auto pvrPixelTypeConstructor = this->pvrPixelTypeConstructor )
-        {
-            void *pixelTypeMem = new char[ sizeof( pvrtexture::PixelType ) + FUTURE_BUFFER_EXAPAND ];
-
-            if ( pixelTypeMem )
-            {
-                try
-                {
-                    pvrPixelTypeConstructor( pixelTypeMem, C1Name, C2Name, C3Name, C4Name, C1Bits, C2Bits, C3Bits, C4Bits );
-
-                    return (PVRPixelType)pixelTypeMem;
-                }
-                catch( ... )
-                {
-                    delete [] pixelTypeMem;
-
-                    throw;
-                }
-            }
-        }
-
-        return NULL;
-    }
-
-    void PVRPixelTypeDelete( PVRPixelType pixelType )
-    {
-        delete [] (char*)pixelType;
-    }
-
-    pvrtexture::uint64 PVRPixelTypeGetID( PVRPixelType pixelType )
-    {
-        if ( pvrtexture::PixelType *pvrPixelType = (pvrtexture::PixelType*)pixelType )
-        {
-            return pvrPixelType->PixelTypeID;
-        }
-
-        return 0;
-    }
-
-    PVRPixelType PVRGetCachedPixelType( ePVRInternalFormat internalFormat )
-    {
-        if ( internalFormat == GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG )
-        {
-            return this->pvrPixelType_pvrtc_2bpp_rgb;
-        }
-        else if ( internalFormat == GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG )
-        {
-            return this->pvrPixelType_pvrtc_2bpp_rgba;
-        }
-        else if ( internalFormat == GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG )
-        {
-            return this->pvrPixelType_pvrtc_4bpp_rgb;
-        }
-        else if ( internalFormat == GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG )
-        {
-            return this->pvrPixelType_pvrtc_4bpp_rgba;
-        }
-
-        return NULL;
-    }
-
-    bool PVRTranscode( PVRTexture sTexture, PVRPixelType ptFormat, const EPVRTVariableType eChannelType, const EPVRTColourSpace eColourspace, const pvrtexture::ECompressorQuality eQuality=pvrtexture::ePVRTCNormal, const bool bDoDither=false )
-    {
-        if ( auto pvrTranscode = this->pvrTranscode )
-        {
-            pvrtexture::CPVRTexture *pvrSrcTexture = (pvrtexture::CPVRTexture*)sTexture;
-            pvrtexture::PixelType *pvrPtFormat = (pvrtexture::PixelType*)ptFormat;
-
-            return pvrTranscode( *pvrSrcTexture, *pvrPtFormat, eChannelType, eColourspace, eQuality, bDoDither );
-        }
-
-        return false;
-    }
 
     inline void Initialize( Interface *engineInterface )
     {
-        bool didRegister = false;
-
-        HMODULE pvrModule = LoadLibraryA( "PVRTexLib.dll" );
-
-        PVRTextureHeader_constructor_t pvrHeaderConstructor = NULL;
-        PVRTextureHeader_destructor_t pvrHeaderDestructor = NULL;
-        PVRTextureHeader_getDataSize_t pvrHeaderGetDataSize = NULL;
-
-        PVRTexture_constructor_t pvrTextureConstructor = NULL;
-        PVRTexture_destructor_t pvrTextureDestructor = NULL;
-        PVRTexture_getDataPtr_t pvrTextureGetDataPtr = NULL;
-
-        PVRPixelType_constructor_byFormat_t pvrPixelTypeConstructorByFormat = NULL;
-        PVRPixelType_constructor_t pvrPixelTypeConstructor = NULL;
-
-        PVRTranscode_t pvrTranscode = NULL;
-
-        this->pvrPixelType_pvrtc_2bpp_rgb = NULL;
-        this->pvrPixelType_pvrtc_2bpp_rgba = NULL;
-        this->pvrPixelType_pvrtc_4bpp_rgb = NULL;
-        this->pvrPixelType_pvrtc_4bpp_rgba = NULL;
-        this->pvrPixelType_rgba8888 = NULL;
-
-        if ( pvrModule )
-        {
-            pvrHeaderConstructor = (PVRTextureHeader_constructor_t)GetProcAddress( pvrModule, "??0CPVRTextureHeader@pvrtexture@@QEAA@_KIIIIIIW4EPVRTColourSpace@@W4EPVRTVariableType@@_N@Z" );
-            pvrHeaderDestructor = (PVRTextureHeader_destructor_t)GetProcAddress( pvrModule, "??1CPVRTextureHeader@pvrtexture@@QEAA@XZ" );
-            pvrHeaderGetDataSize = (PVRTextureHeader_getDataSize_t)GetProcAddress( pvrModule, "?getDataSize@CPVRTextureHeader@pvrtexture@@QEBAIH_N0@Z" );
-
-            pvrTextureConstructor = (PVRTexture_constructor_t)GetProcAddress( pvrModule, "??0CPVRTexture@pvrtexture@@QEAA@AEBVCPVRTextureHeader@1@PEBX@Z" );
-            pvrTextureDestructor = (PVRTexture_destructor_t)GetProcAddress( pvrModule, "??1CPVRTexture@pvrtexture@@QEAA@XZ" );
-            pvrTextureGetDataPtr = (PVRTexture_getDataPtr_t)GetProcAddress( pvrModule, "?getDataPtr@CPVRTexture@pvrtexture@@QEBAPEAXIII@Z" );
-
-            pvrPixelTypeConstructorByFormat = (PVRPixelType_constructor_byFormat_t)GetProcAddress( pvrModule, "??0PixelType@pvrtexture@@QEAA@_K@Z" );
-            pvrPixelTypeConstructor = (PVRPixelType_constructor_t)GetProcAddress( pvrModule, "??0PixelType@pvrtexture@@QEAA@EEEEEEEE@Z" );
-
-            pvrTranscode = (PVRTranscode_t)GetProcAddress( pvrModule, "?Transcode@pvrtexture@@YA_NAEAVCPVRTexture@1@TPixelType@1@W4EPVRTVariableType@@W4EPVRTColourSpace@@W4ECompressorQuality@1@_N@Z" );
-        }
-
-        this->pvrHeaderConstructor = pvrHeaderConstructor;
-        this->pvrHeaderDestructor = pvrHeaderDestructor;
-        this->pvrHeaderGetDataSize = pvrHeaderGetDataSize;
-
-        this->pvrTextureConstructor = pvrTextureConstructor;
-        this->pvrTextureDestructor = pvrTextureDestructor;
-        this->pvrTextureGetDataPtr = pvrTextureGetDataPtr;
-
-        this->pvrPixelTypeConstructorByFormat = pvrPixelTypeConstructorByFormat;
-        this->pvrPixelTypeConstructor = pvrPixelTypeConstructor;
-
-        this->pvrTranscode = pvrTranscode;
-        this->pvrModule = pvrModule;
-
-        // Validate if we have a proper API configuration.
-        if ( pvrHeaderConstructor && pvrHeaderDestructor &&
-             pvrTextureConstructor && pvrTextureDestructor && pvrTextureGetDataPtr &&
-             pvrTranscode &&
-             pvrPixelTypeConstructorByFormat && pvrPixelTypeConstructor )
-        {
-            // Cache important pixel types.
-            {
-                this->pvrPixelType_pvrtc_2bpp_rgb = PVRPixelTypeCreateByFormat( ePVRTPF_PVRTCI_2bpp_RGB );
-                this->pvrPixelType_pvrtc_2bpp_rgba = PVRPixelTypeCreateByFormat( ePVRTPF_PVRTCI_2bpp_RGBA );
-                this->pvrPixelType_pvrtc_4bpp_rgb = PVRPixelTypeCreateByFormat( ePVRTPF_PVRTCI_4bpp_RGB );
-                this->pvrPixelType_pvrtc_4bpp_rgba = PVRPixelTypeCreateByFormat( ePVRTPF_PVRTCI_4bpp_RGBA );
-
-                this->pvrPixelType_rgba8888 = PVRPixelTypeCreate( 'r', 'g', 'b', 'a', 8, 8, 8, 8 );
-            }
-
-            didRegister = RegisterNativeTextureType( engineInterface, "PowerVR", this, sizeof( NativeTexturePVR ) );
-        }
-
-        this->wasRegistered = didRegister;
+        // PVRTC is handled by our own codec, so the native texture is always available.
+        this->wasRegistered = RegisterNativeTextureType( engineInterface, "PowerVR", this, sizeof( NativeTexturePVR ) );
     }
 
     inline void Shutdown( Interface *engineInterface )
@@ -801,65 +441,6 @@ public:
 
             this->wasRegistered = false;
         }
-
-        // Clean up cached things.
-        {
-            if ( this->pvrPixelType_pvrtc_2bpp_rgb )
-            {
-                PVRPixelTypeDelete( this->pvrPixelType_pvrtc_2bpp_rgb );
-
-                this->pvrPixelType_pvrtc_2bpp_rgb = NULL;
-            }
-
-            if ( this->pvrPixelType_pvrtc_2bpp_rgba )
-            {
-                PVRPixelTypeDelete( this->pvrPixelType_pvrtc_2bpp_rgba );
-
-                this->pvrPixelType_pvrtc_2bpp_rgba = NULL;
-            }
-
-            if ( this->pvrPixelType_pvrtc_4bpp_rgb )
-            {
-                PVRPixelTypeDelete( this->pvrPixelType_pvrtc_4bpp_rgb );
-
-                this->pvrPixelType_pvrtc_4bpp_rgb = NULL;
-            }
-
-            if ( this->pvrPixelType_pvrtc_4bpp_rgba )
-            {
-                PVRPixelTypeDelete( this->pvrPixelType_pvrtc_4bpp_rgba );
-
-                this->pvrPixelType_pvrtc_4bpp_rgba = NULL;
-            }
-
-            if ( this->pvrPixelType_rgba8888 )
-            {
-                PVRPixelTypeDelete( this->pvrPixelType_rgba8888 );
-                
-                this->pvrPixelType_rgba8888 = NULL;
-            }
-        }
-
-        // Clean up function stuff.
-        this->pvrHeaderConstructor = NULL;
-        this->pvrHeaderDestructor = NULL;
-        this->pvrHeaderGetDataSize = NULL;
-
-        this->pvrTextureConstructor = NULL;
-        this->pvrTextureDestructor = NULL;
-        this->pvrTextureGetDataPtr = NULL;
-
-        this->pvrPixelTypeConstructorByFormat = NULL;
-        this->pvrPixelTypeConstructor = NULL,
-
-        this->pvrTranscode = NULL;
-
-        if ( HMODULE pvrModule = this->pvrModule )
-        {
-            FreeLibrary( pvrModule );
-
-            this->pvrModule = NULL;
-        }
     }
 
     inline void operator =( const pvrNativeTextureTypeProvider& right )
@@ -0,0 +1,1278 @@
+#ifndef _RENDERWARE_PVRTC_CODEC_
+#define _RENDERWARE_PVRTC_CODEC_
+
+// PowerVR texture compression (PVRTC version 1) codec.
+// Unlike DXT, a PVRTC block does not own its colors: every block stores two low-precision
+// endpoint colors, which are bilinearly upscaled over the whole image, and per pixel
+// modulation values that blend between the two upscaled images.
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "pixelformat.hxx"
+
+#include "rwthreading.parallel.hxx"
+
+#include "rwsimd.hxx"
+
+namespace rw
+{
+
+namespace pvrtc
+{
+
+// Each block is a 64bit word of modulation data followed by the color data.
+template <template <typename numberType> class endianness>
+struct pvrtc_block
+{
+    endianness <uint32> modulationData;
+    endianness <uint32> colorData;
+};
+static_assert( sizeof( pvrtc_block <endian::little_endian> ) == 8, "PVRTC block must be 8 bytes in size!" );
+
+// Endpoint color in hardware precision: 5bit color channels and 4bit alpha.
+struct pvrtcColor
+{
+    uint32 r, g, b, a;
+};
+
+// Endpoint color while encoding, in 8bit range.
+struct pvrtcFloatColor
+{
+    float c[ 4 ];
+};
+
+// Modulation weights in eighths, indexed by the two-bit modulation value.
+static const uint32 pvrtcModulationWeights[ 4 ] = { 0, 3, 5, 8 };
+
+// How the modulation weight of a pixel is obtained.
+enum ePVRTCModulationMode : uint8
+{
+    PVRTCMOD_DIRECT,            // weight is looked up from the stored value
+    PVRTCMOD_PUNCHTHROUGH,      // 4bpp alternative mode; value 2 is transparent
+    PVRTCMOD_AVERAGE,           // 2bpp; average of the four neighbors
+    PVRTCMOD_HORIZONTAL,        // 2bpp; average of the left and right neighbors
+    PVRTCMOD_VERTICAL           // 2bpp; average of the upper and lower neighbors
+};
+
+AINLINE bool isPVRTCPowerOfTwo( uint32 value )
+{
+    return ( value != 0 && ( value & ( value - 1 ) ) == 0 );
+}
+
+// Bilinear taps of a pixel into the block color grid.
+// Ordered as (x0, y0), (x1, y0), (x0, y1), (x1, y1).
+struct pvrtcBilinearTaps
+{
+    uint32 blockIndex[ 4 ];
+    uint32 weight[ 4 ];
+};
+
+// Dimensions and addressing of a PVRTC surface.
+struct pvrtcSurface
+{
+    inline pvrtcSurface( uint32 width, uint32 height, bool is2bpp )
+    {
+        this->width = width;
+        this->height = height;
+        this->is2bpp = is2bpp;
+        this->blockWidth = ( is2bpp ? 8u : 4u );
+        this->blockHeight = 4u;
+        this->blocksWide = ( width / this->blockWidth );
+        this->blocksHigh = ( height / this->blockHeight );
+    }
+
+    // Blocks are stored in Morton order, so the block counts must be powers of two.
+    // The hardware needs at least 2x2 blocks for the bilinear filter.
+    inline bool isValid( void ) const
+    {
+        return
+            ( this->width % this->blockWidth ) == 0 && ( this->height % this->blockHeight ) == 0 &&
+            this->blocksWide >= 2 && this->blocksHigh >= 2 &&
+            isPVRTCPowerOfTwo( this->blocksWide ) && isPVRTCPowerOfTwo( this->blocksHigh );
+    }
+
+    inline uint32 getBlockCount( void ) const
+    {
+        return ( this->blocksWide * this->blocksHigh );
+    }
+
+    inline uint32 getDataSize( void ) const
+    {
+        return ( this->getBlockCount() * (uint32)sizeof( pvrtc_block <endian::little_endian> ) );
+    }
+
+    inline uint32 getBilinearWeightSum( void ) const
+    {
+        return ( this->blockWidth * this->blockHeight );
+    }
+
+    // Interleaves the block coordinates with Y in the lowest bit.
+    // The remaining bits of the longer side are put on top.
+    inline uint32 getBlockStorageIndex( uint32 blockX, uint32 blockY ) const
+    {
+        uint32 minBlockCount = std::min( this->blocksWide, this->blocksHigh );
+
+        uint32 storageIndex = 0;
+        uint32 shiftCount = 0;
+
+        for ( uint32 bit = 1; bit < minBlockCount; bit <<= 1 )
+        {
+            if ( blockY & bit )
+            {
+                storageIndex |= ( 1u << ( shiftCount * 2 ) );
+            }
+
+            if ( blockX & bit )
+            {
+                storageIndex |= ( 2u << ( shiftCount * 2 ) );
+            }
+
+            shiftCount++;
+        }
+
+        uint32 restValue = ( this->blocksWide > this->blocksHigh ? blockX : blockY );
+
+        storageIndex |= ( ( restValue >> shiftCount ) << ( shiftCount * 2 ) );
+
+        return storageIndex;
+    }
+
+    // Block colors are sampled at the block centers and wrap around the surface.
+    inline void getBilinearTaps( uint32 x, uint32 y, pvrtcBilinearTaps& tapsOut ) const
+    {
+        uint32 blockWidth = this->blockWidth;
+        uint32 blockHeight = this->blockHeight;
+
+        uint32 shiftedX = ( x + this->width - blockWidth / 2 );
+        uint32 shiftedY = ( y + this->height - blockHeight / 2 );
+
+        uint32 blockX0 = ( shiftedX / blockWidth ) % this->blocksWide;
+        uint32 blockY0 = ( shiftedY / blockHeight ) % this->blocksHigh;
+
+        uint32 blockX1 = ( blockX0 + 1 ) % this->blocksWide;
+        uint32 blockY1 = ( blockY0 + 1 ) % this->blocksHigh;
+
+        uint32 fracX = ( shiftedX % blockWidth );
+        uint32 fracY = ( shiftedY % blockHeight );
+
+        tapsOut.blockIndex[ 0 ] = ( blockY0 * this->blocksWide + blockX0 );
+        tapsOut.blockIndex[ 1 ] = ( blockY0 * this->blocksWide + blockX1 );
+        tapsOut.blockIndex[ 2 ] = ( blockY1 * this->blocksWide + blockX0 );
+        tapsOut.blockIndex[ 3 ] = ( blockY1 * this->blocksWide + blockX1 );
+
+        tapsOut.weight[ 0 ] = ( blockWidth - fracX ) * ( blockHeight - fracY );
+        tapsOut.weight[ 1 ] = fracX * ( blockHeight - fracY );
+        tapsOut.weight[ 2 ] = ( blockWidth - fracX ) * fracY;
+        tapsOut.weight[ 3 ] = fracX * fracY;
+    }
+
+    inline uint32 wrapX( int32 x ) const
+    {
+        return (uint32)( ( x + (int32)this->width ) % (int32)this->width );
+    }
+
+    inline uint32 wrapY( int32 y ) const
+    {
+        return (uint32)( ( y + (int32)this->height ) % (int32)this->height );
+    }
+
+    uint32 width, height;
+    bool is2bpp;
+    uint32 blockWidth, blockHeight;
+    uint32 blocksWide, blocksHigh;
+};
+
+// Widens a color channel code to the 5bit hardware precision.
+AINLINE uint32 expandPVRTCColorBits( uint32 code, uint32 bitCount )
+{
+    if ( bitCount == 3 )
+    {
+        return ( ( code << 2 ) | ( code >> 1 ) );
+    }
+    else if ( bitCount == 4 )
+    {
+        return ( ( code << 1 ) | ( code >> 3 ) );
+    }
+
+    return code;
+}
+
+// Color A lives in bits 1 to 15 of the color data, bit 15 being the opaque flag.
+AINLINE pvrtcColor decodePVRTCColorA( uint32 colorData )
+{
+    pvrtcColor color;
+
+    if ( colorData & 0x8000 )
+    {
+        color.r = ( ( colorData >> 10 ) & 0x1F );
+        color.g = ( ( colorData >> 5 ) & 0x1F );
+        color.b = expandPVRTCColorBits( ( colorData >> 1 ) & 0xF, 4 );
+        color.a = 0xF;
+    }
+    else
+    {
+        color.r = expandPVRTCColorBits( ( colorData >> 8 ) & 0xF, 4 );
+        color.g = expandPVRTCColorBits( ( colorData >> 4 ) & 0xF, 4 );
+        color.b = expandPVRTCColorBits( ( colorData >> 1 ) & 0x7, 3 );
+        color.a = ( ( ( colorData >> 12 ) & 0x7 ) << 1 );
+    }
+
+    return color;
+}
+
+// Color B lives in bits 16 to 31 of the color data, bit 31 being the opaque flag.
+AINLINE pvrtcColor decodePVRTCColorB( uint32 colorData )
+{
+    pvrtcColor color;
+
+    if ( colorData & 0x80000000 )
+    {
+        color.r = ( ( colorData >> 26 ) & 0x1F );
+        color.g = ( ( colorData >> 21 ) & 0x1F );
+        color.b = ( ( colorData >> 16 ) & 0x1F );
+        color.a = 0xF;
+    }
+    else
+    {
+        color.r = expandPVRTCColorBits( ( colorData >> 24 ) & 0xF, 4 );
+        color.g = expandPVRTCColorBits( ( colorData >> 20 ) & 0xF, 4 );
+        color.b = expandPVRTCColorBits( ( colorData >> 16 ) & 0xF, 4 );
+        color.a = ( ( ( colorData >> 28 ) & 0x7 ) << 1 );
+    }
+
+    return color;
+}
+
+// Upscales the endpoint image at the given pixel and returns it in 8bit precision.
+AINLINE void getPVRTCInterpolatedColor( const pvrtcSurface& surface, const pvrtcColor *colors, uint32 x, uint32 y, uint8 rgbaOut[ 4 ] )
+{
+    pvrtcBilinearTaps taps;
+    surface.getBilinearTaps( x, y, taps );
+
+    uint32 sumR = 0, sumG = 0, sumB = 0, sumA = 0;
+
+    for ( uint32 n = 0; n < 4; n++ )
+    {
+        const pvrtcColor& tapColor = colors[ taps.blockIndex[ n ] ];
+        uint32 tapWeight = taps.weight[ n ];
+
+        sumR += tapColor.r * tapWeight;
+        sumG += tapColor.g * tapWeight;
+        sumB += tapColor.b * tapWeight;
+        sumA += tapColor.a * tapWeight;
+    }
+
+    uint32 colorRange = ( 31 * surface.getBilinearWeightSum() );
+    uint32 alphaRange = ( 15 * surface.getBilinearWeightSum() );
+
+    rgbaOut[ 0 ] = (uint8)( ( sumR * 255 + colorRange / 2 ) / colorRange );
+    rgbaOut[ 1 ] = (uint8)( ( sumG * 255 + colorRange / 2 ) / colorRange );
+    rgbaOut[ 2 ] = (uint8)( ( sumB * 255 + colorRange / 2 ) / colorRange );
+    rgbaOut[ 3 ] = (uint8)( ( sumA * 255 + alphaRange / 2 ) / alphaRange );
+}
+
+AINLINE uint32 getPVRTCModulatedChannel( uint32 colorA, uint32 colorB, uint32 weight )
+{
+    return ( ( colorA * ( 8 - weight ) + colorB * weight + 4 ) >> 3 );
+}
+
+// Spreads the modulation data of a block over the per-pixel modulation arrays.
+inline void unpackPVRTCModulation(
+    const pvrtcSurface& surface, uint32 blockX, uint32 blockY,
+    uint32 modulationData, bool modulationModeBit,
+    uint8 *modValues, uint8 *modModes
+)
+{
+    uint32 blockWidth = surface.blockWidth;
+    uint32 blockHeight = surface.blockHeight;
+
+    uint32 baseX = ( blockX * blockWidth );
+    uint32 baseY = ( blockY * blockHeight );
+
+    if ( surface.is2bpp == false )
+    {
+        ePVRTCModulationMode pixelMode = ( modulationModeBit ? PVRTCMOD_PUNCHTHROUGH : PVRTCMOD_DIRECT );
+
+        for ( uint32 y = 0; y < blockHeight; y++ )
+        {
+            for ( uint32 x = 0; x < blockWidth; x++ )
+            {
+                uint32 pixelIndex = ( ( baseY + y ) * surface.width + baseX + x );
+
+                modValues[ pixelIndex ] = (uint8)( ( modulationData >> ( ( y * blockWidth + x ) * 2 ) ) & 3 );
+                modModes[ pixelIndex ] = pixelMode;
+            }
+        }
+    }
+    else if ( modulationModeBit == false )
+    {
+        // One bit per pixel, choosing either endpoint.
+        for ( uint32 y = 0; y < blockHeight; y++ )
+        {
+            for ( uint32 x = 0; x < blockWidth; x++ )
+            {
+                uint32 pixelIndex = ( ( baseY + y ) * surface.width + baseX + x );
+
+                modValues[ pixelIndex ] = ( ( ( modulationData >> ( y * blockWidth + x ) ) & 1 ) ? 3 : 0 );
+                modModes[ pixelIndex ] = PVRTCMOD_DIRECT;
+            }
+        }
+    }
+    else
+    {
+        // Two bits for every other pixel in a checkerboard pattern; the others are interpolated.
+        // The lowest bit selects the interpolation, bit 20 then decides between horizontal and vertical.
+        ePVRTCModulationMode interpolateMode = PVRTCMOD_AVERAGE;
+
+        if ( modulationData & 1 )
+        {
+            interpolateMode = ( ( modulationData & ( 1u << 20 ) ) ? PVRTCMOD_VERTICAL : PVRTCMOD_HORIZONTAL );
+
+            if ( modulationData & ( 1u << 21 ) )
+            {
+                modulationData |= ( 1u << 20 );
+            }
+            else
+            {
+                modulationData &= ~( 1u << 20 );
+            }
+        }
+
+        if ( modulationData & 2 )
+        {
+            modulationData |= 1;
+        }
+        else
+        {
+            modulationData &= ~1u;
+        }
+
+        for ( uint32 y = 0; y < blockHeight; y++ )
+        {
+            for ( uint32 x = 0; x < blockWidth; x++ )
+            {
+                uint32 pixelIndex = ( ( baseY + y ) * surface.width + baseX + x );
+
+                if ( ( ( x ^ y ) & 1 ) == 0 )
+                {
+                    modValues[ pixelIndex ] = (uint8)( modulationData & 3 );
+                    modModes[ pixelIndex ] = PVRTCMOD_DIRECT;
+
+                    modulationData >>= 2;
+                }
+                else
+                {
+                    modValues[ pixelIndex ] = 0;
+                    modModes[ pixelIndex ] = (uint8)interpolateMode;
+                }
+            }
+        }
+    }
+}
+
+// Returns the modulation weight (in eighths) of a pixel.
+inline uint32 resolvePVRTCModulation(
+    const pvrtcSurface& surface, const uint8 *modValues, const uint8 *modModes,
+    uint32 x, uint32 y, bool& isTransparentOut
+)
+{
+    uint32 pixelIndex = ( y * surface.width + x );
+
+    uint32 modValue = modValues[ pixelIndex ];
+    uint8 modMode = modModes[ pixelIndex ];
+
+    isTransparentOut = false;
+
+    if ( modMode == PVRTCMOD_DIRECT )
+    {
+        return pvrtcModulationWeights[ modValue ];
+    }
+
+    if ( modMode == PVRTCMOD_PUNCHTHROUGH )
+    {
+        if ( modValue == 2 )
+        {
+            isTransparentOut = true;
+        }
+
+        static const uint32 punchThroughWeights[ 4 ] = { 0, 4, 4, 8 };
+
+        return punchThroughWeights[ modValue ];
+    }
+
+    auto getNeighborWeight = [&]( int32 offX, int32 offY ) -> uint32
+    {
+        uint32 neighborX = surface.wrapX( (int32)x + offX );
+        uint32 neighborY = surface.wrapY( (int32)y + offY );
+
+        return pvrtcModulationWeights[ modValues[ neighborY * surface.width + neighborX ] ];
+    };
+
+    if ( modMode == PVRTCMOD_HORIZONTAL )
+    {
+        return ( getNeighborWeight( -1, 0 ) + getNeighborWeight( 1, 0 ) + 1 ) / 2;
+    }
+
+    if ( modMode == PVRTCMOD_VERTICAL )
+    {
+        return ( getNeighborWeight( 0, -1 ) + getNeighborWeight( 0, 1 ) + 1 ) / 2;
+    }
+
+    return ( getNeighborWeight( -1, 0 ) + getNeighborWeight( 1, 0 ) + getNeighborWeight( 0, -1 ) + getNeighborWeight( 0, 1 ) + 2 ) / 4;
+}
+
+// Decodes a PVRTC surface into 32bit RGBA texels with tightly packed rows.
+inline void decompressPVRTC( Interface *engineInterface, const pvrtcSurface& surface, const void *srcData, void *dstTexels )
+{
+    typedef pvrtc_block <endian::little_endian> block_t;
+
+    const block_t *srcBlocks = (const block_t*)srcData;
+
+    uint32 width = surface.width;
+    uint32 blocksWide = surface.blocksWide;
+    uint32 blockCount = surface.getBlockCount();
+
+    std::vector <pvrtcColor> colorsA( blockCount );
+    std::vector <pvrtcColor> colorsB( blockCount );
+
+    std::vector <uint8> modValues( width * surface.height );
+    std::vector <uint8> modModes( width * surface.height );
+
+    // Unpack all blocks first, because 2bpp pixels are interpolated across block borders.
+    ParallelForEach( engineInterface, surface.blocksHigh,
+        [&]( size_t blockY )
+    {
+        for ( uint32 blockX = 0; blockX < blocksWide; blockX++ )
+        {
+            const block_t& srcBlock = srcBlocks[ surface.getBlockStorageIndex( blockX, (uint32)blockY ) ];
+
+            uint32 modulationData = srcBlock.modulationData;
+            uint32 colorData = srcBlock.colorData;
+
+            uint32 colorIndex = ( (uint32)blockY * blocksWide + blockX );
+
+            colorsA[ colorIndex ] = decodePVRTCColorA( colorData );
+            colorsB[ colorIndex ] = decodePVRTCColorB( colorData );
+
+            unpackPVRTCModulation( surface, blockX, (uint32)blockY, modulationData, ( colorData & 1 ) != 0, modValues.data(), modModes.data() );
+        }
+    });
+
+    uint8 *dstPixels = (uint8*)dstTexels;
+
+    ParallelForEach( engineInterface, surface.height,
+        [&]( size_t rowIndex )
+    {
+        uint32 y = (uint32)rowIndex;
+
+        for ( uint32 x = 0; x < width; x++ )
+        {
+            uint8 colorA[ 4 ], colorB[ 4 ];
+
+            getPVRTCInterpolatedColor( surface, colorsA.data(), x, y, colorA );
+            getPVRTCInterpolatedColor( surface, colorsB.data(), x, y, colorB );
+
+            bool isTransparent;
+
+            uint32 modWeight = resolvePVRTCModulation( surface, modValues.data(), modModes.data(), x, y, isTransparent );
+
+            uint8 *dstPixel = ( dstPixels + ( y * width + x ) * 4 );
+
+            for ( uint32 channel = 0; channel < 4; channel++ )
+            {
+                dstPixel[ channel ] = (uint8)getPVRTCModulatedChannel( colorA[ channel ], colorB[ channel ], modWeight );
+            }
+
+            if ( isTransparent )
+            {
+                dstPixel[ 3 ] = 0;
+            }
+        }
+    });
+}
+
+// *** Encoder ***
+
+// Number of endpoint refinement passes after the initial per-block estimation.
+#define PVRTC_REFINEMENT_PASSES     4
+
+AINLINE uint32 getPVRTCModulationError( const uint8 *pixel, const uint8 *colorA, const uint8 *colorB, uint32 weight, bool useAlpha )
+{
+    uint32 channelCount = ( useAlpha ? 4 : 3 );
+
+    uint32 error = 0;
+
+    for ( uint32 channel = 0; channel < channelCount; channel++ )
+    {
+        int32 diff = ( (int32)getPVRTCModulatedChannel( colorA[ channel ], colorB[ channel ], weight ) - (int32)pixel[ channel ] );
+
+        error += (uint32)( diff * diff );
+    }
+
+    return error;
+}
+
+#ifdef RWLIB_HAS_SSE2
+
+// Errors of all four modulation values of a pixel, computed at once.
+// The results are the same as getPVRTCModulationError for each weight.
+AINLINE void getPVRTCModulationErrorsSSE2( const uint8 *pixel, const uint8 *colorA, const uint8 *colorB, bool useAlpha, uint32 errorsOut[ 4 ] )
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    auto loadChannels = [&]( const uint8 *rgba )
+    {
+        uint32 packed;
+        memcpy( &packed, rgba, sizeof( packed ) );
+
+        // The four channels, twice.
+        __m128i channels = _mm_unpacklo_epi8( _mm_cvtsi32_si128( (int)packed ), zero );
+
+        return _mm_unpacklo_epi64( channels, channels );
+    };
+
+    __m128i pixelChannels = loadChannels( pixel );
+    __m128i channelsA = loadChannels( colorA );
+    __m128i channelsB = loadChannels( colorB );
+
+    // Modulation values 0 and 1 in the low vector, 2 and 3 in the high one.
+    const __m128i lowWeightsB = _mm_setr_epi16( 0, 0, 0, 0, 3, 3, 3, 3 );
+    const __m128i highWeightsB = _mm_setr_epi16( 5, 5, 5, 5, 8, 8, 8, 8 );
+    const __m128i eight = _mm_set1_epi16( 8 );
+    const __m128i rounding = _mm_set1_epi16( 4 );
+
+    auto getErrors = [&]( __m128i weightsB )
+    {
+        __m128i weightsA = _mm_sub_epi16( eight, weightsB );
+
+        __m128i modulated =
+            _mm_srli_epi16(
+                _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( channelsA, weightsA ), _mm_mullo_epi16( channelsB, weightsB ) ), rounding ),
+                3
+            );
+
+        __m128i diff = _mm_sub_epi16( modulated, pixelChannels );
+
+        if ( !useAlpha )
+        {
+            diff = _mm_and_si128( diff, _mm_setr_epi16( -1, -1, -1, 0, -1, -1, -1, 0 ) );
+        }
+
+        // ( r*r + g*g, b*b + a*a ) per modulation value.
+        return _mm_madd_epi16( diff, diff );
+    };
+
+    __m128i lowSums = getErrors( lowWeightsB );
+    __m128i highSums = getErrors( highWeightsB );
+
+    lowSums = _mm_add_epi32( lowSums, _mm_shuffle_epi32( lowSums, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    highSums = _mm_add_epi32( highSums, _mm_shuffle_epi32( highSums, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+    __m128i errors = _mm_castps_si128( _mm_shuffle_ps( _mm_castsi128_ps( lowSums ), _mm_castsi128_ps( highSums ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+
+    _mm_storeu_si128( (__m128i*)errorsOut, errors );
+}
+
+#endif //RWLIB_HAS_SSE2
+
+// Picks the two-bit modulation value that reproduces the pixel best.
+// This runs for every pixel of the image, so with SSE2 all four candidates are evaluated together.
+AINLINE uint32 findPVRTCModulationValue( const uint8 *pixel, const uint8 *colorA, const uint8 *colorB, bool useAlpha, bool extremesOnly, uint32 *errorOut = NULL )
+{
+    uint32 bestValue = 0;
+    uint32 bestError = 0xFFFFFFFF;
+
+#ifdef RWLIB_HAS_SSE2
+    uint32 errors[ 4 ];
+
+    getPVRTCModulationErrorsSSE2( pixel, colorA, colorB, useAlpha, errors );
+#endif //RWLIB_HAS_SSE2
+
+    for ( uint32 modValue = 0; modValue < 4; modValue++ )
+    {
+        if ( extremesOnly && modValue != 0 && modValue != 3 )
+            continue;
+
+#ifdef RWLIB_HAS_SSE2
+        uint32 error = errors[ modValue ];
+#else
+        uint32 error = getPVRTCModulationError( pixel, colorA, colorB, pvrtcModulationWeights[ modValue ], useAlpha );
+#endif //RWLIB_HAS_SSE2
+
+        if ( error < bestError )
+        {
+            bestError = error;
+            bestValue = modValue;
+        }
+    }
+
+    if ( errorOut )
+    {
+        *errorOut = bestError;
+    }
+
+    return bestValue;
+}
+
+AINLINE void fetchPVRTCFloatPixel( const uint8 *srcPixels, const pvrtcSurface& surface, uint32 x, uint32 y, bool useAlpha, float pixelOut[ 4 ] )
+{
+    const uint8 *srcPixel = ( srcPixels + ( y * surface.width + x ) * 4 );
+
+    pixelOut[ 0 ] = srcPixel[ 0 ];
+    pixelOut[ 1 ] = srcPixel[ 1 ];
+    pixelOut[ 2 ] = srcPixel[ 2 ];
+    pixelOut[ 3 ] = ( useAlpha ? srcPixel[ 3 ] : 255.0f );
+}
+
+// Initial endpoints: the extremes of the block pixels along their principal axis.
+inline void estimatePVRTCBlockEndpoints(
+    const pvrtcSurface& surface, const uint8 *srcPixels, uint32 blockX, uint32 blockY, bool useAlpha,
+    pvrtcFloatColor& endpointAOut, pvrtcFloatColor& endpointBOut
+)
+{
+    uint32 blockWidth = surface.blockWidth;
+    uint32 blockHeight = surface.blockHeight;
+
+    uint32 pixelCount = ( blockWidth * blockHeight );
+
+    float pixels[ 32 ][ 4 ];
+    float mean[ 4 ] = { 0, 0, 0, 0 };
+
+    for ( uint32 y = 0; y < blockHeight; y++ )
+    {
+        for ( uint32 x = 0; x < blockWidth; x++ )
+        {
+            float *pixel = pixels[ y * blockWidth + x ];
+
+            fetchPVRTCFloatPixel( srcPixels, surface, blockX * blockWidth + x, blockY * blockHeight + y, useAlpha, pixel );
+
+            for ( uint32 c = 0; c < 4; c++ )
+            {
+                mean[ c ] += pixel[ c ];
+            }
+        }
+    }
+
+    for ( uint32 c = 0; c < 4; c++ )
+    {
+        mean[ c ] /= (float)pixelCount;
+    }
+
+    float covariance[ 4 ][ 4 ] = { 0 };
+
+    for ( uint32 n = 0; n < pixelCount; n++ )
+    {
+        float diff[ 4 ];
+
+        for ( uint32 c = 0; c < 4; c++ )
+        {
+            diff[ c ] = ( pixels[ n ][ c ] - mean[ c ] );
+        }
+
+        for ( uint32 i = 0; i < 4; i++ )
+        {
+            for ( uint32 j = 0; j < 4; j++ )
+            {
+                covariance[ i ][ j ] += diff[ i ] * diff[ j ];
+            }
+        }
+    }
+
+    // Power iteration for the principal axis.
+    float axis[ 4 ] = { 1, 1, 1, ( useAlpha ? 1.0f : 0.0f ) };
+    bool hasAxis = true;
+
+    for ( uint32 iter = 0; iter < 8; iter++ )
+    {
+        float nextAxis[ 4 ];
+        float axisLength = 0;
+
+        for ( uint32 i = 0; i < 4; i++ )
+        {
+            nextAxis[ i ] = 0;
+
+            for ( uint32 j = 0; j < 4; j++ )
+            {
+                nextAxis[ i ] += covariance[ i ][ j ] * axis[ j ];
+            }
+
+            axisLength += nextAxis[ i ] * nextAxis[ i ];
+        }
+
+        if ( axisLength < 1e-6f )
+        {
+            hasAxis = false;
+            break;
+        }
+
+        axisLength = std::sqrt( axisLength );
+
+        for ( uint32 i = 0; i < 4; i++ )
+        {
+            axis[ i ] = ( nextAxis[ i ] / axisLength );
+        }
+    }
+
+    float minProj = 0, maxProj = 0;
+
+    if ( hasAxis )
+    {
+        for ( uint32 n = 0; n < pixelCount; n++ )
+        {
+            float proj = 0;
+
+            for ( uint32 c = 0; c < 4; c++ )
+            {
+                proj += ( pixels[ n ][ c ] - mean[ c ] ) * axis[ c ];
+            }
+
+            minProj = std::min( minProj, proj );
+            maxProj = std::max( maxProj, proj );
+        }
+    }
+
+    for ( uint32 c = 0; c < 4; c++ )
+    {
+        endpointAOut.c[ c ] = std::min( 255.0f, std::max( 0.0f, mean[ c ] + minProj * axis[ c ] ) );
+        endpointBOut.c[ c ] = std::min( 255.0f, std::max( 0.0f, mean[ c ] + maxProj * axis[ c ] ) );
+    }
+}
+
+AINLINE void getPVRTCInterpolatedFloatColor( const pvrtcBilinearTaps& taps, const pvrtcFloatColor *endpoints, float weightScale, float colorOut[ 4 ] )
+{
+    for ( uint32 c = 0; c < 4; c++ )
+    {
+        float sum = 0;
+
+        for ( uint32 n = 0; n < 4; n++ )
+        {
+            sum += endpoints[ taps.blockIndex[ n ] ].c[ c ] * (float)taps.weight[ n ];
+        }
+
+        colorOut[ c ] = ( sum * weightScale );
+    }
+}
+
+// Fits the modulation of a pixel against the current endpoints, snapped to the levels the format can store.
+inline float estimatePVRTCPixelModulation(
+    const pvrtcSurface& surface, const uint8 *srcPixels,
+    const pvrtcFloatColor *endpointsA, const pvrtcFloatColor *endpointsB,
+    uint32 x, uint32 y, bool useAlpha
+)
+{
+    pvrtcBilinearTaps taps;
+    surface.getBilinearTaps( x, y, taps );
+
+    float weightScale = ( 1.0f / (float)surface.getBilinearWeightSum() );
+
+    float colorA[ 4 ], colorB[ 4 ], pixel[ 4 ];
+
+    getPVRTCInterpolatedFloatColor( taps, endpointsA, weightScale, colorA );
+    getPVRTCInterpolatedFloatColor( taps, endpointsB, weightScale, colorB );
+
+    fetchPVRTCFloatPixel( srcPixels, surface, x, y, useAlpha, pixel );
+
+    float lineDot = 0, pixelDot = 0;
+
+    for ( uint32 c = 0; c < 4; c++ )
+    {
+        float lineDiff = ( colorB[ c ] - colorA[ c ] );
+
+        lineDot += lineDiff * lineDiff;
+        pixelDot += ( pixel[ c ] - colorA[ c ] ) * lineDiff;
+    }
+
+    if ( lineDot < 1e-3f )
+    {
+        return 0.5f;
+    }
+
+    float modulation = ( pixelDot / lineDot );
+
+    static const float levels[ 4 ] = { 0.0f, 3.0f / 8, 5.0f / 8, 1.0f };
+
+    float bestLevel = 0;
+    float bestDist = 2.0f;
+
+    for ( float level : levels )
+    {
+        float dist = std::abs( level - modulation );
+
+        if ( dist < bestDist )
+        {
+            bestDist = dist;
+            bestLevel = level;
+        }
+    }
+
+    return bestLevel;
+}
+
+// Least-squares fit of the endpoints of one block, keeping the neighboring blocks and the
+// modulation fixed. Every pixel that the block influences through the bilinear filter takes part.
+inline void refinePVRTCBlockEndpoints(
+    const pvrtcSurface& surface, const uint8 *srcPixels, const float *modulation,
+    pvrtcFloatColor *endpointsA, pvrtcFloatColor *endpointsB,
+    uint32 blockX, uint32 blockY, bool useAlpha
+)
+{
+    uint32 blockWidth = surface.blockWidth;
+    uint32 blockHeight = surface.blockHeight;
+
+    uint32 blockIndex = ( blockY * surface.blocksWide + blockX );
+
+    float weightScale = ( 1.0f / (float)surface.getBilinearWeightSum() );
+
+    pvrtcFloatColor& endpointA = endpointsA[ blockIndex ];
+    pvrtcFloatColor& endpointB = endpointsB[ blockIndex ];
+
+    double sumUU = 0, sumUV = 0, sumVV = 0;
+    double sumUT[ 4 ] = { 0 }, sumVT[ 4 ] = { 0 };
+
+    int32 windowX = ( (int32)( blockX * blockWidth ) - (int32)( blockWidth / 2 ) );
+    int32 windowY = ( (int32)( blockY * blockHeight ) - (int32)( blockHeight / 2 ) );
+
+    for ( uint32 offY = 0; offY < blockHeight * 2; offY++ )
+    {
+        uint32 y = surface.wrapY( windowY + (int32)offY );
+
+        for ( uint32 offX = 0; offX < blockWidth * 2; offX++ )
+        {
+            uint32 x = surface.wrapX( windowX + (int32)offX );
+
+            pvrtcBilinearTaps taps;
+            surface.getBilinearTaps( x, y, taps );
+
+            float blockWeight = 0;
+
+            for ( uint32 n = 0; n < 4; n++ )
+            {
+                if ( taps.blockIndex[ n ] == blockIndex )
+                {
+                    blockWeight += (float)taps.weight[ n ] * weightScale;
+                }
+            }
+
+            if ( blockWeight <= 0 )
+                continue;
+
+            float pixelMod = modulation[ y * surface.width + x ];
+
+            float colorA[ 4 ], colorB[ 4 ], pixel[ 4 ];
+
+            getPVRTCInterpolatedFloatColor( taps, endpointsA, weightScale, colorA );
+            getPVRTCInterpolatedFloatColor( taps, endpointsB, weightScale, colorB );
+
+            fetchPVRTCFloatPixel( srcPixels, surface, x, y, useAlpha, pixel );
+
+            float u = ( blockWeight * ( 1.0f - pixelMod ) );
+            float v = ( blockWeight * pixelMod );
+
+            sumUU += u * u;
+            sumUV += u * v;
+            sumVV += v * v;
+
+            for ( uint32 c = 0; c < 4; c++ )
+            {
+                // What this block has to contribute, given the contribution of its neighbors.
+                float reconstructed = ( colorA[ c ] * ( 1.0f - pixelMod ) + colorB[ c ] * pixelMod );
+                float target = ( pixel[ c ] - reconstructed + u * endpointA.c[ c ] + v * endpointB.c[ c ] );
+
+                sumUT[ c ] += u * target;
+                sumVT[ c ] += v * target;
+            }
+        }
+    }
+
+    double det = ( sumUU * sumVV - sumUV * sumUV );
+
+    for ( uint32 c = 0; c < 4; c++ )
+    {
+        double newA = endpointA.c[ c ];
+        double newB = endpointB.c[ c ];
+
+        if ( det > 1e-6 * sumUU * sumVV && det > 1e-12 )
+        {
+            newA = ( sumVV * sumUT[ c ] - sumUV * sumVT[ c ] ) / det;
+            newB = ( sumUU * sumVT[ c ] - sumUV * sumUT[ c ] ) / det;
+        }
+        else if ( sumUU >= sumVV && sumUU > 1e-12 )
+        {
+            newA = ( sumUT[ c ] - sumUV * newB ) / sumUU;
+        }
+        else if ( sumVV > 1e-12 )
+        {
+            newB = ( sumVT[ c ] - sumUV * newA ) / sumVV;
+        }
+
+        endpointA.c[ c ] = (float)std::min( 255.0, std::max( 0.0, newA ) );
+        endpointB.c[ c ] = (float)std::min( 255.0, std::max( 0.0, newB ) );
+    }
+
+    if ( useAlpha == false )
+    {
+        endpointA.c[ 3 ] = 255.0f;
+        endpointB.c[ 3 ] = 255.0f;
+    }
+}
+
+AINLINE uint32 expandPVRTCColorToByte( uint32 value5 )
+{
+    return ( ( value5 * 255 + 15 ) / 31 );
+}
+
+AINLINE uint32 expandPVRTCAlphaToByte( uint32 value4 )
+{
+    return ( ( value4 * 255 + 7 ) / 15 );
+}
+
+// Finds the channel code whose expansion is nearest to the value.
+inline uint32 quantizePVRTCChannel( float value, uint32 bitCount, bool isAlpha, float& errorOut )
+{
+    uint32 bestCode = 0;
+    float bestError = 1e30f;
+
+    for ( uint32 code = 0; code < ( 1u << bitCount ); code++ )
+    {
+        uint32 expanded =
+            ( isAlpha ? expandPVRTCAlphaToByte( code << 1 ) : expandPVRTCColorToByte( expandPVRTCColorBits( code, bitCount ) ) );
+
+        float diff = ( (float)expanded - value );
+        float error = ( diff * diff );
+
+        if ( error < bestError )
+        {
+            bestError = error;
+            bestCode = code;
+        }
+    }
+
+    errorOut = bestError;
+
+    return bestCode;
+}
+
+// Packs an endpoint into its color data bits (without the opaque flag), choosing between the
+// opaque and the translucent layout of the endpoint.
+inline uint32 quantizePVRTCEndpoint( const pvrtcFloatColor& endpoint, bool isColorB, bool useAlpha )
+{
+    const float *c = endpoint.c;
+
+    // Opaque layout: RGB 554 for color A, RGB 555 for color B.
+    float opaqueError = 0;
+    uint32 opaqueBits;
+    {
+        float errR, errG, errB;
+
+        uint32 codeR = quantizePVRTCChannel( c[ 0 ], 5, false, errR );
+        uint32 codeG = quantizePVRTCChannel( c[ 1 ], 5, false, errG );
+        uint32 codeB = quantizePVRTCChannel( c[ 2 ], ( isColorB ? 5 : 4 ), false, errB );
+
+        float alphaDiff = ( 255.0f - c[ 3 ] );
+
+        opaqueError = ( errR + errG + errB + alphaDiff * alphaDiff );
+
+        opaqueBits = ( isColorB ? ( 0x8000 | ( codeR << 10 ) | ( codeG << 5 ) | codeB ) : ( 0x8000 | ( codeR << 10 ) | ( codeG << 5 ) | ( codeB << 1 ) ) );
+    }
+
+    if ( useAlpha == false )
+    {
+        return opaqueBits;
+    }
+
+    // Translucent layout: ARGB 3443 for color A, ARGB 3444 for color B.
+    float translucentError = 0;
+    uint32 translucentBits;
+    {
+        float errA, errR, errG, errB;
+
+        uint32 codeA = quantizePVRTCChannel( c[ 3 ], 3, true, errA );
+        uint32 codeR = quantizePVRTCChannel( c[ 0 ], 4, false, errR );
+        uint32 codeG = quantizePVRTCChannel( c[ 1 ], 4, false, errG );
+        uint32 codeB = quantizePVRTCChannel( c[ 2 ], ( isColorB ? 4 : 3 ), false, errB );
+
+        translucentError = ( errA + errR + errG + errB );
+
+        translucentBits = ( isColorB ? ( ( codeA << 12 ) | ( codeR << 8 ) | ( codeG << 4 ) | codeB ) : ( ( codeA << 12 ) | ( codeR << 8 ) | ( codeG << 4 ) | ( codeB << 1 ) ) );
+    }
+
+    return ( translucentError < opaqueError ? translucentBits : opaqueBits );
+}
+
+// Chooses the modulation of a block against the final, quantized endpoints.
+inline void encodePVRTCBlockModulation(
+    const pvrtcSurface& surface, const uint8 *srcPixels,
+    const uint8 *interpolatedA, const uint8 *interpolatedB, const uint8 *bestValues,
+    uint32 blockX, uint32 blockY, bool useAlpha,
+    uint32& modulationDataOut, bool& modulationModeBitOut
+)
+{
+    uint32 blockWidth = surface.blockWidth;
+    uint32 blockHeight = surface.blockHeight;
+
+    uint32 baseX = ( blockX * blockWidth );
+    uint32 baseY = ( blockY * blockHeight );
+
+    uint32 width = surface.width;
+
+    if ( surface.is2bpp == false )
+    {
+        uint32 modulationData = 0;
+
+        for ( uint32 y = 0; y < blockHeight; y++ )
+        {
+            for ( uint32 x = 0; x < blockWidth; x++ )
+            {
+                uint32 pixelIndex = ( ( baseY + y ) * width + baseX + x );
+
+                modulationData |= ( (uint32)bestValues[ pixelIndex ] << ( ( y * blockWidth + x ) * 2 ) );
+            }
+        }
+
+        modulationDataOut = modulationData;
+        modulationModeBitOut = false;
+        return;
+    }
+
+    // Option one: one bit per pixel.
+    uint32 directData = 0;
+    uint32 directError = 0;
+
+    for ( uint32 y = 0; y < blockHeight; y++ )
+    {
+        for ( uint32 x = 0; x < blockWidth; x++ )
+        {
+            uint32 pixelIndex = ( ( baseY + y ) * width + baseX + x );
+
+            uint32 pixelError;
+
+            uint32 modValue = findPVRTCModulationValue( srcPixels + pixelIndex * 4, interpolatedA + pixelIndex * 4, interpolatedB + pixelIndex * 4, useAlpha, true, &pixelError );
+
+            if ( modValue == 3 )
+            {
+                directData |= ( 1u << ( y * blockWidth + x ) );
+            }
+
+            directError += pixelError;
+        }
+    }
+
+    // Option two: two bits for every other pixel, the others averaged from their four neighbors.
+    // Neighbors in other blocks are assumed to take their best value.
+    uint8 storedValues[ 8 * 4 ];
+
+    uint32 checkerData = 0;
+    uint32 checkerError = 0;
+    uint32 storedCount = 0;
+
+    for ( uint32 y = 0; y < blockHeight; y++ )
+    {
+        for ( uint32 x = 0; x < blockWidth; x++ )
+        {
+            if ( ( ( x ^ y ) & 1 ) != 0 )
+                continue;
+
+            uint32 pixelIndex = ( ( baseY + y ) * width + baseX + x );
+
+            uint32 pixelError;
+
+            // The lowest bit of the first value selects the interpolation mode, so it can only be an extreme.
+            bool isModeCarrier = ( storedCount == 0 );
+
+            uint32 modValue = findPVRTCModulationValue( srcPixels + pixelIndex * 4, interpolatedA + pixelIndex * 4, interpolatedB + pixelIndex * 4, useAlpha, isModeCarrier, &pixelError );
+
+            storedValues[ y * blockWidth + x ] = (uint8)modValue;
+
+            checkerData |= ( ( isModeCarrier ? ( modValue & 2 ) : modValue ) << ( storedCount * 2 ) );
+            checkerError += pixelError;
+
+            storedCount++;
+        }
+    }
+
+    for ( uint32 y = 0; y < blockHeight; y++ )
+    {
+        for ( uint32 x = 0; x < blockWidth; x++ )
+        {
+            if ( ( ( x ^ y ) & 1 ) == 0 )
+                continue;
+
+            auto getNeighborWeight = [&]( int32 offX, int32 offY ) -> uint32
+            {
+                int32 localX = ( (int32)x + offX );
+                int32 localY = ( (int32)y + offY );
+
+                if ( localX >= 0 && localX < (int32)blockWidth && localY >= 0 && localY < (int32)blockHeight )
+                {
+                    return pvrtcModulationWeights[ storedValues[ localY * blockWidth + localX ] ];
+                }
+
+                uint32 neighborX = surface.wrapX( (int32)baseX + localX );
+                uint32 neighborY = surface.wrapY( (int32)baseY + localY );
+
+                return pvrtcModulationWeights[ bestValues[ neighborY * width + neighborX ] ];
+            };
+
+            uint32 modWeight =
+                ( getNeighborWeight( -1, 0 ) + getNeighborWeight( 1, 0 ) + getNeighborWeight( 0, -1 ) + getNeighborWeight( 0, 1 ) + 2 ) / 4;
+
+            uint32 pixelIndex = ( ( baseY + y ) * width + baseX + x );
+
+            checkerError += getPVRTCModulationError( srcPixels + pixelIndex * 4, interpolatedA + pixelIndex * 4, interpolatedB + pixelIndex * 4, modWeight, useAlpha );
+        }
+    }
+
+    if ( checkerError < directError )
+    {
+        modulationDataOut = checkerData;
+        modulationModeBitOut = true;
+    }
+    else
+    {
+        modulationDataOut = directData;
+        modulationModeBitOut = false;
+    }
+}
+
+// Compresses 32bit RGBA texels with tightly packed rows into PVRTC blocks.
+// The endpoints are fitted against the bilinearly upscaled reconstruction, not per block,
+// because every pixel is influenced by four blocks.
+inline void compressPVRTC( Interface *engineInterface, const pvrtcSurface& surface, const void *srcTexels, bool useAlpha, void *dstData )
+{
+    typedef pvrtc_block <endian::little_endian> block_t;
+
+    const uint8 *srcPixels = (const uint8*)srcTexels;
+
+    uint32 width = surface.width;
+    uint32 height = surface.height;
+    uint32 blocksWide = surface.blocksWide;
+    uint32 blocksHigh = surface.blocksHigh;
+    uint32 blockCount = surface.getBlockCount();
+
+    std::vector <pvrtcFloatColor> endpointsA( blockCount );
+    std::vector <pvrtcFloatColor> endpointsB( blockCount );
+
+    ParallelForEach( engineInterface, blocksHigh,
+        [&]( size_t blockY )
+    {
+        for ( uint32 blockX = 0; blockX < blocksWide; blockX++ )
+        {
+            uint32 blockIndex = ( (uint32)blockY * blocksWide + blockX );
+
+            estimatePVRTCBlockEndpoints( surface, srcPixels, blockX, (uint32)blockY, useAlpha, endpointsA[ blockIndex ], endpointsB[ blockIndex ] );
+        }
+    });
+
+    // Refine the endpoints against the modulation they produce.
+    // Blocks that share no pixels are refined together, in four phases of block coordinate parity.
+    {
+        std::vector <float> modulation( width * height );
+
+        for ( uint32 pass = 0; pass < PVRTC_REFINEMENT_PASSES; pass++ )
+        {
+            ParallelForEach( engineInterface, height,
+                [&]( size_t y )
+            {
+                for ( uint32 x = 0; x < width; x++ )
+                {
+                    modulation[ y * width + x ] =
+                        estimatePVRTCPixelModulation( surface, srcPixels, endpointsA.data(), endpointsB.data(), x, (uint32)y, useAlpha );
+                }
+            });
+
+            for ( uint32 phase = 0; phase < 4; phase++ )
+            {
+                uint32 phaseX = ( phase & 1 );
+                uint32 phaseY = ( phase >> 1 );
+
+                ParallelForEach( engineInterface, ( blocksHigh - phaseY + 1 ) / 2,
+                    [&]( size_t phaseRow )
+                {
+                    uint32 blockY = ( (uint32)phaseRow * 2 + phaseY );
+
+                    for ( uint32 blockX = phaseX; blockX < blocksWide; blockX += 2 )
+                    {
+                        refinePVRTCBlockEndpoints( surface, srcPixels, modulation.data(), endpointsA.data(), endpointsB.data(), blockX, blockY, useAlpha );
+                    }
+                });
+            }
+        }
+    }
+
+    // Quantize the endpoints. From here on we work with exactly what the decoder sees.
+    std::vector <uint32> colorWords( blockCount );
+    std::vector <pvrtcColor> colorsA( blockCount );
+    std::vector <pvrtcColor> colorsB( blockCount );
+
+    for ( uint32 blockIndex = 0; blockIndex < blockCount; blockIndex++ )
+    {
+        uint32 colorABits = quantizePVRTCEndpoint( endpointsA[ blockIndex ], false, useAlpha );
+        uint32 colorBBits = quantizePVRTCEndpoint( endpointsB[ blockIndex ], true, useAlpha );
+
+        uint32 colorData = ( ( colorBBits << 16 ) | colorABits );
+
+        colorWords[ blockIndex ] = colorData;
+        colorsA[ blockIndex ] = decodePVRTCColorA( colorData );
+        colorsB[ blockIndex ] = decodePVRTCColorB( colorData );
+    }
+
+    std::vector <uint8> interpolatedA( width * height * 4 );
+    std::vector <uint8> interpolatedB( width * height * 4 );
+    std::vector <uint8> bestValues( width * height );
+
+    ParallelForEach( engineInterface, height,
+        [&]( size_t y )
+    {
+        for ( uint32 x = 0; x < width; x++ )
+        {
+            uint32 pixelIndex = ( (uint32)y * width + x );
+
+            uint8 *colorA = ( interpolatedA.data() + pixelIndex * 4 );
+            uint8 *colorB = ( interpolatedB.data() + pixelIndex * 4 );
+
+            getPVRTCInterpolatedColor( surface, colorsA.data(), x, (uint32)y, colorA );
+            getPVRTCInterpolatedColor( surface, colorsB.data(), x, (uint32)y, colorB );
+
+            bestValues[ pixelIndex ] = (uint8)findPVRTCModulationValue( srcPixels + pixelIndex * 4, colorA, colorB, useAlpha, false );
+        }
+    });
+
+    block_t *dstBlocks = (block_t*)dstData;
+
+    ParallelForEach( engineInterface, blocksHigh,
+        [&]( size_t blockY )
+    {
+        for ( uint32 blockX = 0; blockX < blocksWide; blockX++ )
+        {
+            uint32 modulationData;
+            bool modulationModeBit;
+
+            encodePVRTCBlockModulation(
+                surface, srcPixels,
+                interpolatedA.data(), interpolatedB.data(), bestValues.data(),
+                blockX, (uint32)blockY, useAlpha,
+                modulationData, modulationModeBit
+            );
+
+            uint32 colorData = colorWords[ (uint32)blockY * blocksWide + blockX ];
+
+            if ( modulationModeBit )
+            {
+                colorData |= 1;
+            }
+
+            block_t& dstBlock = dstBlocks[ surface.getBlockStorageIndex( blockX, (uint32)blockY ) ];
+
+            dstBlock.modulationData = modulationData;
+            dstBlock.colorData = colorData;
+        }
+    });
+}
+
+};
+
+};
+
+#endif //_RENDERWARE_PVRTC_CODEC_
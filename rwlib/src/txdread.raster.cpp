@@ -129,6 +129,7 @@ Raster::Raster( const Raster& right )
 
     // Copy raster specifics.
     this->engineInterface = right.engineInterface;
+    this->revision = 0;
 
     // Copy native platform data.
     PlatformTexture *platformTex = NULL;
@@ -138,7 +139,7 @@ Raster::Raster( const Raster& right )
         platformTex = CloneNativeTexture( this->engineInterface, right.platformData );
     }
 
-    this->platformData = platformTex;
+    SetRasterNativeData( this, platformTex, right.platformProvider );
 
     // Cloned rasters are stand-alone. Thus we reset reference counts to default.
     this->refCount = 1;
@@ -156,7 +157,7 @@ Raster::~Raster( void )
     {
         DeleteNativeTexture( this->engineInterface, platformTex );
 
-        this->platformData = NULL;
+        SetRasterNativeData( this, NULL, NULL );
     }
 }
 
@@ -174,6 +175,7 @@ void Raster::SetEngineVersion( LibraryVersion version )
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -184,7 +186,7 @@ void Raster::SetEngineVersion( LibraryVersion version )
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -207,7 +209,7 @@ LibraryVersion Raster::GetEngineVersion( void ) const
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -223,6 +225,7 @@ void Raster::newNativeData( const char *typeName )
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     if ( this->platformData != NULL )
         return;
@@ -237,7 +240,7 @@ void Raster::newNativeData( const char *typeName )
         PlatformTexture *nativeTex = CreateNativeTexture( engineInterface, nativeTypeInfo );
     
         // Store stuff.
-        this->platformData = nativeTex;
+        SetRasterNativeData( this, nativeTex, GetNativeTextureTypeProvider( engineInterface, nativeTex ) );
     }
 }
 
@@ -247,6 +250,7 @@ void Raster::clearNativeData( void )
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -258,7 +262,7 @@ void Raster::clearNativeData( void )
     DeleteNativeTexture( engineInterface, platformTex );
 
     // We have no more native data.
-    this->platformData = NULL;
+    SetRasterNativeData( this, NULL, NULL );
 }
 
 bool Raster::hasNativeDataOfType( const char *typeName ) const
@@ -335,6 +339,12 @@ bool Raster::isImmutable( void ) const
     return NativeIsRasterImmutable( this );
 }
 
+uint32 Raster::getRevision( void ) const
+{
+    // Atomic, so no lock required.
+    return this->revision;
+}
+
 void* Raster::getNativeInterface( void )
 {
     // The native interface offers a direct way of access to the native texture.
@@ -350,7 +360,7 @@ void* Raster::getNativeInterface( void )
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
         return NULL;
@@ -369,7 +379,7 @@ void* Raster::getDriverNativeInterface( void )
 
     Interface *engineInterface = this->engineInterface;
 
-    const texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    const texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
         return NULL;
@@ -381,6 +391,9 @@ void* Raster::getDriverNativeInterface( void )
 #ifdef RWLIB_INCLUDE_NATIVETEX_ATC_MOBILE
 extern void registerATCNativePlugin( void );
 #endif //RWLIB_INCLUDE_NATIVETEX_ATC_MOBILE
+#ifdef RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
+extern void registerETCNativePlugin( void );
+#endif //RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
 #ifdef RWLIB_INCLUDE_NATIVETEX_D3D8
 extern void registerD3D8NativePlugin( void );
 #endif //RWLIB_INCLUDE_NATIVETEX_D3D8
@@ -425,6 +438,9 @@ void registerNativeTexturePlugins( void )
 #ifdef RWLIB_INCLUDE_NATIVETEX_ATC_MOBILE
     registerATCNativePlugin();
 #endif //RWLIB_INCLUDE_NATIVETEX_ATC_MOBILE
+#ifdef RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
+    registerETCNativePlugin();
+#endif //RWLIB_INCLUDE_NATIVETEX_ETC_MOBILE
 #ifdef RWLIB_INCLUDE_NATIVETEX_D3D8
     registerD3D8NativePlugin();
 #endif //RWLIB_INCLUDE_NATIVETEX_D3D8
@@ -189,7 +189,171 @@ inline bool GetNativeTextureRawBitmapData(
     return fetchSuccessful;
 }
 
-bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
+eNativeTranscodeFormat GetPixelDataTranscodeFormat( const pixelDataTraversal& pixelData )
+{
+    uint32 dxtType;
+
+    if ( IsDXTCompressionType( pixelData.compressionType, dxtType ) )
+    {
+        return NATIVE_TRANSCODE_DXT;
+    }
+
+    if ( pixelData.paletteType != PALETTE_NONE )
+    {
+        return NATIVE_TRANSCODE_PALETTE;
+    }
+
+    return NATIVE_TRANSCODE_RAW;
+}
+
+bool TranscodeNativePixelData( Interface *engineInterface, texNativeTypeProvider *srcProvider, texNativeTypeProvider *dstProvider, pixelDataTraversal& pixelData )
+{
+    const nativeTextureStreamPlugin *nativeTexEnv = nativeTextureStreamStore.GetConstPluginStruct( (EngineInterface*)engineInterface );
+
+    if ( !nativeTexEnv )
+        return false;
+
+    eNativeTranscodeFormat transcodeFormat = GetPixelDataTranscodeFormat( pixelData );
+
+    // Transcoders may be (un)registered at runtime.
+    scoped_rwlock_reader <rwlock> ctxBrowseTranscoders( nativeTexEnv->lockTranscoders );
+
+    // Transcoders that are bound to both types are asked first, wildcard transcoders last.
+    for ( int specificity = 2; specificity >= 0; specificity-- )
+    {
+        for ( const nativeTextureStreamPlugin::transcoderRegistration& regInfo : nativeTexEnv->transcoderRegistry )
+        {
+            int regSpecificity = ( regInfo.srcProvider != NULL ? 1 : 0 ) + ( regInfo.dstProvider != NULL ? 1 : 0 );
+
+            if ( regSpecificity != specificity )
+                continue;
+
+            if ( regInfo.srcProvider != NULL && regInfo.srcProvider != srcProvider ||
+                 regInfo.dstProvider != NULL && regInfo.dstProvider != dstProvider )
+            {
+                continue;
+            }
+
+            if ( regInfo.format != NATIVE_TRANSCODE_ANY && regInfo.format != transcodeFormat )
+                continue;
+
+            if ( regInfo.transcoder->TranscodePixelData( engineInterface, srcProvider, dstProvider, pixelData ) )
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Moves DXT blocks over unchanged if the destination stores the same DXT type,
+// for example between D3D8, D3D9 and XBOX.
+// Size rules are met by copying or clearing whole blocks, so this stays lossless.
+struct dxtBlockCopyTranscoder : public nativeTextureTranscoder
+{
+    bool TranscodePixelData( Interface *engineInterface, texNativeTypeProvider *srcProvider, texNativeTypeProvider *dstProvider, pixelDataTraversal& pixelData ) const override
+    {
+        pixelCapabilities dstCaps;
+        dstProvider->GetPixelCapabilities( dstCaps );
+
+        eCompressionType compressionType = pixelData.compressionType;
+
+        bool isSupported =
+            ( compressionType == RWCOMPRESS_DXT1 && dstCaps.supportsDXT1 ||
+              compressionType == RWCOMPRESS_DXT2 && dstCaps.supportsDXT2 ||
+              compressionType == RWCOMPRESS_DXT3 && dstCaps.supportsDXT3 ||
+              compressionType == RWCOMPRESS_DXT4 && dstCaps.supportsDXT4 ||
+              compressionType == RWCOMPRESS_DXT5 && dstCaps.supportsDXT5 );
+
+        // Otherwise the generic path has to decode the blocks.
+        if ( !isSupported )
+            return false;
+
+        // The block layout is the same on every platform, so the texels are moved as they are.
+        // TruncateMipmapLayer works on whole blocks for DXT surfaces.
+        AdjustPixelDataDimensionsByFormat( engineInterface, dstProvider, pixelData );
+
+        return true;
+    }
+};
+
+// Moves palette indices over unchanged and only recolors the palette entries.
+// The generic path does the same palette conversion but then rescans every palette index
+// to recalculate the alpha flag; reordering the palette colors cannot change it.
+struct paletteRecolorTranscoder : public nativeTextureTranscoder
+{
+    bool TranscodePixelData( Interface *engineInterface, texNativeTypeProvider *srcProvider, texNativeTypeProvider *dstProvider, pixelDataTraversal& pixelData ) const override
+    {
+        if ( pixelData.compressionType != RWCOMPRESS_NONE || pixelData.paletteType == PALETTE_NONE )
+            return false;
+
+        pixelCapabilities dstCaps;
+        dstProvider->GetPixelCapabilities( dstCaps );
+
+        if ( !dstCaps.supportsPalette )
+            return false;
+
+        eColorOrdering dstColorOrder = pixelData.colorOrder;
+
+        if ( engineInterface->GetFixIncompatibleRasters() )
+        {
+            uint32 recDepth;
+            eColorOrdering recColorOrder;
+
+            bool hasRecDepth, hasRecColorOrder;
+
+            dstProvider->GetRecommendedRasterFormat( pixelData.rasterFormat, pixelData.paletteType, recDepth, hasRecDepth, recColorOrder, hasRecColorOrder );
+
+            // Repacking the palette indices is left to the generic path.
+            if ( hasRecDepth && recDepth != pixelData.depth )
+            {
+                return false;
+            }
+
+            if ( hasRecColorOrder )
+            {
+                dstColorOrder = recColorOrder;
+            }
+        }
+
+        if ( dstColorOrder != pixelData.colorOrder )
+        {
+            uint32 palRasterDepth = Bitmap::getRasterFormatDepth( pixelData.rasterFormat );
+
+            void *dstPaletteData;
+
+            TransformPaletteDataEx(
+                engineInterface,
+                pixelData.paletteData,
+                pixelData.paletteSize, pixelData.paletteSize,
+                pixelData.rasterFormat, pixelData.colorOrder, palRasterDepth,
+                pixelData.rasterFormat, dstColorOrder, palRasterDepth,
+                true,
+                dstPaletteData
+            );
+
+            assert( dstPaletteData == pixelData.paletteData );
+
+            pixelData.colorOrder = dstColorOrder;
+        }
+
+        AdjustPixelDataDimensionsByFormat( engineInterface, dstProvider, pixelData );
+
+        return true;
+    }
+};
+
+static dxtBlockCopyTranscoder _dxtBlockCopyTranscoder;
+static paletteRecolorTranscoder _paletteRecolorTranscoder;
+
+void RegisterBuiltinNativeTextureTranscoders( nativeTextureStreamPlugin *nativeTexEnv )
+{
+    nativeTexEnv->RegisterTranscoder( NULL, NULL, NATIVE_TRANSCODE_DXT, &_dxtBlockCopyTranscoder );
+    nativeTexEnv->RegisterTranscoder( NULL, NULL, NATIVE_TRANSCODE_PALETTE, &_paletteRecolorTranscoder );
+}
+
+bool ConvertRasterToNativeType( Raster *theRaster, nativeTexTypeHandle_t dstTypeHandle )
 {
     bool conversionSuccess = false;
 
@@ -210,38 +374,30 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
             // Only convert if the raster has image data.
             if ( PlatformTexture *nativeTex = theRaster->platformData )
             {
-                // Get the type information of the original platform data.
-                GenericRTTI *origNativeRtObj = RwTypeSystem::GetTypeStructFromObject( nativeTex );
-
-                RwTypeSystem::typeInfoBase *origTypeInfo = RwTypeSystem::GetTypeInfoFromTypeStruct( origNativeRtObj );
-
-                // Get the type information of the destination format.
-                RwTypeSystem::typeInfoBase *dstTypeInfo = GetNativeTextureType( engineInterface, nativeName );
+                // The type of the original platform data is cached on the raster.
+                nativeTexTypeHandle_t origTypeHandle = GetRasterNativeTypeHandle( theRaster );
 
-                if ( origTypeInfo != NULL && dstTypeInfo != NULL )
+                if ( origTypeHandle != NATIVE_TEXTURE_TYPE_HANDLE_INVALID && dstTypeHandle != NATIVE_TEXTURE_TYPE_HANDLE_INVALID )
                 {
                     // If the destination type and the source type match, we are finished.
-                    if ( engineInterface->typeSystem.IsSameType( origTypeInfo, dstTypeInfo ) )
+                    if ( origTypeHandle == dstTypeHandle )
                     {
                         conversionSuccess = true;
                     }
                     else
                     {
-                        // Attempt to get the native texture type interface for both types.
-                        nativeTextureStreamPlugin::nativeTextureCustomTypeInterface *origTypeInterface = dynamic_cast <nativeTextureStreamPlugin::nativeTextureCustomTypeInterface*> ( origTypeInfo->tInterface );
-                        nativeTextureStreamPlugin::nativeTextureCustomTypeInterface *dstTypeInterface = dynamic_cast <nativeTextureStreamPlugin::nativeTextureCustomTypeInterface*> ( dstTypeInfo->tInterface );
+                        // Attempt to get the native texture type provider for both types.
+                        texNativeTypeProvider *origTypeProvider = GetRasterNativeTypeProvider( theRaster );
+                        texNativeTypeProvider *dstTypeProvider = nativeTexEnv->GetTypeProviderByHandle( dstTypeHandle );
 
                         // Only proceed if both could resolve.
-                        if ( origTypeInterface != NULL && dstTypeInterface != NULL )
+                        if ( origTypeProvider != NULL && dstTypeProvider != NULL )
                         {
                             // Use the original type provider to grab pixel data from the texture.
                             // Then get the pixel capabilities of both formats and convert the pixel data into a compatible format for the destination format.
                             // Finally, apply the pixels to the destination format texture.
                             // * PERFORMANCE: at best, it can fetch pixel data (without allocation), free the original texture, allocate the new texture and put the pixels to it.
                             // * this would be a simple move operation. the actual operation depends on the complexity of both formats.
-                            texNativeTypeProvider *origTypeProvider = origTypeInterface->texTypeProvider;
-                            texNativeTypeProvider *dstTypeProvider = dstTypeInterface->texTypeProvider;
-
                             // In case of an exception, we have to deal with the pixel information, so we do not leak memory.
                             pixelDataTraversal pixelStore;
 
@@ -258,7 +414,7 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
                                 pixelStore.SetStandalone();
 
                                 // 3. Allocate a new texture.
-                                PlatformTexture *newNativeTex = CreateNativeTexture( engineInterface, dstTypeInfo );
+                                PlatformTexture *newNativeTex = CreateNativeTexture( engineInterface, dstTypeProvider->managerData.rwTexType );
 
                                 if ( newNativeTex )
                                 {
@@ -272,13 +428,20 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
                                         }
 
                                         // 4. make pixels compatible for the target format.
-                                        // *  First decide what pixel format we have to deduce from the capabilities
-                                        //    and then call the "ConvertPixelData" function to do the job.
-                                        CompatibilityTransformPixelData( engineInterface, pixelStore, dstTypeProvider );
+                                        // *  Direct transcoders are asked first, so texels that the target can store
+                                        //    as they are do not go through decoding.
+                                        bool hasTranscoded = TranscodeNativePixelData( engineInterface, origTypeProvider, dstTypeProvider, pixelStore );
+
+                                        if ( !hasTranscoded )
+                                        {
+                                            // *  First decide what pixel format we have to deduce from the capabilities
+                                            //    and then call the "ConvertPixelData" function to do the job.
+                                            CompatibilityTransformPixelData( engineInterface, pixelStore, dstTypeProvider );
 
-                                        // The texels have to obey size rules of the destination native texture.
-                                        // So let us check what size rules we need, right?
-                                        AdjustPixelDataDimensionsByFormat( engineInterface, dstTypeProvider, pixelStore );
+                                            // The texels have to obey size rules of the destination native texture.
+                                            // So let us check what size rules we need, right?
+                                            AdjustPixelDataDimensionsByFormat( engineInterface, dstTypeProvider, pixelStore );
+                                        }
 
                                         // 5. Put the texels into our texture.
                                         //    Throwing an exception here means that the texture did not apply any of the pixel
@@ -310,7 +473,7 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
                                         throw;
                                     }
 
-                                    theRaster->platformData = newNativeTex;
+                                    SetRasterNativeData( theRaster, newNativeTex, dstTypeProvider );
 
                                     // We are successful!
                                     conversionSuccess = true;
@@ -343,12 +506,18 @@ bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
     return conversionSuccess;
 }
 
+bool ConvertRasterTo( Raster *theRaster, const char *nativeName )
+{
+    return ConvertRasterToNativeType( theRaster, GetNativeTextureTypeHandle( theRaster->engineInterface, nativeName ) );
+}
+
 void Raster::convertToFormat(eRasterFormat newFormat)
 {
     scoped_rwlock_writer <rwlock> rasterConsistency( GetRasterLock( this ) );
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -360,7 +529,7 @@ void Raster::convertToFormat(eRasterFormat newFormat)
     Interface *engineInterface = this->engineInterface;
 
     // Get the type provider of the native data.
-    texNativeTypeProvider *typeProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *typeProvider = GetRasterNativeTypeProvider( this );
 
     if ( !typeProvider )
     {
@@ -445,7 +614,7 @@ eRasterFormat Raster::getRasterFormat( void ) const
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -456,6 +625,58 @@ eRasterFormat Raster::getRasterFormat( void ) const
 }
 
 Bitmap Raster::getBitmap(void) const
+{
+    return this->getMipmapBitmap( 0 );
+}
+
+Bitmap Raster::getThumbnail( uint32 maxDimm ) const
+{
+    if ( maxDimm == 0 )
+    {
+        throw RwException( "invalid maximum dimension for raster thumbnail" );
+    }
+
+    Interface *engineInterface = this->engineInterface;
+
+    uint32 baseWidth, baseHeight;
+    this->getSize( baseWidth, baseHeight );
+
+    uint32 thumbWidth, thumbHeight;
+    GetThumbnailDimensions( baseWidth, baseHeight, maxDimm, thumbWidth, thumbHeight );
+
+    // Take the smallest mipmap layer that is still at least as big as the thumbnail.
+    // That way we only decode and filter a fraction of the texels that the base layer has.
+    uint32 mipmapCount = this->getMipmapCount();
+
+    uint32 thumbMipIndex = 0;
+
+    if ( mipmapCount > 1 )
+    {
+        mipGenLevelGenerator mipGen( baseWidth, baseHeight );
+
+        for ( uint32 n = 1; n < mipmapCount; n++ )
+        {
+            if ( !mipGen.incrementLevel() )
+                break;
+
+            if ( mipGen.getLevelWidth() < thumbWidth || mipGen.getLevelHeight() < thumbHeight )
+                break;
+
+            thumbMipIndex = n;
+        }
+    }
+
+    Bitmap thumbBitmap = this->getMipmapBitmap( thumbMipIndex );
+
+    if ( thumbBitmap.getWidth() != thumbWidth || thumbBitmap.getHeight() != thumbHeight )
+    {
+        thumbBitmap.scale( engineInterface, thumbWidth, thumbHeight );
+    }
+
+    return thumbBitmap;
+}
+
+Bitmap Raster::getMipmapBitmap( uint32 mipIndex ) const
 {
     scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
 
@@ -465,12 +686,12 @@ Bitmap Raster::getBitmap(void) const
     {
         PlatformTexture *platformTex = this->platformData;
 
-        // If it has any mipmap at all.
-        texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+        // If it has the requested mipmap layer.
+        texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
         uint32 mipmapCount = GetNativeTextureMipmapCount( engineInterface, platformTex, texProvider );
 
-        if ( mipmapCount > 0 )
+        if ( mipIndex < mipmapCount )
         {
             uint32 width;
             uint32 height;
@@ -488,7 +709,7 @@ Bitmap Raster::getBitmap(void) const
             {
                 rawBitmapFetchResult rawBitmap;
 
-                bool gotPixelData = GetNativeTextureRawBitmapData( engineInterface, platformTex, texProvider, 0, false, rawBitmap );
+                bool gotPixelData = GetNativeTextureRawBitmapData( engineInterface, platformTex, texProvider, mipIndex, false, rawBitmap );
 
                 if ( gotPixelData )
                 {
@@ -520,12 +741,101 @@ Bitmap Raster::getBitmap(void) const
     return resultBitmap;
 }
 
+void Raster::getContentHash( uint64& hashLowOut, uint64& hashHighOut ) const
+{
+    scoped_rwlock_reader <rwlock> rasterConsistency( GetRasterLock( this ) );
+
+    PlatformTexture *platformTex = this->platformData;
+
+    if ( !platformTex )
+    {
+        throw RwException( "no native data" );
+    }
+
+    Interface *engineInterface = this->engineInterface;
+
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
+
+    if ( !texProvider )
+    {
+        throw RwException( "invalid native data" );
+    }
+
+    utils::contentHasher hasher;
+
+    // Every property is hashed as 32bit value.
+    auto feedValue = [&]( uint32 value )
+    {
+        hasher.feedValue( value );
+    };
+
+    // The native type matters because conversion results depend on it.
+    {
+        GenericRTTI *rtObj = RwTypeSystem::GetTypeStructFromObject( platformTex );
+
+        RwTypeSystem::typeInfoBase *typeInfo = RwTypeSystem::GetTypeInfoFromTypeStruct( rtObj );
+
+        hasher.feed( typeInfo->name, strlen( typeInfo->name ) + 1 );
+    }
+
+    pixelDataTraversal pixelData;
+
+    texProvider->GetPixelDataFromTexture( engineInterface, platformTex, pixelData );
+
+    try
+    {
+        feedValue( (uint32)pixelData.rasterFormat );
+        feedValue( pixelData.depth );
+        feedValue( pixelData.rowAlignment );
+        feedValue( (uint32)pixelData.colorOrder );
+        feedValue( (uint32)pixelData.paletteType );
+        feedValue( pixelData.paletteSize );
+        feedValue( (uint32)pixelData.compressionType );
+        feedValue( pixelData.hasAlpha ? 1 : 0 );
+        feedValue( pixelData.cubeTexture ? 1 : 0 );
+
+        if ( pixelData.paletteType != PALETTE_NONE && pixelData.paletteData != NULL )
+        {
+            uint32 palRasterFormatDepth = Bitmap::getRasterFormatDepth( pixelData.rasterFormat );
+
+            hasher.feed( pixelData.paletteData, getPaletteDataSize( pixelData.paletteSize, palRasterFormatDepth ) );
+        }
+
+        uint32 mipmapCount = (uint32)pixelData.mipmaps.size();
+
+        feedValue( mipmapCount );
+
+        for ( uint32 n = 0; n < mipmapCount; n++ )
+        {
+            const pixelDataTraversal::mipmapResource& mipLayer = pixelData.mipmaps[ n ];
+
+            feedValue( mipLayer.width );
+            feedValue( mipLayer.height );
+            feedValue( mipLayer.layerWidth );
+            feedValue( mipLayer.layerHeight );
+
+            hasher.feed( mipLayer.texels, mipLayer.dataSize );
+        }
+    }
+    catch( ... )
+    {
+        pixelData.FreePixels( engineInterface );
+
+        throw;
+    }
+
+    pixelData.FreePixels( engineInterface );
+
+    hasher.finish( hashLowOut, hashHighOut );
+}
+
 void Raster::setImageData(const Bitmap& srcImage)
 {
     scoped_rwlock_writer <rwlock> rasterConsistency( GetRasterLock( this ) );
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -536,7 +846,7 @@ void Raster::setImageData(const Bitmap& srcImage)
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
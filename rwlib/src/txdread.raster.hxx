@@ -125,6 +125,46 @@ static inline void DeleteNativeTexture( Interface *intf, PlatformTexture *native
     }
 }
 
+// Native data link of rasters.
+// Only call these functions under the raster consistency lock.
+inline texNativeTypeProvider* GetRasterNativeTypeProvider( const Raster *raster )
+{
+    // Cached when the native data was linked to the raster.
+    return raster->platformProvider;
+}
+
+// Has to be called by every routine that changes the texel data of a raster.
+// Clients compare Raster::getRevision against their own copy to invalidate derived data (previews, etc).
+inline void NotifyRasterModified( Raster *raster )
+{
+    raster->revision++;
+}
+
+// Rasters can only hold native data of registered types, so the handle of the provider is stable here.
+inline nativeTexTypeHandle_t GetRasterNativeTypeHandle( const Raster *raster )
+{
+    return raster->platformTypeHandle;
+}
+
+inline void SetRasterNativeData( Raster *raster, PlatformTexture *nativeTex, texNativeTypeProvider *typeProvider )
+{
+    if ( nativeTex == NULL )
+    {
+        typeProvider = NULL;
+    }
+
+    raster->platformData = nativeTex;
+    raster->platformProvider = typeProvider;
+    raster->platformTypeHandle = ( typeProvider != NULL ? typeProvider->managerData.typeHandle : NATIVE_TEXTURE_TYPE_HANDLE_INVALID );
+
+    NotifyRasterModified( raster );
+}
+
+struct nativeTextureStreamPlugin;
+
+// Registers the built-in transcoders that every engine has.
+void RegisterBuiltinNativeTextureTranscoders( nativeTextureStreamPlugin *nativeTexEnv );
+
 struct nativeTextureStreamPlugin : public serializationProvider
 {
     inline void Initialize( EngineInterface *engineInterface )
@@ -134,6 +174,18 @@ struct nativeTextureStreamPlugin : public serializationProvider
         // Initialize the list that will keep all native texture types.
         LIST_CLEAR( this->texNativeTypes.root );
 
+        // Handles are indices into this registry, offset by one.
+        this->typeProviderRegistry.clear();
+
+        this->lockTypeRegistry = CreateReadWriteLock( engineInterface );
+
+        // Native types are registered later, so the built-in transcoders match any type.
+        this->transcoderRegistry.clear();
+
+        this->lockTranscoders = CreateReadWriteLock( engineInterface );
+
+        RegisterBuiltinNativeTextureTranscoders( this );
+
         // Register us in the serialization manager.
         RegisterSerialization( engineInterface, CHUNK_TEXTURENATIVE, engineInterface->textureTypeInfo, this, RWSERIALIZE_INHERIT );
     }
@@ -147,10 +199,29 @@ struct nativeTextureStreamPlugin : public serializationProvider
         LIST_FOREACH_BEGIN( texNativeTypeProvider, this->texNativeTypes.root, managerData.managerNode )
             // We just set them to false.
             item->managerData.isRegistered = false;
+            item->managerData.typeHandle = NATIVE_TEXTURE_TYPE_HANDLE_INVALID;
         LIST_FOREACH_END
 
         LIST_CLEAR( this->texNativeTypes.root );
 
+        this->typeProviderRegistry.clear();
+
+        if ( rwlock *lockTypeRegistry = this->lockTypeRegistry )
+        {
+            CloseReadWriteLock( engineInterface, lockTypeRegistry );
+
+            this->lockTypeRegistry = NULL;
+        }
+
+        this->transcoderRegistry.clear();
+
+        if ( rwlock *lockTranscoders = this->lockTranscoders )
+        {
+            CloseReadWriteLock( engineInterface, lockTranscoders );
+
+            this->lockTranscoders = NULL;
+        }
+
         if ( RwTypeSystem::typeInfoBase *platformTexType = this->platformTexType )
         {
             engineInterface->typeSystem.DeleteType( platformTexType );
@@ -163,6 +234,8 @@ struct nativeTextureStreamPlugin : public serializationProvider
     {
         EngineInterface *engineInterface = (EngineInterface*)intf;
 
+        scoped_profile_zone profileZone( engineInterface, "SerializeTexture" );
+
         // Make sure we are a valid texture.
         if ( !isRwObjectInheritingFrom( engineInterface, objectToStore, engineInterface->textureTypeInfo ) )
         {
@@ -177,20 +250,12 @@ struct nativeTextureStreamPlugin : public serializationProvider
             // The raster also requires GPU native data, the heart of the texture.
             if ( PlatformTexture *nativeTex = texRaster->platformData )
             {
-                // Get the type information of this texture and find its type provider.
-                GenericRTTI *rtObj = RwTypeSystem::GetTypeStructFromObject( nativeTex );
-
-                RwTypeSystem::typeInfoBase *nativeTypeInfo = RwTypeSystem::GetTypeInfoFromTypeStruct( rtObj );
-
-                // Attempt to cast the type interface to our native texture type provider.
-                // If successful, it indeeed is a native texture.
+                // The type provider has been cached when the native data was linked.
                 {
-                    nativeTextureCustomTypeInterface *nativeTexTypeInterface = dynamic_cast <nativeTextureCustomTypeInterface*> ( nativeTypeInfo->tInterface );
+                    texNativeTypeProvider *texNativeProvider = texRaster->platformProvider;
 
-                    if ( nativeTexTypeInterface )
+                    if ( texNativeProvider )
                     {
-                        texNativeTypeProvider *texNativeProvider = nativeTexTypeInterface->texTypeProvider;
-
                         // Set the version to the version of the native texture.
                         // Texture objects only have a 'virtual' version.
                         LibraryVersion nativeVersion = texNativeProvider->GetTextureVersion( nativeTex );
@@ -239,6 +304,8 @@ struct nativeTextureStreamPlugin : public serializationProvider
     {
         EngineInterface *engineInterface = (EngineInterface*)intf;
 
+        scoped_profile_zone profileZone( engineInterface, "DeserializeTexture" );
+
         // This is a pretty complicated algorithm that will need revision later on, when networked streams are allowed.
         // It is required because tex native rules have been violated by War Drum Studios.
         // First, we need to analyze the given block; this is done by getting candidates from texNativeTypes that
@@ -350,6 +417,7 @@ struct nativeTextureStreamPlugin : public serializationProvider
         {
             // We require to allocate a platform texture, so lets keep a pointer.
             PlatformTexture *platformData = NULL;
+            texNativeTypeProvider *platformProvider = NULL;
 
             try
             {
@@ -363,6 +431,8 @@ struct nativeTextureStreamPlugin : public serializationProvider
 
                     if ( platformData )
                     {
+                        platformProvider = definiteProvider;
+
                         // Set the version of the native texture.
                         definiteProvider->SetTextureVersion( engineInterface, platformData, inputProvider.getBlockVersion() );
 
@@ -466,6 +536,7 @@ struct nativeTextureStreamPlugin : public serializationProvider
 
                             // Give the native data to the runtime.
                             platformData = nativeData;
+                            platformProvider = theProvider;
                             break;
                         }
                     }
@@ -559,7 +630,7 @@ struct nativeTextureStreamPlugin : public serializationProvider
             if ( platformData )   
             {
                 // We link the raster with the texture and put the platform data into the raster.
-                texRaster->platformData = platformData;
+                SetRasterNativeData( texRaster, platformData, platformProvider );
 
                 texOut->SetRaster( texRaster );
 
@@ -664,6 +735,15 @@ struct nativeTextureStreamPlugin : public serializationProvider
                     {
                         typeProvider->managerData.rwTexType = newType;
 
+                        // Intern the type name, so the runtime can refer to it by integer.
+                        {
+                            scoped_rwlock_writer <rwlock> ctxRegisterType( this->lockTypeRegistry );
+
+                            typeProvider->managerData.typeHandle = (nativeTexTypeHandle_t)( this->typeProviderRegistry.size() + 1 );
+
+                            this->typeProviderRegistry.push_back( typeProvider );
+                        }
+
                         LIST_APPEND( this->texNativeTypes.root, typeProvider->managerData.managerNode );
 
                         typeProvider->managerData.isRegistered = true;
@@ -705,6 +785,37 @@ struct nativeTextureStreamPlugin : public serializationProvider
 
                     texProvider->managerData.isRegistered = false;
 
+                    // Handles are never reused, so stale handles resolve to nothing.
+                    {
+                        scoped_rwlock_writer <rwlock> ctxUnregisterType( this->lockTypeRegistry );
+
+                        nativeTexTypeHandle_t typeHandle = texProvider->managerData.typeHandle;
+
+                        if ( typeHandle != NATIVE_TEXTURE_TYPE_HANDLE_INVALID )
+                        {
+                            this->typeProviderRegistry[ typeHandle - 1 ] = NULL;
+
+                            texProvider->managerData.typeHandle = NATIVE_TEXTURE_TYPE_HANDLE_INVALID;
+                        }
+                    }
+
+                    // Transcoders that are bound to this type cannot be used anymore.
+                    scoped_rwlock_writer <rwlock> ctxRemoveTranscoders( this->lockTranscoders );
+
+                    for ( size_t n = 0; n < this->transcoderRegistry.size(); )
+                    {
+                        const transcoderRegistration& regInfo = this->transcoderRegistry[ n ];
+
+                        if ( regInfo.srcProvider == texProvider || regInfo.dstProvider == texProvider )
+                        {
+                            this->transcoderRegistry.erase( this->transcoderRegistry.begin() + n );
+                        }
+                        else
+                        {
+                            n++;
+                        }
+                    }
+
                     // Delete the type.
                     engineInterface->typeSystem.DeleteType( nativeTypeInfo );
                 }
@@ -714,9 +825,89 @@ struct nativeTextureStreamPlugin : public serializationProvider
         return unregisterSuccess;
     }
     
+    // Native texture types are always registered as direct children of the platform texture type
+    // using our type interface, so we do not need an inheritance walk or a dynamic cast.
+    inline texNativeTypeProvider* GetTypeProviderFromType( RwTypeSystem::typeInfoBase *typeInfo ) const
+    {
+        if ( typeInfo == NULL || typeInfo->inheritsFrom != this->platformTexType )
+        {
+            return NULL;
+        }
+
+        return static_cast <nativeTextureCustomTypeInterface*> ( typeInfo->tInterface )->texTypeProvider;
+    }
+
+    inline texNativeTypeProvider* GetTypeProviderByHandle( nativeTexTypeHandle_t typeHandle ) const
+    {
+        scoped_rwlock_reader <rwlock> ctxBrowseTypes( this->lockTypeRegistry );
+
+        if ( typeHandle == NATIVE_TEXTURE_TYPE_HANDLE_INVALID || typeHandle > this->typeProviderRegistry.size() )
+        {
+            return NULL;
+        }
+
+        return this->typeProviderRegistry[ typeHandle - 1 ];
+    }
+
+    inline void RegisterTranscoder( texNativeTypeProvider *srcProvider, texNativeTypeProvider *dstProvider, eNativeTranscodeFormat format, nativeTextureTranscoder *transcoder )
+    {
+        transcoderRegistration regInfo;
+        regInfo.srcProvider = srcProvider;
+        regInfo.dstProvider = dstProvider;
+        regInfo.format = format;
+        regInfo.transcoder = transcoder;
+
+        scoped_rwlock_writer <rwlock> ctxRegisterTranscoder( this->lockTranscoders );
+
+        this->transcoderRegistry.push_back( regInfo );
+    }
+
+    inline bool UnregisterTranscoder( nativeTextureTranscoder *transcoder )
+    {
+        bool hasRemoved = false;
+
+        scoped_rwlock_writer <rwlock> ctxUnregisterTranscoder( this->lockTranscoders );
+
+        for ( size_t n = 0; n < this->transcoderRegistry.size(); )
+        {
+            if ( this->transcoderRegistry[ n ].transcoder == transcoder )
+            {
+                this->transcoderRegistry.erase( this->transcoderRegistry.begin() + n );
+
+                hasRemoved = true;
+            }
+            else
+            {
+                n++;
+            }
+        }
+
+        return hasRemoved;
+    }
+
     RwTypeSystem::typeInfoBase *platformTexType;
 
     RwList <texNativeTypeProvider> texNativeTypes;
+
+    // Registry of type providers by interned type handle.
+    // Native types can be (un)registered at runtime (plugins), so the registry is guarded by lockTypeRegistry.
+    std::vector <texNativeTypeProvider*> typeProviderRegistry;
+    rwlock *lockTypeRegistry;
+
+    // Registry of direct transcoders.
+    // A NULL provider or NATIVE_TRANSCODE_ANY acts as wildcard.
+    struct transcoderRegistration
+    {
+        texNativeTypeProvider *srcProvider;
+        texNativeTypeProvider *dstProvider;
+        eNativeTranscodeFormat format;
+        nativeTextureTranscoder *transcoder;
+    };
+
+    // Transcoders can be (un)registered at any time, so the registry is guarded by lockTranscoders.
+    // Transcoders must not (un)register transcoders themselves.
+    std::vector <transcoderRegistration> transcoderRegistry;
+    rwlock *lockTranscoders;
 };
 
 extern PluginDependantStructRegister <nativeTextureStreamPlugin, RwInterfaceFactory_t> nativeTextureStreamStore;
@@ -29,7 +29,7 @@ bool Raster::supportsImageMethod( const char *method ) const
         throw RwException( "no native data" );
     }
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -67,7 +67,7 @@ void Raster::writeImage(Stream *outputStream, const char *method)
         throw RwException( "no native data" );
     }
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -219,6 +219,7 @@ void Raster::readImage( rw::Stream *inputStream )
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     Interface *engineInterface = this->engineInterface;
 
@@ -229,7 +230,7 @@ void Raster::readImage( rw::Stream *inputStream )
         throw RwException( "no native data" );
     }
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
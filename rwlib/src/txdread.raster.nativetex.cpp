@@ -39,6 +39,55 @@ bool UnregisterNativeTextureType( Interface *engineInterface, const char *native
     return success;
 }
 
+// Direct transcoder registrations.
+bool RegisterNativeTextureTranscoder( Interface *engineInterface, const char *srcTypeName, const char *dstTypeName, eNativeTranscodeFormat format, nativeTextureTranscoder *transcoder )
+{
+    bool success = false;
+
+    nativeTextureStreamPlugin *nativeTexEnv = nativeTextureStreamStore.GetPluginStruct( (EngineInterface*)engineInterface );
+
+    if ( nativeTexEnv )
+    {
+        texNativeTypeProvider *srcProvider = NULL;
+        texNativeTypeProvider *dstProvider = NULL;
+
+        if ( srcTypeName )
+        {
+            srcProvider = nativeTexEnv->GetTypeProviderFromType( GetNativeTextureType( engineInterface, srcTypeName ) );
+        }
+
+        if ( dstTypeName )
+        {
+            dstProvider = nativeTexEnv->GetTypeProviderFromType( GetNativeTextureType( engineInterface, dstTypeName ) );
+        }
+
+        // Named types have to exist, otherwise the transcoder would turn into a wildcard.
+        if ( ( srcTypeName == NULL || srcProvider != NULL ) &&
+             ( dstTypeName == NULL || dstProvider != NULL ) )
+        {
+            nativeTexEnv->RegisterTranscoder( srcProvider, dstProvider, format, transcoder );
+
+            success = true;
+        }
+    }
+
+    return success;
+}
+
+bool UnregisterNativeTextureTranscoder( Interface *engineInterface, nativeTextureTranscoder *transcoder )
+{
+    bool success = false;
+
+    nativeTextureStreamPlugin *nativeTexEnv = nativeTextureStreamStore.GetPluginStruct( (EngineInterface*)engineInterface );
+
+    if ( nativeTexEnv )
+    {
+        success = nativeTexEnv->UnregisterTranscoder( transcoder );
+    }
+
+    return success;
+}
+
 void ExploreNativeTextureTypeProviders( Interface *intf, texNativeTypeProviderCallback_t cb, void *ud )
 {
     EngineInterface *engineInterface = (EngineInterface*)intf;
@@ -74,21 +123,9 @@ texNativeTypeProvider* GetNativeTextureTypeProvider( Interface *intf, void *objM
         {
             RwTypeSystem::typeInfoBase *typeInfo = RwTypeSystem::GetTypeInfoFromTypeStruct( rtObj );
 
-            // Check that we indeed are a native texture type.
-            // This is guarranteed if we inherit from the native texture type info.
-            if ( engineInterface->typeSystem.IsTypeInheritingFrom( nativeTexEnv->platformTexType, typeInfo ) )
-            {
-                // We assume that the type provider is of our native type.
-                // For safety, do a dynamic cast.
-                nativeTextureStreamPlugin::nativeTextureCustomTypeInterface *nativeTypeInterface =
-                    dynamic_cast <nativeTextureStreamPlugin::nativeTextureCustomTypeInterface*> ( typeInfo->tInterface );
-
-                if ( nativeTypeInterface )
-                {
-                    // Return the type provider.
-                    platformData = nativeTypeInterface->texTypeProvider;
-                }
-            }
+            // Native texture types directly inherit from the platform texture type, so we do not
+            // have to walk the inheritance chain under the type system lock.
+            platformData = nativeTexEnv->GetTypeProviderFromType( typeInfo );
         }
     }
 
@@ -97,22 +134,48 @@ texNativeTypeProvider* GetNativeTextureTypeProvider( Interface *intf, void *objM
 
 texNativeTypeProvider* GetNativeTextureTypeProviderByName( Interface *engineInterface, const char *typeName )
 {
-    // Get the type that is associated with the given typeName.
-    RwTypeSystem::typeInfoBase *theType = GetNativeTextureType( engineInterface, typeName );
+    return GetNativeTextureTypeProviderByHandle( engineInterface, GetNativeTextureTypeHandle( engineInterface, typeName ) );
+}
+
+nativeTexTypeHandle_t GetNativeTextureTypeHandle( Interface *intf, const char *typeName )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    nativeTexTypeHandle_t typeHandle = NATIVE_TEXTURE_TYPE_HANDLE_INVALID;
+
+    const nativeTextureStreamPlugin *nativeTexEnv = nativeTextureStreamStore.GetConstPluginStruct( engineInterface );
 
-    if ( theType )
+    if ( nativeTexEnv )
     {
-        // Ensure that we are a native texture type and get its manager.
-        nativeTextureStreamPlugin::nativeTextureCustomTypeInterface *nativeIntf = dynamic_cast <nativeTextureStreamPlugin::nativeTextureCustomTypeInterface*> ( theType->tInterface );
+        // Get the type that is associated with the given typeName.
+        // Callers on hot paths should resolve the handle once and keep it.
+        RwTypeSystem::typeInfoBase *theType = GetNativeTextureType( engineInterface, typeName );
 
-        if ( nativeIntf )
+        if ( texNativeTypeProvider *texProvider = nativeTexEnv->GetTypeProviderFromType( theType ) )
         {
-            // Get the interface pointer.
-            return nativeIntf->texTypeProvider;
+            scoped_rwlock_reader <rwlock> ctxBrowseTypes( nativeTexEnv->lockTypeRegistry );
+
+            typeHandle = texProvider->managerData.typeHandle;
         }
     }
 
-    return NULL;
+    return typeHandle;
+}
+
+texNativeTypeProvider* GetNativeTextureTypeProviderByHandle( Interface *intf, nativeTexTypeHandle_t typeHandle )
+{
+    EngineInterface *engineInterface = (EngineInterface*)intf;
+
+    texNativeTypeProvider *texProvider = NULL;
+
+    const nativeTextureStreamPlugin *nativeTexEnv = nativeTextureStreamStore.GetConstPluginStruct( engineInterface );
+
+    if ( nativeTexEnv )
+    {
+        texProvider = nativeTexEnv->GetTypeProviderByHandle( typeHandle );
+    }
+
+    return texProvider;
 }
 
 void* GetNativeTextureDriverInterface( Interface *engineInterface, const char *typeName )
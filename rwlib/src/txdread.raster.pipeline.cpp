@@ -0,0 +1,826 @@
+// Fused raster processing pipeline.
+// Instead of letting every Raster method fetch, decode, re-encode and store the native texels,
+// we fetch them once, run all operations on one intermediate buffer and store the result once.
+#include "StdInc.h"
+
+#include "txdread.raster.hxx"
+
+#include "txdread.size.hxx"
+
+namespace rw
+{
+
+static inline rasterPipelineOperation makePipelineOperation( eRasterPipelineOperation opType )
+{
+    rasterPipelineOperation op;
+    op.opType = opType;
+    op.width = 0;
+    op.height = 0;
+    op.downsampleMode = NULL;
+    op.upscaleMode = NULL;
+    op.maxMipmapCount = 0;
+    op.mipGenMode = MIPMAPGEN_DEFAULT;
+    op.paletteType = PALETTE_NONE;
+    op.paletteRasterFormat = RASTER_DEFAULT;
+    op.quality = 1.0f;
+    op.compressionType = RWCOMPRESS_NONE;
+
+    return op;
+}
+
+RasterPipeline& RasterPipeline::resize( uint32 width, uint32 height, const char *downsampleMode, const char *upscaleMode )
+{
+    rasterPipelineOperation op = makePipelineOperation( RASTERPIPE_RESIZE );
+    op.width = width;
+    op.height = height;
+    op.downsampleMode = downsampleMode;
+    op.upscaleMode = upscaleMode;
+
+    this->operations.push_back( op );
+
+    return *this;
+}
+
+RasterPipeline& RasterPipeline::clearMipmaps( void )
+{
+    this->operations.push_back( makePipelineOperation( RASTERPIPE_CLEAR_MIPMAPS ) );
+
+    return *this;
+}
+
+RasterPipeline& RasterPipeline::generateMipmaps( uint32 maxMipmapCount, eMipmapGenerationMode mipGenMode )
+{
+    rasterPipelineOperation op = makePipelineOperation( RASTERPIPE_GENERATE_MIPMAPS );
+    op.maxMipmapCount = maxMipmapCount;
+    op.mipGenMode = mipGenMode;
+
+    this->operations.push_back( op );
+
+    return *this;
+}
+
+RasterPipeline& RasterPipeline::convertToPalette( ePaletteType paletteType, eRasterFormat newRasterFormat )
+{
+    // NULL operation, like in the Raster method.
+    if ( paletteType != PALETTE_NONE )
+    {
+        rasterPipelineOperation op = makePipelineOperation( RASTERPIPE_PALETTIZE );
+        op.paletteType = paletteType;
+        op.paletteRasterFormat = newRasterFormat;
+
+        this->operations.push_back( op );
+    }
+
+    return *this;
+}
+
+RasterPipeline& RasterPipeline::compress( float quality )
+{
+    rasterPipelineOperation op = makePipelineOperation( RASTERPIPE_COMPRESS );
+    op.quality = quality;
+
+    this->operations.push_back( op );
+
+    return *this;
+}
+
+RasterPipeline& RasterPipeline::compressCustom( eCompressionType format )
+{
+    rasterPipelineOperation op = makePipelineOperation( RASTERPIPE_COMPRESS_CUSTOM );
+    op.compressionType = format;
+
+    this->operations.push_back( op );
+
+    return *this;
+}
+
+RasterPipeline& RasterPipeline::convertTo( const char *nativeName )
+{
+    this->targetNativeName = nativeName;
+
+    return *this;
+}
+
+bool RasterPipeline::isEmpty( void ) const
+{
+    return ( this->operations.empty() && this->targetNativeName == NULL );
+}
+
+void RasterPipeline::clear( void )
+{
+    this->operations.clear();
+    this->targetNativeName = NULL;
+}
+
+static inline void GetPixelDataFormat( const pixelDataTraversal& pixelData, pixelFormat& formatOut )
+{
+    formatOut.rasterFormat = pixelData.rasterFormat;
+    formatOut.depth = pixelData.depth;
+    formatOut.rowAlignment = pixelData.rowAlignment;
+    formatOut.colorOrder = pixelData.colorOrder;
+    formatOut.paletteType = pixelData.paletteType;
+    formatOut.compressionType = pixelData.compressionType;
+}
+
+static inline bool IsSamePixelFormat( const pixelFormat& left, const pixelFormat& right )
+{
+    return ( left.rasterFormat == right.rasterFormat &&
+             left.depth == right.depth &&
+             left.rowAlignment == right.rowAlignment &&
+             left.colorOrder == right.colorOrder &&
+             left.paletteType == right.paletteType &&
+             left.compressionType == right.compressionType );
+}
+
+static void TruncatePipelineMipmaps( Interface *engineInterface, pixelDataTraversal& pixelData, size_t mipmapCount )
+{
+    size_t oldMipmapCount = pixelData.mipmaps.size();
+
+    if ( mipmapCount >= oldMipmapCount )
+        return;
+
+    for ( size_t n = mipmapCount; n < oldMipmapCount; n++ )
+    {
+        pixelDataTraversal::FreeMipmap( engineInterface, pixelData.mipmaps[ n ] );
+    }
+
+    pixelData.mipmaps.resize( mipmapCount );
+}
+
+// Decodes the pixels into the intermediate format of the pipeline.
+// This is a raw raster format without palette where every mipmap surface is as big as its layer,
+// so that filtering operations can address the texels directly.
+static void DecodePipelineWorkingBuffer( Interface *engineInterface, pixelDataTraversal& pixelData )
+{
+    pixelFormat workFormat;
+    workFormat.paletteType = PALETTE_NONE;
+    workFormat.compressionType = RWCOMPRESS_NONE;
+
+    if ( pixelData.compressionType != RWCOMPRESS_NONE )
+    {
+        workFormat.rasterFormat = RASTER_8888;
+        workFormat.colorOrder = COLOR_BGRA;
+        workFormat.rowAlignment = 4;
+    }
+    else
+    {
+        workFormat.rasterFormat = pixelData.rasterFormat;
+        workFormat.colorOrder = pixelData.colorOrder;
+        workFormat.rowAlignment = ( pixelData.paletteType != PALETTE_NONE ? 4 : pixelData.rowAlignment );
+    }
+
+    // Filtering writes samples at the natural depth of the raster format.
+    workFormat.depth = Bitmap::getRasterFormatDepth( workFormat.rasterFormat );
+
+    pixelFormat curFormat;
+    GetPixelDataFormat( pixelData, curFormat );
+
+    if ( IsSamePixelFormat( curFormat, workFormat ) == false )
+    {
+        bool hasConverted = ConvertPixelData( engineInterface, pixelData, workFormat );
+
+        if ( !hasConverted || pixelData.compressionType != RWCOMPRESS_NONE || pixelData.paletteType != PALETTE_NONE )
+        {
+            throw RwException( "failed to decode raster pixels in raster pipeline" );
+        }
+    }
+
+    // Get rid of surface padding (for instance from DXT blocks).
+    size_t mipmapCount = pixelData.mipmaps.size();
+
+    for ( size_t n = 0; n < mipmapCount; n++ )
+    {
+        pixelDataTraversal::mipmapResource& mipLayer = pixelData.mipmaps[ n ];
+
+        if ( mipLayer.width == mipLayer.layerWidth && mipLayer.height == mipLayer.layerHeight )
+            continue;
+
+        uint32 newSurfWidth, newSurfHeight;
+        void *newTexels;
+        uint32 newDataSize;
+
+        TruncateMipmapLayer(
+            engineInterface,
+            mipLayer.layerWidth, mipLayer.layerHeight, mipLayer.width, mipLayer.height, mipLayer.texels, mipLayer.dataSize,
+            pixelData.depth, pixelData.rowAlignment, PALETTE_NONE, RWCOMPRESS_NONE,
+            mipLayer.layerWidth, mipLayer.layerHeight,
+            newSurfWidth, newSurfHeight,
+            newTexels, newDataSize
+        );
+
+        if ( newTexels != mipLayer.texels )
+        {
+            engineInterface->PixelFree( mipLayer.texels );
+        }
+
+        mipLayer.width = newSurfWidth;
+        mipLayer.height = newSurfHeight;
+        mipLayer.texels = newTexels;
+        mipLayer.dataSize = newDataSize;
+    }
+}
+
+// Filters one layer of the working buffer into a new layer of the given dimensions.
+static void FilterPipelineLayer(
+    EngineInterface *engineInterface, const pixelDataTraversal& pixelData, mipmapLayerResizeColorPipeline& dstColorPipe,
+    const pixelDataTraversal::mipmapResource& srcLayer, uint32 targetLayerWidth, uint32 targetLayerHeight,
+    rasterResizeFilterInterface *upscaleFilter, rasterResizeFilterInterface *downsamplingFilter,
+    const resizeFilteringCaps& upscaleCaps, const resizeFilteringCaps& downsamplingCaps,
+    pixelDataTraversal::mipmapResource& dstLayerOut
+)
+{
+    eSamplingType horiSampling = determineSamplingType( srcLayer.layerWidth, targetLayerWidth );
+    eSamplingType vertSampling = determineSamplingType( srcLayer.layerHeight, targetLayerHeight );
+
+    void *dstTexels = NULL;
+    uint32 dstDataSize = 0;
+
+    PerformRawBitmapResizeFiltering(
+        engineInterface,
+        srcLayer.layerWidth, srcLayer.layerHeight, srcLayer.texels,
+        targetLayerWidth, targetLayerHeight,
+        pixelData.rasterFormat, pixelData.depth, pixelData.rowAlignment, pixelData.colorOrder, PALETTE_NONE, NULL, 0,
+        pixelData.depth,
+        dstColorPipe,
+        horiSampling, vertSampling,
+        upscaleFilter, downsamplingFilter,
+        upscaleCaps, downsamplingCaps,
+        dstTexels, dstDataSize
+    );
+
+    dstLayerOut.width = targetLayerWidth;
+    dstLayerOut.height = targetLayerHeight;
+    dstLayerOut.layerWidth = targetLayerWidth;
+    dstLayerOut.layerHeight = targetLayerHeight;
+    dstLayerOut.texels = dstTexels;
+    dstLayerOut.dataSize = dstDataSize;
+}
+
+static void ResizePipelineWorkingBuffer(
+    EngineInterface *engineInterface, pixelDataTraversal& pixelData,
+    uint32 newWidth, uint32 newHeight, const char *downsampleMode, const char *upscaleMode
+)
+{
+    rasterResizeFilterInterface *downsamplingFilter, *upscaleFilter;
+    resizeFilteringCaps downsamplingCaps, upscaleCaps;
+
+    FetchResizeFilteringFilters(
+        engineInterface, downsampleMode, upscaleMode,
+        downsamplingFilter, upscaleFilter,
+        downsamplingCaps, upscaleCaps
+    );
+
+    mipmapLayerResizeColorPipeline dstColorPipe(
+        pixelData.rasterFormat, pixelData.depth, pixelData.rowAlignment, pixelData.colorOrder,
+        PALETTE_NONE, NULL, 0
+    );
+
+    mipGenLevelGenerator mipGen( newWidth, newHeight );
+
+    if ( !mipGen.isValidLevel() )
+    {
+        throw RwException( "invalid mipmap dimensions given for resizing" );
+    }
+
+    size_t mipmapCount = pixelData.mipmaps.size();
+
+    size_t mipIter = 0;
+
+    for ( ; mipIter < mipmapCount; mipIter++ )
+    {
+        if ( mipIter != 0 && mipGen.incrementLevel() == false )
+        {
+            // The remaining levels do not exist at the new size.
+            break;
+        }
+
+        pixelDataTraversal::mipmapResource& mipLayer = pixelData.mipmaps[ mipIter ];
+
+        uint32 targetLayerWidth = mipGen.getLevelWidth();
+        uint32 targetLayerHeight = mipGen.getLevelHeight();
+
+        if ( mipLayer.layerWidth == targetLayerWidth && mipLayer.layerHeight == targetLayerHeight )
+            continue;
+
+        pixelDataTraversal::mipmapResource newLayer;
+
+        FilterPipelineLayer(
+            engineInterface, pixelData, dstColorPipe,
+            mipLayer, targetLayerWidth, targetLayerHeight,
+            upscaleFilter, downsamplingFilter,
+            upscaleCaps, downsamplingCaps,
+            newLayer
+        );
+
+        engineInterface->PixelFree( mipLayer.texels );
+
+        mipLayer = newLayer;
+    }
+
+    TruncatePipelineMipmaps( engineInterface, pixelData, mipIter );
+}
+
+static void GeneratePipelineMipmaps(
+    EngineInterface *engineInterface, pixelDataTraversal& pixelData,
+    uint32 maxMipmapCount, eMipmapGenerationMode mipGenMode
+)
+{
+    size_t mipmapCount = pixelData.mipmaps.size();
+
+    // We cannot do anything if we do not have a first level (base texture).
+    if ( mipmapCount == 0 || mipmapCount >= maxMipmapCount )
+        return;
+
+    // The mode was verified while planning the pipeline; MIPMAPGEN_DEFAULT is a box filter.
+    // Every level is the box-filtered previous level, which equals filtering the base layer
+    // in growing blocks but touches each texel only once.
+    assert( mipGenMode == MIPMAPGEN_DEFAULT );
+
+    rasterResizeFilterInterface *downsamplingFilter, *upscaleFilter;
+    resizeFilteringCaps downsamplingCaps, upscaleCaps;
+
+    FetchResizeFilteringFilters(
+        engineInterface, "blur", NULL,
+        downsamplingFilter, upscaleFilter,
+        downsamplingCaps, upscaleCaps
+    );
+
+    mipmapLayerResizeColorPipeline dstColorPipe(
+        pixelData.rasterFormat, pixelData.depth, pixelData.rowAlignment, pixelData.colorOrder,
+        PALETTE_NONE, NULL, 0
+    );
+
+    const pixelDataTraversal::mipmapResource& baseLayer = pixelData.mipmaps[ 0 ];
+
+    mipGenLevelGenerator mipGen( baseLayer.layerWidth, baseLayer.layerHeight );
+
+    if ( !mipGen.isValidLevel() )
+    {
+        throw RwException( "invalid raster dimensions in mipmap generation" );
+    }
+
+    for ( size_t n = 1; n < mipmapCount; n++ )
+    {
+        if ( mipGen.incrementLevel() == false )
+            return;
+    }
+
+    while ( pixelData.mipmaps.size() < maxMipmapCount )
+    {
+        if ( mipGen.incrementLevel() == false )
+            break;
+
+        pixelDataTraversal::mipmapResource newLayer;
+
+        FilterPipelineLayer(
+            engineInterface, pixelData, dstColorPipe,
+            pixelData.mipmaps.back(), mipGen.getLevelWidth(), mipGen.getLevelHeight(),
+            upscaleFilter, downsamplingFilter,
+            upscaleCaps, downsamplingCaps,
+            newLayer
+        );
+
+        try
+        {
+            pixelData.mipmaps.push_back( newLayer );
+        }
+        catch( ... )
+        {
+            engineInterface->PixelFree( newLayer.texels );
+
+            throw;
+        }
+    }
+}
+
+// Checks the encoding operation against the destination native texture before any pixels are touched.
+// Decides the compression type for compression operations (RWCOMPRESS_NONE if compression is skipped).
+static void VerifyPipelineEncoding(
+    EngineInterface *engineInterface, const rasterPipelineOperation *encodeOp,
+    texNativeTypeProvider *dstProvider, bool wasCompressed, bool texHasAlpha,
+    eCompressionType& compressionTypeOut
+)
+{
+    compressionTypeOut = RWCOMPRESS_NONE;
+
+    if ( encodeOp == NULL )
+        return;
+
+    eRasterPipelineOperation opType = encodeOp->opType;
+
+    if ( opType == RASTERPIPE_PALETTIZE )
+    {
+        ePaletteType paletteType = encodeOp->paletteType;
+
+        if ( paletteType != PALETTE_4BIT && paletteType != PALETTE_8BIT )
+        {
+            throw RwException( "unknown palette type in raster palettization routine" );
+        }
+
+        pixelCapabilities inputTransferCaps;
+
+        dstProvider->GetPixelCapabilities( inputTransferCaps );
+
+        if ( inputTransferCaps.supportsPalette == false )
+        {
+            throw RwException( "target raster does not support palette input" );
+        }
+
+        storageCapabilities storageCaps;
+
+        dstProvider->GetStorageCapabilities( storageCaps );
+
+        if ( storageCaps.pixelCaps.supportsPalette == false )
+        {
+            throw RwException( "target raster cannot store palette data" );
+        }
+    }
+    else if ( opType == RASTERPIPE_COMPRESS || opType == RASTERPIPE_COMPRESS_CUSTOM )
+    {
+        storageCapabilities storeCaps;
+
+        dstProvider->GetStorageCapabilities( storeCaps );
+
+        // Do not recompress textures and do not compress if the architecture does it already.
+        if ( wasCompressed || storeCaps.isCompressedFormat )
+            return;
+
+        eCompressionType targetCompressionType = encodeOp->compressionType;
+
+        if ( opType == RASTERPIPE_COMPRESS )
+        {
+            pixelCapabilities inputTransferCaps;
+
+            dstProvider->GetPixelCapabilities( inputTransferCaps );
+
+            bool supportsDXT1 = ( inputTransferCaps.supportsDXT1 && storeCaps.pixelCaps.supportsDXT1 );
+            bool supportsDXT2 = ( inputTransferCaps.supportsDXT2 && storeCaps.pixelCaps.supportsDXT2 );
+            bool supportsDXT3 = ( inputTransferCaps.supportsDXT3 && storeCaps.pixelCaps.supportsDXT3 );
+            bool supportsDXT4 = ( inputTransferCaps.supportsDXT4 && storeCaps.pixelCaps.supportsDXT4 );
+            bool supportsDXT5 = ( inputTransferCaps.supportsDXT5 && storeCaps.pixelCaps.supportsDXT5 );
+
+            if ( supportsDXT1 == false &&
+                 supportsDXT2 == false &&
+                 supportsDXT3 == false &&
+                 supportsDXT4 == false &&
+                 supportsDXT5 == false )
+            {
+                throw RwException( "attempted to compress a raster that does not support compression" );
+            }
+
+            bool couldDecide =
+                DecideBestDXTCompressionFormat(
+                    engineInterface,
+                    texHasAlpha,
+                    supportsDXT1, supportsDXT2, supportsDXT3, supportsDXT4, supportsDXT5,
+                    encodeOp->quality,
+                    targetCompressionType
+                );
+
+            if ( !couldDecide )
+            {
+                throw RwException( "could not decide on an optimal DXT compression type" );
+            }
+        }
+
+        compressionTypeOut = targetCompressionType;
+    }
+}
+
+// Decides the pixel format that the pipeline has to encode to at the end.
+// Returns false if the pixels can be passed to the native texture as they are.
+static bool DecidePipelineEncoding(
+    const rasterPipelineOperation *encodeOp, eCompressionType targetCompressionType,
+    const pixelFormat& origFormat, bool isDecoded,
+    const pixelDataTraversal& pixelData,
+    pixelFormat& formatOut
+)
+{
+    bool wantsEncoding = false;
+
+    if ( encodeOp != NULL )
+    {
+        eRasterPipelineOperation opType = encodeOp->opType;
+
+        if ( opType == RASTERPIPE_PALETTIZE )
+        {
+            ePaletteType paletteType = encodeOp->paletteType;
+
+            // We always want to palettize to 32bit quality, unless the user wants otherwise.
+            eRasterFormat targetRasterFormat = encodeOp->paletteRasterFormat;
+
+            if ( targetRasterFormat == RASTER_DEFAULT )
+            {
+                targetRasterFormat = ( pixelData.hasAlpha ? RASTER_8888 : RASTER_888 );
+            }
+
+            formatOut.rasterFormat = targetRasterFormat;
+            formatOut.depth = ( paletteType == PALETTE_4BIT ? 4 : 8 );
+            formatOut.rowAlignment = 4; // good measure.
+            formatOut.colorOrder = pixelData.colorOrder;
+            formatOut.paletteType = paletteType;
+            formatOut.compressionType = RWCOMPRESS_NONE;
+
+            wantsEncoding = true;
+        }
+        else if ( targetCompressionType != RWCOMPRESS_NONE )
+        {
+            formatOut.rasterFormat = pixelData.rasterFormat;
+            formatOut.depth = pixelData.depth;
+            formatOut.rowAlignment = 0;
+            formatOut.colorOrder = pixelData.colorOrder;
+            formatOut.paletteType = PALETTE_NONE;
+            formatOut.compressionType = targetCompressionType;
+
+            wantsEncoding = true;
+        }
+    }
+
+    if ( wantsEncoding == false && isDecoded )
+    {
+        // Put the pixels back into the format they came in, like the single operations do.
+        formatOut = origFormat;
+
+        wantsEncoding = true;
+    }
+
+    return wantsEncoding;
+}
+
+void ExecuteRasterPipeline( Raster *theRaster, const RasterPipeline& pipeline )
+{
+    if ( pipeline.isEmpty() )
+        return;
+
+    EngineInterface *engineInterface = (EngineInterface*)theRaster->engineInterface;
+
+    nativeTextureStreamPlugin *nativeTexEnv = nativeTextureStreamStore.GetPluginStruct( engineInterface );
+
+    if ( !nativeTexEnv )
+    {
+        throw RwException( "native texture environment unavailable" );
+    }
+
+    scoped_rwlock_writer <rwlock> rasterConsistency( GetRasterLock( theRaster ) );
+
+    // Make sure we are mutable.
+    NativeCheckRasterMutable( theRaster );
+    NotifyRasterModified( theRaster );
+
+    PlatformTexture *platformTex = theRaster->platformData;
+
+    if ( !platformTex )
+    {
+        throw RwException( "no native data" );
+    }
+
+    texNativeTypeProvider *srcProvider = GetRasterNativeTypeProvider( theRaster );
+
+    if ( !srcProvider )
+    {
+        throw RwException( "invalid native data" );
+    }
+
+    // Resolve the native texture type that we write to.
+    texNativeTypeProvider *dstProvider = srcProvider;
+    RwTypeSystem::typeInfoBase *dstTypeInfo = NULL;
+
+    if ( const char *targetNativeName = pipeline.targetNativeName )
+    {
+        nativeTexTypeHandle_t dstTypeHandle = GetNativeTextureTypeHandle( engineInterface, targetNativeName );
+
+        dstProvider = nativeTexEnv->GetTypeProviderByHandle( dstTypeHandle );
+
+        if ( dstProvider == NULL )
+        {
+            throw RwException( "invalid target native texture type in raster pipeline" );
+        }
+
+        if ( dstTypeHandle != GetRasterNativeTypeHandle( theRaster ) )
+        {
+            dstTypeInfo = dstProvider->managerData.rwTexType;
+        }
+    }
+
+    bool isConverting = ( dstTypeInfo != NULL );
+
+    PlatformTexture *dstNativeTex = platformTex;
+
+    if ( isConverting )
+    {
+        dstNativeTex = CreateNativeTexture( engineInterface, dstTypeInfo );
+
+        if ( !dstNativeTex )
+        {
+            throw RwException( "failed to allocate target native texture in raster pipeline" );
+        }
+    }
+
+    try
+    {
+        // Plan the execution and verify every operation, so that nothing fails after we took the pixels.
+        // Geometric operations need the intermediate buffer, encoding operations only decide the final format.
+        const rasterPipelineOperation *encodeOp = NULL;
+        bool needsWorkingBuffer = false;
+
+        for ( const rasterPipelineOperation& op : pipeline.operations )
+        {
+            eRasterPipelineOperation opType = op.opType;
+
+            if ( opType == RASTERPIPE_RESIZE )
+            {
+                // Verify that the dimensions are even accepted by the native texture.
+                nativeTextureSizeRules sizeRules;
+
+                dstProvider->GetTextureSizeRules( dstNativeTex, sizeRules );
+
+                if ( sizeRules.IsMipmapSizeValid( op.width, op.height ) == false )
+                {
+                    throw RwException( "dimensions given for raster resize routine are invalid for that native texture type" );
+                }
+
+                needsWorkingBuffer = true;
+            }
+            else if ( opType == RASTERPIPE_GENERATE_MIPMAPS )
+            {
+                // Raster::generateMipmaps does not implement the other modes either.
+                if ( op.mipGenMode != MIPMAPGEN_DEFAULT )
+                {
+                    throw RwException( "unsupported mipmap generation mode in raster pipeline" );
+                }
+
+                needsWorkingBuffer = true;
+            }
+            else if ( opType == RASTERPIPE_PALETTIZE || opType == RASTERPIPE_COMPRESS || opType == RASTERPIPE_COMPRESS_CUSTOM )
+            {
+                // The pixels are encoded once at the end, so a second encoding would silently replace the first.
+                if ( encodeOp != NULL )
+                {
+                    throw RwException( "raster pipeline cannot palettize or compress more than once" );
+                }
+
+                encodeOp = &op;
+            }
+        }
+
+        bool wasCompressed = srcProvider->IsTextureCompressed( platformTex );
+
+        eCompressionType targetCompressionType;
+
+        VerifyPipelineEncoding(
+            engineInterface, encodeOp, dstProvider, wasCompressed, srcProvider->DoesTextureHaveAlpha( platformTex ),
+            targetCompressionType
+        );
+
+        if ( isConverting )
+        {
+            // Transfer the version of the raster.
+            dstProvider->SetTextureVersion( engineInterface, dstNativeTex, srcProvider->GetTextureVersion( platformTex ) );
+        }
+
+        pixelDataTraversal pixelData;
+
+        texNativeTypeProvider::acquireFeedback_t acquireFeedback;
+
+        try
+        {
+            // Fetch the pixels once.
+            // The raster keeps its pixels until all operations succeeded, so borrowed texels are copied first.
+            {
+                pixelDataTraversal texPixels;
+
+                srcProvider->GetPixelDataFromTexture( engineInterface, platformTex, texPixels );
+
+                if ( texPixels.isNewlyAllocated )
+                {
+                    pixelData = texPixels;
+                }
+                else
+                {
+                    pixelData.CloneFrom( engineInterface, texPixels );
+                }
+            }
+
+            pixelFormat origFormat;
+            GetPixelDataFormat( pixelData, origFormat );
+
+            if ( needsWorkingBuffer )
+            {
+                DecodePipelineWorkingBuffer( engineInterface, pixelData );
+            }
+
+            // Run the geometric operations in order.
+            for ( const rasterPipelineOperation& op : pipeline.operations )
+            {
+                eRasterPipelineOperation opType = op.opType;
+
+                if ( opType == RASTERPIPE_RESIZE )
+                {
+                    ResizePipelineWorkingBuffer( engineInterface, pixelData, op.width, op.height, op.downsampleMode, op.upscaleMode );
+                }
+                else if ( opType == RASTERPIPE_CLEAR_MIPMAPS )
+                {
+                    TruncatePipelineMipmaps( engineInterface, pixelData, 1 );
+                }
+                else if ( opType == RASTERPIPE_GENERATE_MIPMAPS )
+                {
+                    GeneratePipelineMipmaps( engineInterface, pixelData, op.maxMipmapCount, op.mipGenMode );
+                }
+            }
+
+            // Encode once.
+            pixelFormat targetFormat;
+
+            bool wantsEncoding =
+                DecidePipelineEncoding(
+                    encodeOp, targetCompressionType, origFormat, needsWorkingBuffer, pixelData,
+                    targetFormat
+                );
+
+            if ( wantsEncoding )
+            {
+                pixelFormat curFormat;
+                GetPixelDataFormat( pixelData, curFormat );
+
+                if ( IsSamePixelFormat( curFormat, targetFormat ) == false )
+                {
+                    bool hasConverted = ConvertPixelData( engineInterface, pixelData, targetFormat );
+
+                    if ( !hasConverted )
+                    {
+                        throw RwException( "pixel conversion failed in raster pipeline" );
+                    }
+                }
+            }
+
+            bool hasTranscoded = false;
+
+            if ( isConverting )
+            {
+                // Direct transcoders are asked first, like in ConvertRasterTo.
+                hasTranscoded = TranscodeNativePixelData( engineInterface, srcProvider, dstProvider, pixelData );
+
+                if ( !hasTranscoded )
+                {
+                    // Make pixels compatible for the target format.
+                    CompatibilityTransformPixelData( engineInterface, pixelData, dstProvider );
+                }
+            }
+
+            if ( !hasTranscoded )
+            {
+                // The texels have to obey size rules of the destination native texture.
+                AdjustPixelDataDimensionsByFormat( engineInterface, dstProvider, pixelData );
+            }
+
+            if ( isConverting == false )
+            {
+                // The raster must keep its pixels if storing the new ones fails.
+                // So we store them into a copy of the native texture, which keeps all of its properties,
+                // and swap it in once it holds the result.
+                dstNativeTex = CloneNativeTexture( engineInterface, platformTex );
+
+                if ( !dstNativeTex )
+                {
+                    throw RwException( "failed to allocate target native texture in raster pipeline" );
+                }
+
+                srcProvider->UnsetPixelDataFromTexture( engineInterface, dstNativeTex, true );
+            }
+
+            // Write once.
+            dstProvider->SetPixelDataToTexture( engineInterface, dstNativeTex, pixelData, acquireFeedback );
+        }
+        catch( ... )
+        {
+            pixelData.FreePixels( engineInterface );
+
+            throw;
+        }
+
+        if ( acquireFeedback.hasDirectlyAcquired == false )
+        {
+            pixelData.FreePixels( engineInterface );
+        }
+        else
+        {
+            pixelData.DetachPixels();
+        }
+    }
+    catch( ... )
+    {
+        if ( dstNativeTex != NULL && dstNativeTex != platformTex )
+        {
+            DeleteNativeTexture( engineInterface, dstNativeTex );
+        }
+
+        throw;
+    }
+
+    // Link the new native texture and delete the old one.
+    DeleteNativeTexture( engineInterface, platformTex );
+
+    SetRasterNativeData( theRaster, dstNativeTex, dstProvider );
+}
+
+};
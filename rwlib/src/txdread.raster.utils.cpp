@@ -20,7 +20,7 @@ void Raster::getSizeRules( rasterSizeRules& rulesOut ) const
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -79,7 +79,7 @@ void Raster::getFormatString( char *buf, size_t bufSize, size_t& lengthOut ) con
 
     Interface *engineInterface = this->engineInterface;
 
-    const texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    const texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
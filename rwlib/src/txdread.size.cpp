@@ -82,10 +82,13 @@ bool UnregisterResizeFiltering( EngineInterface *engineInterface, rasterResizeFi
 
 void Raster::resize(uint32 newWidth, uint32 newHeight, const char *downsampleMode, const char *upscaleMode)
 {
+    scoped_profile_zone profileZone( this->engineInterface, "Raster::resize" );
+
     scoped_rwlock_writer <rwlock> rasterConsistency( GetRasterLock( this ) );
 
     // Make sure we are mutable.
     NativeCheckRasterMutable( this );
+    NotifyRasterModified( this );
 
     PlatformTexture *platformTex = this->platformData;
 
@@ -96,7 +99,7 @@ void Raster::resize(uint32 newWidth, uint32 newHeight, const char *downsampleMod
 
     EngineInterface *engineInterface = (EngineInterface*)this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
@@ -386,7 +389,7 @@ void Raster::getSize(uint32& width, uint32& height) const
 
     Interface *engineInterface = this->engineInterface;
 
-    texNativeTypeProvider *texProvider = GetNativeTextureTypeProvider( engineInterface, platformTex );
+    texNativeTypeProvider *texProvider = GetRasterNativeTypeProvider( this );
 
     if ( !texProvider )
     {
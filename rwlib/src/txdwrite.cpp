@@ -8,6 +8,10 @@
 
 #include "txdread.raster.hxx"
 
+#include "rwthreading.parallel.hxx"
+
+#include <exception>
+
 namespace rw
 {
 
@@ -88,7 +92,7 @@ uint16 GetTexDictionaryRecommendedDriverID( Interface *engineInterface, const Te
 
                     if ( nativeObj )
                     {
-                        texNativeTypeProvider *typeProvider = GetNativeTextureTypeProvider( engineInterface, nativeObj );
+                        texNativeTypeProvider *typeProvider = GetRasterNativeTypeProvider( texRaster );
 
                         if ( typeProvider )
                         {
@@ -150,6 +154,113 @@ uint16 GetTexDictionaryRecommendedDriverID( Interface *engineInterface, const Te
     return recommendedPlatform;
 }
 
+// Growable in-memory stream that a single texture is serialized into.
+struct texSerializationMemoryStream : public Stream
+{
+    inline texSerializationMemoryStream( Interface *engineInterface ) : Stream( engineInterface, NULL )
+    {
+        this->seekPos = 0;
+    }
+
+    size_t read( void *out_buf, size_t readCount )
+    {
+        size_t bufSize = this->buffer.size();
+        size_t seekPos = this->seekPos;
+
+        if ( seekPos >= bufSize )
+            return 0;
+
+        size_t actualCount = std::min( readCount, bufSize - seekPos );
+
+        memcpy( out_buf, this->buffer.data() + seekPos, actualCount );
+
+        this->seekPos = ( seekPos + actualCount );
+
+        return actualCount;
+    }
+
+    size_t write( const void *in_buf, size_t writeCount )
+    {
+        size_t seekPos = this->seekPos;
+        size_t endPos = ( seekPos + writeCount );
+
+        if ( endPos > this->buffer.size() )
+        {
+            this->buffer.resize( endPos );
+        }
+
+        memcpy( this->buffer.data() + seekPos, in_buf, writeCount );
+
+        this->seekPos = endPos;
+
+        return writeCount;
+    }
+
+    void skip( int64 skipCount )
+    {
+        this->seek( skipCount, RWSEEK_CUR );
+    }
+
+    int64 tell( void ) const
+    {
+        return (int64)this->seekPos;
+    }
+
+    void seek( int64 seek_off, eSeekMode seek_mode )
+    {
+        int64 basePos = 0;
+
+        if ( seek_mode == RWSEEK_CUR )
+        {
+            basePos = (int64)this->seekPos;
+        }
+        else if ( seek_mode == RWSEEK_END )
+        {
+            basePos = (int64)this->buffer.size();
+        }
+
+        int64 newPos = ( basePos + seek_off );
+
+        if ( newPos < 0 )
+        {
+            throw RwStreamException( "seek before the beginning of a memory stream" );
+        }
+
+        this->seekPos = (size_t)newPos;
+    }
+
+    int64 size( void ) const
+    {
+        return (int64)this->buffer.size();
+    }
+
+    bool supportsSize( void ) const
+    {
+        return true;
+    }
+
+    std::vector <uint8> buffer;
+    size_t seekPos;
+};
+
+// Result of serializing one texture on a worker thread.
+struct texSerializationResult
+{
+    struct warningQueue : public WarningHandler
+    {
+        void OnWarningMessage( std::string&& theMessage ) override
+        {
+            this->messages.push_back( std::move( theMessage ) );
+        }
+
+        std::vector <std::string> messages;
+    };
+
+    std::vector <uint8> serializedData;
+    warningQueue warnings;
+    std::exception_ptr error;
+};
+
 void texDictionaryStreamPlugin::Serialize( Interface *intf, BlockProvider& outputProvider, RwObject *objectToSerialize ) const
 {
     EngineInterface *engineInterface = (EngineInterface*)intf;
@@ -210,16 +321,78 @@ void texDictionaryStreamPlugin::Serialize( Interface *intf, BlockProvider& outpu
 
     // Serialize all textures of this TXD.
     // This is done by appending the textures after the meta block.
+    // Native texture blocks do not depend on each other, so we serialize them into memory on
+    // worker threads and append them in dictionary order. This produces the same bytes as writing
+    // them one after another. Warnings and errors are reported in dictionary order, too.
+    std::vector <TextureBase*> textures;
+    textures.reserve( numTextures );
+
     LIST_FOREACH_BEGIN( TextureBase, txdObj->textures.root, texDictNode )
 
-        TextureBase *texture = item;
+        textures.push_back( item );
 
-        // Put it into a sub block.
-        BlockProvider texNativeBlock( &outputProvider );
+    LIST_FOREACH_END
 
-        engineInterface->SerializeBlock( texture, texNativeBlock );
+    size_t textureCount = textures.size();
 
-    LIST_FOREACH_END
+    // Limit the amount of textures that are kept in memory at once.
+    size_t batchSize = ( std::max( 1u, std::thread::hardware_concurrency() ) * 2 );
+
+    for ( size_t batchStart = 0; batchStart < textureCount; batchStart += batchSize )
+    {
+        size_t batchCount = std::min( batchSize, textureCount - batchStart );
+
+        std::vector <texSerializationResult> results( batchCount );
+
+        ParallelForEach( engineInterface, batchCount,
+            [&]( size_t n )
+        {
+            TextureBase *texture = textures[ batchStart + n ];
+
+            texSerializationResult& result = results[ n ];
+
+            GlobalPushWarningHandler( engineInterface, &result.warnings );
+
+            try
+            {
+                texSerializationMemoryStream texStream( engineInterface );
+
+                {
+                    BlockProvider texNativeBlock( &texStream, RWBLOCKMODE_WRITE, outputProvider.doesIgnoreBlockRegions() );
+
+                    engineInterface->SerializeBlock( texture, texNativeBlock );
+                }
+
+                result.serializedData = std::move( texStream.buffer );
+            }
+            catch( ... )
+            {
+                result.error = std::current_exception();
+            }
+
+            GlobalPopWarningHandler( engineInterface );
+        });
+
+        for ( texSerializationResult& result : results )
+        {
+            for ( std::string& message : result.warnings.messages )
+            {
+                engineInterface->PushWarning( std::move( message ) );
+            }
+
+            if ( result.error )
+            {
+                std::rethrow_exception( result.error );
+            }
+
+            const std::vector <uint8>& serializedData = result.serializedData;
+
+            if ( serializedData.empty() == false )
+            {
+                outputProvider.write( serializedData.data(), serializedData.size() );
+            }
+        }
+    }
 
     // Write extensions.
     engineInterface->SerializeExtensions( txdObj, outputProvider );
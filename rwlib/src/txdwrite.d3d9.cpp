@@ -301,21 +301,30 @@ struct d3d9MipmapManager
 
             uint32 texDataSize = getRasterDataSizeByRowSize( dstRowSize, mipHeight );
 
-            // Allocate new texels.
-            void *newtexels = engineInterface->PixelAllocate( texDataSize );
-            
-            try
-            {
-                formatHandler->ConvertToRW(
-                    mipLayer.texels, mipWidth, mipHeight, dstRowSize, mipLayer.dataSize,
-                    newtexels
-                );
-            }
-            catch( ... )
+            void *newtexels = mipLayer.texels;
+
+            // Texels that already are RW texels are returned in-place.
+            isNewlyAllocated = ( d3d9CanUseAnonymousTexelsInPlace( nativeTex, formatHandler, depth ) == false );
+
+            if ( isNewlyAllocated )
             {
-                engineInterface->PixelFree( newtexels );
+                // Allocate new texels.
+                newtexels = engineInterface->PixelAllocate( texDataSize );
 
-                throw;
+                try
+                {
+                    d3d9ConvertAnonymousLayerToRW(
+                        engineInterface, formatHandler,
+                        mipLayer.texels, mipLayer.dataSize, mipWidth, mipHeight,
+                        dstRowSize, newtexels
+                    );
+                }
+                catch( ... )
+                {
+                    engineInterface->PixelFree( newtexels );
+
+                    throw;
+                }
             }
 
             // Now return that new stuff.
@@ -338,8 +347,6 @@ struct d3d9MipmapManager
 
             dstTexelsOut = newtexels;
             dstDataSizeOut = texDataSize;
-
-            isNewlyAllocated = true;
         }
         else
         {
@@ -397,6 +404,32 @@ struct d3d9MipmapManager
             // Calculate the row stride that is required to iterate through the RW buffer rows.
             uint32 srcRowSize = getRasterDataRowSize( width, depth, rowAlignment );
 
+            // If the handler stores RW texels anyway, we can take texels of its exact format.
+            if ( formatHandler->IsTextureDataRWCompatible() && compressionType == RWCOMPRESS_NONE && paletteType == PALETTE_NONE )
+            {
+                eRasterFormat handlerRasterFormat;
+                uint32 handlerDepth;
+                eColorOrdering handlerColorOrder;
+
+                formatHandler->GetTextureRWFormat( handlerRasterFormat, handlerDepth, handlerColorOrder );
+
+                if ( rasterFormat == handlerRasterFormat && depth == handlerDepth && colorOrder == handlerColorOrder &&
+                     srcRowSize == getD3DRasterDataRowSize( width, depth ) )
+                {
+                    mipLayer.width = width;
+                    mipLayer.height = height;
+
+                    mipLayer.layerWidth = layerWidth;
+                    mipLayer.layerHeight = layerHeight;
+
+                    mipLayer.texels = srcTexels;
+                    mipLayer.dataSize = dataSize;
+
+                    hasDirectlyAcquiredOut = true;
+                    return;
+                }
+            }
+
             // We create an encoding that is expected to be raw data.
             uint32 texDataSize = (uint32)formatHandler->GetFormatTextureDataSize( width, height );
 
@@ -428,8 +461,8 @@ struct d3d9MipmapManager
             mipLayer.texels = newtexels;
             mipLayer.dataSize = texDataSize;
 
-            // We always newly allocate to store pixels here, because we want to
-            // keep plugin architecture as simple as possible.
+            // Apart from the in-place case, we always newly allocate to store pixels here,
+            // because we want to keep plugin architecture as simple as possible.
             hasDirectlyAcquiredOut = false;
         }
         else
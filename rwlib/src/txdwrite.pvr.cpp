@@ -145,104 +145,89 @@ void pvrNativeTextureTypeProvider::SerializeTexture( TextureBase *theTexture, Pl
 void pvrNativeTextureTypeProvider::DecompressPVRMipmap(
     Interface *engineInterface,
     uint32 mipWidth, uint32 mipHeight, uint32 layerWidth, uint32 layerHeight, const void *srcTexels,
-    eRasterFormat pvrRasterFormat, uint32 pvrDepth, eColorOrdering pvrColorOrder,
+    ePVRInternalFormat internalFormat,
     eRasterFormat targetRasterFormat, uint32 targetDepth, uint32 targetRowAlignment, eColorOrdering targetColorOrder,
-    PVRPixelType pvrSrcPixelType, PVRPixelType pvrDstPixelType,
     void*& dstTexelsOut, uint32& dstDataSizeOut
 )
 {
-    // Create a PVR texture.
-    PVRTextureHeader pvrHeader = PVRTextureHeaderCreate( PVRPixelTypeGetID( pvrSrcPixelType ), mipHeight, mipWidth );
+    uint32 pvrDepth = getDepthByPVRFormat( internalFormat );
 
-    if ( !pvrHeader )
+    if ( pvrDepth == 0 )
     {
-        throw RwException( "failed to create PVRTexLib texture header" );
+        throw RwException( "failed to decompress PVRTC due to unknown internalFormat" );
     }
 
-    try
+    pvrtc::pvrtcSurface pvrSurface( mipWidth, mipHeight, ( pvrDepth == 2 ) );
+
+    if ( !pvrSurface.isValid() )
     {
-        PVRTexture pvrSourceTexture = PVRTextureCreate( pvrHeader, srcTexels );
+        throw RwException( "invalid mipmap dimensions in PowerVR native texture mipmap decompression" );
+    }
 
-        if ( !pvrSourceTexture )
-        {
-            throw RwException( "failed to create PVRTexLib texture" );
-        }
-        
-        try
-        {
-            // Decompress it.
-            bool transcodeSuccess =
-                PVRTranscode( pvrSourceTexture, pvrDstPixelType, ePVRTVarTypeUnsignedByteNorm, ePVRTCSpacelRGB );
+    // The codec outputs 32bit RGBA colors, which we then put into the target format.
+    uint32 pvrRowSize = getRasterDataRowSize( mipWidth, 32, getPVRToolTextureDataRowAlignment() );
 
-            if ( transcodeSuccess == false )
-            {
-                throw RwException( "failed to decompress PVRTC compressed data using PVRTexLib" );
-            }
+    uint32 pvrDataSize = getRasterDataSizeByRowSize( pvrRowSize, mipHeight );
 
-            // Create a new raw texture of the layer dimensions.
-            uint32 dstRowSize = getRasterDataRowSize( layerWidth, targetDepth, targetRowAlignment );
+    void *pvrTexels = engineInterface->PixelAllocate( pvrDataSize );
 
-            uint32 dstDataSize = getRasterDataSizeByRowSize( dstRowSize, layerHeight );
+    if ( !pvrTexels )
+    {
+        throw RwException( "failed to allocate color buffer for PowerVR native texture decompression" );
+    }
 
-            uint32 pvrWidth = mipWidth;
-            uint32 pvrHeight = mipHeight;
+    try
+    {
+        pvrtc::decompressPVRTC( engineInterface, pvrSurface, srcTexels, pvrTexels );
 
-            uint32 pvrRowSize = getRasterDataRowSize( pvrWidth, pvrDepth, getPVRToolTextureDataRowAlignment() );
+        // Create a new raw texture of the layer dimensions.
+        uint32 dstRowSize = getRasterDataRowSize( layerWidth, targetDepth, targetRowAlignment );
 
-            const void *srcTexelPtr = PVRTextureGetDataPtr( pvrSourceTexture );
+        uint32 dstDataSize = getRasterDataSizeByRowSize( dstRowSize, layerHeight );
 
-            // Allocate new texels.
-            void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
+        // Allocate new texels.
+        void *dstTexels = engineInterface->PixelAllocate( dstDataSize );
 
-            if ( !dstTexels )
-            {
-                throw RwException( "failed to allocate destination surface for decompressed PowerVR native texture data" );
-            }
-
-            try
-            {
-                colorModelDispatcher fetchDispatch( pvrRasterFormat, pvrColorOrder, pvrDepth, NULL, 0, PALETTE_NONE );
-                colorModelDispatcher putDispatch( targetRasterFormat, targetColorOrder, targetDepth, NULL, 0, PALETTE_NONE );
-
-                copyTexelDataBounded(
-                    srcTexelPtr, dstTexels,
-                    fetchDispatch, putDispatch,
-                    pvrWidth, pvrHeight,
-                    layerWidth, layerHeight,
-                    0, 0,
-                    0, 0,
-                    pvrRowSize, dstRowSize
-                );
-            }
-            catch( ... )
-            {
-                // If anything went wrong in the pixel fetching, we free our data.
-                engineInterface->PixelFree( dstTexels );
-
-                throw;
-            }
+        if ( !dstTexels )
+        {
+            throw RwException( "failed to allocate destination surface for decompressed PowerVR native texture data" );
+        }
 
-            // Give things to the runtime.
-            dstTexelsOut = dstTexels;
-            dstDataSizeOut = dstDataSize;
+        try
+        {
+            colorModelDispatcher fetchDispatch( RASTER_8888, COLOR_RGBA, 32, NULL, 0, PALETTE_NONE );
+            colorModelDispatcher putDispatch( targetRasterFormat, targetColorOrder, targetDepth, NULL, 0, PALETTE_NONE );
+
+            copyTexelDataBounded(
+                pvrTexels, dstTexels,
+                fetchDispatch, putDispatch,
+                mipWidth, mipHeight,
+                layerWidth, layerHeight,
+                0, 0,
+                0, 0,
+                pvrRowSize, dstRowSize
+            );
         }
         catch( ... )
         {
-            PVRTextureDelete( pvrSourceTexture );
+            // If anything went wrong in the pixel fetching, we free our data.
+            engineInterface->PixelFree( dstTexels );
 
             throw;
         }
 
-        PVRTextureDelete( pvrSourceTexture );
+        // Give things to the runtime.
+        dstTexelsOut = dstTexels;
+        dstDataSizeOut = dstDataSize;
     }
     catch( ... )
     {
-        PVRTextureHeaderDelete( pvrHeader );
+        engineInterface->PixelFree( pvrTexels );
 
         throw;
     }
 
-    PVRTextureHeaderDelete( pvrHeader );
+    engineInterface->PixelFree( pvrTexels );
 }
 
 inline void getPVRTargetRasterFormat( ePVRInternalFormat internalFormat, eRasterFormat& targetRasterFormat, uint32& targetDepth, eColorOrdering& targetColorOrder )
@@ -287,17 +272,6 @@ void pvrNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
 
     pixelsOut.mipmaps.resize( mipmapCount );
     {
-        // Create source of the pixel type descriptor.
-        PVRPixelType pvrSrcPixelType = PVRGetCachedPixelType( internalFormat );
-
-        if ( !pvrSrcPixelType )
-        {
-            throw RwException( "failed to decompress PVRTC due to unknown internalFormat" );
-        }
-
-        // We need a pixel type for the decompressed format.
-        PVRPixelType pvrDstPixelType = this->pvrPixelType_rgba8888;
-
         for ( size_t n = 0; n < mipmapCount; n++ )
         {
             // Get parameters of this mipmap layer.
@@ -318,9 +292,8 @@ void pvrNativeTextureTypeProvider::GetPixelDataFromTexture( Interface *engineInt
             DecompressPVRMipmap(
                 engineInterface,
                 mipWidth, mipHeight, layerWidth, layerHeight, srcTexels,
-                RASTER_8888, 32, COLOR_RGBA,
+                internalFormat,
                 targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
-                pvrSrcPixelType, pvrDstPixelType,
                 dstTexels, dstDataSize
             );
 
@@ -415,29 +388,6 @@ void pvrNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
 
     // Compress mipmap layers.
     {
-        // Determine the source pixel format.
-        PVRPixelType pvrSrcPixelType = this->pvrPixelType_rgba8888;
-
-        // Transform the internal format into a pvrtexlib parameter.
-        PVRPixelType pvrDstPixelType = PVRGetCachedPixelType( internalFormat );
-
-        if ( !pvrDstPixelType )
-        {
-            throw RwException( "failed to compress PVRTC due to unknown internalFormat" );
-        }
-
-        // Determine the block dimensions of the PVR destination texture.
-        uint32 pvrBlockWidth, pvrBlockHeight;
-
-        uint32 pvrDepth = getDepthByPVRFormat( internalFormat );
-
-        bool gotDimms = getPVRCompressionBlockDimensions( pvrDepth, pvrBlockWidth, pvrBlockHeight );
-
-        if ( !gotDimms )
-        {
-            throw RwException( "failed to get PVR block compression dimensions in PVR native texture texel acquisition" );
-        }
-
         // Pre-allocate the mipmap array.
         pvrTex->mipmaps.resize( mipmapCount );
 
@@ -465,10 +415,7 @@ void pvrNativeTextureTypeProvider::SetPixelDataToTexture( Interface *engineInter
                 engineInterface,
                 mipWidth, mipHeight, srcTexels,
                 srcRasterFormat, srcDepth, srcRowAlignment, srcColorOrder, srcPaletteType, paletteData, paletteSize,
-                RASTER_8888, 32, COLOR_RGBA,
-                pvrSrcPixelType, pvrDstPixelType,
-                pvrBlockWidth, pvrBlockHeight,
-                pvrDepth,
+                internalFormat,
                 compressedWidth, compressedHeight,
                 dstTexels, dstDataSize
             );
@@ -567,17 +514,6 @@ struct pvrMipmapManager
 
         getPVRTargetRasterFormat( internalFormat, targetRasterFormat, targetDepth, targetColorOrder );
 
-        // Create source of the pixel type descriptor.
-        pvrNativeTextureTypeProvider::PVRPixelType pvrSrcPixelType = typeProv->PVRGetCachedPixelType( internalFormat );
-
-        if ( !pvrSrcPixelType )
-        {
-            throw RwException( "failed to decompress PVRTC due to unknown internalFormat" );
-        }
-
-        // We need a pixel type for the decompressed format.
-        pvrNativeTextureTypeProvider::PVRPixelType pvrDstPixelType = typeProv->pvrPixelType_rgba8888;
-
         // Do the decompression.
         void *dstTexels = NULL;
         uint32 dstDataSize = 0;
@@ -585,9 +521,8 @@ struct pvrMipmapManager
         typeProv->DecompressPVRMipmap(
             engineInterface,
             mipWidth, mipHeight, layerWidth, layerHeight, srcTexels,
-            RASTER_8888, 32, COLOR_RGBA,
+            internalFormat,
             targetRasterFormat, targetDepth, targetRowAlignment, targetColorOrder,
-            pvrSrcPixelType, pvrDstPixelType,
             dstTexels, dstDataSize
         );
 
@@ -674,29 +609,6 @@ struct pvrMipmapManager
             srcTexelsNewlyAllocated = true;
         }
 
-        // Determine the source pixel format.
-        pvrNativeTextureTypeProvider::PVRPixelType pvrSrcPixelType = typeProv->pvrPixelType_rgba8888;
-
-        // Transform the internal format into a pvrtexlib parameter.
-        pvrNativeTextureTypeProvider::PVRPixelType pvrDstPixelType = typeProv->PVRGetCachedPixelType( internalFormat );
-
-        if ( !pvrDstPixelType )
-        {
-            throw RwException( "failed to compress PVRTC due to unknown internalFormat" );
-        }
-
-        // Determine the block dimensions of the PVR destination texture.
-        uint32 pvrBlockWidth, pvrBlockHeight;
-
-        uint32 pvrDepth = getDepthByPVRFormat( internalFormat );
-
-        bool gotDimms = getPVRCompressionBlockDimensions( pvrDepth, pvrBlockWidth, pvrBlockHeight );
-
-        if ( gotDimms )
-        {
-            throw RwException( "failed to get PVR native texture block compression dimensions in mipmap texel acquisition" );
-        }
-
         // Do the compression.
         uint32 compressedWidth, compressedHeight;
 
@@ -707,10 +619,7 @@ struct pvrMipmapManager
             engineInterface,
             width, height, srcTexels,
             rasterFormat, depth, rowAlignment, colorOrder, paletteType, paletteData, paletteSize,
-            RASTER_8888, 32, COLOR_RGBA,
-            pvrSrcPixelType, pvrDstPixelType,
-            pvrBlockWidth, pvrBlockHeight,
-            pvrDepth,
+            internalFormat,
             compressedWidth, compressedHeight,
             dstTexels, dstDataSize
         );
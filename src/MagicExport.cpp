@@ -1,5 +1,7 @@
 #include "MagicExport.h"
 
+#include <cstring>
+
 #include "texformathelper.hxx"
 
 bool MagicFormatPluginExports::PutTexelRGBA(
@@ -35,4 +37,121 @@ bool MagicFormatPluginExports::BrowseTexelRGBA(
         texelSource, texelIndex, internal_rasterFormat, depth, internal_colorOrder,
 		internal_paletteType, paletteData, paletteSize, redOut, greenOut, blueOut, alphaOut
     );
-}
\ No newline at end of file
+}
+
+bool MagicFormatPluginExports::PutTexelRowRGBA(
+    void *dstRow, unsigned int texelCount, MAGIC_RASTER_FORMAT rasterFormat, unsigned int depth,
+    MAGIC_COLOR_ORDERING colorOrder, const unsigned char *rgbaTexels
+) const
+{
+    rw::eRasterFormat internal_rasterFormat;
+    rw::eColorOrdering internal_colorOrder;
+
+    MagicMapToInternalRasterFormat( rasterFormat, internal_rasterFormat );
+    MagicMapToInternalColorOrdering( colorOrder, internal_colorOrder );
+
+    if ( internal_rasterFormat == rw::RASTER_8888 && depth == 32 )
+    {
+        // Most plugins travel in 32bit color, which we can write directly.
+        unsigned char *dstTexels = (unsigned char*)dstRow;
+
+        if ( internal_colorOrder == rw::COLOR_RGBA )
+        {
+            memcpy( dstTexels, rgbaTexels, texelCount * 4 );
+
+            return true;
+        }
+        else if ( internal_colorOrder == rw::COLOR_BGRA )
+        {
+            for ( unsigned int n = 0; n < texelCount; n++ )
+            {
+                const unsigned char *srcTexel = ( rgbaTexels + n * 4 );
+                unsigned char *dstTexel = ( dstTexels + n * 4 );
+
+                dstTexel[0] = srcTexel[2];
+                dstTexel[1] = srcTexel[1];
+                dstTexel[2] = srcTexel[0];
+                dstTexel[3] = srcTexel[3];
+            }
+
+            return true;
+        }
+    }
+
+    for ( unsigned int n = 0; n < texelCount; n++ )
+    {
+        const unsigned char *srcTexel = ( rgbaTexels + n * 4 );
+
+        bool couldPut = rw::PutTexelRGBA(
+            dstRow, n, internal_rasterFormat, depth, internal_colorOrder,
+            srcTexel[0], srcTexel[1], srcTexel[2], srcTexel[3]
+        );
+
+        if ( !couldPut )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool MagicFormatPluginExports::BrowseTexelRowRGBA(
+    const void *srcRow, unsigned int texelCount, MAGIC_RASTER_FORMAT rasterFormat,
+    unsigned int depth, MAGIC_COLOR_ORDERING colorOrder, MAGIC_PALETTE_TYPE paletteType, const void *paletteData, unsigned int paletteSize,
+    unsigned char *rgbaTexelsOut
+) const
+{
+    rw::eRasterFormat internal_rasterFormat;
+    rw::eColorOrdering internal_colorOrder;
+    rw::ePaletteType internal_paletteType;
+
+    MagicMapToInternalRasterFormat( rasterFormat, internal_rasterFormat );
+    MagicMapToInternalColorOrdering( colorOrder, internal_colorOrder );
+    MagicMapToInternalPaletteType( paletteType, internal_paletteType );
+
+    if ( internal_rasterFormat == rw::RASTER_8888 && depth == 32 && internal_paletteType == rw::PALETTE_NONE )
+    {
+        const unsigned char *srcTexels = (const unsigned char*)srcRow;
+
+        if ( internal_colorOrder == rw::COLOR_RGBA )
+        {
+            memcpy( rgbaTexelsOut, srcTexels, texelCount * 4 );
+
+            return true;
+        }
+        else if ( internal_colorOrder == rw::COLOR_BGRA )
+        {
+            for ( unsigned int n = 0; n < texelCount; n++ )
+            {
+                const unsigned char *srcTexel = ( srcTexels + n * 4 );
+                unsigned char *dstTexel = ( rgbaTexelsOut + n * 4 );
+
+                dstTexel[0] = srcTexel[2];
+                dstTexel[1] = srcTexel[1];
+                dstTexel[2] = srcTexel[0];
+                dstTexel[3] = srcTexel[3];
+            }
+
+            return true;
+        }
+    }
+
+    for ( unsigned int n = 0; n < texelCount; n++ )
+    {
+        unsigned char *dstTexel = ( rgbaTexelsOut + n * 4 );
+
+        bool couldBrowse = rw::BrowseTexelRGBA(
+            srcRow, n, internal_rasterFormat, depth, internal_colorOrder,
+            internal_paletteType, paletteData, paletteSize,
+            dstTexel[0], dstTexel[1], dstTexel[2], dstTexel[3]
+        );
+
+        if ( !couldBrowse )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -22,6 +22,7 @@ static inline bool getRecommendedPlatformForDataType( RwVersionSets::eDataType d
     case RwVersionSets::RWVS_DT_UNCOMPRESSED_MOBILE:
     case RwVersionSets::RWVS_DT_POWERVR:
     case RwVersionSets::RWVS_DT_S3TC_MOBILE:
+    case RwVersionSets::RWVS_DT_ETC_MOBILE:
         platformOut = RwVersionSets::RWVS_PL_MOBILE;
         return true;
     case RwVersionSets::RWVS_DT_PSP:
@@ -125,6 +125,7 @@ struct defaultMemAlloc
 // Main window plugin entry points.
 extern void InitializeRWFileSystemWrap(void);
 extern void InitializeTaskCompletionWindowEnv( void );
+extern void InitializeTexturePreviewEnv( void );
 extern void InitializeSerializationStorageEnv( void );
 extern void InitializeMainWindowSerializationBlock( void );
 extern void InitializeMagicLanguages( void );
@@ -145,6 +146,7 @@ int main(int argc, char *argv[])
     // Initialize all main window plugins.
     InitializeRWFileSystemWrap();
     InitializeTaskCompletionWindowEnv();
+    InitializeTexturePreviewEnv();
     InitializeSerializationStorageEnv();
     InitializeMainWindowSerializationBlock();
     InitializeMagicLanguages();
@@ -93,6 +93,10 @@ MainWindow::MainWindow(QString appPath, rw::Interface *engineInterface, CFileSys
     this->drawMipmapLayers = false;
 	this->showBackground = false;
 
+    this->previewLogicalWidth = 0;
+    this->previewLogicalHeight = 0;
+    this->previewMipIndex = 0;
+
     this->hasOpenedTXDFileInfo = false;
 
     this->rwEngine = engineInterface;
@@ -1152,6 +1156,9 @@ void MainWindow::setCurrentTXD( rw::TexDictionary *txdObj )
 
         this->currentSelectedTexture = NULL;
 
+        // The previews keep the rasters of this TXD alive.
+        PurgeTexturePreviewCache( this );
+
         this->rwEngine->DeleteRwObject( this->currentTXD );
 
         this->currentTXD = NULL;
@@ -1553,44 +1560,60 @@ void MainWindow::updateTextureView( void )
 		{
             try
             {
-			    // Get a bitmap to the raster.
-			    // This is a 2D color component surface.
-			    rw::Bitmap rasterBitmap( this->rwEngine, 32, rw::RASTER_8888, rw::COLOR_BGRA );
+                // When fitting the image into the viewport, a smaller mipmap layer does the job.
+                // The preview is decoded in the background and handed to presentTexturePreview.
+                rw::uint32 viewWidth = 0;
+                rw::uint32 viewHeight = 0;
 
-                if ( this->drawMipmapLayers && rasterData->getMipmapCount() > 1 )
+                if ( this->showFullImage )
                 {
-                    rasterBitmap.setBgColor( 1.0, 1.0, 1.0, 0.0 );
-
-                    rw::DebugDrawMipmaps( this->rwEngine, rasterData, rasterBitmap );
+                    viewWidth = std::max( 1, imageView->width() );
+                    viewHeight = std::max( 1, imageView->height() );
                 }
-                else
-                {
-                    rasterBitmap = rasterData->getBitmap();
-                }
-
-			    QImage texImage = convertRWBitmapToQImage( rasterBitmap );
 
-			    imageWidget->setPixmap(QPixmap::fromImage(texImage));
-                this->updateTextureViewport();
-			    imageWidget->show();
+                RequestTexturePreview( this, rasterData, viewWidth, viewHeight, this->drawMipmapLayers );
             }
             catch( rw::RwException& except )
             {
-				this->txdLog->addLogMessage(QString("failed to get bitmap from texture: ") + except.message.c_str(), LOGMSG_WARNING);
-
-                // We hide the image widget.
-                this->clearViewImage();
+                this->presentTexturePreviewError( except.message.c_str() );
             }
 		}
     }
 }
 
+void MainWindow::presentTexturePreview( rw::Raster *raster, const QImage& image, rw::uint32 logicalWidth, rw::uint32 logicalHeight, rw::uint32 mipIndex )
+{
+    TexInfoWidget *texItem = this->currentSelectedTexture;
+
+    // The selection could have changed in the meantime.
+    if ( texItem == NULL || texItem->GetTextureHandle()->GetRaster() != raster )
+        return;
+
+    this->previewLogicalWidth = logicalWidth;
+    this->previewLogicalHeight = logicalHeight;
+    this->previewMipIndex = mipIndex;
+
+    imageWidget->setPixmap(QPixmap::fromImage(image));
+    this->updateTextureViewport();
+    imageWidget->show();
+}
+
+void MainWindow::presentTexturePreviewError( const QString& errorMessage )
+{
+    this->txdLog->addLogMessage(QString("failed to get bitmap from texture: ") + errorMessage, LOGMSG_WARNING);
+
+    // We hide the image widget.
+    this->clearViewImage();
+}
+
 void MainWindow::updateTextureViewport() {
     QLabel *imageWidget = this->imageWidget;
-    if (const QPixmap *widgetPixMap = imageWidget->pixmap()){
+    if (imageWidget->pixmap()){
+        // The pixmap can be a smaller mipmap layer, so go by the size of the texture itself.
+        float w, h, border_w, border_h;
+        w = this->previewLogicalWidth; h = this->previewLogicalHeight;
+        bool needsFinerLayer = false;
         if (this->showFullImage) {
-            float w, h, border_w, border_h;
-            w = widgetPixMap->width(); h = widgetPixMap->height();
             border_w = imageView->width();
             border_h = imageView->height();
             float scaleFactor = std::min(border_w / w, border_h / h);
@@ -1598,11 +1621,20 @@ void MainWindow::updateTextureViewport() {
                 imageWidget->setFixedSize(scaleFactor * w, scaleFactor * h);
             }
             else {
-                imageWidget->setFixedSize(widgetPixMap->width(), widgetPixMap->height());
+                imageWidget->setFixedSize(w, h);
             }
+            rw::uint32 layerWidth = std::max( 1u, this->previewLogicalWidth >> this->previewMipIndex );
+            rw::uint32 layerHeight = std::max( 1u, this->previewLogicalHeight >> this->previewMipIndex );
+            needsFinerLayer = ( layerWidth < (rw::uint32)imageWidget->width() || layerHeight < (rw::uint32)imageWidget->height() );
         }
         else {
-            imageWidget->setFixedSize(widgetPixMap->width(), widgetPixMap->height());
+            imageWidget->setFixedSize(w, h);
+            needsFinerLayer = ( this->previewMipIndex != 0 );
+        }
+
+        // Zooming in or growing the viewport asks for more detail.
+        if ( needsFinerLayer ) {
+            this->updateTextureView();
         }
     }
 }
@@ -2471,6 +2503,9 @@ void MainWindow::onExportAllTextures( bool checked )
 
 void MainWindow::clearViewImage()
 {
+    // Do not let a pending preview show up again.
+    CancelTexturePreview( this );
+
 	imageWidget->clear();
     imageWidget->setFixedSize(1, 1);
 	imageWidget->hide();
@@ -445,6 +445,9 @@ static void massbuild_task_entry( rw::thread_t threadHandle, rw::Interface *engi
 
     try
     {
+        // Deliver the warnings of this build as one block so they do not interleave with other tasks in the log.
+        rw::utils::warning_batch_scope warnBatch( engineInterface );
+
         // Run the mass build module.
         MassBuildModule module( params->taskWnd, engineInterface );
 
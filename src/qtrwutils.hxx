@@ -10,6 +10,26 @@ inline QImage convertRWBitmapToQImage( const rw::Bitmap& rasterBitmap )
 
 	QImage texImage(width, height, QImage::Format::Format_ARGB32);
 
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // Format_ARGB32 texels are stored as B, G, R, A bytes, so 32bit BGRA bitmaps can be copied row by row.
+    if ( rasterBitmap.getFormat() == rw::RASTER_8888 && rasterBitmap.getDepth() == 32 && rasterBitmap.getColorOrder() == rw::COLOR_BGRA )
+    {
+        const char *srcTexels = (const char*)rasterBitmap.getTexelsData();
+
+        rw::uint32 srcRowSize = rw::getRasterDataRowSize( width, 32, rasterBitmap.getRowAlignment() );
+
+        if ( srcTexels != NULL )
+        {
+            for ( rw::uint32 y = 0; y < height; y++ )
+            {
+                memcpy( texImage.scanLine( y ), srcTexels + (size_t)y * srcRowSize, width * 4 );
+            }
+        }
+
+        return texImage;
+    }
+#endif //Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+
 	// Copy scanline by scanline.
 	for (int y = 0; y < height; y++)
 	{
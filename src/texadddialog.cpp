@@ -871,11 +871,24 @@ void TexAddDialog::UpdatePreview() {
         try {
             int w, h;
             {
+                rw::uint32 rasterWidth, rasterHeight;
+                previewRaster->getSize(rasterWidth, rasterHeight);
+
+                w = rasterWidth, h = rasterHeight;
+
                 // Put the contents of the platform original into the preview widget.
-                // We want to transform the raster into a bitmap, basically.
-                QPixmap pixmap = convertRWBitmapToQPixmap( previewRaster->getBitmap() );
+                // The scaled preview never shows more than 300 pixels per side, so we only decode a thumbnail
+                // for it; the unscaled preview needs every texel of the base layer.
+                rw::Bitmap previewBitmap( this->mainWnd->GetEngine() );
+
+                if (scaledPreviewCheckBox->isChecked()) {
+                    rw::DecodeThumbnail( previewRaster, 300, previewBitmap );
+                }
+                else {
+                    previewBitmap = previewRaster->getBitmap();
+                }
 
-                w = pixmap.width(), h = pixmap.height();
+                QPixmap pixmap = convertRWBitmapToQPixmap( previewBitmap );
 
                 this->previewLabel->setPixmap(pixmap);
             }
@@ -1466,26 +1479,9 @@ void TexAddDialog::OnScalePreviewStateChanged(int state) {
     if (state == Qt::Unchecked && this->fillPreviewCheckBox->isChecked()) {
         this->fillPreviewCheckBox->setChecked(false);
     }
-    else {
-        rw::Raster *previewRaster = this->GetDisplayRaster();
-        if (previewRaster) {
-            rw::uint32 w, h;
-            previewRaster->getSize(w, h);
-            if (state == Qt::Unchecked) {
-                this->previewLabel->setFixedSize(w, h);
-                this->previewLabel->setScaledContents(false);
-            }
-            else {
-                int maxLen = w > h ? w : h;
-                if (maxLen > 300 || this->fillPreviewCheckBox->isChecked()) {
-                    float factor = 300.0f / maxLen;
-                    w = (float)w * factor;
-                    h = (float)h * factor;
-                }
-                this->previewLabel->setFixedSize(w, h);
-                this->previewLabel->setScaledContents(true);
-            }
-        }
+    // Scaled and unscaled previews are decoded at different resolutions.
+    if (this->GetDisplayRaster()) {
+        this->UpdatePreview();
     }
 }
 
@@ -1,35 +1,112 @@
 #include "mainwindow.h"
 
-#include <d3d9.h>
 #include <cwchar>
 #include <locale>
 
 #include "texformathelper.hxx"
 
+#include <QDir>
+
+#ifdef _WIN32
+#include <d3d9.h>
 #include <Windows.h>
+#else
+#include <QLibrary>
+#endif
 
 #ifndef _DEBUG
 #if defined(_M_AMD64)
-#define MAGF_FORMAT_DIR     L"formats_x64"
+#define MAGF_FORMAT_DIR     "formats_x64"
 #else
-#define MAGF_FORMAT_DIR     L"formats"
+#define MAGF_FORMAT_DIR     "formats"
 #endif
 #else
 #if defined(_M_AMD64)
-#define MAGF_FORMAT_DIR     L"formats_d_x64"
+#define MAGF_FORMAT_DIR     "formats_d_x64"
 #else
-#define MAGF_FORMAT_DIR     L"formats_d"
+#define MAGF_FORMAT_DIR     "formats_d"
 #endif
 #endif
 
-typedef void (__cdecl* LPFNSETINTERFACE)( const MagicFormatPluginInterface *intf );
-typedef MagicFormat* (__cdecl* LPFNDLLFUNC1)(unsigned int&);
+#ifdef _WIN32
+#define MAGF_CALL __cdecl
+#else
+#define MAGF_CALL
+#endif
+
+typedef void (MAGF_CALL* LPFNSETINTERFACE)( const MagicFormatPluginInterface *intf );
+typedef MagicFormat* (MAGF_CALL* LPFNDLLFUNC1)(unsigned int&);
+typedef unsigned int (MAGF_CALL* LPFNGETCAPS)( void );
+
+// Oldest plugin ABI that we can still drive.
+// Revisions only appended to the plugin interface since then.
+static const unsigned int MAGF_MIN_SUPPORTED_VERSION = 2;
+
+// Module handling of the plugins, so that the loading logic is the same everywhere.
+#ifdef _WIN32
+
+static void* magfLoadModule( const QString& path, QString& errorOut )
+{
+    HMODULE hDLL = LoadLibraryW( QDir::toNativeSeparators( path ).toStdWString().c_str() );
+
+    if ( hDLL == NULL )
+    {
+        errorOut = ansi_to_qt( std::to_string( GetLastError() ) );
+    }
+
+    return hDLL;
+}
+
+static void* magfGetModuleProc( void *module, const char *procName )
+{
+    return (void*)GetProcAddress( (HMODULE)module, procName );
+}
+
+static void magfFreeModule( void *module )
+{
+    FreeLibrary( (HMODULE)module );
+}
+
+#else
+
+static void* magfLoadModule( const QString& path, QString& errorOut )
+{
+    QLibrary *library = new QLibrary( path );
+
+    if ( library->load() == false )
+    {
+        errorOut = library->errorString();
+
+        delete library;
+
+        return NULL;
+    }
+
+    return library;
+}
+
+static void* magfGetModuleProc( void *module, const char *procName )
+{
+    return (void*)( (QLibrary*)module )->resolve( procName );
+}
+
+static void magfFreeModule( void *module )
+{
+    QLibrary *library = (QLibrary*)module;
+
+    library->unload();
+
+    delete library;
+}
+
+#endif
 
 struct MagicFormat_Ver1handler : public rw::d3dpublic::nativeTextureFormatHandler
 {
-    inline MagicFormat_Ver1handler( MagicFormat *handler )
+    inline MagicFormat_Ver1handler( MagicFormat *handler, unsigned int capabilities )
     {
         this->libHandler = handler;
+        this->capabilities = capabilities;
     }
 
     const char*     GetFormatName( void ) const override
@@ -89,8 +166,38 @@ struct MagicFormat_Ver1handler : public rw::d3dpublic::nativeTextureFormatHandle
         );
     }
 
+    bool IsTextureDataRWCompatible( void ) const override
+    {
+        return ( this->capabilities & MAGIC_FORMAT_CAPS_RW_LAYOUT ) != 0;
+    }
+
+    bool ConvertRowsToRW(
+        const void *texData, unsigned int texMipWidth, unsigned int texMipHeight, size_t dstRowStride, size_t texDataSize,
+        unsigned int firstRow, unsigned int rowCount,
+        void *texOut
+    ) const override
+    {
+        if ( ( this->capabilities & MAGIC_FORMAT_CAPS_ROW_BANDS ) == 0 )
+            return false;
+
+        // Present the band as a texture of its own.
+        size_t bandOffset = libHandler->GetFormatTextureDataSize( texMipWidth, firstRow );
+        size_t bandDataSize = libHandler->GetFormatTextureDataSize( texMipWidth, rowCount );
+
+        if ( bandOffset + bandDataSize > texDataSize )
+            return false;
+
+        libHandler->ConvertToRW(
+            (const char*)texData + bandOffset, texMipWidth, rowCount, dstRowStride, bandDataSize,
+            (char*)texOut + dstRowStride * firstRow
+        );
+
+        return true;
+    }
+
 private:
     MagicFormat *libHandler;
+    unsigned int capabilities;
 };
 
 static MagicFormatPluginExports _funcExportIntf;
@@ -103,10 +210,103 @@ void MainWindow::initializeNativeFormats( void )
 
     if ( driverIntf )
     {
-		WIN32_FIND_DATA FindFileData;
-		memset(&FindFileData, 0, sizeof(WIN32_FIND_DATA));
-        std::wstring magfpath = this->m_appPath.toStdWString();
-        std::wstring path = magfpath + L'\\' + MAGF_FORMAT_DIR + L'\\' + L"*.magf";
+        QString formatDir = this->m_appPath + QString( "/" ) + QString( MAGF_FORMAT_DIR ) + QString( "/" );
+
+        auto loadPlugin = [&]( const QString& pluginName )
+        {
+            QString errorMessage;
+
+            void *module = magfLoadModule( formatDir + pluginName, errorMessage );
+
+            if ( module == NULL )
+            {
+                QString message =
+                    QString( "Failed to load texture format plugin (" ) + pluginName + QString( ", " ) + errorMessage + QString( ")" );
+
+                this->txdLog->showError(message);
+                return;
+            }
+
+            bool success = false;
+
+            LPFNDLLFUNC1 func = (LPFNDLLFUNC1)magfGetModuleProc( module, "GetFormatInstance" );
+            LPFNSETINTERFACE intfFunc = (LPFNSETINTERFACE)magfGetModuleProc( module, "SetInterface" );
+
+            if (func && intfFunc)
+            {
+                unsigned int magf_version = 0;
+
+                MagicFormat *handler = func( magf_version );
+
+                // We must have a compatible ABI version to load.
+                if ( magf_version >= MAGF_MIN_SUPPORTED_VERSION && magf_version <= MagicFormatAPIVersion() )
+                {
+                    // Give it our module interface.
+                    intfFunc( &_funcExportIntf );
+
+                    // Fast paths are optional.
+                    unsigned int capabilities = 0;
+
+                    if ( magf_version >= 4 )
+                    {
+                        if ( LPFNGETCAPS capsFunc = (LPFNGETCAPS)magfGetModuleProc( module, "GetFormatCapabilities" ) )
+                        {
+                            capabilities = capsFunc();
+                        }
+                    }
+
+                    MagicFormat_Ver1handler *vhandler = new MagicFormat_Ver1handler( handler, capabilities );
+
+                    bool hasRegistered = driverIntf->RegisterFormatHandler(handler->GetD3DFormat(), vhandler);
+
+                    if ( hasRegistered )
+                    {
+                        magf_extension reg_entry;
+                        reg_entry.d3dformat = handler->GetD3DFormat();
+                        reg_entry.loadedLibrary = module;
+                        reg_entry.handler = vhandler;
+
+                        this->magf_formats.push_back( reg_entry );
+
+                        success = true;
+
+                        QString message =
+                            QString( "Loaded plugin " ) + pluginName +
+                            QString( " (" ) + handler->GetFormatName() + QString( ")" );
+
+                        this->txdLog->addLogMessage(message, LOGMSG_INFO);
+                    }
+                    else
+                    {
+                        delete vhandler;
+                    }
+                }
+                else
+                {
+                    QString message =
+                        QString( "Texture format plugin (" ) + pluginName + QString( ") is incorrect version" );
+
+                    this->txdLog->showError(message);
+                }
+            }
+            else
+            {
+                QString message =
+                    QString( "Texture format plugin (" ) + pluginName + QString( ") is corrupted" );
+
+                this->txdLog->showError(message);
+            }
+
+            if ( success == false )
+            {
+                magfFreeModule( module );
+            }
+        };
+
+#ifdef _WIN32
+		WIN32_FIND_DATAW FindFileData;
+		memset(&FindFileData, 0, sizeof(FindFileData));
+        std::wstring path = QDir::toNativeSeparators( formatDir ).toStdWString() + L"*.magf";
 		HANDLE hFind = FindFirstFileW(path.c_str(), &FindFileData);
 		if (hFind != INVALID_HANDLE_VALUE)
 		{
@@ -114,87 +314,19 @@ void MainWindow::initializeNativeFormats( void )
 			{
 				if (!(FindFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
 				{
-                    std::wstring wPluginName = FindFileData.cFileName;
-                    std::wstring filename = magfpath + L'\\' + MAGF_FORMAT_DIR + L'\\' + FindFileData.cFileName;
-					HMODULE hDLL = LoadLibraryW(filename.c_str());
-					if (hDLL != NULL)
-					{
-                        bool success = false;
-
-						LPFNDLLFUNC1 func = (LPFNDLLFUNC1)GetProcAddress(hDLL, "GetFormatInstance");
-                        LPFNSETINTERFACE intfFunc = (LPFNSETINTERFACE)GetProcAddress( hDLL, "SetInterface" );
-						if (func && intfFunc)
-						{
-                            unsigned int magf_version = 0;
-
-							MagicFormat *handler = func( magf_version );
-
-                            // We must have correct ABI version to load.
-                            if ( magf_version == MagicFormatAPIVersion() )
-                            {
-                                // Give it our module interface.
-                                intfFunc( &_funcExportIntf );
-
-                                MagicFormat_Ver1handler *vhandler = new MagicFormat_Ver1handler( handler );
-
-							    bool hasRegistered = driverIntf->RegisterFormatHandler(handler->GetD3DFormat(), vhandler);
-
-                                if ( hasRegistered )
-                                {
-                                    magf_extension reg_entry;
-                                    reg_entry.d3dformat = handler->GetD3DFormat();
-                                    reg_entry.loadedLibrary = hDLL;
-                                    reg_entry.handler = vhandler;
-
-                                    this->magf_formats.push_back( reg_entry );
-
-                                    success = true;
-                                    
-                                    QString message =
-                                        QString( "Loaded plugin " ) + QString::fromStdWString( wPluginName ) +
-                                        QString( " (" ) + handler->GetFormatName() + QString( ")" );
-
-							        this->txdLog->addLogMessage(message, LOGMSG_INFO);
-                                }
-                                else
-                                {
-                                    delete vhandler;
-                                }
-                            }
-                            else
-                            {
-                                QString message =
-                                    QString( "Texture format plugin (" ) + QString::fromStdWString( wPluginName ) + QString( ") is incorrect version" );
-
-							    this->txdLog->showError(message);
-                            }
-						}
-						else
-						{
-                            QString message =
-                                QString( "Texture format plugin (" ) + QString::fromStdWString( wPluginName ) + QString( ") is corrupted" );
-
-							this->txdLog->showError(message);
-						}
-
-                        if ( success == false )
-                        {
-                            FreeLibrary( hDLL );
-                        }
-					}
-					else
-					{
-                        DWORD lastError = GetLastError();
-
-                        QString message =
-                            QString( "Failed to load texture format plugin (" ) + QString::fromStdWString( wPluginName ) + QString( ", " ) + ansi_to_qt( std::to_string( lastError ) ) + QString( ")" );
-
-						this->txdLog->showError(message);
-					}
+                    loadPlugin( QString::fromWCharArray( FindFileData.cFileName ) );
 				}
-			} while (FindNextFile(hFind, &FindFileData));
+			} while (FindNextFileW(hFind, &FindFileData));
 			FindClose(hFind);
 		}
+#else
+        QStringList pluginNames = QDir( formatDir ).entryList( QStringList( "*.magf" ), QDir::Files );
+
+        for ( const QString& pluginName : pluginNames )
+        {
+            loadPlugin( pluginName );
+        }
+#endif
     }
 }
 
@@ -220,7 +352,7 @@ void MainWindow::shutdownNativeFormats( void )
             }
 
             // Unload the library.
-            FreeLibrary( (HMODULE)ext.loadedLibrary );
+            magfFreeModule( ext.loadedLibrary );
         }
 
         // Clear the list of resident formats.
@@ -12,7 +12,7 @@ inline void MagicMapToInternalRasterFormat( MAGIC_RASTER_FORMAT formatIn, rw::eR
     }
     else if ( formatIn == MAGIC_RASTER_FORMAT::RASTER_565 )
     {
-        formatOut = rw::RASTER_4444;
+        formatOut = rw::RASTER_565;
     }
     else if ( formatIn == MAGIC_RASTER_FORMAT::RASTER_4444 )
     {
@@ -34,6 +34,10 @@ inline void MagicMapToInternalRasterFormat( MAGIC_RASTER_FORMAT formatIn, rw::eR
     {
         formatOut = rw::RASTER_555;
     }
+    else if ( formatIn == MAGIC_RASTER_FORMAT::RASTER_LUM_ALPHA )
+    {
+        formatOut = rw::RASTER_LUM_ALPHA;
+    }
     else
     {
         formatOut = rw::RASTER_DEFAULT;
@@ -118,6 +122,10 @@ inline void MagicMapToVirtualRasterFormat( rw::eRasterFormat formatIn, MAGIC_RAS
     {
         formatOut = MAGIC_RASTER_FORMAT::RASTER_555;
     }
+    else if ( formatIn == rw::RASTER_LUM_ALPHA )
+    {
+        formatOut = MAGIC_RASTER_FORMAT::RASTER_LUM_ALPHA;
+    }
     else
     {
         formatOut = MAGIC_RASTER_FORMAT::RASTER_DEFAULT;
@@ -0,0 +1,473 @@
+// Background decoding of texture previews, with a LRU cache of decoded mipmap layers.
+
+#include "mainwindow.h"
+#include "texturepreview.h"
+
+#include "qtrwutils.hxx"
+
+#include <sdk/PluginHelpers.h>
+
+#include <QCoreApplication>
+#include <QEvent>
+
+#include <mutex>
+#include <condition_variable>
+
+// Amount of decoded texel memory that we keep around for quick re-display.
+#define TEXPREVIEW_CACHE_BUDGET     ( 64 * 1024 * 1024 )
+
+// Returns the smallest mipmap layer that still covers the size the texture is shown at.
+static rw::uint32 GetPreviewMipmapLevel( rw::uint32 baseWidth, rw::uint32 baseHeight, rw::uint32 mipmapCount, rw::uint32 viewWidth, rw::uint32 viewHeight )
+{
+    if ( viewWidth == 0 || viewHeight == 0 || baseWidth == 0 || baseHeight == 0 )
+        return 0;
+
+    double scaleFactor = std::min( (double)viewWidth / baseWidth, (double)viewHeight / baseHeight );
+
+    if ( scaleFactor >= 1.0 )
+        return 0;
+
+    rw::uint32 shownWidth = (rw::uint32)ceil( baseWidth * scaleFactor );
+    rw::uint32 shownHeight = (rw::uint32)ceil( baseHeight * scaleFactor );
+
+    rw::uint32 mipIndex = 0;
+
+    while ( mipIndex + 1 < mipmapCount )
+    {
+        rw::uint32 nextWidth = std::max( 1u, baseWidth >> ( mipIndex + 1 ) );
+        rw::uint32 nextHeight = std::max( 1u, baseHeight >> ( mipIndex + 1 ) );
+
+        if ( nextWidth < shownWidth || nextHeight < shownHeight )
+            break;
+
+        mipIndex++;
+    }
+
+    return mipIndex;
+}
+
+struct texturePreviewEnv
+{
+    // A decoding job; holds a reference to the raster.
+    struct previewJob
+    {
+        rw::Raster *raster;
+        rw::uint32 revision;
+        rw::uint32 mipIndex;
+        bool drawMipmapLayers;
+        unsigned int serial;
+    };
+
+    struct previewCacheEntry
+    {
+        previewJob key;             // the serial is meaningless here
+        QImage image;
+        rw::uint32 logicalWidth, logicalHeight;
+    };
+
+    struct preview_result_event : public QEvent
+    {
+        inline preview_result_event( void ) : QEvent( QEvent::User )
+        {
+            this->logicalWidth = 0;
+            this->logicalHeight = 0;
+            this->hasFailed = false;
+        }
+
+        previewJob job;
+        QImage image;
+        rw::uint32 logicalWidth, logicalHeight;
+
+        bool hasFailed;
+        QString errorMessage;
+    };
+
+    // Receives the worker results on the UI thread.
+    struct resultReceiver : public QObject
+    {
+        inline resultReceiver( texturePreviewEnv *env )
+        {
+            this->env = env;
+        }
+
+        void customEvent( QEvent *evt ) override
+        {
+            if ( preview_result_event *resultEvt = dynamic_cast <preview_result_event*> ( evt ) )
+            {
+                env->OnPreviewResult( *resultEvt );
+            }
+        }
+
+        texturePreviewEnv *env;
+    };
+
+    inline void Initialize( MainWindow *mainWnd )
+    {
+        rw::Interface *rwEngine = mainWnd->GetEngine();
+
+        this->mainWnd = mainWnd;
+        this->receiver = new resultReceiver( this );
+
+        this->hasPendingJob = false;
+        this->isTerminating = false;
+        this->currentSerial = 0;
+        this->hasQueuedJob = false;
+        this->cacheSize = 0;
+
+        this->workerThread = rw::MakeThread( rwEngine, worker_runtime, this );
+
+        rw::ResumeThread( rwEngine, this->workerThread );
+    }
+
+    inline void Shutdown( MainWindow *mainWnd )
+    {
+        rw::Interface *rwEngine = mainWnd->GetEngine();
+
+        {
+            std::unique_lock <std::mutex> jobLock( this->jobMutex );
+
+            this->isTerminating = true;
+        }
+
+        this->jobCond.notify_all();
+
+        rw::JoinThread( rwEngine, this->workerThread );
+        rw::CloseThread( rwEngine, this->workerThread );
+
+        // Results that are still in the queue carry raster references.
+        QCoreApplication::sendPostedEvents( this->receiver, QEvent::User );
+
+        delete this->receiver;
+
+        if ( this->hasPendingJob )
+        {
+            rw::DeleteRaster( this->pendingJob.raster );
+
+            this->hasPendingJob = false;
+        }
+
+        this->Purge();
+    }
+
+    static void worker_runtime( rw::thread_t handle, rw::Interface *engineInterface, void *ud )
+    {
+        texturePreviewEnv *env = (texturePreviewEnv*)ud;
+
+        while ( true )
+        {
+            previewJob job;
+            {
+                std::unique_lock <std::mutex> jobLock( env->jobMutex );
+
+                env->jobCond.wait( jobLock, [&] { return ( env->hasPendingJob || env->isTerminating ); } );
+
+                if ( env->isTerminating )
+                    break;
+
+                job = env->pendingJob;
+
+                env->hasPendingJob = false;
+            }
+
+            preview_result_event *resultEvt = new preview_result_event();
+
+            resultEvt->job = job;
+
+            try
+            {
+                rw::Raster *raster = job.raster;
+
+                if ( job.drawMipmapLayers )
+                {
+                    rw::Bitmap rasterBitmap( engineInterface, 32, rw::RASTER_8888, rw::COLOR_BGRA );
+
+                    rasterBitmap.setBgColor( 1.0, 1.0, 1.0, 0.0 );
+
+                    rw::DebugDrawMipmaps( engineInterface, raster, rasterBitmap );
+
+                    rasterBitmap.getSize( resultEvt->logicalWidth, resultEvt->logicalHeight );
+
+                    resultEvt->image = convertRWBitmapToQImage( rasterBitmap );
+                }
+                else
+                {
+                    raster->getSize( resultEvt->logicalWidth, resultEvt->logicalHeight );
+
+                    resultEvt->image = convertRWBitmapToQImage( raster->getMipmapBitmap( job.mipIndex ) );
+                }
+            }
+            catch( rw::RwException& except )
+            {
+                resultEvt->hasFailed = true;
+                resultEvt->errorMessage = except.message.c_str();
+            }
+
+            // The event takes over the raster reference.
+            QCoreApplication::postEvent( env->receiver, resultEvt );
+        }
+    }
+
+    inline static bool IsSameKey( const previewJob& left, const previewJob& right )
+    {
+        return ( left.raster == right.raster && left.revision == right.revision &&
+                 left.mipIndex == right.mipIndex && left.drawMipmapLayers == right.drawMipmapLayers );
+    }
+
+    inline static size_t GetImageSize( const QImage& image )
+    {
+        return ( (size_t)image.bytesPerLine() * image.height() );
+    }
+
+    inline void RemoveEntry( std::list <previewCacheEntry>::iterator iter )
+    {
+        this->cacheSize -= GetImageSize( iter->image );
+
+        rw::DeleteRaster( iter->key.raster );
+
+        this->cache.erase( iter );
+    }
+
+    void Purge( void )
+    {
+        while ( !this->cache.empty() )
+        {
+            this->RemoveEntry( this->cache.begin() );
+        }
+    }
+
+    void CachePreview( const previewJob& key, QImage image, rw::uint32 logicalWidth, rw::uint32 logicalHeight )
+    {
+        // Previews of older raster revisions can never be requested again.
+        for ( auto iter = this->cache.begin(); iter != this->cache.end(); )
+        {
+            auto curIter = iter++;
+
+            if ( curIter->key.raster == key.raster && curIter->key.revision != key.revision )
+            {
+                this->RemoveEntry( curIter );
+            }
+        }
+
+        previewCacheEntry entry;
+        entry.key = key;
+        entry.image = std::move( image );
+        entry.logicalWidth = logicalWidth;
+        entry.logicalHeight = logicalHeight;
+
+        this->cacheSize += GetImageSize( entry.image );
+
+        this->cache.push_front( std::move( entry ) );
+
+        // Evict the least recently used previews, but always keep the one we just added.
+        while ( this->cacheSize > TEXPREVIEW_CACHE_BUDGET && this->cache.size() > 1 )
+        {
+            this->RemoveEntry( std::prev( this->cache.end() ) );
+        }
+    }
+
+    void OnPreviewResult( preview_result_event& resultEvt )
+    {
+        const previewJob& job = resultEvt.job;
+
+        rw::Raster *raster = job.raster;
+
+        bool isCurrent = ( job.serial == this->currentSerial && !this->isTerminating );
+
+        if ( isCurrent )
+        {
+            this->hasQueuedJob = false;
+        }
+
+        if ( resultEvt.hasFailed )
+        {
+            rw::DeleteRaster( raster );
+
+            if ( isCurrent )
+            {
+                this->mainWnd->presentTexturePreviewError( resultEvt.errorMessage );
+            }
+            return;
+        }
+
+        // If the raster was changed while we were decoding, then a newer request is on its way.
+        if ( this->isTerminating || raster->getRevision() != job.revision )
+        {
+            rw::DeleteRaster( raster );
+            return;
+        }
+
+        QImage image = std::move( resultEvt.image );
+
+        // The cache keeps the raster reference.
+        this->CachePreview( job, image, resultEvt.logicalWidth, resultEvt.logicalHeight );
+
+        if ( isCurrent )
+        {
+            this->mainWnd->presentTexturePreview( raster, image, resultEvt.logicalWidth, resultEvt.logicalHeight, job.mipIndex );
+        }
+    }
+
+    void Request( rw::Raster *raster, rw::uint32 viewWidth, rw::uint32 viewHeight, bool drawMipmapLayers )
+    {
+        previewJob job;
+        job.raster = raster;
+        job.revision = raster->getRevision();
+        job.mipIndex = 0;
+        job.drawMipmapLayers = false;
+        job.serial = 0;
+
+        rw::uint32 mipmapCount = raster->getMipmapCount();
+
+        if ( drawMipmapLayers && mipmapCount > 1 )
+        {
+            job.drawMipmapLayers = true;
+        }
+        else if ( mipmapCount > 1 )
+        {
+            rw::uint32 baseWidth, baseHeight;
+            raster->getSize( baseWidth, baseHeight );
+
+            job.mipIndex = GetPreviewMipmapLevel( baseWidth, baseHeight, mipmapCount, viewWidth, viewHeight );
+        }
+
+        // Any cached layer that is at least as detailed will do.
+        auto bestIter = this->cache.end();
+
+        for ( auto iter = this->cache.begin(); iter != this->cache.end(); iter++ )
+        {
+            const previewJob& key = iter->key;
+
+            if ( key.raster == raster && key.revision == job.revision && key.drawMipmapLayers == job.drawMipmapLayers && key.mipIndex <= job.mipIndex )
+            {
+                if ( bestIter == this->cache.end() || key.mipIndex > bestIter->key.mipIndex )
+                {
+                    bestIter = iter;
+                }
+            }
+        }
+
+        if ( bestIter != this->cache.end() )
+        {
+            this->Cancel();
+
+            // Mark as most recently used.
+            this->cache.splice( this->cache.begin(), this->cache, bestIter );
+
+            const previewCacheEntry& entry = this->cache.front();
+
+            this->mainWnd->presentTexturePreview( raster, entry.image, entry.logicalWidth, entry.logicalHeight, entry.key.mipIndex );
+            return;
+        }
+
+        // Resizing the viewport asks for the same preview many times.
+        if ( this->hasQueuedJob && IsSameKey( this->queuedJob, job ) )
+            return;
+
+        job.serial = ++this->currentSerial;
+
+        this->queuedJob = job;
+        this->hasQueuedJob = true;
+
+        // Hand it to the worker, replacing any job that it has not started yet.
+        job.raster = rw::AcquireRaster( raster );
+
+        rw::Raster *replacedRaster = NULL;
+        {
+            std::unique_lock <std::mutex> jobLock( this->jobMutex );
+
+            if ( this->hasPendingJob )
+            {
+                replacedRaster = this->pendingJob.raster;
+            }
+
+            this->pendingJob = job;
+            this->hasPendingJob = true;
+        }
+
+        this->jobCond.notify_one();
+
+        if ( replacedRaster )
+        {
+            rw::DeleteRaster( replacedRaster );
+        }
+    }
+
+    void DropPendingJob( void )
+    {
+        rw::Raster *droppedRaster = NULL;
+        {
+            std::unique_lock <std::mutex> jobLock( this->jobMutex );
+
+            if ( this->hasPendingJob )
+            {
+                droppedRaster = this->pendingJob.raster;
+
+                this->hasPendingJob = false;
+            }
+        }
+
+        if ( droppedRaster )
+        {
+            rw::DeleteRaster( droppedRaster );
+        }
+    }
+
+    void Cancel( void )
+    {
+        // Results of jobs in flight are ignored after this.
+        this->currentSerial++;
+        this->hasQueuedJob = false;
+
+        this->DropPendingJob();
+    }
+
+    MainWindow *mainWnd;
+    resultReceiver *receiver;
+
+    rw::thread_t workerThread;
+
+    std::mutex jobMutex;
+    std::condition_variable jobCond;
+    previewJob pendingJob;
+    bool hasPendingJob;
+    bool isTerminating;
+
+    // Only accessed on the UI thread.
+    unsigned int currentSerial;
+    previewJob queuedJob;           // latest job that was handed to the worker
+    bool hasQueuedJob;
+
+    std::list <previewCacheEntry> cache;    // most recently used first
+    size_t cacheSize;
+};
+
+static PluginDependantStructRegister <texturePreviewEnv, mainWindowFactory_t> texturePreviewEnvRegister;
+
+void RequestTexturePreview( MainWindow *mainWnd, rw::Raster *raster, rw::uint32 viewWidth, rw::uint32 viewHeight, bool drawMipmapLayers )
+{
+    if ( texturePreviewEnv *env = texturePreviewEnvRegister.GetPluginStruct( mainWnd ) )
+    {
+        env->Request( raster, viewWidth, viewHeight, drawMipmapLayers );
+    }
+}
+
+void CancelTexturePreview( MainWindow *mainWnd )
+{
+    if ( texturePreviewEnv *env = texturePreviewEnvRegister.GetPluginStruct( mainWnd ) )
+    {
+        env->Cancel();
+    }
+}
+
+void PurgeTexturePreviewCache( MainWindow *mainWnd )
+{
+    if ( texturePreviewEnv *env = texturePreviewEnvRegister.GetPluginStruct( mainWnd ) )
+    {
+        env->Purge();
+    }
+}
+
+void InitializeTexturePreviewEnv( void )
+{
+    texturePreviewEnvRegister.RegisterPlugin( mainWindowFactory );
+}
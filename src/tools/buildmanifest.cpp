@@ -0,0 +1,229 @@
+#include "mainwindow.h"
+
+#include "buildmanifest.h"
+
+#define BUILDMANIFEST_MAGIC         "txdbuild_manifest 1"
+
+// The manifest is a text file of tab separated records, so the values must not contain those characters.
+static std::string SanitizeManifestField( const std::string& value )
+{
+    std::string result = value;
+
+    for ( char& curChar : result )
+    {
+        if ( curChar == '\t' || curChar == '\n' || curChar == '\r' )
+        {
+            curChar = ' ';
+        }
+    }
+
+    return result;
+}
+
+static std::vector <std::string> SplitManifestLine( const std::string& line )
+{
+    std::vector <std::string> fields;
+
+    size_t fieldStart = 0;
+
+    while ( true )
+    {
+        size_t fieldEnd = line.find( '\t', fieldStart );
+
+        if ( fieldEnd == std::string::npos )
+        {
+            fields.push_back( line.substr( fieldStart ) );
+            break;
+        }
+
+        fields.push_back( line.substr( fieldStart, fieldEnd - fieldStart ) );
+
+        fieldStart = fieldEnd + 1;
+    }
+
+    return fields;
+}
+
+const buildManifestSource* buildManifestEntry::FindSource( const std::string& path ) const
+{
+    for ( const buildManifestSource& source : this->sources )
+    {
+        if ( source.path == path )
+        {
+            return &source;
+        }
+    }
+
+    return NULL;
+}
+
+bool buildManifestEntry::isSameBuild( const buildManifestEntry& right ) const
+{
+    if ( this->configFingerprint != right.configFingerprint )
+        return false;
+
+    size_t sourceCount = this->sources.size();
+
+    if ( sourceCount != right.sources.size() )
+        return false;
+
+    for ( size_t n = 0; n < sourceCount; n++ )
+    {
+        if ( this->sources[ n ].isSameBuild( right.sources[ n ] ) == false )
+            return false;
+    }
+
+    return true;
+}
+
+void BuildManifest::Load( CFileTranslator *root, const char *fileName, const std::string& settingsFingerprint )
+{
+    this->settingsFingerprint = settingsFingerprint;
+    this->entries.clear();
+
+    CFile *manifestStream = root->Open( fileName, "rb" );
+
+    if ( !manifestStream )
+        return;
+
+    std::string manifestData;
+    manifestData.resize( manifestStream->GetSize() );
+
+    size_t readCount = manifestStream->Read( (char*)manifestData.data(), 1, manifestData.size() );
+
+    delete manifestStream;
+
+    manifestData.resize( readCount );
+
+    buildManifestEntry *curEntry = NULL;
+
+    size_t lineStart = 0;
+    bool isFirstLine = true;
+
+    while ( lineStart < manifestData.size() )
+    {
+        size_t lineEnd = manifestData.find( '\n', lineStart );
+
+        if ( lineEnd == std::string::npos )
+        {
+            lineEnd = manifestData.size();
+        }
+
+        std::string line = manifestData.substr( lineStart, lineEnd - lineStart );
+
+        lineStart = lineEnd + 1;
+
+        if ( isFirstLine )
+        {
+            // Unknown format, start from scratch.
+            if ( line != BUILDMANIFEST_MAGIC )
+                break;
+
+            isFirstLine = false;
+            continue;
+        }
+
+        std::vector <std::string> fields = SplitManifestLine( line );
+
+        if ( fields[ 0 ] == "settings" && fields.size() == 2 )
+        {
+            // Everything was built differently, so nothing can be trusted.
+            if ( fields[ 1 ] != settingsFingerprint )
+                break;
+        }
+        else if ( fields[ 0 ] == "txd" && fields.size() == 3 )
+        {
+            curEntry = &this->entries[ fields[ 1 ] ];
+            curEntry->configFingerprint = fields[ 2 ];
+        }
+        else if ( fields[ 0 ] == "src" && fields.size() == 6 && curEntry != NULL )
+        {
+            buildManifestSource source;
+            source.path = fields[ 1 ];
+            source.fileSize = strtoull( fields[ 2 ].c_str(), NULL, 10 );
+            source.modTime = strtoll( fields[ 3 ].c_str(), NULL, 10 );
+            source.contentHash = fields[ 4 ];
+            source.configFingerprint = fields[ 5 ];
+
+            curEntry->sources.push_back( std::move( source ) );
+        }
+    }
+
+    // A manifest that does not state its settings is not usable.
+    if ( isFirstLine )
+    {
+        this->entries.clear();
+    }
+}
+
+bool BuildManifest::Save( CFileTranslator *root, const char *fileName ) const
+{
+    CFile *manifestStream = root->Open( fileName, "wb" );
+
+    if ( !manifestStream )
+        return false;
+
+    std::string manifestData = BUILDMANIFEST_MAGIC "\n";
+
+    manifestData += "settings\t" + SanitizeManifestField( this->settingsFingerprint ) + "\n";
+
+    for ( const auto& entryPair : this->entries )
+    {
+        const buildManifestEntry& entry = entryPair.second;
+
+        manifestData += "txd\t" + SanitizeManifestField( entryPair.first ) + "\t" + SanitizeManifestField( entry.configFingerprint ) + "\n";
+
+        for ( const buildManifestSource& source : entry.sources )
+        {
+            manifestData +=
+                "src\t" + SanitizeManifestField( source.path ) +
+                "\t" + std::to_string( source.fileSize ) +
+                "\t" + std::to_string( source.modTime ) +
+                "\t" + source.contentHash +
+                "\t" + SanitizeManifestField( source.configFingerprint ) + "\n";
+        }
+    }
+
+    manifestStream->Write( manifestData.data(), 1, manifestData.size() );
+
+    delete manifestStream;
+
+    return true;
+}
+
+const buildManifestEntry* BuildManifest::FindEntry( const std::string& txdPath ) const
+{
+    auto iter = this->entries.find( txdPath );
+
+    if ( iter == this->entries.end() )
+        return NULL;
+
+    return &iter->second;
+}
+
+void BuildManifest::SetEntry( const std::string& txdPath, buildManifestEntry entry )
+{
+    this->entries[ txdPath ] = std::move( entry );
+}
+
+void BuildManifest::RemoveEntry( const std::string& txdPath )
+{
+    this->entries.erase( txdPath );
+}
+
+void BuildManifest::KeepOnly( const std::set <std::string>& txdPaths )
+{
+    auto iter = this->entries.begin();
+
+    while ( iter != this->entries.end() )
+    {
+        if ( txdPaths.find( iter->first ) == txdPaths.end() )
+        {
+            iter = this->entries.erase( iter );
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+// Build manifest of the TXD builder.
+// Remembers for every built TXD which source images and settings went into it, so that a
+// later run only has to rebuild the TXDs (and textures) whose inputs have changed.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+struct buildManifestSource
+{
+    std::string path;               // relative to the source root, UTF-8
+    rw::uint64 fileSize = 0;
+    rw::int64 modTime = 0;
+    std::string contentHash;
+    std::string configFingerprint;  // effective configuration of the texture
+
+    // Two sources produce the same texture if their contents and configuration match.
+    inline bool isSameBuild( const buildManifestSource& right ) const
+    {
+        return ( this->path == right.path && this->contentHash == right.contentHash && this->configFingerprint == right.configFingerprint );
+    }
+};
+
+struct buildManifestEntry
+{
+    std::string configFingerprint;  // effective configuration of the TXD
+    std::vector <buildManifestSource> sources;
+
+    const buildManifestSource* FindSource( const std::string& path ) const;
+
+    // True if a TXD built from the other entry would turn out the same.
+    bool isSameBuild( const buildManifestEntry& right ) const;
+};
+
+class BuildManifest
+{
+public:
+    // Loads the manifest from disk. All records are dropped if they were built
+    // with other global settings.
+    void Load( CFileTranslator *root, const char *fileName, const std::string& settingsFingerprint );
+    bool Save( CFileTranslator *root, const char *fileName ) const;
+
+    const buildManifestEntry* FindEntry( const std::string& txdPath ) const;
+    void SetEntry( const std::string& txdPath, buildManifestEntry entry );
+    void RemoveEntry( const std::string& txdPath );
+
+    // Forgets about all TXDs that are not part of the build anymore.
+    void KeepOnly( const std::set <std::string>& txdPaths );
+
+private:
+    std::string settingsFingerprint;
+
+    std::map <std::string, buildManifestEntry> entries;
+};
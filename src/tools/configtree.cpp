@@ -2,6 +2,8 @@
 
 #include "configtree.h"
 
+#include <set>
+
 void ConfigNode::SetString( std::string key, std::string value )
 {
     configValueType data;
@@ -218,4 +220,35 @@ bool ConfigNode::GetBoolean( const std::string& key, bool& valueOut ) const
     }
 
     return false;
+}
+
+std::string ConfigNode::GetFingerprint( void ) const
+{
+    // Collect the keys of the entire chain; values of children override parent values.
+    std::set <std::string> keys;
+
+    for ( const ConfigNode *curNode = this; curNode != NULL; curNode = curNode->parent )
+    {
+        for ( const auto& valuePair : curNode->values )
+        {
+            keys.insert( valuePair.first );
+        }
+    }
+
+    std::string fingerprint;
+
+    for ( const std::string& key : keys )
+    {
+        std::string value;
+
+        if ( this->GetString( key, value ) )
+        {
+            fingerprint += key;
+            fingerprint += '=';
+            fingerprint += value;
+            fingerprint += ';';
+        }
+    }
+
+    return fingerprint;
 }
\ No newline at end of file
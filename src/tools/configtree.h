@@ -27,6 +27,10 @@ struct ConfigNode
     bool GetFloat( const std::string& key, double& valueOut ) const;
     bool GetBoolean( const std::string& key, bool& valueOut ) const;
 
+    // Returns all effective values (including inherited ones) as one string.
+    // Two nodes with the same fingerprint configure things the same way.
+    std::string GetFingerprint( void ) const;
+
     void SetParent( const ConfigNode *parent )
     {
         this->parent = parent;
@@ -0,0 +1,514 @@
+#include "mainwindow.h"
+
+#include "convcache.h"
+
+#include <algorithm>
+
+// Name of the file that keeps sizes and usage order of all cache entries.
+#define CONVCACHE_INDEX_FILE        "cache.idx"
+#define CONVCACHE_INDEX_MAGIC       "txdgen_cache 2"
+
+// Entry files are named by their key; warnings of the conversion are kept next to the result.
+#define CONVCACHE_KEY_LENGTH        32
+#define CONVCACHE_RESULT_EXT        ".txd"
+#define CONVCACHE_WARNINGS_EXT      ".wrn"
+#define CONVCACHE_TEMP_EXT          ".tmp"
+
+std::string convCacheKey::toString( void ) const
+{
+    char buf[ 33 ];
+
+    snprintf( buf, sizeof( buf ), "%016llx%016llx", (unsigned long long)this->hashHigh, (unsigned long long)this->hashLow );
+
+    return buf;
+}
+
+void convCacheHasher::feedStream( CFile *stream )
+{
+    char buffer[ 65536 ];
+
+    while ( true )
+    {
+        size_t readCount = stream->Read( buffer, 1, sizeof( buffer ) );
+
+        if ( readCount == 0 )
+            break;
+
+        this->feed( buffer, readCount );
+    }
+}
+
+convCacheKey convCacheHasher::finish( void ) const
+{
+    convCacheKey key;
+
+    contentHasher::finish( key.hashLow, key.hashHigh );
+
+    return key;
+}
+
+ConversionCache::ConversionCache( CFileTranslator *cacheRoot, rw::uint64 maxCacheSize )
+{
+    this->cacheRoot = cacheRoot;
+    this->maxCacheSize = maxCacheSize;
+    this->cacheSize = 0;
+    this->useCounter = 0;
+    this->hitCount = 0;
+    this->missCount = 0;
+    this->evictionCount = 0;
+
+    this->LoadIndex();
+}
+
+ConversionCache::~ConversionCache( void )
+{
+    this->Save();
+}
+
+// The cache directory is configurable, so we only ever delete files that the cache has created itself.
+static bool IsCacheEntryFileName( const filePath& fileName, const filePath& extention )
+{
+    if ( !extention.equals( "txd", false ) && !extention.equals( "wrn", false ) && !extention.equals( "tmp", false ) )
+        return false;
+
+    std::string fileNameANSI = fileName.convert_ansi();
+
+    if ( fileNameANSI.size() != CONVCACHE_KEY_LENGTH )
+        return false;
+
+    for ( char c : fileNameANSI )
+    {
+        if ( !( c >= '0' && c <= '9' || c >= 'a' && c <= 'f' ) )
+            return false;
+    }
+
+    return true;
+}
+
+void ConversionCache::LoadIndex( void )
+{
+    CFile *indexStream = this->cacheRoot->Open( CONVCACHE_INDEX_FILE, "rb" );
+
+    if ( indexStream )
+    {
+        std::string indexData;
+        indexData.resize( indexStream->GetSize() );
+
+        size_t readCount = indexStream->Read( (char*)indexData.data(), 1, indexData.size() );
+
+        delete indexStream;
+
+        indexData.resize( readCount );
+
+        size_t lineStart = 0;
+        bool isFirstLine = true;
+
+        while ( lineStart < indexData.size() )
+        {
+            size_t lineEnd = indexData.find( '\n', lineStart );
+
+            if ( lineEnd == std::string::npos )
+            {
+                lineEnd = indexData.size();
+            }
+
+            std::string line = indexData.substr( lineStart, lineEnd - lineStart );
+
+            lineStart = lineEnd + 1;
+
+            if ( isFirstLine )
+            {
+                // Drop caches of another format.
+                if ( line.compare( 0, strlen( CONVCACHE_INDEX_MAGIC ), CONVCACHE_INDEX_MAGIC ) != 0 )
+                    break;
+
+                unsigned long long useCounter = 0;
+
+                sscanf( line.c_str() + strlen( CONVCACHE_INDEX_MAGIC ), "%llu", &useCounter );
+
+                this->useCounter = useCounter;
+
+                isFirstLine = false;
+                continue;
+            }
+
+            char keyString[ 33 ];
+            unsigned long long dataSize, lastUse;
+
+            if ( sscanf( line.c_str(), "%32s %llu %llu", keyString, &dataSize, &lastUse ) != 3 )
+                continue;
+
+            std::string entryFileName = std::string( keyString ) + CONVCACHE_RESULT_EXT;
+
+            // Entries can be deleted behind our back.
+            if ( this->cacheRoot->Exists( entryFileName.c_str() ) == false )
+                continue;
+
+            cacheEntry entry;
+            entry.dataSize = dataSize;
+            entry.lastUse = lastUse;
+
+            this->entries[ keyString ] = entry;
+
+            this->cacheSize += dataSize;
+        }
+    }
+
+    // Remove entry files that are not tracked by the index, like left-overs of aborted runs.
+    std::vector <filePath> cacheFiles;
+
+    this->cacheRoot->GetFiles( "@", "*", false, cacheFiles );
+
+    for ( const filePath& cacheFilePath : cacheFiles )
+    {
+        filePath extention;
+
+        filePath fileName = FileSystem::GetFileNameItem( cacheFilePath.c_str(), false, NULL, &extention );
+
+        if ( IsCacheEntryFileName( fileName, extention ) == false )
+            continue;
+
+        if ( extention.equals( "tmp", false ) == false && this->entries.find( fileName.convert_ansi() ) != this->entries.end() )
+            continue;
+
+        this->cacheRoot->Delete( cacheFilePath );
+    }
+}
+
+void ConversionCache::Save( void )
+{
+    CFile *indexStream = this->cacheRoot->Open( CONVCACHE_INDEX_FILE, "wb" );
+
+    if ( indexStream )
+    {
+        std::string indexData = CONVCACHE_INDEX_MAGIC " " + std::to_string( this->useCounter ) + "\n";
+
+        for ( const auto& entryPair : this->entries )
+        {
+            const cacheEntry& entry = entryPair.second;
+
+            indexData += entryPair.first + " " + std::to_string( entry.dataSize ) + " " + std::to_string( entry.lastUse ) + "\n";
+        }
+
+        indexStream->Write( indexData.data(), 1, indexData.size() );
+
+        delete indexStream;
+    }
+}
+
+void ConversionCache::RemoveEntry( const std::string& keyString )
+{
+    auto iter = this->entries.find( keyString );
+
+    if ( iter != this->entries.end() )
+    {
+        this->cacheSize -= iter->second.dataSize;
+
+        this->entries.erase( iter );
+    }
+
+    this->cacheRoot->Delete( ( keyString + CONVCACHE_RESULT_EXT ).c_str() );
+    this->cacheRoot->Delete( ( keyString + CONVCACHE_WARNINGS_EXT ).c_str() );
+}
+
+bool ConversionCache::Fetch( const convCacheKey& key, CFile *targetStream, std::string& warningsOut )
+{
+    std::string keyString = key.toString();
+
+    auto iter = this->entries.find( keyString );
+
+    if ( iter != this->entries.end() )
+    {
+        CFile *cacheStream = this->cacheRoot->Open( ( keyString + CONVCACHE_RESULT_EXT ).c_str(), "rb" );
+
+        if ( cacheStream )
+        {
+            FileSystem::StreamCopy( *cacheStream, *targetStream );
+
+            delete cacheStream;
+
+            // Only conversions that warned have a warnings file.
+            warningsOut.clear();
+
+            if ( CFile *warningsStream = this->cacheRoot->Open( ( keyString + CONVCACHE_WARNINGS_EXT ).c_str(), "rb" ) )
+            {
+                warningsOut.resize( (size_t)warningsStream->GetSize() );
+
+                size_t readCount = warningsStream->Read( (char*)warningsOut.data(), 1, warningsOut.size() );
+
+                warningsOut.resize( readCount );
+
+                delete warningsStream;
+            }
+
+            iter->second.lastUse = ++this->useCounter;
+
+            this->hitCount++;
+
+            return true;
+        }
+
+        // The file is gone, so forget about it.
+        this->RemoveEntry( keyString );
+    }
+
+    this->missCount++;
+
+    return false;
+}
+
+CFile* ConversionCache::BeginStore( const convCacheKey& key )
+{
+    return this->cacheRoot->Open( ( key.toString() + CONVCACHE_TEMP_EXT ).c_str(), "wb" );
+}
+
+bool ConversionCache::EndStore( const convCacheKey& key, CFile *cacheStream, bool successful, const std::string& warnings, CFile *targetStream )
+{
+    std::string keyString = key.toString();
+
+    std::string tmpFileName = keyString + CONVCACHE_TEMP_EXT;
+    std::string entryFileName = keyString + CONVCACHE_RESULT_EXT;
+
+    size_t dataSize = cacheStream->GetSize();
+
+    delete cacheStream;
+
+    if ( successful == false )
+    {
+        this->cacheRoot->Delete( tmpFileName.c_str() );
+
+        return false;
+    }
+
+    // Replace any old entry.
+    this->RemoveEntry( keyString );
+
+    if ( this->cacheRoot->Rename( tmpFileName.c_str(), entryFileName.c_str() ) == false )
+    {
+        this->cacheRoot->Delete( tmpFileName.c_str() );
+
+        return false;
+    }
+
+    bool canKeepEntry = true;
+
+    if ( warnings.empty() == false )
+    {
+        if ( CFile *warningsStream = this->cacheRoot->Open( ( keyString + CONVCACHE_WARNINGS_EXT ).c_str(), "wb" ) )
+        {
+            warningsStream->Write( warnings.data(), 1, warnings.size() );
+
+            delete warningsStream;
+
+            dataSize += warnings.size();
+        }
+        else
+        {
+            // Without its warnings a cached result would hide diagnostics on later runs.
+            canKeepEntry = false;
+        }
+    }
+
+    // Give the result to the build.
+    bool hasCopied = false;
+
+    if ( CFile *resultStream = this->cacheRoot->Open( entryFileName.c_str(), "rb" ) )
+    {
+        FileSystem::StreamCopy( *resultStream, *targetStream );
+
+        delete resultStream;
+
+        hasCopied = true;
+    }
+
+    if ( canKeepEntry == false )
+    {
+        this->RemoveEntry( keyString );
+
+        return hasCopied;
+    }
+
+    cacheEntry entry;
+    entry.dataSize = dataSize;
+    entry.lastUse = ++this->useCounter;
+
+    this->entries[ keyString ] = entry;
+
+    this->cacheSize += dataSize;
+
+    if ( this->cacheSize > this->maxCacheSize )
+    {
+        this->Evict( &key );
+    }
+
+    return hasCopied;
+}
+
+void ConversionCache::Evict( const convCacheKey *keepKey )
+{
+    if ( this->cacheSize <= this->maxCacheSize )
+        return;
+
+    std::string keepKeyString;
+
+    if ( keepKey )
+    {
+        keepKeyString = keepKey->toString();
+    }
+
+    // Oldest use first.
+    std::vector <std::pair <rw::uint64, std::string>> evictOrder;
+
+    for ( const auto& entryPair : this->entries )
+    {
+        if ( entryPair.first != keepKeyString )
+        {
+            evictOrder.push_back( std::make_pair( entryPair.second.lastUse, entryPair.first ) );
+        }
+    }
+
+    std::sort( evictOrder.begin(), evictOrder.end() );
+
+    for ( const auto& evictItem : evictOrder )
+    {
+        if ( this->cacheSize <= this->maxCacheSize )
+            break;
+
+        this->RemoveEntry( evictItem.second );
+
+        this->evictionCount++;
+    }
+}
+
+// Rough size of the texel data of a raster, used to limit the memory of the deduplication table.
+static rw::uint64 EstimateRasterMemorySize( rw::Raster *raster )
+{
+    rw::uint32 width, height;
+
+    raster->getSize( width, height );
+
+    rw::uint64 bitsPerPixel;
+
+    if ( raster->isCompressed() )
+    {
+        bitsPerPixel = ( raster->getCompressionFormat() == rw::RWCOMPRESS_DXT1 ? 4 : 8 );
+    }
+    else if ( raster->getPaletteType() != rw::PALETTE_NONE )
+    {
+        bitsPerPixel = 8;
+    }
+    else
+    {
+        bitsPerPixel = rw::Bitmap::getRasterFormatDepth( raster->getRasterFormat() );
+    }
+
+    rw::uint64 memSize = ( (rw::uint64)width * height * bitsPerPixel ) / 8;
+
+    // Mipmaps add up to a third.
+    if ( raster->getMipmapCount() > 1 )
+    {
+        memSize += memSize / 3;
+    }
+
+    return memSize;
+}
+
+RasterDedupCache::RasterDedupCache( const convCacheHasher& settingsHash, rw::uint64 maxMemorySize ) : settingsHash( settingsHash )
+{
+    this->maxMemorySize = maxMemorySize;
+    this->memorySize = 0;
+    this->hitCount = 0;
+    this->uniqueCount = 0;
+}
+
+RasterDedupCache::~RasterDedupCache( void )
+{
+    for ( auto& entryPair : this->entries )
+    {
+        rw::DeleteRaster( entryPair.second.raster );
+    }
+}
+
+convCacheKey RasterDedupCache::GetKey( rw::Raster *raster ) const
+{
+    rw::uint64 contentHashLow, contentHashHigh;
+
+    raster->getContentHash( contentHashLow, contentHashHigh );
+
+    convCacheHasher keyHash = this->settingsHash;
+
+    keyHash.feedValue( contentHashLow );
+    keyHash.feedValue( contentHashHigh );
+
+    return keyHash.finish();
+}
+
+rw::Raster* RasterDedupCache::Fetch( const convCacheKey& key, std::string& warningsOut )
+{
+    auto iter = this->entries.find( key.toString() );
+
+    if ( iter == this->entries.end() )
+        return NULL;
+
+    cacheEntry& entry = iter->second;
+
+    // Each texture gets its own copy, so that later changes to one of them do not leak into the others.
+    rw::Raster *clonedRaster = rw::CloneRaster( entry.raster );
+
+    if ( clonedRaster )
+    {
+        warningsOut = entry.warnings;
+
+        this->lruList.splice( this->lruList.begin(), this->lruList, entry.lruNode );
+
+        this->hitCount++;
+    }
+
+    return clonedRaster;
+}
+
+void RasterDedupCache::Store( const convCacheKey& key, rw::Raster *convertedRaster, const std::string& warnings )
+{
+    std::string keyString = key.toString();
+
+    if ( this->entries.find( keyString ) != this->entries.end() )
+        return;
+
+    rw::Raster *clonedRaster = rw::CloneRaster( convertedRaster );
+
+    if ( !clonedRaster )
+        return;
+
+    this->lruList.push_front( keyString );
+
+    cacheEntry entry;
+    entry.raster = clonedRaster;
+    entry.warnings = warnings;
+    entry.memorySize = EstimateRasterMemorySize( clonedRaster ) + warnings.size();
+    entry.lruNode = this->lruList.begin();
+
+    this->entries[ keyString ] = entry;
+
+    this->memorySize += entry.memorySize;
+
+    this->uniqueCount++;
+
+    this->Evict();
+}
+
+void RasterDedupCache::Evict( void )
+{
+    // Always keep the newest entry, even if it is bigger than the budget.
+    while ( this->memorySize > this->maxMemorySize && this->lruList.size() > 1 )
+    {
+        auto iter = this->entries.find( this->lruList.back() );
+
+        this->lruList.pop_back();
+
+        this->memorySize -= iter->second.memorySize;
+
+        rw::DeleteRaster( iter->second.raster );
+
+        this->entries.erase( iter );
+    }
+}
@@ -0,0 +1,120 @@
+// Persistent cache of converted TXD files for mass conversion.
+// Entries are addressed by a hash over the input file contents and every setting that
+// influences the conversion result, so a changed input or config simply misses.
+
+#pragma once
+
+#include <string>
+#include <map>
+#include <list>
+
+struct convCacheKey
+{
+    rw::uint64 hashLow;
+    rw::uint64 hashHigh;
+
+    std::string toString( void ) const;
+};
+
+// Same hash as rasters use for their contents, so raster hashes can be mixed into keys.
+struct convCacheHasher : public rw::utils::contentHasher
+{
+    // Hashes the stream from its current position until the end.
+    void feedStream( CFile *stream );
+
+    convCacheKey finish( void ) const;
+};
+
+class ConversionCache
+{
+public:
+    ConversionCache( CFileTranslator *cacheRoot, rw::uint64 maxCacheSize );
+    ~ConversionCache( void );
+
+    // Copies the cached result into targetStream and returns the warnings of the original conversion.
+    // Returns false on a miss.
+    bool Fetch( const convCacheKey& key, CFile *targetStream, std::string& warningsOut );
+
+    // Storing a result is done by writing the conversion into the stream returned by BeginStore.
+    // EndStore commits it together with its warnings if the conversion was successful and copies it into targetStream.
+    CFile* BeginStore( const convCacheKey& key );
+    bool EndStore( const convCacheKey& key, CFile *cacheStream, bool successful, const std::string& warnings, CFile *targetStream );
+
+    // Removes the least recently used entries until the cache fits its size limit.
+    void Evict( const convCacheKey *keepKey = NULL );
+
+    // Writes the cache index to disk.
+    void Save( void );
+
+    unsigned int GetHitCount( void ) const          { return this->hitCount; }
+    unsigned int GetMissCount( void ) const         { return this->missCount; }
+    unsigned int GetEvictionCount( void ) const     { return this->evictionCount; }
+    rw::uint64 GetCacheSize( void ) const           { return this->cacheSize; }
+
+private:
+    void LoadIndex( void );
+    void RemoveEntry( const std::string& keyString );
+
+    struct cacheEntry
+    {
+        rw::uint64 dataSize;
+        rw::uint64 lastUse;
+    };
+
+    CFileTranslator *cacheRoot;
+
+    std::map <std::string, cacheEntry> entries;
+
+    rw::uint64 maxCacheSize;
+    rw::uint64 cacheSize;
+    rw::uint64 useCounter;
+
+    unsigned int hitCount;
+    unsigned int missCount;
+    unsigned int evictionCount;
+};
+
+// In-memory table of converted rasters of the current run.
+// Game trees contain the same texture in many TXDs, so each unique raster is converted only once
+// and later copies receive a clone of the result.
+class RasterDedupCache
+{
+public:
+    RasterDedupCache( const convCacheHasher& settingsHash, rw::uint64 maxMemorySize );
+    ~RasterDedupCache( void );
+
+    // Key of an unprocessed raster, made of its native pixel data and the conversion settings.
+    convCacheKey GetKey( rw::Raster *raster ) const;
+
+    // Returns a new clone of the converted raster with the given key, or NULL if there is none.
+    // warningsOut receives the warnings that the conversion of the raster issued.
+    rw::Raster* Fetch( const convCacheKey& key, std::string& warningsOut );
+
+    // Remembers the result of a successful raster conversion together with its warnings.
+    void Store( const convCacheKey& key, rw::Raster *convertedRaster, const std::string& warnings );
+
+    unsigned int GetHitCount( void ) const          { return this->hitCount; }
+    unsigned int GetUniqueCount( void ) const       { return this->uniqueCount; }
+
+private:
+    void Evict( void );
+
+    struct cacheEntry
+    {
+        rw::Raster *raster;
+        std::string warnings;
+        rw::uint64 memorySize;
+        std::list <std::string>::iterator lruNode;
+    };
+
+    convCacheHasher settingsHash;
+
+    std::map <std::string, cacheEntry> entries;
+    std::list <std::string> lruList;    // most recently used first
+
+    rw::uint64 maxMemorySize;
+    rw::uint64 memorySize;
+
+    unsigned int hitCount;
+    unsigned int uniqueCount;
+};
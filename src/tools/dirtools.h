@@ -10,6 +10,12 @@ struct gtaFileProcessor
         this->reconstruct_archives = true;
         this->use_compressed_img_archives = true;
         this->module = module;
+
+        // Source files are read sequentially, so we let FileSystem read ahead of the parser.
+        // The read-ahead buffers and threads come from a pool that FileSystem keeps bounded.
+        this->streamParams.bufferSize = 65536;
+        this->streamParams.bufferCount = 3;
+        this->streamParams.enableReadAhead = true;
     }
 
     inline ~gtaFileProcessor( void )
@@ -27,6 +33,8 @@ struct gtaFileProcessor
         traverse.sentry = theSentry;
         traverse.reconstruct_archives = this->reconstruct_archives;
         traverse.use_compressed_img_archives = this->use_compressed_img_archives;
+        traverse.streamParams = &this->streamParams;
+        traverse.streamStats = &this->streamStats;
 
         discHandle->ScanDirectory( "@", "*", true, NULL, _discFileCallback, &traverse );
     }
@@ -41,10 +49,42 @@ struct gtaFileProcessor
         this->use_compressed_img_archives = doUse;
     }
 
+    inline void setReadAheadBuffering( size_t bufferSize, unsigned int bufferCount )
+    {
+        this->streamParams.bufferSize = bufferSize;
+        this->streamParams.bufferCount = bufferCount;
+        this->streamParams.enableReadAhead = ( bufferCount >= 2 );
+    }
+
+    // Accumulated buffering counters of all source files that were processed.
+    inline const fsBufferedStreamStats& getStreamStatistics( void ) const
+    {
+        return this->streamStats;
+    }
+
+    // Tells the user how well the read-ahead buffering has performed, so that it can be tuned.
+    inline void reportStreamStatistics( void ) const
+    {
+        const fsBufferedStreamStats& stats = this->streamStats;
+
+        if ( stats.hitCount == 0 && stats.missCount == 0 && stats.stallCount == 0 )
+            return;
+
+        this->module->OnMessage(
+            "read-ahead: " + std::to_string( stats.hitCount ) + " hits, " +
+            std::to_string( stats.missCount ) + " misses, " +
+            std::to_string( stats.stallCount ) + " stalls, " +
+            std::to_string( stats.prefetchedBytes / 1024 ) + " KB prefetched\n"
+        );
+    }
+
 private:
     bool reconstruct_archives;
     bool use_compressed_img_archives;
 
+    fsBufferedStreamParams streamParams;
+    fsBufferedStreamStats streamStats;
+
     struct _discFileTraverse
     {
         inline _discFileTraverse( void )
@@ -63,9 +103,21 @@ private:
         bool reconstruct_archives;
         bool use_compressed_img_archives;
 
+        const fsBufferedStreamParams *streamParams;
+        fsBufferedStreamStats *streamStats;
+
         sentryType *sentry;
     };
 
+    static inline void accumulateStreamStatistics( fsBufferedStreamStats& dst, const fsBufferedStreamStats& src )
+    {
+        dst.hitCount += src.hitCount;
+        dst.missCount += src.missCount;
+        dst.stallCount += src.stallCount;
+        dst.prefetchCount += src.prefetchCount;
+        dst.prefetchedBytes += src.prefetchedBytes;
+    }
+
     static void _discFileCallback( const filePath& discFilePathAbs, void *userdata )
     {
         _discFileTraverse *info = (_discFileTraverse*)userdata;
@@ -199,6 +251,8 @@ private:
                                     traverse.sentry = info->sentry;
                                     traverse.reconstruct_archives = info->reconstruct_archives;
                                     traverse.use_compressed_img_archives = info->use_compressed_img_archives;
+                                    traverse.streamParams = info->streamParams;
+                                    traverse.streamStats = info->streamStats;
 
                                     srcIMGRoot->ScanDirectory( "@", "*", true, NULL, _discFileCallback, &traverse );
 
@@ -269,6 +323,25 @@ private:
                     sourceStream = info->discHandle->Open( discFilePathAbs, L"rb" );
                 }
 
+                // Buffer the file reads so that they overlap with the processing.
+                CFile *bufferedStream = NULL;
+
+                if ( sourceStream )
+                {
+                    try
+                    {
+                        bufferedStream = fileSystem->CreateBufferedStream( sourceStream, true, *info->streamParams );
+                    }
+                    catch( ... )
+                    {
+                        delete sourceStream;
+
+                        throw;
+                    }
+
+                    sourceStream = bufferedStream;
+                }
+
                 if ( sourceStream )
                 {
                     try
@@ -302,6 +375,17 @@ private:
                         throw;
                     }
 
+                    // Remember how well the buffering has performed.
+                    if ( sourceStream == bufferedStream )
+                    {
+                        fsBufferedStreamStats fileStats;
+
+                        if ( fileSystem->GetBufferedStreamStats( bufferedStream, fileStats ) )
+                        {
+                            accumulateStreamStatistics( *info->streamStats, fileStats );
+                        }
+                    }
+
                     delete sourceStream;
                 }
             }
@@ -22,7 +22,8 @@ namespace rwkind
         PLATFORM_DXT_MOBILE,
         PLATFORM_PVR,
         PLATFORM_ATC,
-        PLATFORM_UNC_MOBILE
+        PLATFORM_UNC_MOBILE,
+        PLATFORM_ETC
     };
 
     enum eTargetGame
@@ -96,6 +97,15 @@ namespace rwkind
             platOut = PLATFORM_UNC_MOBILE;
             return true;
         }
+        else if ( stricmp( targetPlatform, "ETC" ) == 0 ||
+                  stricmp( targetPlatform, "ETC1" ) == 0 ||
+                  stricmp( targetPlatform, "ETC2" ) == 0 ||
+                  stricmp( targetPlatform, "etc_mobile" ) == 0 ||
+                  stricmp( targetPlatform, "mobile_etc" ) == 0 )
+        {
+            platOut = PLATFORM_ETC;
+            return true;
+        }
 
         return false;
     }
@@ -274,6 +284,10 @@ namespace rwkind
         {
             thePlatform = PLATFORM_UNC_MOBILE;
         }
+        else if ( texRaster->hasNativeDataOfType( "etc_mobile" ) )
+        {
+            thePlatform = PLATFORM_ETC;
+        }
 
         return thePlatform;
     }
@@ -318,6 +332,10 @@ namespace rwkind
         {
             quality = 0.9;
         }
+        else if ( platform == PLATFORM_ETC )
+        {
+            quality = 0.75;
+        }
 
         return quality;
     }
@@ -406,6 +424,10 @@ namespace rwkind
         {
             return "uncompressed_mobile";
         }
+        else if ( targetPlatform == PLATFORM_ETC )
+        {
+            return "etc_mobile";
+        }
         
         return NULL;
     }
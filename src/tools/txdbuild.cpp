@@ -6,9 +6,14 @@
 
 #include "configtree.h"
 
+#include "convcache.h"
+#include "buildmanifest.h"
+
 #include <gtaconfig/include.h>
 
 #include <regex>
+#include <codecvt>
+#include <algorithm>
 
 #include "imagepipe.hxx"
 
@@ -314,6 +319,9 @@ void BuildSingleTexture(
                 GetConfigNodeAddressMode( cfgParent, "vAddress", rw::RWTEXADDRESS_WRAP )
             );
 
+            // Collect the raster operations, so that they can run in a single pass.
+            rw::RasterPipeline rasterPipe;
+
             // Scale the raster?
             {
                 std::string strSize;
@@ -329,12 +337,7 @@ void BuildSingleTexture(
                     if ( parseCount == 2 )
                     {
                         // Do the resize with default filters.
-                        rw::Raster *texRaster = imgTex->GetRaster();
-
-                        if ( texRaster )
-                        {
-                            texRaster->resize( width, height );
-                        }
+                        rasterPipe.resize( width, height );
                     }
                 }
             }
@@ -342,46 +345,41 @@ void BuildSingleTexture(
             // Generate mipmaps?
             if ( GetConfigNodeBoolean( cfgParent, "genMipmaps", false ) )
             {
-                rw::Raster *texRaster = imgTex->GetRaster();
+                int genMipMaxLevel = GetConfigNodeInt( cfgParent, "genMipMaxLevel", 32 );
 
-                if ( texRaster )
-                {
-                    int genMipMaxLevel = GetConfigNodeInt( cfgParent, "genMipMaxLevel", 32 );
-
-                    texRaster->generateMipmaps( genMipMaxLevel );
-                }
+                rasterPipe.generateMipmaps( genMipMaxLevel );
             }
 
             // We want to palettize?
             if ( GetConfigNodeBoolean( cfgParent, "palettized", false ) )
             {
-                rw::Raster *texRaster = imgTex->GetRaster();
-
-                if ( texRaster )
+                // Decide what palette format.
+                rw::ePaletteType paletteType = rw::PALETTE_8BIT;
                 {
-                    // Decide what palette format.
-                    rw::ePaletteType paletteType = rw::PALETTE_8BIT;
-                    {
-                        std::string palName = GetConfigNodeString( cfgParent, "palType", "PAL8" );
-
-                        getPaletteTypeFromString( palName.c_str(), paletteType );
-                    }
+                    std::string palName = GetConfigNodeString( cfgParent, "palType", "PAL8" );
 
-                    texRaster->convertToPalette( paletteType, rw::RASTER_8888 );    // maximum palette quality.
+                    getPaletteTypeFromString( palName.c_str(), paletteType );
                 }
+
+                rasterPipe.convertToPalette( paletteType, rw::RASTER_8888 );    // maximum palette quality.
             }
 
             // Maybe this texture wants to be compressed.
             if ( GetConfigNodeBoolean( cfgParent, "compressed", false ) )
             {
-                // Lets do it.
+                float comprQuality = (float)GetConfigNodeFloat( cfgParent, "comprQuality", 1.0 );
+
+                rasterPipe.compress( comprQuality );
+            }
+
+            // Lets do it.
+            if ( rasterPipe.isEmpty() == false )
+            {
                 rw::Raster *texRaster = imgTex->GetRaster();
 
                 if ( texRaster )
                 {
-                    float comprQuality = (float)GetConfigNodeFloat( cfgParent, "comprQuality", 1.0 );
-
-                    texRaster->compress( comprQuality );
+                    rw::ExecuteRasterPipeline( texRaster, rasterPipe );
                 }
             }
 
@@ -666,12 +664,218 @@ void ReadConfigurationBlock(
     }
 }
 
+// Name of the file in the output root that remembers what went into each TXD.
+#define TXDBUILD_MANIFEST_FILE      "_txdbuild.manifest"
+
+// Manifest paths do not depend on the host, so that the output directory can be moved around.
+static std::string GetManifestPathString( const filePath& path )
+{
+    std::wstring widePath = path.convert_unicode();
+
+    std::replace( widePath.begin(), widePath.end(), L'\\', L'/' );
+
+    return std::wstring_convert <std::codecvt_utf8 <wchar_t>> ().to_bytes( widePath );
+}
+
+static std::string HashConfigFingerprint( const ConfigNode& cfgNode )
+{
+    std::string fingerprint = cfgNode.GetFingerprint();
+
+    convCacheHasher hasher;
+    hasher.feed( fingerprint.data(), fingerprint.size() );
+
+    return hasher.finish().toString();
+}
+
+// Global settings that influence every TXD but are not part of the configuration tree.
+static std::string GetBuildSettingsFingerprint( const TxdBuildModule::run_config& config )
+{
+    return
+        "platform=" + std::to_string( (int)config.targetPlatform ) +
+        ";game=" + std::to_string( (int)config.targetGame ) + ";";
+}
+
+// Fills in size, time and content hash of a texture source.
+// The contents are only hashed if the file looks different than at the previous build.
+static bool GetTextureSourceRecord( CFileTranslator *gameRoot, const filePath& texturePath, const buildManifestSource *prevRecord, buildManifestSource& recordOut )
+{
+    struct stat fileStats;
+
+    if ( gameRoot->Stat( texturePath, &fileStats ) == false )
+        return false;
+
+    recordOut.fileSize = (rw::uint64)fileStats.st_size;
+    recordOut.modTime = (rw::int64)fileStats.st_mtime;
+
+    if ( prevRecord && prevRecord->fileSize == recordOut.fileSize && prevRecord->modTime == recordOut.modTime )
+    {
+        recordOut.contentHash = prevRecord->contentHash;
+        return true;
+    }
+
+    CFile *fileStream = gameRoot->Open( texturePath, L"rb" );
+
+    if ( !fileStream )
+        return false;
+
+    convCacheHasher hasher;
+    hasher.feedStream( fileStream );
+
+    delete fileStream;
+
+    recordOut.contentHash = hasher.finish().toString();
+    return true;
+}
+
+static void BuildTextureFromFile(
+    rw::Interface *rwEngine, rw::TexDictionary *texDict,
+    CFileTranslator *gameRoot, const filePath& texturePath,
+    TxdBuildModule *module, const TxdBuildModule::run_config& config, const filePath& extention,
+    const ConfigNode& cfgNode
+)
+{
+    // We first have to establish a stream to the file.
+    CFile *fsImgStream = gameRoot->Open( texturePath, L"rb" );
+
+    if ( !fsImgStream )
+    {
+        module->OnMessage( std::wstring( L"failed to open texture: " ) + texturePath.convert_unicode() + L'\n' );
+        return;
+    }
+
+    try
+    {
+        // Decompress if we find compressed things. ;)
+        fsImgStream = module->WrapStreamCodec( fsImgStream );
+    }
+    catch( ... )
+    {
+        delete fsImgStream;
+
+        throw;
+    }
+
+    try
+    {
+        rw::Stream *imgStream = RwStreamCreateTranslated( rwEngine, fsImgStream );
+
+        if ( imgStream )
+        {
+            try
+            {
+                // Try turning it into a texture now.
+                BuildSingleTexture(
+                    rwEngine, texDict,
+                    texturePath, imgStream,
+                    module, config, extention,
+                    cfgNode
+                );
+            }
+            catch( ... )
+            {
+                rwEngine->DeleteStream( imgStream );
+
+                throw;
+            }
+
+            rwEngine->DeleteStream( imgStream );
+        }
+    }
+    catch( ... )
+    {
+        delete fsImgStream;
+
+        throw;
+    }
+
+    delete fsImgStream;
+}
+
+// Reads back the TXD of a previous build so that its unchanged textures can be reused.
+static rw::TexDictionary* LoadPreviousTXD( rw::Interface *rwEngine, CFileTranslator *outputRoot, const filePath& txdPath )
+{
+    rw::TexDictionary *texDict = NULL;
+
+    CFile *fsTXDStream = outputRoot->Open( txdPath, L"rb" );
+
+    if ( fsTXDStream )
+    {
+        try
+        {
+            rw::Stream *txdStream = RwStreamCreateTranslated( rwEngine, fsTXDStream );
+
+            if ( txdStream )
+            {
+                try
+                {
+                    rw::RwObject *rwObj = rwEngine->Deserialize( txdStream );
+
+                    if ( rwObj )
+                    {
+                        texDict = rw::ToTexDictionary( rwEngine, rwObj );
+
+                        if ( !texDict )
+                        {
+                            rwEngine->DeleteRwObject( rwObj );
+                        }
+                    }
+                }
+                catch( rw::RwException& )
+                {
+                    // A broken output is simply rebuilt.
+                    texDict = NULL;
+                }
+
+                rwEngine->DeleteStream( txdStream );
+            }
+        }
+        catch( ... )
+        {
+            delete fsTXDStream;
+
+            throw;
+        }
+
+        delete fsTXDStream;
+    }
+
+    return texDict;
+}
+
+static rw::TextureBase* FindTextureByName( rw::TexDictionary *texDict, const std::string& name )
+{
+    for ( rw::TexDictionary::texIter_t iter( texDict->GetTextureIterator() ); !iter.IsEnd(); iter.Increment() )
+    {
+        rw::TextureBase *texHandle = iter.Resolve();
+
+        if ( texHandle->GetName() == name )
+        {
+            return texHandle;
+        }
+    }
+
+    return NULL;
+}
+
+struct txdBuildStatistics
+{
+    unsigned int upToDateCount = 0;
+    unsigned int rebuiltCount = 0;
+    unsigned int reusedTextureCount = 0;
+};
+
 void BuildTXDArchives(
     rw::Interface *rwEngine,
     TxdBuildModule *module, CFileTranslator *gameRoot, CFileTranslator *outputRoot,
-    const TxdBuildModule::run_config& config, const ConfigNode& cfgNode
+    const TxdBuildModule::run_config& config, const ConfigNode& cfgNode,
+    BuildManifest& manifest
 )
 {
+    txdBuildStatistics stats;
+
+    // All TXDs that are still part of the build.
+    std::set <std::string> visitedTXDs;
+
     // Process things.
     auto dir_callback = [&]( const filePath& dirPath )
     {
@@ -700,6 +904,126 @@ void BuildTXDArchives(
             // We can only continue if we actually have a valid location to write our TXD to.
             if ( hasTXDWritePath )
             {
+                std::string manifestKey = GetManifestPathString( txdWritePath );
+
+                visitedTXDs.insert( manifestKey );
+
+                // Take the record of the previous build out of the manifest.
+                // It is put back once the TXD is known to be correct.
+                buildManifestEntry prevEntry;
+                bool hasPrevEntry = false;
+
+                if ( const buildManifestEntry *manifestEntry = manifest.FindEntry( manifestKey ) )
+                {
+                    if ( config.incrementalBuild )
+                    {
+                        prevEntry = *manifestEntry;
+                        hasPrevEntry = true;
+                    }
+
+                    manifest.RemoveEntry( manifestKey );
+                }
+
+                // Load configuration for this TXD.
+                ConfigNode txdConfigNode;
+                txdConfigNode.SetParent( &cfgNode );
+                {
+                    filePath iniPath = dirPath + L"_build.ini";
+
+                    ReadConfigurationBlock(
+                        rwEngine,
+                        gameRoot, std::move( iniPath ),
+                        txdConfigNode,
+                        module
+                    );
+                }
+
+                buildManifestEntry newEntry;
+                newEntry.configFingerprint = HashConfigFingerprint( txdConfigNode );
+
+                // Find all textures of this TXD and what they are made of.
+                struct textureSource
+                {
+                    filePath path;
+                    filePath extention;
+                    ConfigNode cfgNode;
+                };
+
+                std::vector <textureSource> textureSources;
+                {
+                    auto per_dir_file_cb = [&]( const filePath& texturePath )
+                    {
+                        // We have to parse the path to this texture.
+                        filePath pathToTexture;
+                        filePath relTexturePath;
+
+                        if ( gameRoot->GetRelativePathFromRoot( texturePath, false, pathToTexture ) == false ||
+                             gameRoot->GetRelativePathFromRoot( texturePath, true, relTexturePath ) == false )
+                        {
+                            return;
+                        }
+
+                        filePath extOut;
+
+                        filePath fileNameItem = FileSystem::GetFileNameItem( texturePath, false, NULL, &extOut );
+
+                        // Ignore some extensions.
+                        // Those are used for meta-properties of textures.
+                        if ( extOut == L"ini" )
+                            return;
+
+                        // Alright, this is a candidate for a valid texture!
+                        textureSource source;
+                        source.path = texturePath;
+                        source.extention = extOut;
+
+                        // Load configuration for this texture.
+                        source.cfgNode.SetParent( &txdConfigNode );
+                        {
+                            filePath texIniPath = ( pathToTexture + fileNameItem + L".ini" );
+
+                            ReadConfigurationBlock(
+                                rwEngine,
+                                gameRoot, std::move( texIniPath ),
+                                source.cfgNode,
+                                module
+                            );
+                        }
+
+                        buildManifestSource record;
+                        record.path = GetManifestPathString( relTexturePath );
+                        record.configFingerprint = HashConfigFingerprint( source.cfgNode );
+
+                        const buildManifestSource *prevRecord = ( hasPrevEntry ? prevEntry.FindSource( record.path ) : NULL );
+
+                        if ( GetTextureSourceRecord( gameRoot, texturePath, prevRecord, record ) == false )
+                        {
+                            module->OnMessage( std::wstring( L"failed to open texture: " ) + texturePath.convert_unicode() + L'\n' );
+                            return;
+                        }
+
+                        newEntry.sources.push_back( std::move( record ) );
+                        textureSources.push_back( std::move( source ) );
+
+                        rw::CheckThreadHazards( rwEngine );
+                    };
+
+                    gameRoot->ScanDirectory( dirPath, "*", false, NULL, std::move( per_dir_file_cb ), NULL );
+                }
+
+                bool hasOutputFile = outputRoot->Exists( txdWritePath );
+
+                // Nothing to do if neither the sources nor their configuration have changed.
+                if ( hasPrevEntry && hasOutputFile && prevEntry.isSameBuild( newEntry ) )
+                {
+                    module->OnMessage( std::wstring( L"up to date '" ) + txdWritePath.convert_unicode() + L"'\n" );
+
+                    manifest.SetEntry( manifestKey, std::move( newEntry ) );
+
+                    stats.upToDateCount++;
+                    return;
+                }
+
                 // Send a status message about our build process.
                 module->OnMessage( std::wstring( L"building '" ) + txdWritePath.convert_unicode() + L"'...\n" );
 
@@ -709,138 +1033,74 @@ void BuildTXDArchives(
                 {
                     throw rw::RwException( "failed to allocate texture dictionary object" );
                 }
+
+                // Textures whose sources did not change are taken from the previous build.
+                rw::TexDictionary *prevTexDict = NULL;
         
                 try
                 {
-                    // Load configuration for this TXD.
-                    ConfigNode txdConfigNode;
-                    txdConfigNode.SetParent( &cfgNode );
+                    if ( hasPrevEntry && hasOutputFile )
                     {
-                        filePath iniPath = dirPath + L"_build.ini";
-
-                        ReadConfigurationBlock(
-                            rwEngine,
-                            gameRoot, std::move( iniPath ),
-                            txdConfigNode,
-                            module
-                        );
+                        prevTexDict = LoadPreviousTXD( rwEngine, outputRoot, txdWritePath );
                     }
 
+                    bool hasFailedTextures = false;
+
                     // Add all textures to this TXD.
+                    size_t sourceCount = textureSources.size();
+
+                    for ( size_t n = 0; n < sourceCount; n++ )
                     {
-                        auto per_dir_file_cb = [&]( const filePath& texturePath )
-                        {
-                            // We first have to establish a stream to the file.
-                            CFile *fsImgStream = gameRoot->Open( texturePath, L"rb" );
+                        const textureSource& source = textureSources[ n ];
+                        const buildManifestSource& record = newEntry.sources[ n ];
 
-                            if ( fsImgStream )
-                            {
-                                try
-                                {
-                                    // Decompress if we find compressed things. ;)
-                                    fsImgStream = module->WrapStreamCodec( fsImgStream );
-                                }
-                                catch( ... )
-                                {
-                                    delete fsImgStream;
+                        bool isReused = false;
 
-                                    throw;
-                                }
-                            }
+                        if ( prevTexDict )
+                        {
+                            const buildManifestSource *prevRecord = prevEntry.FindSource( record.path );
 
-                            if ( fsImgStream )
+                            if ( prevRecord && prevRecord->isSameBuild( record ) )
                             {
-                                try
-                                {
-                                    // Try to turn this file into a texture.
-                                    try
-                                    {
-                                        rw::Stream *imgStream = RwStreamCreateTranslated( rwEngine, fsImgStream );
-
-                                        if ( imgStream )
-                                        {
-                                            try
-                                            {
-                                                // We have to parse the path to this texture.
-                                                filePath pathToTexture;
-                                                    
-                                                bool gotPath = gameRoot->GetRelativePathFromRoot( texturePath, false, pathToTexture );
-
-                                                if ( gotPath )
-                                                {
-                                                    filePath extOut;
-
-                                                    filePath fileNameItem = FileSystem::GetFileNameItem( texturePath, false, NULL, &extOut );
-
-                                                    // Ignore some extensions.
-                                                    // Those are used for meta-properties of textures.
-                                                    if ( extOut != L"ini" )
-                                                    {
-                                                        // Alright, this is a candidate for a valid texture!
-                                                        // Let process this entry.
-
-                                                        // Load configuration for this texture.
-                                                        ConfigNode textureCfgNode;
-                                                        textureCfgNode.SetParent( &txdConfigNode );
-                                                        {
-                                                            filePath texIniPath = ( pathToTexture + fileNameItem + L".ini" );
-
-                                                            ReadConfigurationBlock(
-                                                                rwEngine,
-                                                                gameRoot, std::move( texIniPath ),
-                                                                textureCfgNode,
-                                                                module
-                                                            );
-                                                        }
-
-                                                        // We got all streams prepared!
-                                                        // Try turning it into a texture now.
-                                                        BuildSingleTexture(
-                                                            rwEngine, texDict,
-                                                            texturePath, imgStream,
-                                                            module, config, extOut,
-                                                            textureCfgNode
-                                                        );
-                                                    }
-                                                }
-                                            }
-                                            catch( ... )
-                                            {
-                                                rwEngine->DeleteStream( imgStream );
-
-                                                throw;
-                                            }
-
-                                            rwEngine->DeleteStream( imgStream );
-                                        }
-                                    }
-                                    catch( rw::RwException& except )
-                                    {
-                                        // Tell the runtime about any errors.
-                                        module->OnMessage( std::string( "failed to build texture: " ) + except.message + '\n' );
+                                std::string texName = FileSystem::GetFileNameItem( source.path, false ).convert_ansi();
 
-                                        // Continue. This is just one of many textures.
-                                    }
-                                }
-                                catch( ... )
+                                if ( rw::TextureBase *prevTex = FindTextureByName( prevTexDict, texName ) )
                                 {
-                                    delete fsImgStream;
+                                    prevTex->RemoveFromDictionary();
+                                    prevTex->AddToDictionary( texDict );
 
-                                    throw;
-                                }
+                                    stats.reusedTextureCount++;
 
-                                delete fsImgStream;
+                                    isReused = true;
+                                }
                             }
-                            else
+                        }
+
+                        if ( !isReused )
+                        {
+                            try
                             {
-                                module->OnMessage( std::wstring( L"failed to open texture: " ) + texturePath.convert_unicode() + L'\n' );
+                                BuildTextureFromFile(
+                                    rwEngine, texDict,
+                                    gameRoot, source.path,
+                                    module, config, source.extention,
+                                    source.cfgNode
+                                );
                             }
+                            catch( rw::RwException& except )
+                            {
+                                // Tell the runtime about any errors.
+                                module->OnMessage( std::string( "failed to build texture: " ) + except.message + '\n' );
 
-                            // Allow termination per texture.
-                            rw::CheckThreadHazards( rwEngine );
-                        };
+                                // Try again at the next build.
+                                hasFailedTextures = true;
+
+                                // Continue. This is just one of many textures.
+                            }
+                        }
 
-                        gameRoot->ScanDirectory( dirPath, "*", false, NULL, std::move( per_dir_file_cb ), NULL );
+                        // Allow termination per texture.
+                        rw::CheckThreadHazards( rwEngine );
                     }
 
                     // If we have at least one texture in this texture dictionary, we can initialize it and write away.
@@ -893,6 +1153,14 @@ void BuildTXDArchives(
                             }
 
                             delete fsTXDStream;
+
+                            // Remember what this TXD was built from.
+                            if ( !hasFailedTextures )
+                            {
+                                manifest.SetEntry( manifestKey, std::move( newEntry ) );
+                            }
+
+                            stats.rebuiltCount++;
                         }
                         else
                         {
@@ -902,11 +1170,21 @@ void BuildTXDArchives(
                 }
                 catch( ... )
                 {
+                    if ( prevTexDict )
+                    {
+                        rwEngine->DeleteRwObject( prevTexDict );
+                    }
+
                     rwEngine->DeleteRwObject( texDict );
 
                     throw;
                 }
 
+                if ( prevTexDict )
+                {
+                    rwEngine->DeleteRwObject( prevTexDict );
+                }
+
                 rwEngine->DeleteRwObject( texDict );
             }
 
@@ -922,6 +1200,15 @@ void BuildTXDArchives(
 
     // Let us use the kickass C++11 lambdas :)
     gameRoot->ScanDirectory( "@", "*", true, std::move( dir_callback ), NULL, NULL );
+
+    // The scan went through, so directories that are not there anymore can be forgotten.
+    manifest.KeepOnly( visitedTXDs );
+
+    module->OnMessage(
+        "\n" + std::to_string( stats.rebuiltCount ) + " TXDs built, " +
+        std::to_string( stats.upToDateCount ) + " up to date, " +
+        std::to_string( stats.reusedTextureCount ) + " textures reused\n"
+    );
 }
 
 bool TxdBuildModule::RunApplication( const run_config& config )
@@ -994,7 +1281,26 @@ bool TxdBuildModule::RunApplication( const run_config& config )
                         {
                             if ( hasGameRoot && hasOutputRoot )
                             {
-                                BuildTXDArchives( this->rwEngine, this, gameRootTranslator, outputRootTranslator, config, rootNode );
+                                // Remember what every TXD was built from, so that the next build can skip unchanged ones.
+                                BuildManifest manifest;
+                                manifest.Load( outputRootTranslator, TXDBUILD_MANIFEST_FILE, GetBuildSettingsFingerprint( config ) );
+
+                                try
+                                {
+                                    BuildTXDArchives( this->rwEngine, this, gameRootTranslator, outputRootTranslator, config, rootNode, manifest );
+                                }
+                                catch( ... )
+                                {
+                                    // Keep the records of all TXDs that were finished.
+                                    manifest.Save( outputRootTranslator, TXDBUILD_MANIFEST_FILE );
+
+                                    throw;
+                                }
+
+                                if ( manifest.Save( outputRootTranslator, TXDBUILD_MANIFEST_FILE ) == false )
+                                {
+                                    this->OnMessage( L"failed to write build manifest\n" );
+                                }
                             }
                         }
                         catch( ... )
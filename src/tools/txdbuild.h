@@ -24,6 +24,9 @@ struct TxdBuildModule abstract : public MessageReceiver, public rw::WarningManag
         float compressionQuality = 1.0f;
         bool doPalettize = false;
         rw::ePaletteType paletteType = rw::PALETTE_NONE;
+
+        // Only rebuild TXDs whose sources or configuration changed since the last build.
+        bool incrementalBuild = true;
     };
 
     bool RunApplication( const run_config& cfg );
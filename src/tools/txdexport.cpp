@@ -3,6 +3,21 @@
 
 #include "dirtools.h"
 
+#include "convcache.h"
+
+// Name of the file in the output root that lists which exported image stands in for which texture.
+#define TXDEXPORT_DEDUP_REPORT      "_duplicates.txt"
+
+// Remembers the images that were exported already, by the contents of their rasters.
+struct exportDedupTable
+{
+    std::map <std::string, filePath> exportedImages;
+
+    // Lines of "<skipped image>\t<exported image>".
+    std::string report;
+    unsigned int duplicateCount = 0;
+};
+
 static rw::TexDictionary* RwTexDictionaryStreamRead( rw::Interface *rwEngine, CFile *stream )
 {
     rw::TexDictionary *resultDict = NULL;
@@ -51,7 +66,8 @@ static void ExportImagesFromDictionary(
     rw::TexDictionary *texDict, CFileTranslator *outputRoot,
     const filePath& txdFileName, const filePath& relPathFromRoot,
     MassExportModule::eOutputType outputType,
-    const std::string& imgFormat
+    const std::string& imgFormat,
+    exportDedupTable *dedupTable
 )
 {
     rw::Interface *rwEngine = texDict->GetEngine();
@@ -90,6 +106,31 @@ static void ExportImagesFromDictionary(
 
             targetFileName += lower_ext;
 
+            // Native textures carry their own properties, so only images are deduplicated.
+            if ( dedupTable && stricmp( imgFormat.c_str(), "RWTEX" ) != 0 )
+            {
+                rw::uint64 contentHashLow, contentHashHigh;
+
+                texRaster->getContentHash( contentHashLow, contentHashHigh );
+
+                convCacheHasher keyHash;
+                keyHash.feedValue( contentHashLow );
+                keyHash.feedValue( contentHashHigh );
+
+                std::string keyString = keyHash.finish().toString();
+
+                auto iter = dedupTable->exportedImages.find( keyString );
+
+                if ( iter != dedupTable->exportedImages.end() )
+                {
+                    dedupTable->report += targetFileName.convert_ansi() + "\t" + iter->second.convert_ansi() + "\n";
+                    dedupTable->duplicateCount++;
+                    continue;
+                }
+
+                dedupTable->exportedImages[ keyString ] = targetFileName;
+            }
+
             // Create the target stream.
             CFile *targetStream = outputRoot->Open( targetFileName, "wb" );
 
@@ -147,6 +188,7 @@ struct _discFileSentry_txdexport
 {
     MassExportModule *module;
     const MassExportModule::run_config *config;
+    exportDedupTable *dedupTable;
 
     inline bool OnSingletonFile(
         CFileTranslator *sourceRoot, CFileTranslator *buildRoot, const filePath& relPathFromRoot,
@@ -195,7 +237,7 @@ struct _discFileSentry_txdexport
                         // Export everything inside of this.
                         ExportImagesFromDictionary(
                             texDict, buildRoot, fileName, relPathFromRootWithoutFile, config->outputType,
-                            config->recImgFormat
+                            config->recImgFormat, this->dedupTable
                         );
 
                         anyWork = true;
@@ -251,16 +293,34 @@ bool MassExportModule::ApplicationMain( const run_config& cfg )
                 }
 #endif
 
+                this->rwEngine->SetTGARunLengthEncoding( cfg.compressTGA );
+
                 gtaFileProcessor <_discFileSentry_txdexport> fileProc( this );
 
                 fileProc.setUseCompressedIMGArchives( true );
                 fileProc.setArchiveReconstruction( false );
 
+                exportDedupTable dedupTable;
+
                 _discFileSentry_txdexport sentry;
                 sentry.module = this;
                 sentry.config = &cfg;
+                sentry.dedupTable = ( cfg.deduplicateImages ? &dedupTable : NULL );
 
                 fileProc.process( &sentry, gameRootTranslator, outputRootTranslator );
+
+                fileProc.reportStreamStatistics();
+
+                // Tell the user where the skipped images can be found.
+                if ( dedupTable.duplicateCount != 0 )
+                {
+                    if ( CFile *reportStream = outputRootTranslator->Open( TXDEXPORT_DEDUP_REPORT, "wb" ) )
+                    {
+                        reportStream->Write( dedupTable.report.data(), 1, dedupTable.report.size() );
+
+                        delete reportStream;
+                    }
+                }
             }
         }
         catch( ... )
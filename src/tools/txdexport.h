@@ -17,6 +17,12 @@ struct MassExportModule abstract : public MessageReceiver
         std::wstring outputRoot = L"export_out/";
         std::string recImgFormat = "PNG";
         eOutputType outputType = OUTPUT_TXDNAME;
+
+        // Write each unique image only once and list the duplicates in a report.
+        bool deduplicateImages = true;
+
+        // Compress TGA output with run-length encoding; flat UI textures shrink a lot.
+        bool compressTGA = false;
     };
 
     inline MassExportModule( rw::Interface *rwEngine )
@@ -8,10 +8,15 @@
 
 #include "dirtools.h"
 
+#include "convcache.h"
+
 using namespace rwkind;
 
+// Increase this if the conversion logic changes in a way that makes cached results invalid.
+static const rw::uint32 TXDGEN_CONVCACHE_VERSION = 3;
+
 
-static inline void ConvertRasterToPlatformEx( rw::TextureBase *theTexture, rw::Raster *texRaster, rwkind::eTargetPlatform targetPlatform, rwkind::eTargetGame targetGame )
+static inline bool ConvertRasterToPlatformEx( rw::TextureBase *theTexture, rw::Raster *texRaster, rwkind::eTargetPlatform targetPlatform, rwkind::eTargetGame targetGame )
 {
     bool hasConversionSucceeded = rwkind::ConvertRasterToPlatform( texRaster, targetPlatform, targetGame );
 
@@ -19,6 +24,8 @@ static inline void ConvertRasterToPlatformEx( rw::TextureBase *theTexture, rw::R
     {
         theTexture->GetEngine()->PushWarning( "TxdGen: failed to convert texture " + theTexture->GetName() );
     }
+
+    return hasConversionSucceeded;
 }
 
 bool TxdGenModule::ProcessTXDArchive(
@@ -28,6 +35,7 @@ bool TxdGenModule::ProcessTXDArchive(
     bool improveFiltering,
     bool doCompress, float compressionQuality,
     bool outputDebug, CFileTranslator *debugRoot,
+    RasterDedupCache *dedupCache,
     const rw::LibraryVersion& gameVersion,
     std::string& errMsg
 ) const
@@ -99,6 +107,56 @@ bool TxdGenModule::ProcessTXDArchive(
 
                         if ( texRaster )
                         {
+                            // Maybe we have converted the same raster already.
+                            convCacheKey dedupKey;
+
+                            if ( dedupCache )
+                            {
+                                dedupKey = dedupCache->GetKey( texRaster );
+
+                                std::string dedupWarnings;
+
+                                if ( rw::Raster *convertedRaster = dedupCache->Fetch( dedupKey, dedupWarnings ) )
+                                {
+                                    theTexture->SetRaster( convertedRaster );
+
+                                    rw::DeleteRaster( convertedRaster );
+
+                                    theTexture->SetEngineVersion( gameVersion );
+
+                                    // Report the same diagnostics as the conversion that produced the raster.
+                                    if ( dedupWarnings.empty() == false )
+                                    {
+                                        rwEngine->PushWarning( std::move( dedupWarnings ) );
+                                    }
+
+                                    // Only the texture properties are left to be updated.
+                                    if ( clearMipmaps || generateMipmaps )
+                                    {
+                                        theTexture->fixFiltering();
+                                    }
+
+                                    if ( improveFiltering )
+                                    {
+                                        theTexture->improveFiltering();
+                                    }
+
+                                    continue;
+                                }
+                            }
+
+                            // The warnings of this conversion are kept along with the result in the deduplication table.
+                            size_t warningsStart = 0;
+
+                            if ( dedupCache )
+                            {
+                                rwEngine->FlushWarnings();
+
+                                warningsStart = this->_warningMan.buffer.size();
+                            }
+
+                            bool convertSuccessful = true;
+
                             // Decide whether to convert to target architecture beforehand or afterward.
                             bool shouldConvertBeforehand = ShouldRasterConvertBeforehand( texRaster, targetPlatform );
 
@@ -106,26 +164,34 @@ bool TxdGenModule::ProcessTXDArchive(
 
                             if ( shouldConvertBeforehand == true )
                             {
-                                ConvertRasterToPlatformEx( theTexture, texRaster, targetPlatform, targetGame );
+                                convertSuccessful = ConvertRasterToPlatformEx( theTexture, texRaster, targetPlatform, targetGame );
 
                                 hasConvertedToTargetArchitecture = true;
                             }
 
-                            // Clear mipmaps if requested.
-                            if ( clearMipmaps )
+                            // Mipmap operations are run in one pass over the raster.
                             {
-                                texRaster->clearMipmaps();
+                                rw::RasterPipeline mipmapPipe;
 
-                                theTexture->fixFiltering();
-                            }
+                                // Clear mipmaps if requested.
+                                if ( clearMipmaps )
+                                {
+                                    mipmapPipe.clearMipmaps();
+                                }
 
-                            // Generate mipmaps on demand.
-                            if ( generateMipmaps )
-                            {
-                                // We generate as many mipmaps as we can.
-                                texRaster->generateMipmaps( mipGenMaxLevel + 1, mipGenMode );
+                                // Generate mipmaps on demand.
+                                if ( generateMipmaps )
+                                {
+                                    // We generate as many mipmaps as we can.
+                                    mipmapPipe.generateMipmaps( mipGenMaxLevel + 1, mipGenMode );
+                                }
+
+                                if ( mipmapPipe.isEmpty() == false )
+                                {
+                                    rw::ExecuteRasterPipeline( texRaster, mipmapPipe );
 
-                                theTexture->fixFiltering();
+                                    theTexture->fixFiltering();
+                                }
                             }
 
                             // Output debug stuff.
@@ -224,7 +290,7 @@ bool TxdGenModule::ProcessTXDArchive(
                                 // If we are not target architecture already, make sure we are.
                                 if ( hasConvertedToTargetArchitecture == false )
                                 {
-                                    ConvertRasterToPlatformEx( theTexture, texRaster, targetPlatform, targetGame );
+                                    convertSuccessful = ConvertRasterToPlatformEx( theTexture, texRaster, targetPlatform, targetGame );
 
                                     hasConvertedToTargetArchitecture = true;
                                 }
@@ -251,11 +317,36 @@ bool TxdGenModule::ProcessTXDArchive(
                             {
                                 if ( hasConvertedToTargetArchitecture == false )
                                 {
-                                    ConvertRasterToPlatformEx( theTexture, texRaster, targetPlatform, targetGame );
+                                    convertSuccessful = ConvertRasterToPlatformEx( theTexture, texRaster, targetPlatform, targetGame );
 
                                     hasConvertedToTargetArchitecture = true;
                                 }
                             }
+
+                            // Later copies of this raster can take the result, unless the conversion failed.
+                            if ( dedupCache && convertSuccessful )
+                            {
+                                rwEngine->FlushWarnings();
+
+                                const std::string& warningBuffer = this->_warningMan.buffer;
+
+                                std::string convWarnings;
+
+                                if ( warningBuffer.size() > warningsStart )
+                                {
+                                    // Skip the separator to the warnings that came before.
+                                    size_t warningsOffset = warningsStart;
+
+                                    if ( warningsOffset != 0 )
+                                    {
+                                        warningsOffset++;
+                                    }
+
+                                    convWarnings = warningBuffer.substr( warningsOffset );
+                                }
+
+                                dedupCache->Store( dedupKey, texRaster, convWarnings );
+                            }
                         }
                     }
                 }
@@ -366,6 +457,9 @@ struct _discFileSentry_txdgen
     rw::LibraryVersion gameVersion;
     bool outputDebug;
     CFileTranslator *debugTranslator;
+    ConversionCache *convCache;
+    RasterDedupCache *dedupCache;
+    convCacheHasher settingsHash;       // hash over all settings that affect the conversion result
 
     inline bool OnSingletonFile(
         CFileTranslator *sourceRoot, CFileTranslator *buildRoot, const filePath& relPathFromRoot,
@@ -403,33 +497,117 @@ struct _discFileSentry_txdgen
                 {
                     module->OnMessage( "*** " + relPathFromRoot.convert_ansi() + " ..." );
 
-                    std::string errorMessage;
-
-                    bool couldProcessTXD = this->module->ProcessTXDArchive(
-                        sourceRoot, sourceStream, targetStream, this->targetPlatform, this->targetGame,
-                        this->clearMipmaps,
-                        this->generateMipmaps, this->mipGenMode, this->mipGenMaxLevel,
-                        this->improveFiltering,
-                        this->doCompress, this->compressionQuality,
-                        this->outputDebug, this->debugTranslator,
-                        this->gameVersion,
-                        errorMessage
-                    );
+                    // Keep the warnings of this TXD together, even if they come from worker threads.
+                    rw::utils::warning_batch_scope warnBatch( module->GetEngine() );
+
+                    // Debug output needs the textures, so it always goes the long way.
+                    ConversionCache *convCache = ( this->outputDebug ? NULL : this->convCache );
+
+                    convCacheKey cacheKey;
+
+                    bool isCacheHit = false;
+
+                    std::string cachedWarnings;
+
+                    if ( convCache )
+                    {
+                        convCacheHasher inputHash = this->settingsHash;
+
+                        sourceStream->Seek( 0, SEEK_SET );
+
+                        inputHash.feedStream( sourceStream );
 
-                    if ( couldProcessTXD )
+                        sourceStream->Seek( 0, SEEK_SET );
+
+                        cacheKey = inputHash.finish();
+
+                        isCacheHit = convCache->Fetch( cacheKey, targetStream, cachedWarnings );
+                    }
+
+                    if ( isCacheHit )
                     {
                         hasCopiedFile = true;
 
                         anyWork = true;
 
-                        module->OnMessage( "OK\n" );
+                        module->OnMessage( "OK (cached)\n" );
+
+                        // Report the same diagnostics as the run that produced the entry.
+                        if ( cachedWarnings.empty() == false )
+                        {
+                            module->_warningMan.OnWarning( std::move( cachedWarnings ) );
+                        }
                     }
                     else
                     {
-                        module->OnMessage( "error:\n" + errorMessage + "\n" );
+                        // Write the result into the cache first, so that it can be stored in one go.
+                        CFile *cacheStream = NULL;
+
+                        if ( convCache )
+                        {
+                            cacheStream = convCache->BeginStore( cacheKey );
+                        }
+
+                        std::string errorMessage;
+
+                        bool couldProcessTXD = false;
+
+                        try
+                        {
+                            couldProcessTXD = this->module->ProcessTXDArchive(
+                                sourceRoot, sourceStream, ( cacheStream ? cacheStream : targetStream ), this->targetPlatform, this->targetGame,
+                                this->clearMipmaps,
+                                this->generateMipmaps, this->mipGenMode, this->mipGenMaxLevel,
+                                this->improveFiltering,
+                                this->doCompress, this->compressionQuality,
+                                this->outputDebug, this->debugTranslator,
+                                ( this->outputDebug ? NULL : this->dedupCache ),
+                                this->gameVersion,
+                                errorMessage
+                            );
+                        }
+                        catch( ... )
+                        {
+                            if ( cacheStream )
+                            {
+                                convCache->EndStore( cacheKey, cacheStream, false, std::string(), targetStream );
+                            }
+
+                            throw;
+                        }
+
+                        if ( cacheStream )
+                        {
+                            // The warnings of this TXD are stored along with the result.
+                            module->GetEngine()->FlushWarnings();
+
+                            bool couldStore = convCache->EndStore( cacheKey, cacheStream, couldProcessTXD, module->_warningMan.buffer, targetStream );
+
+                            if ( couldProcessTXD && !couldStore )
+                            {
+                                errorMessage = "failed to transfer the result from the conversion cache";
+
+                                couldProcessTXD = false;
+                            }
+                        }
+
+                        if ( couldProcessTXD )
+                        {
+                            hasCopiedFile = true;
+
+                            anyWork = true;
+
+                            module->OnMessage( "OK\n" );
+                        }
+                        else
+                        {
+                            module->OnMessage( "error:\n" + errorMessage + "\n" );
+                        }
                     }
 
                     // Output any warnings.
+                    module->GetEngine()->FlushWarnings();
+
                     module->_warningMan.Purge();
                 }
             }
@@ -613,6 +791,23 @@ TxdGenModule::run_config TxdGenModule::ParseConfig( CFileTranslator *root, const
                     }
                 }
 
+                // ETC compression quality.
+                if ( const char *etcQuality = mainEntry->Get( "etcQuality" ) )
+                {
+                    if ( stricmp( etcQuality, "fast" ) == 0 )
+                    {
+                        cfg.c_etcQuality = rw::ETCQUALITY_FAST;
+                    }
+                    else if ( stricmp( etcQuality, "normal" ) == 0 )
+                    {
+                        cfg.c_etcQuality = rw::ETCQUALITY_NORMAL;
+                    }
+                    else if ( stricmp( etcQuality, "high" ) == 0 )
+                    {
+                        cfg.c_etcQuality = rw::ETCQUALITY_HIGH;
+                    }
+                }
+
                 // Warning level.
                 if ( mainEntry->Find( "warningLevel" ) )
                 {
@@ -660,6 +855,43 @@ TxdGenModule::run_config TxdGenModule::ParseConfig( CFileTranslator *root, const
                 {
                     cfg.c_outputDebug = mainEntry->GetBool( "outputDebug" );
                 }
+
+                // Conversion cache.
+                if ( mainEntry->Find( "useConversionCache" ) )
+                {
+                    cfg.c_useConversionCache = mainEntry->GetBool( "useConversionCache" );
+                }
+
+                if ( const char *cacheRoot = mainEntry->Get( "conversionCacheRoot" ) )
+                {
+                    cfg.c_conversionCacheRoot = (std::wstring_convert <std::codecvt <wchar_t, char, std::mbstate_t>, wchar_t> ()).from_bytes( cacheRoot );
+                }
+
+                if ( mainEntry->Find( "conversionCacheMaxSize" ) )
+                {
+                    int cacheMaxSizeInt = mainEntry->GetInt( "conversionCacheMaxSize" );
+
+                    if ( cacheMaxSizeInt >= 0 )
+                    {
+                        cfg.c_conversionCacheMaxSize = (rw::uint32)cacheMaxSizeInt;
+                    }
+                }
+
+                // Texture deduplication.
+                if ( mainEntry->Find( "deduplicateTextures" ) )
+                {
+                    cfg.c_deduplicateTextures = mainEntry->GetBool( "deduplicateTextures" );
+                }
+
+                if ( mainEntry->Find( "dedupMaxMemory" ) )
+                {
+                    int dedupMaxMemoryInt = mainEntry->GetInt( "dedupMaxMemory" );
+
+                    if ( dedupMaxMemoryInt >= 0 )
+                    {
+                        cfg.c_dedupMaxMemory = (rw::uint32)dedupMaxMemoryInt;
+                    }
+                }
             }
 
             // Kill the configuration.
@@ -687,6 +919,7 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
         // Set some configuration.
         rwEngine->SetPaletteRuntime( cfg.c_palRuntimeType );
         rwEngine->SetDXTRuntime( cfg.c_dxtRuntimeType );
+        rwEngine->SetETCCompressionQuality( cfg.c_etcQuality );
 
         // We inherit certain properties from Magic.TXD, so we do not want to set them here anymore.
 #if 0
@@ -769,6 +1002,10 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
         {
             strTargetPlatform = "uncompressed [mobile]";
         }
+        else if ( cfg.c_targetPlatform == PLATFORM_ETC )
+        {
+            strTargetPlatform = "ETC [mobile]";
+        }
 
         this->OnMessage(
             std::string( "* targetPlatform: " ) + strTargetPlatform + "\n"
@@ -859,6 +1096,27 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
             std::string( "* dxtRuntimeType: " ) + strDXTRuntimeType + "\n"
         );
 
+        rw::eETCCompressionQuality actualETCQuality = rwEngine->GetETCCompressionQuality();
+
+        const char *strETCQuality = "unknown";
+
+        if ( actualETCQuality == rw::ETCQUALITY_FAST )
+        {
+            strETCQuality = "fast";
+        }
+        else if ( actualETCQuality == rw::ETCQUALITY_NORMAL )
+        {
+            strETCQuality = "normal";
+        }
+        else if ( actualETCQuality == rw::ETCQUALITY_HIGH )
+        {
+            strETCQuality = "high";
+        }
+
+        this->OnMessage(
+            std::string( "* etcQuality: " ) + strETCQuality + "\n"
+        );
+
         this->OnMessage(
             std::string( "* warningLevel: " ) + std::to_string( rwEngine->GetWarningLevel() ) + "\n"
         );
@@ -887,6 +1145,32 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
             std::string( "* ignoreSerializationRegions: " ) + ( rwEngine->GetIgnoreSerializationBlockRegions() ? "true" : "false" ) + "\n"
         );
 
+        this->OnMessage(
+            std::string( "* useConversionCache: " ) + ( cfg.c_useConversionCache ? "true" : "false" ) + "\n"
+        );
+
+        if ( cfg.c_useConversionCache )
+        {
+            this->OnMessage(
+                L"* conversionCacheRoot: " + cfg.c_conversionCacheRoot + L"\n"
+            );
+
+            this->OnMessage(
+                std::string( "* conversionCacheMaxSize: " ) + std::to_string( cfg.c_conversionCacheMaxSize ) + " MB\n"
+            );
+        }
+
+        this->OnMessage(
+            std::string( "* deduplicateTextures: " ) + ( cfg.c_deduplicateTextures ? "true" : "false" ) + "\n"
+        );
+
+        if ( cfg.c_deduplicateTextures )
+        {
+            this->OnMessage(
+                std::string( "* dedupMaxMemory: " ) + std::to_string( cfg.c_dedupMaxMemory ) + " MB\n"
+            );
+        }
+
         // Finish with a newline.
         this->OnMessage( "\n" );
 
@@ -908,6 +1192,20 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
                 hasDebugRoot = obtainAbsolutePath( L"debug_output/", absDebugOutputTranslator, true, true );
             }
 
+            CFileTranslator *absCacheTranslator = NULL;
+
+            bool hasCacheRoot = false;
+
+            if ( cfg.c_useConversionCache )
+            {
+                hasCacheRoot = obtainAbsolutePath( cfg.c_conversionCacheRoot.c_str(), absCacheTranslator, true, true );
+
+                if ( !hasCacheRoot )
+                {
+                    this->OnMessage( "could not get a filesystem handle to the conversion cache; converting without it\n\n" );
+                }
+            }
+
             if ( hasGameRoot && hasOutputRoot )
             {
                 try
@@ -940,8 +1238,84 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
                     sentry.gameVersion = targetVersion;
                     sentry.outputDebug = cfg.c_outputDebug;
                     sentry.debugTranslator = absDebugOutputTranslator;
+                    sentry.convCache = NULL;
+                    sentry.dedupCache = NULL;
+
+                    // Everything that changes the output of ProcessTXDArchive has to be part of the cache key.
+                    {
+                        convCacheHasher& settingsHash = sentry.settingsHash;
+
+                        settingsHash.feedValue( TXDGEN_CONVCACHE_VERSION );
+                        settingsHash.feedValue( sentry.targetPlatform );
+                        settingsHash.feedValue( sentry.targetGame );
+                        settingsHash.feedValue( targetVersion.rwLibMajor );
+                        settingsHash.feedValue( targetVersion.rwLibMinor );
+                        settingsHash.feedValue( targetVersion.rwRevMajor );
+                        settingsHash.feedValue( targetVersion.rwRevMinor );
+                        settingsHash.feedValue( sentry.clearMipmaps );
+                        settingsHash.feedValue( sentry.generateMipmaps );
+                        settingsHash.feedValue( sentry.mipGenMode );
+                        settingsHash.feedValue( sentry.mipGenMaxLevel );
+                        settingsHash.feedValue( sentry.improveFiltering );
+                        settingsHash.feedValue( sentry.doCompress );
+                        settingsHash.feedValue( sentry.compressionQuality );
+                        settingsHash.feedValue( rwEngine->GetPaletteRuntime() );
+                        settingsHash.feedValue( rwEngine->GetDXTRuntime() );
+                        settingsHash.feedValue( rwEngine->GetETCCompressionQuality() );
+                        settingsHash.feedValue( rwEngine->GetFixIncompatibleRasters() );
+                        settingsHash.feedValue( rwEngine->GetDXTPackedDecompression() );
+                        settingsHash.feedValue( rwEngine->GetIgnoreSerializationBlockRegions() );
+                    }
+
+                    if ( hasCacheRoot )
+                    {
+                        sentry.convCache = new ConversionCache( absCacheTranslator, (rw::uint64)cfg.c_conversionCacheMaxSize * 1024 * 1024 );
+                    }
+
+                    if ( cfg.c_deduplicateTextures )
+                    {
+                        sentry.dedupCache = new RasterDedupCache( sentry.settingsHash, (rw::uint64)cfg.c_dedupMaxMemory * 1024 * 1024 );
+                    }
+
+                    try
+                    {
+                        fileProc.process( &sentry, absGameRootTranslator, absOutputRootTranslator );
+                    }
+                    catch( ... )
+                    {
+                        // Keep what we have converted so far.
+                        delete sentry.convCache;
+
+                        delete sentry.dedupCache;
+
+                        throw;
+                    }
 
-                    fileProc.process( &sentry, absGameRootTranslator, absOutputRootTranslator );
+                    fileProc.reportStreamStatistics();
+
+                    if ( RasterDedupCache *dedupCache = sentry.dedupCache )
+                    {
+                        this->OnMessage(
+                            "texture deduplication: " + std::to_string( dedupCache->GetUniqueCount() ) + " unique rasters converted, " +
+                            std::to_string( dedupCache->GetHitCount() ) + " duplicates reused\n"
+                        );
+
+                        delete dedupCache;
+                    }
+
+                    if ( ConversionCache *convCache = sentry.convCache )
+                    {
+                        convCache->Evict();
+
+                        this->OnMessage(
+                            "conversion cache: " + std::to_string( convCache->GetHitCount() ) + " hits, " +
+                            std::to_string( convCache->GetMissCount() ) + " misses, " +
+                            std::to_string( convCache->GetEvictionCount() ) + " evicted, " +
+                            std::to_string( convCache->GetCacheSize() / ( 1024 * 1024 ) ) + " MB in use\n"
+                        );
+
+                        delete convCache;
+                    }
 
                     // Output any warnings.
                     _warningMan.Purge();
@@ -970,6 +1344,11 @@ bool TxdGenModule::ApplicationMain( const run_config& cfg )
             }
 
             // Clean up resources.
+            if ( hasCacheRoot )
+            {
+                delete absCacheTranslator;
+            }
+
             if ( hasDebugRoot )
             {
                 delete absDebugOutputTranslator;
@@ -3,6 +3,8 @@
 
 #include "shared.h"
 
+class RasterDedupCache;
+
 class TxdGenModule : public MessageReceiver
 {
 public:
@@ -38,6 +40,8 @@ public:
 
         rw::eDXTCompressionMethod c_dxtRuntimeType = rw::DXTRUNTIME_SQUISH;
 
+        rw::eETCCompressionQuality c_etcQuality = rw::ETCQUALITY_NORMAL;
+
         bool c_reconstructIMGArchives = true;
 
         bool c_fixIncompatibleRasters = true;
@@ -54,6 +58,15 @@ public:
         int c_warningLevel = 3;
 
         bool c_ignoreSecureWarnings = false;
+
+        // Results of earlier runs are reused if neither the input TXD nor the settings changed.
+        bool c_useConversionCache = true;
+        std::wstring c_conversionCacheRoot = L"txdgen_cache/";
+        rw::uint32 c_conversionCacheMaxSize = 1024;     // in megabytes
+
+        // Identical textures that appear in multiple TXDs are converted only once.
+        bool c_deduplicateTextures = true;
+        rw::uint32 c_dedupMaxMemory = 256;              // in megabytes
     };
 
     run_config ParseConfig( CFileTranslator *root, const filePath& cfgPath ) const;
@@ -67,6 +80,7 @@ public:
         bool improveFiltering,
         bool doCompress, float compressionQuality,
         bool outputDebug, CFileTranslator *debugRoot,
+        RasterDedupCache *dedupCache,
         const rw::LibraryVersion& gameVersion,
         std::string& errMsg
     ) const;
@@ -36,7 +36,8 @@ static platformToNaturalList_t platformToNaturalList =
     { rwkind::PLATFORM_DXT_MOBILE, "S3TC mobile" },
     { rwkind::PLATFORM_PVR, "PowerVR" },
     { rwkind::PLATFORM_ATC, "AMD TC" },
-    { rwkind::PLATFORM_UNC_MOBILE, "uncomp. mobile" }
+    { rwkind::PLATFORM_UNC_MOBILE, "uncomp. mobile" },
+    { rwkind::PLATFORM_ETC, "ETC mobile" }
 };
 
 struct gameToNatural
@@ -1,21 +1,19 @@
 #include "StdInc.h"
 
-#include "rwutils.hxx"
-
 RenderWareThumbnailProvider::RenderWareThumbnailProvider( void ) : refCount( 1 )
 {
     this->isInitialized = false;
-    this->thumbObj = NULL;
+    this->thumbStream = NULL;
 
     module_refCount++;
 }
 
 RenderWareThumbnailProvider::~RenderWareThumbnailProvider( void )
 {
-    // If we have a RenderWare object, free it.
-    if ( rw::RwObject *rwObj = this->thumbObj )
+    // Let go of the stream that the shell gave us.
+    if ( IStream *thumbStream = this->thumbStream )
     {
-        rwEngine->DeleteRwObject( rwObj );
+        thumbStream->Release();
     }
 
     // TODO: this is actually crap, because after this operation we also have to execute code, anyway.
@@ -81,57 +79,15 @@ IFACEMETHODIMP RenderWareThumbnailProvider::Initialize( IStream *pStream, DWORD
     if ( this->isInitialized )
         return HRESULT_FROM_WIN32(ERROR_ALREADY_INITIALIZED);
 
-    try
-    {
-        // We decide to handle the thing over here.
-        // So we want to read the RenderWare object.
-        rw::Stream *rwStream = RwStreamCreateFromWin32( rwEngine, pStream );
+    // We only know the size of the thumbnail in GetThumbnail, so we decode there.
+    // That way only as many texels as the thumbnail needs are decoded.
+    pStream->AddRef();
 
-        if ( rwStream )
-        {
-            try
-            {
-                this->thumbObj = rwEngine->Deserialize( rwStream );
-            }
-            catch( ... )
-            {
-                // We failed for some reason.
-            }
+    this->thumbStream = pStream;
 
-            rwEngine->DeleteStream( rwStream );
-        }
+    this->isInitialized = true;
 
-        this->isInitialized = true;
-
-        return S_OK;
-    }
-    catch( ... )
-    {
-        // Shit.
-        return E_FAIL;
-    }
-}
-
-static void adjustToMaxDimm( rw::uint32 width, rw::uint32 height, rw::uint32 maxDimm, rw::uint32& recWidth, rw::uint32& recHeight )
-{
-    if ( width > maxDimm )
-    {
-        double aspectRatio = (double)height / (double)width;
-
-        width = maxDimm;
-        height = (rw::uint32)( (double)width * aspectRatio );
-    }
-    
-    if ( height > maxDimm )
-    {
-        double aspectRatio = (double)width / (double)height;
-
-        height = maxDimm;
-        width = (rw::uint32)( (double)height * aspectRatio );
-    }
-
-    recWidth = width;
-    recHeight = height;
+    return S_OK;
 }
 
 struct bitmapPixel
@@ -139,13 +95,8 @@ struct bitmapPixel
     unsigned char b, g, r, a;
 };
 
-static HRESULT rasterToHBITMAP( rw::Raster *raster, rw::uint32 bmpWidth, rw::uint32 bmpHeight, HBITMAP *pBitmap, bool& hasAlphaOut )
+static HRESULT bitmapToHBITMAP( const rw::Bitmap& pixelData, HBITMAP *pBitmap, bool& hasAlphaOut )
 {
-    rw::Bitmap pixelData = raster->getBitmap();
-
-    // We should scale the bitmap.
-    pixelData.scale( rwEngine, bmpWidth, bmpHeight );
-
     // We want to encode as 32bit HBITMAP.
     rw::uint32 width, height;
     pixelData.getSize( width, height );
@@ -238,85 +189,60 @@ static HRESULT rasterToHBITMAP( rw::Raster *raster, rw::uint32 bmpWidth, rw::uin
     return S_OK;
 }
 
-static HRESULT generateRasterPreviewHBITMAP( UINT cx, rw::Raster *texRaster, HBITMAP *pBitmap, WTS_ALPHATYPE *pAlphaType )
+IFACEMETHODIMP RenderWareThumbnailProvider::GetThumbnail( UINT cx, HBITMAP *pBitmap, WTS_ALPHATYPE *pAlphaType )
 {
-    // So we want to turn this into an experimental HBITMAP.
-    // Lets do it!
-    // First determine the final size that it should have.
-    rw::uint32 width, height;
-    texRaster->getSize( width, height );
+    if ( !this->isInitialized )
+        return S_FALSE;
 
-    rw::uint32 recWidth, recHeight;
-    {
-        adjustToMaxDimm( width, height, cx, recWidth, recHeight );
-    }
+    IStream *thumbStream = this->thumbStream;
 
-    rw::Raster *srcRaster = rw::AcquireRaster( texRaster );
+    if ( thumbStream == NULL || cx == 0 )
+        return S_FALSE;
 
-    HRESULT res;
+    HRESULT res = S_FALSE;
 
     try
     {
-        // Do stuff.
-        bool hasAlpha = false;
-        HBITMAP bmp;
-
-        res = rasterToHBITMAP( srcRaster, recWidth, recHeight, &bmp, hasAlpha );
+        rw::Stream *rwStream = RwStreamCreateFromWin32( rwEngine, thumbStream );
 
-        if ( res == S_OK )
+        if ( rwStream )
         {
-            *pBitmap = bmp;
-            *pAlphaType = ( hasAlpha ? WTSAT_ARGB : WTSAT_RGB );
-        }
-    }
-    catch( ... )
-    {
-        rw::DeleteRaster( srcRaster );
-
-        throw;
-    }
+            try
+            {
+                // Decodes TXDs and textures from the closest mipmap of their first raster.
+                rw::Bitmap pixelData( rwEngine );
 
-    // Clean up.
-    rw::DeleteRaster( srcRaster );
+                bool gotThumbnail = rw::DecodeThumbnail( rwStream, cx, pixelData );
 
-    return res;
-}
+                if ( gotThumbnail )
+                {
+                    bool hasAlpha = false;
+                    HBITMAP bmp;
 
-IFACEMETHODIMP RenderWareThumbnailProvider::GetThumbnail( UINT cx, HBITMAP *pBitmap, WTS_ALPHATYPE *pAlphaType )
-{
-    if ( !this->isInitialized )
-        return S_FALSE;
+                    res = bitmapToHBITMAP( pixelData, &bmp, hasAlpha );
 
-    // We can always have no TXD available.
-    if ( rw::RwObject *thumbObj = this->thumbObj )
-    {
-        try
-        {
-            // It all depends on the kind of object we have!
-            if ( rw::TexDictionary *txd = rw::ToTexDictionary( rwEngine, thumbObj ) )
-            {
-                // As a test, return the first raster of the TXD.
-                if ( rw::TextureBase *texHandle = GetFirstTexture( txd ) )
-                {
-                    if ( rw::Raster *texRaster = texHandle->GetRaster() )
+                    if ( res == S_OK )
                     {
-                        return generateRasterPreviewHBITMAP( cx, texRaster, pBitmap, pAlphaType );
+                        *pBitmap = bmp;
+                        *pAlphaType = ( hasAlpha ? WTSAT_ARGB : WTSAT_RGB );
                     }
                 }
             }
-            else if ( rw::TextureBase *texHandle = rw::ToTexture( rwEngine, this->thumbObj ) )
+            catch( ... )
             {
-                if ( rw::Raster *texRaster = texHandle->GetRaster() )
-                {
-                    return generateRasterPreviewHBITMAP( cx, texRaster, pBitmap, pAlphaType );
-                }
+                rwEngine->DeleteStream( rwStream );
+
+                throw;
             }
-        }
-        catch( ... )
-        {
-            // Ignore any kind of runtime error we could encounter.
+
+            rwEngine->DeleteStream( rwStream );
         }
     }
+    catch( ... )
+    {
+        // Ignore any kind of runtime error we could encounter.
+        res = S_FALSE;
+    }
 
-    return S_FALSE;
+    return res;
 }
\ No newline at end of file
@@ -19,5 +19,5 @@ private:
 
     std::atomic <unsigned long> refCount;
 
-    rw::RwObject *thumbObj;
+    IStream *thumbStream;   // decoded once the shell tells us the thumbnail size
 };
\ No newline at end of file